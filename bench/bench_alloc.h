@@ -0,0 +1,92 @@
+/**
+ * Bench Alloc - Process-wide live heap byte and allocation counters for the
+ * benchmarks
+ *
+ * Replaces the global operator new/delete, so include it in exactly one
+ * translation unit per benchmark executable.
+ */
+
+#ifndef RUNE_DISCORD_BENCH_ALLOC_H
+#define RUNE_DISCORD_BENCH_ALLOC_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+// Every allocation in the process carries a small header with its size, so
+// live heap bytes can be compared across containers (including dpp::cache,
+// whose allocator cannot be swapped).
+static std::atomic<int64_t> g_live_bytes{ 0 };
+static std::atomic<int64_t> g_alloc_count{ 0 };
+
+// Plain allocations use malloc with a 16-byte header so node-based
+// containers are not penalized; over-aligned ones get an aligned header.
+static const size_t kHeader = 16;
+
+static void* counted_alloc(size_t size, size_t align) {
+    const size_t header = align > kHeader ? align : kHeader;
+    void* raw = nullptr;
+#if defined(_MSC_VER)
+    raw = _aligned_malloc(size + header, header);
+#else
+    if (header == kHeader) {
+        raw = malloc(size + header);
+    } else if (posix_memalign(&raw, header, size + header) != 0) {
+        raw = nullptr;
+    }
+#endif
+    if (!raw) {
+        throw std::bad_alloc();
+    }
+    auto* base = static_cast<unsigned char*>(raw);
+    *reinterpret_cast<size_t*>(base + header - 2 * sizeof(size_t)) = size;
+    *reinterpret_cast<size_t*>(base + header - sizeof(size_t)) = header;
+    g_live_bytes += static_cast<int64_t>(size);
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return base + header;
+}
+
+static void counted_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    auto* user = static_cast<unsigned char*>(ptr);
+    const size_t header = *reinterpret_cast<size_t*>(user - sizeof(size_t));
+    const size_t size = *reinterpret_cast<size_t*>(user - 2 * sizeof(size_t));
+    g_live_bytes -= static_cast<int64_t>(size);
+#if defined(_MSC_VER)
+    _aligned_free(user - header);
+#else
+    free(user - header);
+#endif
+}
+
+void* operator new(size_t size) { return counted_alloc(size, 0); }
+void* operator new[](size_t size) { return counted_alloc(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return counted_alloc(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_alloc(size, static_cast<size_t>(align)); }
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { counted_free(ptr); }
+
+static int64_t bench_live_bytes() {
+    return g_live_bytes.load();
+}
+
+// Allocations made so far (never decreases)
+static int64_t bench_alloc_count() {
+    return g_alloc_count.load(std::memory_order_relaxed);
+}
+
+#endif // RUNE_DISCORD_BENCH_ALLOC_H
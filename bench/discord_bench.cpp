@@ -0,0 +1,498 @@
+/**
+ * Discord Benchmark - End-to-end cost of the plugin behind a fake host, with
+ * MockDiscord standing in for the gateway and REST API
+ *
+ * Usage: discord_bench [--events N] [--json]
+ * Defaults: 200000 events. --json prints one machine-readable object
+ * ({"bench": ..., "results": [{"name", "value", "unit"}]}) for tracking runs
+ * over time; otherwise a table is printed.
+ *
+ * Allocation counts cover everything on the measured path, including the
+ * mock's own bookkeeping (one copy of each dispatch frame, one log entry per
+ * REST call), so they are an upper bound for the plugin alone.
+ */
+
+#include "bench_alloc.h"
+#include "bot_manager.h"
+#include "discord_plugin.h"
+#include "flow_scanner.h"
+#include "mock_discord.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+NODEPLUG_EXPORT const PluginAPI* NodePlugin_GetAPI(void);
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+static const uint64_t kGuildId = 81384788765712384ULL;
+static const uint64_t kChannelId = 81384788765712385ULL;
+static const uint64_t kBotUserId = 81384788765712386ULL;
+static const uint64_t kAuthorId = 81384788765712387ULL;
+static const char kFlowId[] = "bench-flow";
+
+static const size_t kSettingsIterations = 2000;
+static const size_t kFlowNodes = 2000;
+static const size_t kFlowIterations = 200;
+static const size_t kPrescanFlows = 64;
+static const size_t kLatencySamples = 20000;
+static const size_t kActionIterations = 20000;
+static const size_t kActionChunk = 500;  // executes per timed chunk before draining the mock
+
+// ============================================================================
+// Results
+// ============================================================================
+
+struct Result {
+    std::string name;
+    double value;
+    std::string unit;
+};
+
+static std::vector<Result> g_results;
+
+static void report(const std::string& name, double value, const std::string& unit) {
+    g_results.push_back({ name, value, unit });
+}
+
+static double elapsed_ns(Clock::time_point start, Clock::time_point end) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// ============================================================================
+// Fake host
+// ============================================================================
+
+static std::string g_settings_json;
+static std::string g_flows_directory;
+static uint64_t g_log_lines = 0;
+
+static void bench_log(int, const char*) {
+    ++g_log_lines;
+}
+
+static const char* bench_get_setting(HostServices*, const char* key) {
+    if (std::strcmp(key, "com.rune.discord") == 0) {
+        return g_settings_json.c_str();
+    }
+    if (std::strcmp(key, "flows_directory") == 0) {
+        return g_flows_directory.c_str();
+    }
+    return nullptr;
+}
+
+static HostServices g_host_services{};
+
+// ============================================================================
+// Fake node context
+// ============================================================================
+
+/**
+ * BenchContext - ExecContext with string/int inputs set by the benchmark.
+ * Outputs are kept as the host would (copied), and each trigger_output() runs
+ * on_trigger, which is where event latency is stamped.
+ */
+struct BenchContext {
+    ExecContext ctx;  // first, so ExecContext* converts back
+    std::map<std::string, std::string> inputs;
+    std::map<std::string, int64_t> int_inputs;
+    std::map<std::string, std::string> outputs;
+    uint64_t triggers = 0;
+    uint64_t errors = 0;
+    std::function<void()> on_trigger;
+
+    BenchContext();
+};
+
+static BenchContext* from_ctx(ExecContext* ctx) {
+    return reinterpret_cast<BenchContext*>(ctx);
+}
+
+static const char* ctx_get_input_string(ExecContext* ctx, const char* name) {
+    auto* self = from_ctx(ctx);
+    auto it = self->inputs.find(name);
+    return it != self->inputs.end() ? it->second.c_str() : "";
+}
+
+static int64_t ctx_get_input_int(ExecContext* ctx, const char* name) {
+    auto* self = from_ctx(ctx);
+    auto it = self->int_inputs.find(name);
+    return it != self->int_inputs.end() ? it->second : 0;
+}
+
+static double ctx_get_input_float(ExecContext*, const char*) {
+    return 0.0;
+}
+
+static bool ctx_get_input_bool(ExecContext*, const char*) {
+    return false;
+}
+
+static const char* ctx_get_property(ExecContext*, const char*) {
+    return "";
+}
+
+static void ctx_set_output_string(ExecContext* ctx, const char* name, const char* value) {
+    from_ctx(ctx)->outputs[name].assign(value ? value : "");
+}
+
+static void ctx_set_output_int(ExecContext* ctx, const char* name, int64_t value) {
+    from_ctx(ctx)->outputs[name] = std::to_string(value);
+}
+
+static void ctx_set_output_float(ExecContext* ctx, const char* name, double value) {
+    from_ctx(ctx)->outputs[name] = std::to_string(value);
+}
+
+static void ctx_set_output_bool(ExecContext* ctx, const char* name, bool value) {
+    from_ctx(ctx)->outputs[name] = value ? "true" : "false";
+}
+
+static void ctx_trigger_output(ExecContext* ctx, const char*) {
+    auto* self = from_ctx(ctx);
+    ++self->triggers;
+    if (self->on_trigger) {
+        self->on_trigger();
+    }
+}
+
+static void ctx_set_error(ExecContext* ctx, const char* message) {
+    auto* self = from_ctx(ctx);
+    if (self->errors++ == 0) {
+        std::fprintf(stderr, "node error: %s\n", message ? message : "");
+    }
+}
+
+BenchContext::BenchContext() : ctx{} {
+    ctx.get_input_string = ctx_get_input_string;
+    ctx.get_input_int = ctx_get_input_int;
+    ctx.get_input_float = ctx_get_input_float;
+    ctx.get_input_bool = ctx_get_input_bool;
+    ctx.get_property = ctx_get_property;
+    ctx.set_output_string = ctx_set_output_string;
+    ctx.set_output_int = ctx_set_output_int;
+    ctx.set_output_float = ctx_set_output_float;
+    ctx.set_output_bool = ctx_set_output_bool;
+    ctx.set_output_json = ctx_set_output_string;
+    ctx.trigger_output = ctx_trigger_output;
+    ctx.set_error = ctx_set_error;
+}
+
+// ============================================================================
+// Node registry
+// ============================================================================
+
+struct RegisteredNode {
+    const NodeDesc* desc;
+    const NodeVTable* vtable;
+};
+
+static std::map<std::string, RegisteredNode> g_nodes;
+
+static void bench_register_node(const NodeDesc* desc, const NodeVTable* vtable) {
+    g_nodes[desc->type_id] = { desc, vtable };
+}
+
+static const NodeVTable& node(const char* type_id) {
+    auto it = g_nodes.find(type_id);
+    if (it == g_nodes.end()) {
+        std::fprintf(stderr, "node %s is not registered\n", type_id);
+        std::exit(1);
+    }
+    return *it->second.vtable;
+}
+
+// ============================================================================
+// Phases
+// ============================================================================
+
+static void bench_settings_parse(const PluginAPI* api) {
+    const auto start = Clock::now();
+    for (size_t i = 0; i < kSettingsIterations; ++i) {
+        api->on_settings_changed(g_settings_json.c_str());
+    }
+    const auto end = Clock::now();
+    report("settings_parse", elapsed_ns(start, end) / kSettingsIterations / 1000.0, "us/op");
+}
+
+// Every flow that does not auto-connect is scanned for On Ready nodes when it
+// loads: flow_scan_cold is the streaming scan of a changed flow.json,
+// flow_scan a reload of an unchanged one (cache hit), and flow_prescan the
+// parallel pass over a flows directory the first load triggers
+static void bench_flow_scan(const PluginAPI* api) {
+    json nodes = json::array();
+    for (size_t i = 0; i < kFlowNodes; ++i) {
+        nodes.push_back({
+            {"id", i},
+            {"type", (i % 3 == 0) ? "com.rune.discord.send_message" : "com.rune.core.branch"},
+            {"position", { {"x", static_cast<double>(i) * 12.5}, {"y", 40.0} }},
+            {"properties", { {"label", "node " + std::to_string(i)}, {"enabled", true} }}
+        });
+    }
+    json links = json::array();
+    for (size_t i = 1; i < kFlowNodes; ++i) {
+        links.push_back({ {"from", i - 1}, {"to", i}, {"pin", "Exec"} });
+    }
+    const std::string flowDir = g_flows_directory + "/" + kFlowId;
+    std::filesystem::create_directories(flowDir);
+    const std::string text = json{ {"id", kFlowId}, {"nodes", nodes}, {"links", links} }.dump();
+    {
+        std::ofstream out(flowDir + "/flow.json", std::ios::binary);
+        out << text;
+    }
+
+    json settings = json::parse(g_settings_json);
+    settings["auto_connect"] = true;
+    api->on_settings_changed(settings.dump().c_str());
+
+    const std::string flowPath = FlowScanner::flow_path(g_flows_directory, kFlowId);
+    auto coldStart = Clock::now();
+    for (size_t i = 0; i < kFlowIterations; ++i) {
+        FlowScanner::scan_file(flowPath);
+    }
+    auto coldEnd = Clock::now();
+    report("flow_scan_cold", elapsed_ns(coldStart, coldEnd) / kFlowIterations / 1000.0, "us/op");
+    report("flow_scan_throughput",
+           static_cast<double>(text.size()) * kFlowIterations / (elapsed_ns(coldStart, coldEnd) / 1e9) / (1024.0 * 1024.0),
+           "MiB/s");
+
+    api->on_flow_loaded(kFlowId);
+    const auto start = Clock::now();
+    for (size_t i = 0; i < kFlowIterations; ++i) {
+        api->on_flow_loaded(kFlowId);
+    }
+    const auto end = Clock::now();
+    report("flow_scan", elapsed_ns(start, end) / kFlowIterations / 1000.0, "us/op");
+
+    // Copies of the flow under a fresh directory, scanned by a fresh cache
+    const std::string prescanDir = g_flows_directory + "/prescan";
+    for (size_t i = 0; i < kPrescanFlows; ++i) {
+        const std::string dir = prescanDir + "/flow-" + std::to_string(i);
+        std::filesystem::create_directories(dir);
+        std::ofstream out(dir + "/flow.json", std::ios::binary);
+        out << text;
+    }
+    FlowScanner scanner;
+    const auto prescanStart = Clock::now();
+    const size_t scanned = scanner.prescan(prescanDir);
+    const auto prescanEnd = Clock::now();
+    report("flow_prescan", elapsed_ns(prescanStart, prescanEnd) / 1e6, "ms");
+    report("flow_prescan_per_flow", elapsed_ns(prescanStart, prescanEnd) / std::max<size_t>(scanned, 1) / 1000.0,
+           "us/flow");
+    std::filesystem::remove_all(prescanDir);
+
+    api->on_settings_changed(g_settings_json.c_str());
+}
+
+static void drain(const PluginAPI* api, MockDiscord& mock) {
+    while (mock.pending() > 0) {
+        api->on_tick(0.0f);
+    }
+    api->on_tick(0.0f);
+}
+
+// Gateway dispatch -> event queue -> On Message listener -> node outputs
+static void bench_event_throughput(const PluginAPI* api, MockDiscord& mock, BenchContext& onMessage,
+                                   size_t events) {
+    for (size_t i = 0; i < events; ++i) {
+        mock.message_create(kGuildId, kChannelId, kAuthorId, "benchmark message " + std::to_string(i));
+    }
+
+    const uint64_t before = onMessage.triggers;
+    const int64_t allocsBefore = bench_alloc_count();
+    const auto start = Clock::now();
+    while (onMessage.triggers - before < events) {
+        api->on_tick(0.0f);
+    }
+    const auto end = Clock::now();
+    const int64_t allocs = bench_alloc_count() - allocsBefore;
+
+    report("event_throughput", static_cast<double>(events) / (elapsed_ns(start, end) / 1e9), "events/s");
+    report("event_allocs", static_cast<double>(allocs) / static_cast<double>(events), "allocs/event");
+}
+
+// One event per tick: time from the start of the host tick to the listener's
+// trigger_output()
+static void bench_dispatch_latency(const PluginAPI* api, MockDiscord& mock, BenchContext& onMessage) {
+    std::vector<double> samples;
+    samples.reserve(kLatencySamples);
+    Clock::time_point tickStart;
+    onMessage.on_trigger = [&]() {
+        samples.push_back(elapsed_ns(tickStart, Clock::now()));
+    };
+
+    for (size_t i = 0; i < kLatencySamples; ++i) {
+        mock.message_create(kGuildId, kChannelId, kAuthorId, "latency probe");
+        tickStart = Clock::now();
+        api->on_tick(0.0f);
+    }
+    onMessage.on_trigger = nullptr;
+
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto at = [&](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * static_cast<double>(samples.size())))];
+    };
+    report("dispatch_latency_p50", at(0.50) / 1000.0, "us");
+    report("dispatch_latency_p99", at(0.99) / 1000.0, "us");
+}
+
+// Cost of execute() alone; the REST round trips it starts are drained
+// outside the timed chunks
+static void bench_action(const PluginAPI* api, MockDiscord& mock, const char* name, const char* type_id,
+                         BenchContext& ctx) {
+    const NodeVTable& vt = node(type_id);
+    void* inst = vt.create ? vt.create() : nullptr;
+
+    double totalNs = 0.0;
+    int64_t allocs = 0;
+    for (size_t done = 0; done < kActionIterations; done += kActionChunk) {
+        const int64_t allocsBefore = bench_alloc_count();
+        const auto start = Clock::now();
+        for (size_t i = 0; i < kActionChunk; ++i) {
+            vt.execute(inst, &ctx.ctx);
+        }
+        const auto end = Clock::now();
+        allocs += bench_alloc_count() - allocsBefore;
+        totalNs += elapsed_ns(start, end);
+        drain(api, mock);
+        mock.clear_log();
+    }
+
+    if (vt.destroy) {
+        vt.destroy(inst);
+    }
+    report(std::string(name) + "_execute", totalNs / kActionIterations, "ns/op");
+    report(std::string(name) + "_allocs", static_cast<double>(allocs) / kActionIterations, "allocs/op");
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    size_t events = 200000;
+    bool jsonOutput = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            jsonOutput = true;
+        } else if (std::strcmp(argv[i], "--events") == 0 && i + 1 < argc) {
+            events = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--events N] [--json]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (events == 0) {
+        events = 1;
+    }
+
+    const PluginAPI* api = NodePlugin_GetAPI();
+
+    const auto flowsDir = std::filesystem::temp_directory_path() / "rune_discord_bench";
+    std::filesystem::remove_all(flowsDir);
+    std::filesystem::create_directories(flowsDir);
+    g_flows_directory = flowsDir.string();
+
+    // The plugin's own defaults, so settings parsing sees every key
+    g_settings_json = api->get_settings_schema()->defaults;
+
+    g_host_services.log = bench_log;
+    g_host_services.get_setting = bench_get_setting;
+    api->on_load(&g_host_services);
+
+    PluginNodeRegistry registry{};
+    registry.register_node = bench_register_node;
+    api->on_register(&registry, nullptr);
+
+    bench_settings_parse(api);
+    bench_flow_scan(api);
+
+    // Offline session against the mock, with its rate limits and latency off
+    // so the plugin is what gets measured
+    MockDiscord mock;
+    mock.set_rate_limit("POST /channels/{id}/messages", 0, Clock::duration::zero());
+    mock.set_rate_limit("PUT /channels/{id}/messages/{id}/reactions/{emoji}/@me", 0, Clock::duration::zero());
+    mock.set_global_rate_limit(0);
+    mock.add_user(kAuthorId, "bench-user");
+    mock.add_channel(kChannelId, kGuildId, "general");
+    mock.add_member(kGuildId, kAuthorId);
+
+    BotManager::instance().set_transport(&mock);
+    if (!BotManager::instance().initialize("bench")) {
+        std::fprintf(stderr, "BotManager failed to start against the mock\n");
+        return 1;
+    }
+    mock.ready(kBotUserId, { kGuildId });
+    drain(api, mock);
+
+    BenchContext onMessage;
+    const NodeVTable& onMessageVt = node("com.rune.discord.on_message");
+    void* onMessageInst = onMessageVt.create();
+    onMessageVt.start_listening(onMessageInst, &onMessage.ctx);
+
+    bench_event_throughput(api, mock, onMessage, events);
+    bench_dispatch_latency(api, mock, onMessage);
+
+    const std::string channel = std::to_string(kChannelId);
+    const std::string messageId = std::to_string(mock.message_create(kGuildId, kChannelId, kAuthorId, "reply target"));
+    drain(api, mock);
+
+    BenchContext sendMessage;
+    sendMessage.inputs = { {"ChannelID", channel}, {"Content", "hello from the benchmark"} };
+    bench_action(api, mock, "send_message", "com.rune.discord.send_message", sendMessage);
+
+    BenchContext reply;
+    reply.inputs = { {"ChannelID", channel}, {"MessageID", messageId}, {"Content", "a reply"} };
+    bench_action(api, mock, "reply_to_message", "com.rune.discord.reply_to_message", reply);
+
+    BenchContext directMessage;
+    directMessage.inputs = { {"UserID", std::to_string(kAuthorId)}, {"Content", "a direct message"} };
+    bench_action(api, mock, "send_direct_message", "com.rune.discord.send_direct_message", directMessage);
+
+    BenchContext format;
+    format.inputs = { {"Template", "{0} said {1} in <#{2}> ({3})"}, {"Arg0", "bench-user"},
+                      {"Arg1", "hello"}, {"Arg2", channel}, {"Arg3", messageId} };
+    bench_action(api, mock, "format_message", "com.rune.discord.format_message", format);
+
+    onMessageVt.stop_listening(onMessageInst);
+    onMessageVt.destroy(onMessageInst);
+    api->on_unload();
+    BotManager::instance().set_transport(nullptr);
+    std::filesystem::remove_all(flowsDir);
+
+    const uint64_t errors = sendMessage.errors + reply.errors + directMessage.errors + format.errors;
+
+    if (jsonOutput) {
+        json results = json::array();
+        for (const auto& r : g_results) {
+            results.push_back({ {"name", r.name}, {"value", r.value}, {"unit", r.unit} });
+        }
+        const json out = { {"bench", "discord_bench"}, {"events", events}, {"node_errors", errors},
+                           {"results", results} };
+        std::printf("%s\n", out.dump().c_str());
+    } else {
+        std::printf("%-30s %16s  %s\n", "benchmark", "value", "unit");
+        for (const auto& r : g_results) {
+            std::printf("%-30s %16.3f  %s\n", r.name.c_str(), r.value, r.unit.c_str());
+        }
+        if (errors > 0) {
+            std::printf("\n%llu node error(s); results are not representative\n",
+                        static_cast<unsigned long long>(errors));
+        }
+    }
+    return errors > 0 ? 1 : 0;
+}
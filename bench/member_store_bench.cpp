@@ -0,0 +1,190 @@
+/**
+ * MemberStore Benchmark - Memory and lookup cost of the compact member store
+ * versus DPP-style per-object storage for one synthetic large guild
+ *
+ * Usage: member_store_bench [member_count] [role_count]
+ * Defaults: 500000 members, 120 roles.
+ */
+
+#include "bench_alloc.h"
+#include "member_store.h"
+#include <dpp/dpp.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+static const uint64_t kGuildId = 81384788765712384ULL;
+static const size_t kChunkSize = 1000;  // members per gateway chunk
+
+static std::string random_name(std::mt19937_64& rng, size_t min_len, size_t max_len) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_.";
+    const size_t len = min_len + rng() % (max_len - min_len + 1);
+    std::string s(len, 'a');
+    for (auto& c : s) {
+        c = alphabet[rng() % (sizeof(alphabet) - 1)];
+    }
+    return s;
+}
+
+// One GUILD_MEMBERS_CHUNK "d" object per kChunkSize members, generated
+// lazily so the JSON itself does not count towards either store's memory
+class ChunkSource {
+public:
+    ChunkSource(size_t members, size_t roles) : m_members(members), m_rng(42) {
+        for (size_t i = 0; i < roles; ++i) {
+            m_roles.push_back(std::to_string(kGuildId + 1000 + i));
+        }
+    }
+
+    bool next(json& d) {
+        if (m_next >= m_members) {
+            return false;
+        }
+        json members = json::array();
+        const size_t end = std::min(m_members, m_next + kChunkSize);
+        for (; m_next < end; ++m_next) {
+            json user = {
+                {"id", std::to_string(user_id(m_next))},
+                {"username", random_name(m_rng, 6, 20)},
+                {"global_name", (m_rng() % 4 == 0) ? json(random_name(m_rng, 4, 16)) : json(nullptr)},
+                {"discriminator", "0"},
+                {"avatar", nullptr},
+                {"bot", m_rng() % 50 == 0}
+            };
+            json roles = json::array();
+            const size_t roleCount = m_rng() % 7;
+            for (size_t r = 0; r < roleCount; ++r) {
+                roles.push_back(m_roles[m_rng() % m_roles.size()]);
+            }
+            members.push_back({
+                {"user", user},
+                {"nick", (m_rng() % 7 == 0) ? json(random_name(m_rng, 3, 24)) : json(nullptr)},
+                {"roles", roles},
+                {"joined_at", "2021-05-01T12:34:56.789000+00:00"},
+                {"deaf", false},
+                {"mute", false},
+                {"flags", 0}
+            });
+        }
+        d = {
+            {"guild_id", std::to_string(kGuildId)},
+            {"members", members},
+            {"chunk_index", 0},
+            {"chunk_count", 1}
+        };
+        return true;
+    }
+
+    static uint64_t user_id(size_t i) { return (uint64_t(1) << 60) + i * 4099; }
+
+private:
+    size_t m_members;
+    size_t m_next = 0;
+    std::mt19937_64 m_rng;
+    std::vector<std::string> m_roles;
+};
+
+// What DPP keeps with its default cache policy: one heap-allocated dpp::user
+// per user in the user cache, plus one dpp::guild_member per member in the
+// guild's member map
+struct DppStyleStore {
+    std::unordered_map<dpp::snowflake, dpp::user*> users;
+    std::unordered_map<dpp::snowflake, dpp::guild_member> members;
+
+    void ingest_chunk(json& d) {
+        for (auto& m : d["members"]) {
+            const dpp::snowflake user_id = std::strtoull(m["user"]["id"].get<std::string>().c_str(), nullptr, 10);
+            auto* user = new dpp::user();
+            user->fill_from_json(&m["user"]);
+            users[user_id] = user;
+            dpp::guild_member member;
+            member.fill_from_json(&m, kGuildId, user_id);
+            members[user_id] = member;
+        }
+    }
+
+    ~DppStyleStore() {
+        for (auto& u : users) {
+            delete u.second;
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    const size_t memberCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500000;
+    const size_t roleCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 120;
+    std::printf("%zu members, %zu roles\n", memberCount, roleCount);
+
+    int64_t storeBytes = 0;
+    double storeLookupNs = 0;
+    {
+        MemberStore store;
+        ChunkSource source(memberCount, roleCount);
+        const int64_t before = bench_live_bytes();
+        json d;
+        while (source.next(d)) {
+            store.ingest_chunk(d);
+        }
+        d = json();
+        storeBytes = bench_live_bytes() - before;
+
+        StoredMember out;
+        size_t found = 0;
+        const auto t = Clock::now();
+        for (size_t i = 0; i < memberCount; ++i) {
+            found += store.get_member(kGuildId, ChunkSource::user_id(i), out) ? 1 : 0;
+        }
+        storeLookupNs = std::chrono::duration<double, std::nano>(Clock::now() - t).count() / memberCount;
+        std::printf("  MemberStore: %zu/%zu found, memory_bytes() = %.1f MB\n",
+                    found, memberCount, store.memory_bytes() / (1024.0 * 1024.0));
+    }
+
+    int64_t dppBytes = 0;
+    double dppLookupNs = 0;
+    {
+        DppStyleStore store;
+        ChunkSource source(memberCount, roleCount);
+        const int64_t before = bench_live_bytes();
+        json d;
+        while (source.next(d)) {
+            store.ingest_chunk(d);
+        }
+        d = json();
+        dppBytes = bench_live_bytes() - before;
+
+        // Same fields Get Member returns, copied out the same way
+        StoredMember out;
+        size_t found = 0;
+        const auto t = Clock::now();
+        for (size_t i = 0; i < memberCount; ++i) {
+            auto m = store.members.find(ChunkSource::user_id(i));
+            auto u = store.users.find(ChunkSource::user_id(i));
+            if (m != store.members.end() && u != store.users.end()) {
+                out.username = u->second->username;
+                out.nickname = m->second.get_nickname();
+                out.roles = m->second.get_roles();
+                ++found;
+            }
+        }
+        dppLookupNs = std::chrono::duration<double, std::nano>(Clock::now() - t).count() / memberCount;
+        std::printf("  DPP objects: %zu/%zu found\n", found, memberCount);
+    }
+
+    std::printf("  %-14s %10.1f MB  %7.1f B/member  lookup %6.1f ns\n", "MemberStore",
+                storeBytes / (1024.0 * 1024.0), double(storeBytes) / memberCount, storeLookupNs);
+    std::printf("  %-14s %10.1f MB  %7.1f B/member  lookup %6.1f ns\n", "DPP objects",
+                dppBytes / (1024.0 * 1024.0), double(dppBytes) / memberCount, dppLookupNs);
+    if (storeBytes > 0) {
+        std::printf("  reduction: %.1fx\n", double(dppBytes) / double(storeBytes));
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * MessageIndex Benchmark - Ingest rate, memory and query latency of the
+ * message history behind Search Messages
+ *
+ * Usage: message_index_bench [message_count]
+ * Defaults: 2000000 messages from 20000 authors in 500 channels, words drawn
+ * from a Zipf-like 50000-word vocabulary.
+ */
+
+#include "bench_alloc.h"
+#include "message_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const size_t kVocabulary = 50000;
+static const size_t kAuthors = 20000;
+static const size_t kChannels = 500;
+static const size_t kQueries = 2000;
+
+static std::string make_word(size_t rank) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz";
+    std::string word = "w";
+    for (size_t r = rank + 1; r > 0; r /= 26) {
+        word += alphabet[r % 26];
+    }
+    return word;
+}
+
+// Word ranks with frequency roughly proportional to 1/rank
+class ZipfWords {
+public:
+    explicit ZipfWords(std::mt19937_64& rng) : m_rng(rng) {
+        double total = 0;
+        for (size_t i = 0; i < kVocabulary; ++i) {
+            total += 1.0 / double(i + 1);
+            m_cdf.push_back(total);
+        }
+        for (auto& c : m_cdf) {
+            c /= total;
+        }
+    }
+
+    size_t next() {
+        const double u = std::uniform_real_distribution<double>(0, 1)(m_rng);
+        return static_cast<size_t>(std::lower_bound(m_cdf.begin(), m_cdf.end(), u) - m_cdf.begin());
+    }
+
+private:
+    std::mt19937_64& m_rng;
+    std::vector<double> m_cdf;
+};
+
+static uint64_t author_id(size_t i) { return (uint64_t(1) << 58) + i * 7919; }
+static uint64_t channel_id(size_t i) { return (uint64_t(1) << 59) + i * 104729; }
+
+static void report(const char* name, std::vector<double>& micros, size_t results) {
+    std::sort(micros.begin(), micros.end());
+    double sum = 0;
+    for (double m : micros) {
+        sum += m;
+    }
+    std::printf("  %-26s mean %8.2f us  p50 %8.2f us  p99 %8.2f us  (%zu results)\n", name,
+                sum / micros.size(), micros[micros.size() / 2], micros[micros.size() * 99 / 100], results);
+}
+
+int main(int argc, char** argv) {
+    const size_t messageCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    std::printf("%zu messages, %zu authors, %zu channels\n", messageCount, kAuthors, kChannels);
+
+    std::mt19937_64 rng(42);
+    ZipfWords words(rng);
+
+    MessageIndex index;
+    index.configure(messageCount, size_t(1) << 40, std::chrono::seconds(7 * 86400), MessageIndex::Eviction::Oldest);
+
+    const int64_t start = static_cast<int64_t>(std::time(nullptr)) - 3600;
+    const int64_t before = bench_live_bytes();
+    double ingestSeconds = 0;
+    {
+        IndexedMessage message;
+        const auto t = Clock::now();
+        for (size_t i = 0; i < messageCount; ++i) {
+            message.id = (uint64_t(1) << 62) + i;
+            message.author_id = author_id(rng() % kAuthors);
+            message.channel_id = channel_id(rng() % kChannels);
+            message.guild_id = 1;
+            message.timestamp = start + static_cast<int64_t>(i * 3600 / messageCount);
+            message.content.clear();
+            const size_t wordCount = 3 + rng() % 12;
+            for (size_t w = 0; w < wordCount; ++w) {
+                if (w) {
+                    message.content += ' ';
+                }
+                message.content += make_word(words.next());
+            }
+            index.add(message);
+        }
+        ingestSeconds = std::chrono::duration<double>(Clock::now() - t).count();
+    }
+    const int64_t liveBytes = bench_live_bytes() - before;
+
+    std::printf("  ingest: %.0f messages/s\n", messageCount / ingestSeconds);
+    std::printf("  memory: %.1f MB live heap (%.1f B/message), memory_bytes() = %.1f MB\n",
+                liveBytes / (1024.0 * 1024.0), double(liveBytes) / messageCount,
+                index.memory_bytes() / (1024.0 * 1024.0));
+
+    auto run = [&](const char* name, const std::function<MessageQuery()>& make) {
+        std::vector<double> micros;
+        std::vector<IndexedMessage> out;
+        size_t results = 0;
+        for (size_t q = 0; q < kQueries; ++q) {
+            MessageQuery query = make();
+            out.clear();
+            const auto t = Clock::now();
+            results += index.search(query, out);
+            micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t).count());
+        }
+        report(name, micros, results);
+    };
+
+    run("rare word", [&]() {
+        MessageQuery q;
+        q.text = make_word(5000 + rng() % 40000);
+        return q;
+    });
+    run("common word", [&]() {
+        MessageQuery q;
+        q.text = make_word(rng() % 10);
+        return q;
+    });
+    run("author + common word", [&]() {
+        MessageQuery q;
+        q.author_id = author_id(rng() % kAuthors);
+        q.text = make_word(rng() % 50);
+        return q;
+    });
+    run("two words", [&]() {
+        MessageQuery q;
+        q.text = make_word(rng() % 200) + " " + make_word(rng() % 200);
+        return q;
+    });
+    run("channel, last 10 minutes", [&]() {
+        MessageQuery q;
+        q.channel_id = channel_id(rng() % kChannels);
+        q.since = start + 3000;
+        q.limit = 1000;
+        return q;
+    });
+    return 0;
+}
@@ -0,0 +1,673 @@
+/**
+ * Mock Discord - Implementation
+ */
+
+#include "mock_discord.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iterator>
+
+using json = nlohmann::json;
+
+static const uint64_t kDiscordEpochMs = 1420070400000ULL;
+
+// ISO 8601 creation time of a snowflake, as Discord sends message timestamps
+static std::string snowflake_timestamp(uint64_t id) {
+    const uint64_t ms = (id >> 22) + kDiscordEpochMs;
+    const std::time_t seconds = static_cast<std::time_t>(ms / 1000);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char text[40];
+    std::snprintf(text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02d.%03u000+00:00", utc.tm_year + 1900,
+                  utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, static_cast<unsigned>(ms % 1000));
+    return text;
+}
+
+static std::vector<std::string> split_path(const std::string& path) {
+    std::vector<std::string> segments;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        if (end > start) {
+            segments.push_back(path.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return segments;
+}
+
+static bool is_id(const std::string& segment) {
+    return !segment.empty() && segment.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// "POST /channels/{id}/messages" for "POST /channels/123/messages"
+static std::string route_template(const std::string& method, const std::string& path) {
+    std::string route = method + " ";
+    const std::vector<std::string> segments = split_path(path);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        route += '/';
+        if (i > 0 && segments[i - 1] == "reactions") {
+            route += "{emoji}";
+        } else if (i > 1 && is_id(segments[i - 1]) &&
+                   (segments[i - 2] == "interactions" || segments[i - 2] == "webhooks")) {
+            route += "{token}";
+        } else if (is_id(segments[i])) {
+            route += "{id}";
+        } else {
+            route += segments[i];
+        }
+    }
+    return route;
+}
+
+// Discord buckets by the channel, guild or webhook a route acts on
+static std::string major_id(const std::string& path) {
+    const std::vector<std::string> segments = split_path(path);
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        if ((segments[i] == "channels" || segments[i] == "guilds" || segments[i] == "webhooks") &&
+            is_id(segments[i + 1])) {
+            return segments[i + 1];
+        }
+    }
+    return std::string();
+}
+
+static uint64_t json_id(const json& obj, const char* key) {
+    auto it = obj.find(key);
+    if (it == obj.end()) {
+        return 0;
+    }
+    if (it->is_string()) {
+        return std::strtoull(it->get_ref<const std::string&>().c_str(), nullptr, 10);
+    }
+    return it->is_number_unsigned() ? it->get<uint64_t>() : 0;
+}
+
+static TransportResponse json_response(int status, const json& body) {
+    TransportResponse response;
+    response.status = status;
+    response.body = body.dump();
+    response.headers.emplace_back("Content-Type", "application/json");
+    return response;
+}
+
+static TransportResponse error_response(int status, const char* message, int code) {
+    return json_response(status, json{ {"message", message}, {"code", code} });
+}
+
+static std::string seconds_text(MockDiscord::Clock::duration d) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", std::chrono::duration<double>(d).count());
+    return buf;
+}
+
+MockDiscord::MockDiscord(uint64_t seed) : m_rng(seed) {
+    // Discord's published per-channel limits for the routes the plugin uses
+    // most; everything else is only subject to the global limit
+    set_rate_limit("POST /channels/{id}/messages", 5, std::chrono::seconds(5));
+    set_rate_limit("PUT /channels/{id}/messages/{id}/reactions/{emoji}/@me", 1, std::chrono::milliseconds(250));
+    set_global_rate_limit(50);
+}
+
+// ============================================================================
+// Server state and scripting
+// ============================================================================
+
+void MockDiscord::add_user(uint64_t id, const std::string& username, bool bot) {
+    json user = { {"id", std::to_string(id)}, {"username", username}, {"global_name", nullptr},
+                  {"avatar", nullptr}, {"discriminator", "0"}, {"bot", bot} };
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_users[id] = user.dump();
+}
+
+void MockDiscord::add_channel(uint64_t id, uint64_t guild_id, const std::string& name, int type) {
+    json channel = { {"id", std::to_string(id)}, {"type", type}, {"name", name}, {"topic", nullptr} };
+    if (guild_id != 0) {
+        channel["guild_id"] = std::to_string(guild_id);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_channels[id] = channel.dump();
+}
+
+void MockDiscord::add_member(uint64_t guild_id, uint64_t user_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_members[guild_id].push_back(user_id);
+}
+
+void MockDiscord::dispatch(const std::string& type, const std::string& d, Clock::duration delay) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    schedule_dispatch_locked(type, d, delay);
+}
+
+void MockDiscord::ready(uint64_t bot_user_id, const std::vector<uint64_t>& guild_ids) {
+    json guilds = json::array();
+    for (uint64_t id : guild_ids) {
+        guilds.push_back({ {"id", std::to_string(id)}, {"unavailable", true} });
+    }
+    json d = { {"v", 10},
+               {"user", { {"id", std::to_string(bot_user_id)}, {"username", "mock-bot"}, {"bot", true} }},
+               {"guilds", guilds},
+               {"session_id", "mock-session"},
+               {"shard", {0, 1}} };
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bot_user_id = bot_user_id;
+    schedule_dispatch_locked("READY", d.dump(), Clock::duration::zero());
+}
+
+uint64_t MockDiscord::message_create(uint64_t guild_id, uint64_t channel_id, uint64_t author_id,
+                                     const std::string& content, Clock::duration delay) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t id = next_snowflake_locked();
+    json author;
+    auto user = m_users.find(author_id);
+    if (user != m_users.end()) {
+        author = json::parse(user->second);
+    } else {
+        author = { {"id", std::to_string(author_id)}, {"username", "user" + std::to_string(author_id)} };
+    }
+    json d = { {"id", std::to_string(id)}, {"type", 0}, {"channel_id", std::to_string(channel_id)},
+               {"author", author}, {"content", content}, {"timestamp", snowflake_timestamp(id)},
+               {"tts", false}, {"mentions", json::array()},
+               {"embeds", json::array()}, {"attachments", json::array()} };
+    if (guild_id != 0) {
+        d["guild_id"] = std::to_string(guild_id);
+    }
+    schedule_dispatch_locked("MESSAGE_CREATE", d.dump(), delay);
+    return id;
+}
+
+uint64_t MockDiscord::slash_command(uint64_t guild_id, uint64_t channel_id, uint64_t user_id,
+                                    const std::string& command, const std::string& options, Clock::duration delay) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t id = next_snowflake_locked();
+    json user;
+    auto known = m_users.find(user_id);
+    if (known != m_users.end()) {
+        user = json::parse(known->second);
+    } else {
+        user = { {"id", std::to_string(user_id)}, {"username", "user" + std::to_string(user_id)} };
+    }
+    json data = { {"id", std::to_string(next_snowflake_locked())}, {"name", command}, {"type", 1} };
+    json parsedOptions = json::parse(options, nullptr, false);
+    if (parsedOptions.is_array()) {
+        data["options"] = parsedOptions;
+    }
+    json d = { {"id", std::to_string(id)}, {"type", 2}, {"application_id", std::to_string(m_bot_user_id)},
+               {"token", "mock-token-" + std::to_string(id)}, {"channel_id", std::to_string(channel_id)},
+               {"data", data}, {"version", 1} };
+    if (guild_id != 0) {
+        d["guild_id"] = std::to_string(guild_id);
+        d["member"] = { {"user", user}, {"roles", json::array()} };
+    } else {
+        d["user"] = user;
+    }
+    schedule_dispatch_locked("INTERACTION_CREATE", d.dump(), delay);
+    return id;
+}
+
+void MockDiscord::reaction_add(uint64_t guild_id, uint64_t channel_id, uint64_t message_id, uint64_t user_id,
+                               const std::string& emoji, Clock::duration delay) {
+    json d = { {"user_id", std::to_string(user_id)}, {"channel_id", std::to_string(channel_id)},
+               {"message_id", std::to_string(message_id)}, {"emoji", { {"id", nullptr}, {"name", emoji} }} };
+    if (guild_id != 0) {
+        d["guild_id"] = std::to_string(guild_id);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    schedule_dispatch_locked("MESSAGE_REACTION_ADD", d.dump(), delay);
+}
+
+bool MockDiscord::load_recording(const std::string& path, uint32_t speed, size_t batch, std::string& error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording_batch = batch > 0 ? batch : 1;
+    return m_recording.open(path, speed, error);
+}
+
+void MockDiscord::set_latency(Clock::duration base, Clock::duration jitter) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_latency = base;
+    m_jitter = jitter;
+}
+
+void MockDiscord::set_rate_limit(const std::string& route, uint32_t limit, Clock::duration window) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Live buckets restart from the new limit
+    for (auto it = m_buckets.begin(); it != m_buckets.end();) {
+        it = it->first.compare(0, route.size() + 1, route + ":") == 0 ? m_buckets.erase(it) : std::next(it);
+    }
+    if (limit == 0) {
+        m_route_limits.erase(route);
+        return;
+    }
+    Bucket bucket;
+    bucket.limit = limit;
+    bucket.window = window;
+    m_route_limits[route] = bucket;
+}
+
+void MockDiscord::set_global_rate_limit(uint32_t per_second) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_global = Bucket();
+    m_global.limit = per_second;
+    m_global.window = std::chrono::seconds(1);
+}
+
+void MockDiscord::fail_next(const std::string& route, int status, uint32_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_failures[route] = Failure{ status, count };
+}
+
+std::vector<MockRequest> MockDiscord::requests() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_log;
+}
+
+std::vector<std::string> MockDiscord::gateway_frames() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frames;
+}
+
+MockStats MockDiscord::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+size_t MockDiscord::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timeline.size() + (m_recording.is_open() && !m_recording.finished() ? 1 : 0);
+}
+
+void MockDiscord::clear_log() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_log.clear();
+    m_frames.clear();
+    m_stats = MockStats();
+}
+
+MockDiscord::Clock::duration MockDiscord::latency_locked() {
+    if (m_jitter <= Clock::duration::zero()) {
+        return m_latency;
+    }
+    std::uniform_int_distribution<int64_t> jitter(0, m_jitter.count());
+    return m_latency + Clock::duration(jitter(m_rng));
+}
+
+// Real-looking snowflakes: the creation time lives in the top bits, and
+// message timestamps are derived from it
+uint64_t MockDiscord::next_snowflake_locked() {
+    const uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    return ((nowMs - kDiscordEpochMs) << 22) | (m_snowflake_counter++ & 0x3FFFFF);
+}
+
+void MockDiscord::schedule_dispatch_locked(const std::string& type, const std::string& d, Clock::duration delay) {
+    Timed item;
+    item.due = Clock::now() + delay + latency_locked();
+    item.order = ++m_order;
+    item.is_dispatch = true;
+    item.frame = "{\"t\":\"" + type + "\",\"s\":" + std::to_string(++m_seq) + ",\"op\":0,\"d\":" + d + "}";
+    m_timeline.push(std::move(item));
+}
+
+void MockDiscord::schedule_request_locked(size_t slot, Clock::duration delay) {
+    Timed item;
+    item.due = Clock::now() + delay + latency_locked();
+    item.order = ++m_order;
+    item.request = slot;
+    m_timeline.push(std::move(item));
+}
+
+// ============================================================================
+// DiscordTransport
+// ============================================================================
+
+void MockDiscord::request(const std::string& method, const std::string& path, const std::string& body,
+                          ResponseCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t slot;
+    if (!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        slot = m_in_flight.size();
+        m_in_flight.emplace_back();
+    }
+    InFlight& call = m_in_flight[slot];
+    call.method = method;
+    call.path = path;
+    call.body = body;
+    call.callback = std::move(callback);
+    call.started = Clock::now();
+    call.attempts = 0;
+    schedule_request_locked(slot, Clock::duration::zero());
+}
+
+// One shard, always connected
+bool MockDiscord::gateway_send(uint32_t, const std::string& payload) {
+    json frame = json::parse(payload, nullptr, false);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frames.push_back(payload);
+    ++m_stats.gateway_frames;
+    if (!frame.is_object() || frame.value("op", -1) != 8 || !frame["d"].is_object()) {
+        return true;
+    }
+
+    // Request Guild Members: one chunk with the requested (or all) members
+    const json& d = frame["d"];
+    const uint64_t guildId = json_id(d, "guild_id");
+    const std::vector<uint64_t>& known = m_members[guildId];
+    std::vector<uint64_t> wanted;
+    json notFound = json::array();
+    if (d.contains("user_ids") && d["user_ids"].is_array()) {
+        for (const auto& v : d["user_ids"]) {
+            const uint64_t id = v.is_string() ? std::strtoull(v.get_ref<const std::string&>().c_str(), nullptr, 10)
+                                              : (v.is_number_unsigned() ? v.get<uint64_t>() : 0);
+            if (std::find(known.begin(), known.end(), id) != known.end()) {
+                wanted.push_back(id);
+            } else {
+                notFound.push_back(std::to_string(id));
+            }
+        }
+    } else {
+        wanted = known;
+    }
+
+    json members = json::array();
+    for (uint64_t id : wanted) {
+        auto user = m_users.find(id);
+        json userJson = user != m_users.end()
+            ? json::parse(user->second)
+            : json{ {"id", std::to_string(id)}, {"username", "user" + std::to_string(id)} };
+        members.push_back({ {"user", userJson}, {"roles", json::array()}, {"nick", nullptr},
+                            {"joined_at", "2024-01-01T00:00:00.000000+00:00"} });
+    }
+    json chunk = { {"guild_id", std::to_string(guildId)}, {"members", members}, {"chunk_index", 0},
+                   {"chunk_count", 1}, {"not_found", notFound} };
+    if (d.contains("nonce")) {
+        chunk["nonce"] = d["nonce"];
+    }
+    schedule_dispatch_locked("GUILD_MEMBERS_CHUNK", chunk.dump(), Clock::duration::zero());
+    return true;
+}
+
+uint32_t MockDiscord::shard_count() const {
+    return 1;
+}
+
+void MockDiscord::poll(const DispatchCallback& on_dispatch) {
+    std::vector<std::string> frames;
+    std::vector<std::pair<ResponseCallback, TransportResponse>> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Clock::time_point now = Clock::now();
+
+        if (m_recording.is_open()) {
+            m_recording.poll(m_recording_batch, [&frames](const std::string& raw_event) {
+                frames.push_back(raw_event);
+            });
+            if (m_recording.finished()) {
+                m_recording.close();
+            }
+        }
+
+        while (!m_timeline.empty() && m_timeline.top().due <= now) {
+            Timed item = m_timeline.top();
+            m_timeline.pop();
+            if (item.is_dispatch) {
+                frames.push_back(std::move(item.frame));
+                continue;
+            }
+
+            InFlight& call = m_in_flight[item.request];
+            ++call.attempts;
+            const std::string route = route_template(call.method, call.path);
+            bool limited = false;
+            Clock::duration retryAfter{};
+            TransportResponse response = serve_locked(call, route, now, limited, retryAfter);
+
+            MockRequest entry;
+            entry.method = call.method;
+            entry.path = call.path;
+            entry.route = route;
+            entry.body = call.body;
+            entry.status = response.status;
+            entry.attempts = call.attempts;
+            entry.latency = now - call.started;
+            m_log.push_back(std::move(entry));
+
+            if (limited) {
+                // What DPP does on a 429: wait it out, then send again
+                ++m_stats.rate_limited;
+                schedule_request_locked(item.request, retryAfter);
+                continue;
+            }
+            ++m_stats.requests;
+            if (response.status >= 400) {
+                ++m_stats.failed;
+            }
+            if (call.callback) {
+                completions.emplace_back(std::move(call.callback), std::move(response));
+            }
+            call = InFlight();
+            m_free_slots.push_back(item.request);
+        }
+        m_stats.dispatches += frames.size();
+    }
+
+    for (const auto& frame : frames) {
+        on_dispatch(frame);
+    }
+    for (auto& completion : completions) {
+        completion.first(completion.second);
+    }
+}
+
+// ============================================================================
+// REST routing
+// ============================================================================
+
+bool MockDiscord::take(Bucket& bucket, Clock::time_point now, Clock::duration& retry_after) {
+    if (now >= bucket.reset) {
+        bucket.remaining = bucket.limit;
+        bucket.reset = now + bucket.window;
+    }
+    if (bucket.remaining == 0) {
+        retry_after = bucket.reset - now;
+        return false;
+    }
+    --bucket.remaining;
+    return true;
+}
+
+TransportResponse MockDiscord::serve_locked(const InFlight& call, const std::string& route, Clock::time_point now,
+                                            bool& rate_limited, Clock::duration& retry_after) {
+    rate_limited = false;
+    if (m_global.limit > 0 && !take(m_global, now, retry_after)) {
+        rate_limited = true;
+        TransportResponse response = json_response(429, json{ {"message", "You are being rate limited."},
+            {"retry_after", std::chrono::duration<double>(retry_after).count()}, {"global", true} });
+        response.headers.emplace_back("Retry-After", seconds_text(retry_after));
+        response.headers.emplace_back("X-RateLimit-Global", "true");
+        response.headers.emplace_back("X-RateLimit-Scope", "global");
+        return response;
+    }
+
+    Bucket* bucket = nullptr;
+    std::string bucketKey;
+    auto limits = m_route_limits.find(route);
+    if (limits != m_route_limits.end()) {
+        bucketKey = route + ":" + major_id(call.path);
+        auto it = m_buckets.find(bucketKey);
+        if (it == m_buckets.end()) {
+            it = m_buckets.emplace(bucketKey, limits->second).first;
+        }
+        bucket = &it->second;
+        if (!take(*bucket, now, retry_after)) {
+            rate_limited = true;
+            TransportResponse response = json_response(429, json{ {"message", "You are being rate limited."},
+                {"retry_after", std::chrono::duration<double>(retry_after).count()}, {"global", false} });
+            response.headers.emplace_back("Retry-After", seconds_text(retry_after));
+            response.headers.emplace_back("X-RateLimit-Limit", std::to_string(bucket->limit));
+            response.headers.emplace_back("X-RateLimit-Remaining", "0");
+            response.headers.emplace_back("X-RateLimit-Reset-After", seconds_text(retry_after));
+            response.headers.emplace_back("X-RateLimit-Bucket", route);
+            response.headers.emplace_back("X-RateLimit-Scope", "user");
+            return response;
+        }
+    }
+
+    TransportResponse response;
+    auto failure = m_failures.find(route);
+    if (failure != m_failures.end() && failure->second.count > 0) {
+        --failure->second.count;
+        response = error_response(failure->second.status, "Injected failure", 0);
+    } else {
+        response = route_locked(call, route);
+    }
+
+    if (bucket) {
+        response.headers.emplace_back("X-RateLimit-Limit", std::to_string(bucket->limit));
+        response.headers.emplace_back("X-RateLimit-Remaining", std::to_string(bucket->remaining));
+        response.headers.emplace_back("X-RateLimit-Reset-After", seconds_text(bucket->reset - now));
+        response.headers.emplace_back("X-RateLimit-Bucket", route);
+    }
+    return response;
+}
+
+TransportResponse MockDiscord::route_locked(const InFlight& call, const std::string& route) {
+    const std::vector<std::string> segments = split_path(call.path);
+
+    if (route == "POST /channels/{id}/messages") {
+        json message = call.body.empty() ? json::object() : json::parse(call.body, nullptr, false);
+        if (!message.is_object()) {
+            return error_response(400, "Invalid Form Body", 50035);
+        }
+        message["id"] = std::to_string(next_snowflake_locked());
+        message["channel_id"] = segments[1];
+        message["author"] = { {"id", std::to_string(m_bot_user_id)}, {"username", "mock-bot"}, {"bot", true} };
+        return json_response(200, message);
+    }
+
+    if (route == "PUT /channels/{id}/messages/{id}/reactions/{emoji}/@me") {
+        TransportResponse response;
+        response.status = 204;
+        return response;
+    }
+
+    if (route == "POST /users/@me/channels") {
+        json body = json::parse(call.body, nullptr, false);
+        const uint64_t recipient = body.is_object() ? json_id(body, "recipient_id") : 0;
+        if (recipient == 0) {
+            return error_response(400, "Invalid Form Body", 50035);
+        }
+        uint64_t& channel = m_dm_channels[recipient];
+        if (channel == 0) {
+            channel = next_snowflake_locked();
+            m_channels[channel] = json{ {"id", std::to_string(channel)}, {"type", 1} }.dump();
+        }
+        return json_response(200, json{ {"id", std::to_string(channel)}, {"type", 1},
+                                        {"recipients", json::array({ { {"id", std::to_string(recipient)} } })} });
+    }
+
+    if (route == "GET /users/{id}") {
+        auto user = m_users.find(std::strtoull(segments[1].c_str(), nullptr, 10));
+        if (user == m_users.end()) {
+            return error_response(404, "Unknown User", 10013);
+        }
+        TransportResponse response = json_response(200, json());
+        response.body = user->second;
+        return response;
+    }
+
+    if (route == "GET /guilds/{id}/members/{id}") {
+        const uint64_t userId = std::strtoull(segments[3].c_str(), nullptr, 10);
+        const std::vector<uint64_t>& known = m_members[std::strtoull(segments[1].c_str(), nullptr, 10)];
+        if (std::find(known.begin(), known.end(), userId) == known.end()) {
+            return error_response(404, "Unknown Member", 10007);
+        }
+        auto user = m_users.find(userId);
+        json userJson = user != m_users.end()
+            ? json::parse(user->second)
+            : json{ {"id", segments[3]}, {"username", "user" + segments[3]} };
+        return json_response(200, json{ {"user", userJson}, {"roles", json::array()}, {"nick", nullptr},
+                                         {"joined_at", "2024-01-01T00:00:00.000000+00:00"} });
+    }
+
+    // Interaction responses: the callback answers nothing; edits and
+    // follow-ups come back as messages on the interaction's token
+    if (route == "POST /interactions/{id}/{token}/callback") {
+        TransportResponse response;
+        response.status = 204;
+        return response;
+    }
+
+    if (route == "GET /channels/{id}/webhooks") {
+        json webhooks = json::array();
+        for (const auto& webhook : m_webhooks[std::strtoull(segments[1].c_str(), nullptr, 10)]) {
+            webhooks.push_back(json::parse(webhook));
+        }
+        return json_response(200, webhooks);
+    }
+
+    if (route == "POST /channels/{id}/webhooks") {
+        json body = json::parse(call.body, nullptr, false);
+        const uint64_t id = next_snowflake_locked();
+        json webhook = { {"id", std::to_string(id)}, {"type", 1}, {"channel_id", segments[1]},
+                         {"name", body.is_object() ? body.value("name", std::string()) : std::string()},
+                         {"token", "mock-webhook-" + std::to_string(id)},
+                         {"user", { {"id", std::to_string(m_bot_user_id)}, {"username", "mock-bot"}, {"bot", true} }} };
+        m_webhooks[std::strtoull(segments[1].c_str(), nullptr, 10)].push_back(webhook.dump());
+        m_webhook_tokens[id] = webhook["token"].get<std::string>();
+        return json_response(200, webhook);
+    }
+
+    if (route == "POST /webhooks/{id}/{token}" || route == "PATCH /webhooks/{id}/{token}/messages/@original") {
+        // Channel webhooks check their token; application IDs (interaction
+        // follow-ups) accept any
+        auto token = m_webhook_tokens.find(std::strtoull(segments[1].c_str(), nullptr, 10));
+        if (token != m_webhook_tokens.end() && token->second != segments[2]) {
+            return error_response(401, "Invalid Webhook Token", 50027);
+        }
+        json message = call.body.empty() ? json::object() : json::parse(call.body, nullptr, false);
+        if (!message.is_object()) {
+            return error_response(400, "Invalid Form Body", 50035);
+        }
+        message["id"] = std::to_string(next_snowflake_locked());
+        message["webhook_id"] = segments[1];
+        return json_response(200, message);
+    }
+
+    if (route == "PUT /applications/{id}/commands" || route == "PUT /applications/{id}/guilds/{id}/commands") {
+        json commands = json::parse(call.body, nullptr, false);
+        if (!commands.is_array()) {
+            return error_response(400, "Invalid Form Body", 50035);
+        }
+        for (auto& command : commands) {
+            command["id"] = std::to_string(next_snowflake_locked());
+            command["application_id"] = segments[1];
+        }
+        return json_response(200, commands);
+    }
+
+    if (route == "GET /channels/{id}") {
+        auto channel = m_channels.find(std::strtoull(segments[1].c_str(), nullptr, 10));
+        if (channel == m_channels.end()) {
+            return error_response(404, "Unknown Channel", 10003);
+        }
+        TransportResponse response = json_response(200, json());
+        response.body = channel->second;
+        return response;
+    }
+
+    return error_response(404, "404: Not Found", 0);
+}
@@ -0,0 +1,181 @@
+/**
+ * Mock Discord - Scriptable in-process Discord for integration tests and
+ * benchmarks
+ */
+
+#ifndef RUNE_DISCORD_MOCK_DISCORD_H
+#define RUNE_DISCORD_MOCK_DISCORD_H
+
+#include "discord_transport.h"
+#include "gateway_recording.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One REST call as the mock served it (after any 429 retries)
+struct MockRequest {
+    std::string method;
+    std::string path;
+    std::string route;  // path with IDs replaced by {id} (and {token}, {emoji})
+    std::string body;
+    int status = 0;
+    uint32_t attempts = 0;  // 1 + number of 429s waited out
+    std::chrono::steady_clock::duration latency{};  // request() to callback
+};
+
+struct MockStats {
+    uint64_t requests = 0;       // completed REST calls
+    uint64_t rate_limited = 0;   // 429 responses (each retried)
+    uint64_t failed = 0;         // final status >= 400
+    uint64_t dispatches = 0;     // gateway dispatches delivered
+    uint64_t gateway_frames = 0; // frames sent by the bot
+};
+
+/**
+ * MockDiscord - Stands in for Discord and DPP's client side behind
+ * BotManager::set_transport(). The gateway side delivers scripted dispatches
+ * (built here or played from a gateway_record_path recording) and answers
+ * member requests (op 8) from its member list. The REST side routes message
+ * creation, reactions, DM channels, user/channel/member lookups, interaction
+ * responses, channel webhooks and slash command registration; it keeps
+ * Discord-style per-route buckets (X-RateLimit-* headers, 429 with
+ * retry_after, plus a global limit), and a 429 is waited out and retried as
+ * DPP would. Every request and dispatch takes the configured latency (base
+ * plus seeded random jitter), and failures can be injected per route.
+ *
+ * All callbacks run from poll(), i.e. from BotManager::tick(). Thread-safe.
+ */
+class MockDiscord : public DiscordTransport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit MockDiscord(uint64_t seed = 1);
+
+    // Server state
+    void add_user(uint64_t id, const std::string& username, bool bot = false);
+    void add_channel(uint64_t id, uint64_t guild_id, const std::string& name, int type = 0);
+    void add_member(uint64_t guild_id, uint64_t user_id);
+
+    // Gateway script. d is the dispatch's "d" object as JSON text; delay is
+    // added to the configured latency.
+    void dispatch(const std::string& type, const std::string& d,
+                  Clock::duration delay = Clock::duration::zero());
+    void ready(uint64_t bot_user_id, const std::vector<uint64_t>& guild_ids);
+    // Returns the new message's ID
+    uint64_t message_create(uint64_t guild_id, uint64_t channel_id, uint64_t author_id, const std::string& content,
+                            Clock::duration delay = Clock::duration::zero());
+    void reaction_add(uint64_t guild_id, uint64_t channel_id, uint64_t message_id, uint64_t user_id,
+                      const std::string& emoji, Clock::duration delay = Clock::duration::zero());
+    // INTERACTION_CREATE for a slash command; options is the JSON array of
+    // data.options (may be empty). Returns the interaction's ID.
+    uint64_t slash_command(uint64_t guild_id, uint64_t channel_id, uint64_t user_id, const std::string& command,
+                           const std::string& options = std::string(), Clock::duration delay = Clock::duration::zero());
+    // Plays a GatewayRecorder file alongside the scripted dispatches;
+    // speed/batch as for gateway_replay_speed/gateway_replay_batch
+    bool load_recording(const std::string& path, uint32_t speed, size_t batch, std::string& error);
+
+    // Fault injection. Routes are "METHOD /path" with IDs as {id} (see
+    // MockRequest::route); a limit of 0 removes the bucket.
+    void set_latency(Clock::duration base, Clock::duration jitter = Clock::duration::zero());
+    void set_rate_limit(const std::string& route, uint32_t limit, Clock::duration window);
+    void set_global_rate_limit(uint32_t per_second);
+    void fail_next(const std::string& route, int status, uint32_t count = 1);
+
+    // Inspection
+    std::vector<MockRequest> requests() const;
+    std::vector<std::string> gateway_frames() const;
+    MockStats stats() const;
+    // Scripted dispatches and requests not yet delivered/answered
+    size_t pending() const;
+    void clear_log();
+
+    // DiscordTransport
+    void request(const std::string& method, const std::string& path, const std::string& body,
+                 ResponseCallback callback) override;
+    bool gateway_send(uint32_t shard_id, const std::string& payload) override;
+    uint32_t shard_count() const override;
+    void poll(const DispatchCallback& on_dispatch) override;
+
+private:
+    struct InFlight {
+        std::string method;
+        std::string path;
+        std::string body;
+        ResponseCallback callback;
+        Clock::time_point started;
+        uint32_t attempts = 0;
+    };
+
+    struct Timed {
+        Clock::time_point due;
+        uint64_t order = 0;
+        bool is_dispatch = false;
+        std::string frame;      // dispatch
+        size_t request = 0;     // index into m_in_flight
+        bool operator>(const Timed& other) const {
+            return due != other.due ? due > other.due : order > other.order;
+        }
+    };
+
+    struct Bucket {
+        uint32_t limit = 0;
+        Clock::duration window{};
+        uint32_t remaining = 0;
+        Clock::time_point reset;
+    };
+
+    struct Failure {
+        int status = 0;
+        uint32_t count = 0;
+    };
+
+    Clock::duration latency_locked();
+    uint64_t next_snowflake_locked();
+    void schedule_dispatch_locked(const std::string& type, const std::string& d, Clock::duration delay);
+    void schedule_request_locked(size_t slot, Clock::duration delay);
+    // Takes a token from bucket; false with the wait if it is exhausted
+    static bool take(Bucket& bucket, Clock::time_point now, Clock::duration& retry_after);
+    TransportResponse serve_locked(const InFlight& call, const std::string& route, Clock::time_point now,
+                                   bool& rate_limited, Clock::duration& retry_after);
+    TransportResponse route_locked(const InFlight& call, const std::string& route);
+
+    mutable std::mutex m_mutex;
+    std::mt19937_64 m_rng;
+    Clock::duration m_latency{};
+    Clock::duration m_jitter{};
+    uint64_t m_order = 0;
+    uint64_t m_seq = 0;
+    uint64_t m_snowflake_counter = 0;
+    uint64_t m_bot_user_id = 0;
+
+    std::priority_queue<Timed, std::vector<Timed>, std::greater<Timed>> m_timeline;
+    std::vector<InFlight> m_in_flight;
+    std::vector<size_t> m_free_slots;
+
+    GatewayPlayback m_recording;
+    size_t m_recording_batch = 0;
+
+    std::map<std::string, Bucket> m_route_limits;        // route -> template
+    std::map<std::string, Bucket> m_buckets;             // route + major ID -> live bucket
+    Bucket m_global;
+    std::map<std::string, Failure> m_failures;
+
+    std::unordered_map<uint64_t, std::string> m_users;     // ID -> user JSON
+    std::unordered_map<uint64_t, std::string> m_channels;  // ID -> channel JSON
+    std::unordered_map<uint64_t, uint64_t> m_dm_channels;  // user -> DM channel
+    std::unordered_map<uint64_t, std::vector<uint64_t>> m_members;  // guild -> users
+    std::unordered_map<uint64_t, std::vector<std::string>> m_webhooks;  // channel -> webhook JSON
+    std::unordered_map<uint64_t, std::string> m_webhook_tokens;         // webhook ID -> token
+
+    std::vector<MockRequest> m_log;
+    std::vector<std::string> m_frames;
+    MockStats m_stats;
+};
+
+#endif // RUNE_DISCORD_MOCK_DISCORD_H
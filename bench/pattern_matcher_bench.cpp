@@ -0,0 +1,137 @@
+/**
+ * PatternMatcher Benchmark - One-pass multi-pattern matching against the
+ * per-pattern scans of a chain of keyword and regex checks
+ *
+ * Usage: pattern_matcher_bench [message_count]
+ * Defaults: 20000 chat-like messages checked against 48 keywords and 8
+ * regexes, case-insensitively; about one message in 20 contains a keyword.
+ */
+
+#include "pattern_matcher.h"
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const size_t kKeywords = 48;
+static const char* const kRegexes[] = {
+    "/discord\\.gg\\/\\w+/",
+    "/https?:\\/\\/[a-z0-9.-]+\\.(ru|tk|xyz)/",
+    "/(aaaa|eeee|oooo)/",
+    "/\\d{3}-\\d{3}-\\d{4}/",
+    "/fr[e3][e3] n[i1]tr[o0]/",
+    "/^!\\w+/",
+    "/[A-Z]{12,}/",
+    "/(buy|sell) (cheap|free) \\w+/",
+};
+
+static std::string make_word(std::mt19937_64& rng) {
+    static const char alphabet[] = "etaoinshrdlcumwfgypbvkjxqz";
+    std::string word;
+    const size_t length = 2 + rng() % 8;
+    for (size_t i = 0; i < length; ++i) {
+        // Skewed towards common letters, like text
+        const size_t r = rng() % 26;
+        word += alphabet[(r * r) / 26];
+    }
+    return word;
+}
+
+static std::string lower(std::string text) {
+    for (char& c : text) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+int main(int argc, char** argv) {
+    const size_t messageCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    std::mt19937_64 rng(42);
+
+    std::vector<std::string> keywords;
+    for (size_t i = 0; i < kKeywords; ++i) {
+        keywords.push_back(make_word(rng) + make_word(rng));
+    }
+    std::vector<std::string> patterns = keywords;
+    patterns.insert(patterns.end(), std::begin(kRegexes), std::end(kRegexes));
+
+    std::vector<std::string> messages;
+    size_t bytes = 0;
+    for (size_t m = 0; m < messageCount; ++m) {
+        std::string message;
+        const size_t words = 3 + rng() % 25;
+        for (size_t w = 0; w < words; ++w) {
+            if (w) {
+                message += ' ';
+            }
+            message += rng() % 400 == 0 ? keywords[rng() % kKeywords] : make_word(rng);
+        }
+        if (rng() % 7 == 0) {
+            message[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(message[0])));
+        }
+        bytes += message.size();
+        messages.push_back(std::move(message));
+    }
+    std::printf("%zu messages (%.1f bytes avg), %zu patterns (%zu keywords)\n", messageCount,
+                double(bytes) / messageCount, patterns.size(), keywords.size());
+
+    // Baseline: one check per pattern, as a chain of Contains and Regex nodes does
+    std::vector<std::regex> regexes;
+    std::vector<std::string> loweredKeywords;
+    for (const std::string& pattern : patterns) {
+        if (pattern.size() >= 2 && pattern.front() == '/' && pattern.back() == '/') {
+            regexes.emplace_back(pattern.substr(1, pattern.size() - 2),
+                                 std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+        } else {
+            loweredKeywords.push_back(lower(pattern));
+        }
+    }
+    size_t baselineHits = 0;
+    auto t = Clock::now();
+    for (const std::string& message : messages) {
+        for (const std::string& keyword : loweredKeywords) {
+            baselineHits += lower(message).find(keyword) != std::string::npos;
+        }
+        for (const std::regex& regex : regexes) {
+            baselineHits += std::regex_search(message, regex);
+        }
+    }
+    const double baselineNs = std::chrono::duration<double, std::nano>(Clock::now() - t).count() / messageCount;
+
+    PatternMatcher matcher;
+    std::string error;
+    t = Clock::now();
+    if (!matcher.compile(patterns, true, error)) {
+        std::fprintf(stderr, "compile failed: %s\n", error.c_str());
+        return 1;
+    }
+    const double compileUs = std::chrono::duration<double, std::micro>(Clock::now() - t).count();
+
+    size_t hits = 0;
+    std::vector<uint32_t> ids;
+    for (int pass = 0; pass < 2; ++pass) {
+        // The first pass warms the lazy DFA; the second is what a running bot sees
+        hits = 0;
+        t = Clock::now();
+        for (const std::string& message : messages) {
+            ids.clear();
+            matcher.match(message, ids);
+            hits += ids.size();
+        }
+    }
+    const double matcherNs = std::chrono::duration<double, std::nano>(Clock::now() - t).count() / messageCount;
+
+    std::printf("  per-pattern checks: %8.0f ns/message  (%zu hits)\n", baselineNs, baselineHits);
+    std::printf("  PatternMatcher:     %8.0f ns/message  (%zu hits, %.0f MB/s, compile %.0f us, %zu DFA states)\n",
+                matcherNs, hits, bytes / messageCount / matcherNs * 1000.0, compileUs, matcher.dfa_states());
+    std::printf("  speedup: %.1fx\n", baselineNs / matcherNs);
+    return 0;
+}
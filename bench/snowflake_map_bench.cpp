@@ -0,0 +1,226 @@
+/**
+ * SnowflakeMap Benchmark - SnowflakeMap vs std::unordered_map vs dpp::cache
+ *
+ * Usage: snowflake_map_bench [key_count ...]
+ * Default key counts: 1000000 10000000 50000000. The 50M run needs several
+ * GB of RAM for the node-based containers; pass smaller counts to skip it.
+ */
+
+#include "bench_alloc.h"
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// Workload
+// ============================================================================
+
+struct Workload {
+    std::vector<uint64_t> keys;      // insertion order (roughly time ordered, like real IDs)
+    std::vector<uint64_t> lookups;   // the same keys, shuffled
+    std::vector<uint64_t> misses;    // keys that are never inserted
+};
+
+// Snowflakes: 42-bit ms timestamp, 5-bit worker, 5-bit process, 12-bit sequence
+static uint64_t make_snowflake(uint64_t timestamp, uint64_t worker, uint64_t sequence) {
+    return (timestamp << 22) | ((worker & 0x3FF) << 12) | (sequence & 0xFFF);
+}
+
+static Workload make_workload(size_t count) {
+    Workload w;
+    std::mt19937_64 rng(0x5EED);
+    uint64_t timestamp = 1420070400000ULL;  // arbitrary start; only spacing matters
+    w.keys.reserve(count);
+    w.misses.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        timestamp += rng() % 4;
+        const uint64_t worker = rng() % 1024;
+        w.keys.push_back(make_snowflake(timestamp, worker, i));
+        w.misses.push_back(make_snowflake(timestamp, worker, i) | (1ULL << 63));
+    }
+    w.lookups = w.keys;
+    std::shuffle(w.lookups.begin(), w.lookups.end(), rng);
+    std::shuffle(w.misses.begin(), w.misses.end(), rng);
+    return w;
+}
+
+struct Result {
+    const char* name;
+    double insert_ns;
+    double hit_ns;
+    double miss_ns;
+    double erase_ns;
+    int64_t bytes;
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double ns_per_op(Clock::time_point start, size_t ops) {
+    const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return ops ? ns / static_cast<double>(ops) : 0.0;
+}
+
+// Sum of found payloads; printed so the optimizer cannot drop lookups
+static volatile uint64_t g_sink = 0;
+
+// ============================================================================
+// Containers
+// ============================================================================
+
+static Result bench_snowflake_map(const Workload& w) {
+    Result r{ "SnowflakeMap", 0, 0, 0, 0, 0 };
+    const int64_t before = bench_live_bytes();
+    {
+        SnowflakeMap<uint64_t> map;
+        auto t = Clock::now();
+        for (uint64_t key : w.keys) {
+            map.try_emplace(key, key);
+        }
+        r.insert_ns = ns_per_op(t, w.keys.size());
+        r.bytes = bench_live_bytes() - before;
+
+        uint64_t sum = 0;
+        t = Clock::now();
+        for (uint64_t key : w.lookups) {
+            auto it = map.find(key);
+            if (it != map.end()) sum += it->second;
+        }
+        r.hit_ns = ns_per_op(t, w.lookups.size());
+
+        t = Clock::now();
+        for (uint64_t key : w.misses) {
+            auto it = map.find(key);
+            if (it != map.end()) sum += it->second;
+        }
+        r.miss_ns = ns_per_op(t, w.misses.size());
+        g_sink = g_sink + sum;
+
+        const size_t half = w.lookups.size() / 2;
+        t = Clock::now();
+        for (size_t i = 0; i < half; ++i) {
+            map.erase(w.lookups[i]);
+        }
+        r.erase_ns = ns_per_op(t, half);
+    }
+    return r;
+}
+
+static Result bench_unordered_map(const Workload& w) {
+    Result r{ "std::unordered_map", 0, 0, 0, 0, 0 };
+    const int64_t before = bench_live_bytes();
+    {
+        std::unordered_map<dpp::snowflake, uint64_t> map;
+        auto t = Clock::now();
+        for (uint64_t key : w.keys) {
+            map.emplace(key, key);
+        }
+        r.insert_ns = ns_per_op(t, w.keys.size());
+        r.bytes = bench_live_bytes() - before;
+
+        uint64_t sum = 0;
+        t = Clock::now();
+        for (uint64_t key : w.lookups) {
+            auto it = map.find(key);
+            if (it != map.end()) sum += it->second;
+        }
+        r.hit_ns = ns_per_op(t, w.lookups.size());
+
+        t = Clock::now();
+        for (uint64_t key : w.misses) {
+            auto it = map.find(key);
+            if (it != map.end()) sum += it->second;
+        }
+        r.miss_ns = ns_per_op(t, w.misses.size());
+        g_sink = g_sink + sum;
+
+        const size_t half = w.lookups.size() / 2;
+        t = Clock::now();
+        for (size_t i = 0; i < half; ++i) {
+            map.erase(w.lookups[i]);
+        }
+        r.erase_ns = ns_per_op(t, half);
+    }
+    return r;
+}
+
+// dpp::cache stores heap-allocated managed objects behind a shared mutex,
+// which is what the plugin would get by reusing DPP's cache type directly
+struct BenchEntity : public dpp::managed {
+    uint64_t payload = 0;
+};
+
+static Result bench_dpp_cache(const Workload& w) {
+    Result r{ "dpp::cache", 0, 0, 0, 0, 0 };
+    const int64_t before = bench_live_bytes();
+    {
+        dpp::cache<BenchEntity> cache;
+        auto t = Clock::now();
+        for (uint64_t key : w.keys) {
+            auto* entity = new BenchEntity();
+            entity->id = key;
+            entity->payload = key;
+            cache.store(entity);
+        }
+        r.insert_ns = ns_per_op(t, w.keys.size());
+        r.bytes = bench_live_bytes() - before;
+
+        uint64_t sum = 0;
+        t = Clock::now();
+        for (uint64_t key : w.lookups) {
+            if (BenchEntity* e = cache.find(key)) sum += e->payload;
+        }
+        r.hit_ns = ns_per_op(t, w.lookups.size());
+
+        t = Clock::now();
+        for (uint64_t key : w.misses) {
+            if (BenchEntity* e = cache.find(key)) sum += e->payload;
+        }
+        r.miss_ns = ns_per_op(t, w.misses.size());
+        g_sink = g_sink + sum;
+
+        // remove() only queues objects for DPP's garbage collector, so the
+        // erase figure excludes the final delete
+        const size_t half = w.lookups.size() / 2;
+        t = Clock::now();
+        for (size_t i = 0; i < half; ++i) {
+            if (BenchEntity* e = cache.find(w.lookups[i])) cache.remove(e);
+        }
+        r.erase_ns = ns_per_op(t, half);
+    }
+    return r;
+}
+
+static void print_result(const Result& r, size_t count) {
+    std::printf("  %-20s insert %7.1f ns  hit %7.1f ns  miss %7.1f ns  erase %7.1f ns  %8.1f MB (%5.1f B/key)\n",
+                r.name, r.insert_ns, r.hit_ns, r.miss_ns, r.erase_ns,
+                static_cast<double>(r.bytes) / (1024.0 * 1024.0),
+                count ? static_cast<double>(r.bytes) / static_cast<double>(count) : 0.0);
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; ++i) {
+        counts.push_back(static_cast<size_t>(std::strtoull(argv[i], nullptr, 10)));
+    }
+    if (counts.empty()) {
+        counts = { 1000000, 10000000, 50000000 };
+    }
+
+    std::printf("SnowflakeMap group probing: %s\n", RUNE_SNOWFLAKE_MAP_SSE2 ? "SSE2" : "scalar");
+    for (size_t count : counts) {
+        std::printf("%zu keys\n", count);
+        const Workload w = make_workload(count);
+        print_result(bench_snowflake_map(w), count);
+        print_result(bench_unordered_map(w), count);
+        print_result(bench_dpp_cache(w), count);
+    }
+    std::printf("(checksum %llu)\n", static_cast<unsigned long long>(g_sink));
+    return 0;
+}
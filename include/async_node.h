@@ -0,0 +1,84 @@
+/**
+ * Async Node - Delivery of results that can arrive after a node's execute()
+ */
+
+#ifndef RUNE_DISCORD_ASYNC_NODE_H
+#define RUNE_DISCORD_ASYNC_NODE_H
+
+#include "discord_plugin.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+/**
+ * AsyncNode - Shared by Fetch User, Fetch Channel and Resolve IDs. A result
+ * that is ready within execute() (a cache hit) is delivered on that
+ * execution's context. One that arrives later, from tick(), is delivered on
+ * the context the host passed to start_listening, which stays valid until
+ * stop_listening; the execute() context is never kept past the call.
+ *
+ * A late result is dropped if the node stopped listening, was destroyed, or
+ * was executed again in the meantime, so only the newest request answers.
+ * Data holds the node's output buffers. Main thread only.
+ */
+template <typename Data>
+class AsyncNode {
+    struct Shared {
+        ExecContext* listening = nullptr;  // from start_listening
+        ExecContext* executing = nullptr;  // only while execute() runs
+        uint64_t request = 0;
+        Data data;
+    };
+
+public:
+    AsyncNode() : m_shared(std::make_shared<Shared>()) {}
+
+    // start_listening / stop_listening entries
+    void listen(ExecContext* ctx) { m_shared->listening = ctx; }
+    void stop() {
+        m_shared->listening = nullptr;
+        ++m_shared->request;
+    }
+
+    /**
+     * Execution - Scope of one execute(ctx); starts a new request, which
+     * supersedes any still in flight
+     */
+    class Execution {
+    public:
+        Execution(AsyncNode& node, ExecContext* ctx) : m_shared(node.m_shared), m_request(++m_shared->request) {
+            m_shared->executing = ctx;
+        }
+        ~Execution() { m_shared->executing = nullptr; }
+        Execution(const Execution&) = delete;
+        Execution& operator=(const Execution&) = delete;
+
+        // Callback for this request's lookup. deliver(ctx, data, result)
+        // writes the outputs and fires the trigger.
+        template <typename Result, typename Deliver>
+        std::function<void(Result)> callback(Deliver deliver) const {
+            std::weak_ptr<Shared> weak = m_shared;
+            const uint64_t request = m_request;
+            return [weak, request, deliver](Result result) {
+                auto shared = weak.lock();
+                if (!shared || shared->request != request) {
+                    return;
+                }
+                ExecContext* ctx = shared->executing ? shared->executing : shared->listening;
+                if (ctx) {
+                    deliver(ctx, shared->data, std::forward<Result>(result));
+                }
+            };
+        }
+
+    private:
+        std::shared_ptr<Shared> m_shared;
+        uint64_t m_request;
+    };
+
+private:
+    std::shared_ptr<Shared> m_shared;
+};
+
+#endif // RUNE_DISCORD_ASYNC_NODE_H
@@ -0,0 +1,15 @@
+/**
+ * Atomic File - Replacing a file with a fully written temporary
+ */
+
+#ifndef RUNE_DISCORD_ATOMIC_FILE_H
+#define RUNE_DISCORD_ATOMIC_FILE_H
+
+#include <string>
+
+// Moves tmp_path over path. rename() replaces the target atomically on POSIX,
+// so a crash leaves either the old or the new file; only if that fails (an
+// existing target on Windows) is path removed first and the rename retried.
+bool atomic_replace_file(const std::string& tmp_path, const std::string& path);
+
+#endif // RUNE_DISCORD_ATOMIC_FILE_H
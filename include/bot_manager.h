@@ -5,12 +5,30 @@
 #ifndef RUNE_DISCORD_BOT_MANAGER_H
 #define RUNE_DISCORD_BOT_MANAGER_H
 
+#include "cache_snapshot.h"
+#include "command_registry.h"
+#include "component_router.h"
+#include "discord_transport.h"
+#include "dm_channel_cache.h"
+#include "dpp_transport.h"
+#include "entity_cache.h"
+#include "event_journal.h"
+#include "event_trace.h"
+#include "gateway_recording.h"
+#include "id_resolver.h"
+#include "interaction_tracker.h"
+#include "member_store.h"
+#include "message_index.h"
+#include "metrics.h"
+#include "snowflake_map.h"
 #include <dpp/dpp.h>
+#include <atomic>
 #include <string>
 #include <mutex>
 #include <functional>
 #include <vector>
 #include <queue>
+#include <chrono>
 
 // Forward declaration
 struct ExecContext;
@@ -19,7 +37,9 @@ struct ExecContext;
 enum class DiscordEventType {
     Ready,
     Message,
-    ReactionAdd
+    ReactionAdd,
+    SlashCommand,
+    Component
 };
 
 // Event data structures
@@ -40,17 +60,38 @@ struct ReactionEventData {
     dpp::snowflake guild_id;
 };
 
+struct InteractionEventData {
+    dpp::snowflake interaction_id;
+    std::string command_name;
+    std::string options_json;  // {"option": value, "subcommand": {...}}
+    dpp::snowflake user_id;
+    std::string user_name;
+    dpp::snowflake channel_id;
+    dpp::snowflake guild_id;
+};
+
 // Queued event structure
 struct QueuedEvent {
     DiscordEventType type;
     MessageEventData message_data;
     ReactionEventData reaction_data;
+    InteractionEventData interaction_data;
+    ComponentEventData component_data;
+    uint64_t journal_seq = 0;  // 0 = not journaled (or a replay)
+    std::chrono::steady_clock::time_point queued_at;  // for dispatch latency
+    uint64_t trace_id = 0;    // non-zero when sampled by the event tracer
+    int64_t received_us = 0;  // tracer clock at handler entry
 };
 
 // Listener callback types
 using ReadyCallback = std::function<void()>;
 using MessageCallback = std::function<void(const MessageEventData&)>;
 using ReactionCallback = std::function<void(const ReactionEventData&)>;
+// Returns whether the listener took the interaction; one nobody takes is
+// released (InteractionTracker::release) instead of left to its auto-defer
+using SlashCommandCallback = std::function<bool(const InteractionEventData&)>;
+using UserFetchCallback = std::function<void(const UserRecord&)>;
+using ChannelFetchCallback = std::function<void(const ChannelRecord&)>;
 
 /**
  * BotManager - Singleton that manages the DPP cluster
@@ -71,6 +112,14 @@ public:
     void add_ready_listener(ReadyCallback callback);
     void add_message_listener(MessageCallback callback);
     void add_reaction_listener(ReactionCallback callback);
+    void add_slash_command_listener(SlashCommandCallback callback);
+    // Routes clicks on components whose custom_id starts with "<prefix>:" to
+    // on_click (see ComponentRouter). Returns 0 if the prefix is taken or
+    // invalid. Main thread only, like components().
+    ComponentRouter::Handle add_component_route(const std::string& prefix, bool message_bound,
+                                                ComponentRouter::ClickCallback on_click,
+                                                ComponentRouter::ExpiryCallback on_expired);
+    ComponentRouter& components() { return m_components; }
 
     void clear_listeners();
 
@@ -78,14 +127,115 @@ public:
     void send_message(dpp::snowflake channel_id, const std::string& content);
     void send_embed(dpp::snowflake channel_id, const dpp::embed& embed);
     void add_reaction(dpp::snowflake channel_id, dpp::snowflake message_id, const std::string& emoji);
-    void reply_to_message(dpp::snowflake channel_id, dpp::snowflake message_id, const std::string& content);
+    void reply_to_message(dpp::snowflake channel_id, dpp::snowflake message_id, const std::string& content,
+                          const dpp::embed* embed = nullptr);
+    // Uses the cached DM channel for the user when known (one REST call);
+    // otherwise opens the channel via direct_message_create and caches it.
     void send_direct_message(dpp::snowflake user_id, const std::string& content);
+    // Presence updates are coalesced: unchanged presences are dropped, and
+    // changes within presence_debounce_ms of the last send are held until the
+    // window elapses (flushed from tick()), so only the latest state goes out.
     void set_presence(const dpp::presence& presence);
 
+    // Answers an interaction from On Slash Command: the initial response, an
+    // edit of the deferred one if the interaction was auto-deferred, or a
+    // follow-up after that. False if the interaction is unknown or expired.
+    bool respond_to_interaction(dpp::snowflake interaction_id, const dpp::message& msg);
+
+    // Sends one REST call on an interaction token (InteractionTracker). done,
+    // which may be empty, gets whether Discord accepted the call; it may run
+    // on any thread.
+    void send_interaction_call(const InteractionCall& call, std::function<void(bool ok)> done);
+
+    // Webhook fast path: executes a channel webhook owned by the bot (created on
+    // first use and cached per channel). Webhook executions are rate limited per
+    // webhook rather than per channel, so high-volume output does not compete
+    // with the bot's own message bucket. Username/avatar_url may be empty.
+    void send_webhook_message(dpp::snowflake channel_id, const std::string& content,
+                              const std::string& username, const std::string& avatar_url,
+                              const dpp::embed* embed = nullptr);
+
+    // Async lookups: DPP cache, member store and warm-start snapshot, then the
+    // plugin TTL cache, then REST.
+    // Concurrent fetches of one ID share a single REST call. Callbacks always
+    // run on the main thread from tick(), including cache hits.
+    void fetch_user(dpp::snowflake user_id, UserFetchCallback callback);
+    void fetch_channel(dpp::snowflake channel_id, ChannelFetchCallback callback);
+
+    // Synchronous cache-only probes (DPP cache, member store, warm-start
+    // snapshot, then the TTL cache); false on a miss
+    bool peek_user(dpp::snowflake user_id, UserRecord& out);
+    bool peek_channel(dpp::snowflake channel_id, ChannelRecord& out);
+
+    // Sends a raw gateway frame on the shard that owns the guild; false if
+    // that shard is not connected
+    bool send_guild_gateway_payload(dpp::snowflake guild_id, const std::string& payload);
+
+    // Slash commands defined by the listening On Slash Command nodes. Changes
+    // are registered from tick() once they have settled (main thread only).
+    CommandRegistry& commands() { return m_commands; }
+
+    // Compact member store (populated only when member_store_enabled is set)
+    MemberStore& member_store() { return m_member_store; }
+
+    // Warm-start snapshot loaded on initialize() (empty unless snapshot_path
+    // is set). Live DPP cache entries always take precedence over it.
+    const CacheSnapshot& snapshot() const { return m_snapshot; }
+
+    // Recent message history for Search Messages (empty unless
+    // message_index_enabled is set)
+    const MessageIndex& message_index() const { return m_message_index; }
+
+    // Sampled event spans (empty unless trace_sample_rate is set)
+    EventTracer& tracer() { return m_tracer; }
+
+    // Batch lookup of many IDs; see IdResolver. Main thread only.
+    void resolve_ids(ResolveKind kind, dpp::snowflake guild_id,
+                     const std::vector<dpp::snowflake>& ids, ResolveCallback callback);
+
+    // Re-queues journaled events received in [since_ms, until_ms] (unix ms)
+    // for dispatch to the event listeners, oldest first, up to limit. Returns
+    // the number queued; false if no journal is configured.
+    bool replay_journal(uint64_t since_ms, uint64_t until_ms, bool messages, bool reactions,
+                        size_t limit, size_t& queued);
+
+    // Queue work to run on the main thread during the next tick()
+    void post_to_main(std::function<void()> task);
+
+    // Refreshes the cache-size and shard heartbeat gauges in
+    // discord_metrics(). tick() does this once a second.
+    void sample_metrics();
+
+    // Sends one REST call (path relative to the API base) through the
+    // session's transport, with its latency, status and bucket recorded
+    // against route. callback, which may be empty, may run on any thread; it
+    // gets status 0 right away when no session is running. Failures without
+    // a callback are logged.
+    void rest_request(RestRoute route, const std::string& method, const std::string& path,
+                      const std::string& body, DiscordTransport::ResponseCallback callback);
+
+    // True while running from gateway_replay_path instead of a live
+    // connection (there is no cluster, and actions are no-ops)
+    bool is_replaying() const { return m_replaying; }
+
+    // True while actions reach Discord (or an installed transport); false
+    // when stopped or replaying
+    bool is_online() const { return m_running && m_transport != nullptr; }
+
+    // Routes the next initialize() through an in-process transport instead
+    // of a DPP cluster (tests and benchmarks); null restores the network.
+    // The transport must outlive the session. Not for use while running.
+    void set_transport(DiscordTransport* transport) { m_installed_transport = transport; }
+
     // Getters
     dpp::cluster* get_cluster() { return m_bot.get(); }
     bool has_ready_fired() const { return m_readyFired; }
 
+    // Event whose listeners are running right now, or null (main thread
+    // only). Nodes that execute inside the flow run it starts can read its
+    // fields; anything that runs later, after an async reply, sees null.
+    const QueuedEvent* dispatching_event() const { return m_dispatching_event; }
+
 private:
     BotManager() = default;
     ~BotManager();
@@ -93,22 +243,152 @@ private:
     BotManager& operator=(const BotManager&) = delete;
 
     void setup_event_handlers();
+    // Sizes the plugin-side caches and the message index from the settings
+    void configure_stores();
+    void index_message(const MessageEventData& message, int64_t sent);
+
+    // Journals the event (when journal_kind is non-zero and a journal is open)
+    // and queues it for tick(), under one lock so journal order is queue order
+    void enqueue_event(QueuedEvent& event, uint16_t journal_kind, const std::string& raw_event);
+    // Stamps and counts the event and pushes it; m_event_mutex must be held
+    void push_event_locked(QueuedEvent&& event);
+    // Samples a new event for tracing; call where its handler starts
+    void begin_trace(QueuedEvent& event);
+    // Queues an INTERACTION_CREATE "d" object if it is a slash command or a
+    // component click, and starts tracking it for auto-defer
+    void queue_interaction(const nlohmann::json& d, QueuedEvent& event);
+    void recover_journal();
+
+    // One raw gateway dispatch frame -> queued events and store updates. The
+    // live DPP handlers, gateway replay and in-process transports all call it.
+    // shard_id is the shard that received it (READY restores presence there).
+    void handle_dispatch(const std::string& raw_event, uint32_t shard_id = 0);
+
+    // Gateway replay (see gateway_replay_path): dispatches fall due from the
+    // recording and are fed through handle_dispatch() at the start of tick()
+    bool start_gateway_replay();
+    void pump_gateway_replay();
+
+    // In-process transport session (see set_transport)
+    bool start_transport_session();
+
+    // POST /channels/{id}/messages
+    void create_message(const dpp::message& msg, DiscordTransport::ResponseCallback callback = nullptr);
+
+    // Slash command registration: loads command_state_path, and bulk
+    // overwrites the scopes whose commands changed once they have been stable
+    // for kCommandSyncDelay and the bot is ready
+    void load_command_state();
+    void sync_commands(std::chrono::steady_clock::time_point now);
+    void overwrite_commands(dpp::snowflake application_id, const CommandRegistry::Registration& registration);
+    void on_commands_overwritten(dpp::snowflake application_id, const CommandRegistry::Registration& registration,
+                                 int status);
+
+    // Writes discord_metrics() to metrics_file_path (write-then-rename, so
+    // scrapers never see a partial file)
+    void write_metrics_file();
+
+    struct ChannelWebhook {
+        dpp::snowflake id;
+        std::string token;
+    };
+
+    struct PendingWebhookMessage {
+        dpp::message fallback;  // sent as the bot when no webhook works
+        std::string body;
+        bool retried = false;   // already re-resolved once after a 401/404
+    };
+
+    // DPP cache, member store, then snapshot (no TTL cache, no REST)
+    bool find_local_user(dpp::snowflake user_id, UserRecord& out);
+    bool find_local_channel(dpp::snowflake channel_id, ChannelRecord& out);
+
+    void load_snapshot(const std::string& token);
+    void save_snapshot();
+
+    void open_and_send_direct_message(dpp::snowflake user_id, const std::string& content);
+
+    void flush_presence();
+    void send_presence_payload(const std::string& payload);
+    void resend_presence_to_shard(uint32_t shard_id);
+
+    // Cached webhook, a queued lookup, or the bot during the retry delay
+    void send_via_webhook(dpp::snowflake channel_id, PendingWebhookMessage msg);
+    void resolve_channel_webhook(dpp::snowflake channel_id);
+    void on_channel_webhook_resolved(dpp::snowflake channel_id, const ChannelWebhook* webhook);
+    void execute_webhook(dpp::snowflake channel_id, const ChannelWebhook& webhook, PendingWebhookMessage msg);
 
     std::unique_ptr<dpp::cluster> m_bot;
+    // What actions go through: m_dpp_transport over m_bot, or the installed
+    // transport. Null when stopped or replaying.
+    std::unique_ptr<DppTransport> m_dpp_transport;
+    DiscordTransport* m_installed_transport = nullptr;
+    DiscordTransport* m_transport = nullptr;
     bool m_running = false;
     std::string m_token;
 
-    // Event queue for main thread processing
+    // Event queue for main thread processing. Interactions have their own
+    // lane, dispatched ahead of everything else each tick.
     std::mutex m_event_mutex;
     std::queue<QueuedEvent> m_event_queue;
+    std::queue<QueuedEvent> m_interaction_queue;
 
     // Listeners
     std::mutex m_listener_mutex;
     std::vector<ReadyCallback> m_ready_listeners;
     std::vector<MessageCallback> m_message_listeners;
     std::vector<ReactionCallback> m_reaction_listeners;
+    std::vector<SlashCommandCallback> m_slash_command_listeners;
 
     bool m_readyFired = false;
+    const QueuedEvent* m_dispatching_event = nullptr;  // see dispatching_event()
+
+    DmChannelCache m_dm_channels;
+    TtlCache<UserRecord> m_user_cache;
+    TtlCache<ChannelRecord> m_channel_cache;
+    IdResolver m_id_resolver{ *this };
+    InteractionTracker m_interactions{ *this };
+    CommandRegistry m_commands;
+    ComponentRouter m_components;
+    std::atomic<uint64_t> m_application_id{ 0 };  // from READY
+    std::atomic<uint64_t> m_bot_user_id{ 0 };     // from READY
+    uint64_t m_command_generation = 0;
+    bool m_commands_dirty = false;
+    static constexpr std::chrono::seconds kCommandSyncDelay{ 1 };
+    std::chrono::steady_clock::time_point m_commands_changed_at;
+    MemberStore m_member_store;
+    CacheSnapshot m_snapshot;
+    MessageIndex m_message_index;
+    EventTracer m_tracer;
+    EventJournal m_journal;
+    GatewayRecorder m_recorder;
+    GatewayPlayback m_playback;
+    bool m_replaying = false;
+
+    std::chrono::steady_clock::time_point m_last_metrics_sample;
+    std::chrono::steady_clock::time_point m_last_metrics_write;
+
+    // Main-thread task queue (see post_to_main)
+    std::mutex m_main_task_mutex;
+    std::vector<std::function<void()>> m_main_tasks;
+
+    // Presence coalescing state. Payloads are the serialized gateway op 3
+    // frames, built once and shared by every shard.
+    std::mutex m_presence_mutex;
+    bool m_presence_pending = false;
+    std::string m_pending_presence_payload;
+    std::string m_last_presence_payload;
+    std::chrono::steady_clock::time_point m_last_presence_send;
+
+    // Channel webhooks (channel ID -> webhook), plus messages waiting on a
+    // webhook lookup/creation that is still in flight for that channel.
+    // Channels whose webhook could not be found or created (no Manage
+    // Webhooks, webhook limit) send as the bot until their retry time.
+    std::mutex m_webhook_mutex;
+    SnowflakeMap<ChannelWebhook> m_channel_webhooks;
+    SnowflakeMap<std::vector<PendingWebhookMessage>> m_pending_webhook_messages;
+    SnowflakeMap<std::chrono::steady_clock::time_point> m_webhook_retry_at;
+    static constexpr std::chrono::minutes kWebhookRetryDelay{ 10 };
 };
 
 #endif // RUNE_DISCORD_BOT_MANAGER_H
@@ -0,0 +1,118 @@
+/**
+ * Cache Snapshot - Memory-mapped warm-start snapshot of guilds, channels,
+ * roles and users
+ */
+
+#ifndef RUNE_DISCORD_CACHE_SNAPSHOT_H
+#define RUNE_DISCORD_CACHE_SNAPSHOT_H
+
+#include "mapped_file.h"
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct SnapshotGuild {
+    dpp::snowflake id;
+    dpp::snowflake owner_id;
+    std::string name;
+    uint32_t member_count = 0;
+};
+
+struct SnapshotChannel {
+    dpp::snowflake id;
+    dpp::snowflake guild_id;
+    dpp::snowflake parent_id;
+    std::string name;
+    std::string topic;
+    uint32_t type = 0;
+    uint32_t position = 0;
+};
+
+struct SnapshotRole {
+    dpp::snowflake id;
+    dpp::snowflake guild_id;
+    uint64_t permissions = 0;
+    std::string name;
+    uint32_t colour = 0;
+    uint32_t position = 0;
+};
+
+struct SnapshotUser {
+    dpp::snowflake id;
+    std::string username;
+    std::string global_name;
+    std::string avatar_url;
+    bool is_bot = false;
+};
+
+// Everything written to (or carried forward from) a snapshot
+struct SnapshotData {
+    std::vector<SnapshotGuild> guilds;
+    std::vector<SnapshotChannel> channels;
+    std::vector<SnapshotRole> roles;
+    std::vector<SnapshotUser> users;
+};
+
+/**
+ * CacheSnapshot - Read side maps the file and answers lookups straight from
+ * it: records are fixed-size, sorted by ID and binary searched, with names
+ * in a shared string pool, so loading costs one mmap plus header checks.
+ *
+ * A snapshot is rejected if its magic/version or section bounds are wrong,
+ * if it is older than the configured maximum age (or from the future), or if
+ * it was written for a different bot token. IDs reported deleted by live
+ * events are masked with mark_deleted(). Lookups and mark_deleted() are
+ * thread-safe; load/close/save must not race with them.
+ */
+class CacheSnapshot {
+public:
+    bool load(const std::string& path, uint64_t token_hash, std::chrono::seconds max_age, std::string& error);
+    void close();
+
+    bool is_loaded() const { return m_loaded; }
+    uint64_t created_ms() const { return m_created_ms; }
+
+    bool find_guild(dpp::snowflake id, SnapshotGuild& out) const;
+    bool find_channel(dpp::snowflake id, SnapshotChannel& out) const;
+    bool find_role(dpp::snowflake id, SnapshotRole& out) const;
+    bool find_user(dpp::snowflake id, SnapshotUser& out) const;
+
+    void mark_deleted(dpp::snowflake id);
+
+    // Copies out every record not marked deleted (for carrying forward)
+    void collect(SnapshotData& out) const;
+
+    // Sorts the records and writes the file atomically via a temporary file
+    static bool save(const std::string& path, SnapshotData& data, uint64_t token_hash, std::string& error);
+
+    static uint64_t hash_token(const std::string& token);
+
+private:
+    struct Section {
+        const uint8_t* records = nullptr;
+        size_t count = 0;
+    };
+
+    const uint8_t* find_record(const Section& section, size_t record_size, dpp::snowflake id) const;
+    std::string read_string(const uint8_t* ref) const;
+    bool is_deleted(dpp::snowflake id) const;
+
+    MappedFile m_file;
+    bool m_loaded = false;
+    uint64_t m_created_ms = 0;
+    const uint8_t* m_strings = nullptr;
+    size_t m_strings_size = 0;
+    Section m_guilds;
+    Section m_channels;
+    Section m_roles;
+    Section m_users;
+
+    mutable std::mutex m_deleted_mutex;
+    SnowflakeMap<uint8_t> m_deleted;
+};
+
+#endif // RUNE_DISCORD_CACHE_SNAPSHOT_H
@@ -0,0 +1,100 @@
+/**
+ * Command Registry - Slash command definitions of the loaded flows and what was last registered
+ */
+
+#ifndef RUNE_DISCORD_COMMAND_REGISTRY_H
+#define RUNE_DISCORD_COMMAND_REGISTRY_H
+
+#include <dpp/dpp.h>
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One command, as an On Slash Command node defines it
+struct SlashCommandDefinition {
+    std::string name;
+    std::string description;
+    nlohmann::json options = nlohmann::json::array();  // Discord application command options
+    dpp::snowflake guild_id;                           // 0: global command
+};
+
+/**
+ * CommandRegistry - Collects the commands the On Slash Command nodes of the
+ * loaded flows define, read from their flow.json files with the FlowScanner,
+ * and works out which scopes (global, or one guild) need a bulk overwrite.
+ * Every loaded flow is rescanned before anything is hashed, so a registration
+ * always covers the complete set. Each scope's commands are canonicalized
+ * (sorted by name, keys in sorted order, compact JSON) and hashed with 64-bit
+ * FNV-1a; a scope is registered only when its hash differs from the one last
+ * registered for that application and scope. With a state file the hashes
+ * survive restarts, so a restart with unchanged commands makes no
+ * registration calls.
+ *
+ * Definitions do not depend on which nodes are listening: a flow keeps its
+ * commands after it is unloaded. A scope is overwritten with an empty list
+ * only when a rescan finds that the flow files which defined its commands no
+ * longer do. Main thread only.
+ */
+class CommandRegistry {
+public:
+    // One bulk overwrite to issue
+    struct Registration {
+        dpp::snowflake guild_id;
+        std::string body;  // canonical JSON array
+        uint64_t hash = 0;
+        size_t count = 0;
+    };
+
+    // A flow was loaded from path (<flows_dir>/<id>/flow.json); its
+    // definitions are read by the next scan_flows()
+    void add_flow(const std::string& flow_id, const std::string& path);
+    // Bumped by every add_flow
+    uint64_t generation() const { return m_generation; }
+    // Definitions found by the last scan_flows()
+    size_t size() const;
+
+    // Rescans every added flow's file. A missing file no longer defines
+    // anything; one that fails to parse keeps its last definitions.
+    void scan_flows();
+
+    // Scopes of application_id whose canonical command set is not the one
+    // last registered (or in flight)
+    std::vector<Registration> changed(dpp::snowflake application_id) const;
+
+    // Bulk overwrite issued / acknowledged / failed
+    void begin(dpp::snowflake application_id, const Registration& registration);
+    void registered(dpp::snowflake application_id, const Registration& registration);
+    void failed(dpp::snowflake application_id, const Registration& registration);
+
+    // Registered hashes. load() replaces them from the file (a missing file
+    // is not an error); save() writes atomically via a temporary file.
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    // Forgets overwrites whose completion will never arrive (new session)
+    void cancel_in_flight() { m_in_flight.clear(); }
+
+    static uint64_t fnv1a(const std::string& data);
+
+private:
+    static std::string scope_key(dpp::snowflake application_id, dpp::snowflake guild_id);
+
+    struct Flow {
+        std::string path;
+        std::vector<SlashCommandDefinition> definitions;
+    };
+
+    std::set<uint64_t> defined_scopes() const;
+
+    uint64_t m_generation = 0;
+    std::map<std::string, Flow> m_flows;           // by flow id
+    std::set<uint64_t> m_vacated;                  // guilds whose definitions were all removed
+    std::map<std::string, uint64_t> m_registered;  // "application:guild" -> hash
+    std::map<std::string, uint64_t> m_in_flight;
+};
+
+#endif // RUNE_DISCORD_COMMAND_REGISTRY_H
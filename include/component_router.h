@@ -0,0 +1,128 @@
+/**
+ * Component Router - Routes button and select menu clicks to the node that owns their custom_id
+ */
+
+#ifndef RUNE_DISCORD_COMPONENT_ROUTER_H
+#define RUNE_DISCORD_COMPONENT_ROUTER_H
+
+#include <dpp/dpp.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A click on a message component (INTERACTION_CREATE type 3)
+struct ComponentEventData {
+    dpp::snowflake interaction_id;
+    dpp::snowflake message_id;  // message the component is attached to
+    std::string custom_id;
+    std::string values_json;    // selected values of a select menu, ["a", ...]; [] for buttons
+    int component_type = 0;     // 2 button, 3 and 5-8 select menus
+    dpp::snowflake user_id;
+    std::string user_name;
+    dpp::snowflake channel_id;
+    dpp::snowflake guild_id;
+};
+
+/**
+ * ComponentRouter - A component's custom_id is "<prefix>:<state>" (or just
+ * "<prefix>"). Each On Component node owns one prefix, so a click is routed
+ * with a single hash lookup on the part before the first ':' and the rest is
+ * handed to the node as its state; no listener sees another node's clicks.
+ *
+ * A route can also be bound to individual messages for a limited time
+ * (bind()). Bindings sit in a hashed timer wheel with one-second slots, so
+ * arming and expiring them is O(1) however many are live; on expiry the
+ * route's expiry callback runs with the message id. A message-bound route
+ * only accepts clicks on messages it currently has a binding for.
+ *
+ * Main thread only: nodes add and remove routes in start/stop_listening, and
+ * BotManager::tick() routes clicks and advances the wheel.
+ */
+class ComponentRouter {
+public:
+    using Handle = uint64_t;
+    using Clock = std::chrono::steady_clock;
+    using ClickCallback = std::function<void(const ComponentEventData&, const std::string& state)>;
+    using ExpiryCallback = std::function<void(dpp::snowflake message_id)>;
+
+    static const char kSeparator = ':';
+    static const size_t kWheelSlots = 512;  // seconds per revolution
+
+    enum class Result {
+        Routed,
+        NoRoute,   // no node owns the prefix
+        NotBound   // message-bound route, but the message has no live binding
+    };
+
+    // Returns 0 if the prefix is empty, contains kSeparator or is already owned
+    Handle add_route(const std::string& prefix, bool message_bound, ClickCallback on_click,
+                     ExpiryCallback on_expired);
+    // Drops the route and its bindings (without running the expiry callback)
+    void remove_route(Handle handle);
+
+    // Binds message_id to the route owning prefix until ttl has passed (0:
+    // until the route is removed). Binding again restarts the timeout.
+    // Returns false if no route owns the prefix.
+    bool bind(dpp::snowflake message_id, const std::string& prefix, std::chrono::seconds ttl, Clock::time_point now);
+
+    // Runs the owning route's click callback
+    Result route(const ComponentEventData& event) const;
+    // Expires the bindings that are due and runs their expiry callbacks
+    void advance(Clock::time_point now);
+
+    void clear();
+    size_t routes() const { return m_routes.size(); }
+    size_t bindings() const { return m_bindings.size(); }
+
+    // Splits a custom_id into its prefix and state
+    static void split(const std::string& custom_id, std::string& prefix, std::string& state);
+
+private:
+    struct Route {
+        Handle handle = 0;
+        bool message_bound = false;
+        ClickCallback on_click;
+        ExpiryCallback on_expired;
+    };
+
+    struct BindingKey {
+        uint64_t message_id;
+        Handle route;
+        bool operator==(const BindingKey& other) const {
+            return message_id == other.message_id && route == other.route;
+        }
+    };
+    struct BindingKeyHash {
+        size_t operator()(const BindingKey& key) const {
+            return static_cast<size_t>((key.message_id * 0x9E3779B97F4A7C15ULL) ^ key.route);
+        }
+    };
+    struct Binding {
+        uint64_t deadline = 0;  // wheel tick; 0: never expires
+        uint64_t seq = 0;       // matches the wheel entry that may expire it
+    };
+    struct WheelEntry {
+        BindingKey key;
+        uint64_t deadline;
+        uint64_t seq;
+    };
+
+    uint64_t wheel_tick(Clock::time_point now) const;
+
+    Handle m_next_handle = 1;
+    std::unordered_map<std::string, Route> m_routes;     // prefix -> route
+    std::unordered_map<Handle, std::string> m_prefixes;  // route -> prefix
+    std::unordered_map<BindingKey, Binding, BindingKeyHash> m_bindings;
+
+    std::vector<std::vector<WheelEntry>> m_wheel;
+    bool m_wheel_started = false;
+    Clock::time_point m_origin;
+    uint64_t m_tick = 0;  // last tick advance() processed
+    uint64_t m_next_seq = 1;
+};
+
+#endif // RUNE_DISCORD_COMPONENT_ROUTER_H
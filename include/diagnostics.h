@@ -0,0 +1,47 @@
+/**
+ * Diagnostics - Live text view of the bot for the plugin menu
+ */
+
+#ifndef RUNE_DISCORD_DIAGNOSTICS_H
+#define RUNE_DISCORD_DIAGNOSTICS_H
+
+#include "metrics.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * DiagnosticsPanel - Connection state and heartbeat per shard, event rates,
+ * queue backlog, REST bucket status and cache sizes, rendered as text.
+ *
+ * Everything shown comes from DiscordMetrics, whose counters and gauges are
+ * relaxed atomics (the gauges are refreshed once a second by tick()), so
+ * rendering takes no lock the gateway threads or the dispatch loop use.
+ * Rates are the counter deltas since the previous render. Host thread only.
+ */
+class DiagnosticsPanel {
+public:
+    // Re-render interval while live
+    static constexpr std::chrono::seconds kLiveInterval{ 5 };
+
+    std::string render();
+
+    bool live() const { return m_live; }
+    void set_live(bool live);
+
+    // From on_tick: logs a render every kLiveInterval while live
+    void tick();
+
+private:
+    std::chrono::steady_clock::time_point m_last_render;
+    std::chrono::steady_clock::time_point m_next_live;
+    uint64_t m_last_received[DiscordMetrics::kEventTypes] = {};
+    uint64_t m_last_dropped = 0;
+    uint64_t m_last_rest = 0;
+    bool m_rendered = false;
+    bool m_live = false;
+};
+
+DiagnosticsPanel& diagnostics_panel();
+
+#endif // RUNE_DISCORD_DIAGNOSTICS_H
@@ -23,15 +23,32 @@ void register_data_nodes(PluginNodeRegistry* reg);
 void register_on_ready_node(PluginNodeRegistry* reg);
 void register_on_message_node(PluginNodeRegistry* reg);
 void register_on_reaction_node(PluginNodeRegistry* reg);
+void register_on_slash_command_node(PluginNodeRegistry* reg);
+void register_on_component_node(PluginNodeRegistry* reg);
 void register_connect_discord_node(PluginNodeRegistry* reg);
 void register_send_message_node(PluginNodeRegistry* reg);
 void register_send_embed_node(PluginNodeRegistry* reg);
 void register_reply_to_message_node(PluginNodeRegistry* reg);
+void register_respond_to_interaction_node(PluginNodeRegistry* reg);
+void register_bind_component_message_node(PluginNodeRegistry* reg);
 void register_send_direct_message_node(PluginNodeRegistry* reg);
 void register_set_presence_node(PluginNodeRegistry* reg);
+void register_send_via_webhook_node(PluginNodeRegistry* reg);
+void register_replay_journal_node(PluginNodeRegistry* reg);
+void register_dump_trace_node(PluginNodeRegistry* reg);
+void register_dump_node_profile_node(PluginNodeRegistry* reg);
 void register_get_user_node(PluginNodeRegistry* reg);
 void register_get_channel_node(PluginNodeRegistry* reg);
+void register_get_member_node(PluginNodeRegistry* reg);
+void register_fetch_user_node(PluginNodeRegistry* reg);
+void register_fetch_channel_node(PluginNodeRegistry* reg);
+void register_resolve_ids_node(PluginNodeRegistry* reg);
+void register_search_messages_node(PluginNodeRegistry* reg);
+void register_match_patterns_node(PluginNodeRegistry* reg);
+void register_get_discord_stats_node(PluginNodeRegistry* reg);
 void register_build_embed_node(PluginNodeRegistry* reg);
+void register_embed_to_json_node(PluginNodeRegistry* reg);
+void register_format_message_node(PluginNodeRegistry* reg);
 
 // Plugin configuration (from settings)
 struct DiscordPluginConfig
@@ -69,6 +86,94 @@ struct DiscordPluginConfig
     // Convenience toggles
     bool enable_message_content_intent;
     bool enable_dpp_logging;
+
+    // Logging: lines below log_level are never formatted; DPP messages below
+    // dpp_log_min_severity are not forwarded. At most log_rate_limit lines
+    // per call site are logged every 10 s (0 = unlimited); the rest are
+    // summarized.
+    std::string log_level;
+    std::string dpp_log_min_severity;
+    uint32_t log_rate_limit;
+
+    // Presence updates issued within this window (milliseconds) are coalesced
+    // and only the latest state is sent. 0 sends every change immediately.
+    uint32_t presence_debounce_ms;
+
+    // DM channel cache (user ID -> DM channel ID). Capacity 0 disables it;
+    // a non-empty path persists the cache across restarts.
+    uint32_t dm_cache_capacity;
+    std::string dm_cache_path;
+
+    // Fetch User / Fetch Channel cache: TTLs for found and not-found results
+    // (milliseconds) and the maximum number of cached IDs per entity type.
+    uint32_t entity_cache_ttl_ms;
+    uint32_t entity_cache_negative_ttl_ms;
+    uint32_t entity_cache_capacity;
+
+    // Resolve IDs: maximum concurrent REST lookups per batch
+    uint32_t rest_max_concurrency;
+
+    // Keep guild members in the compact MemberStore (fed from member chunks)
+    // and turn off DPP's per-object user cache
+    bool member_store_enabled;
+
+    // Warm-start snapshot of guilds, channels, roles and users. An empty path
+    // disables it; snapshots older than the max age are ignored. Users are
+    // capped at snapshot_max_users.
+    std::string snapshot_path;
+    uint32_t snapshot_max_age_s;
+    uint32_t snapshot_max_users;
+
+    // Search Messages history: retention window (seconds), message and memory
+    // caps, and what happens at the cap ("oldest" evicts, "reject" drops new)
+    bool message_index_enabled;
+    uint32_t message_index_max_messages;
+    uint32_t message_index_max_mb;
+    uint32_t message_index_window_s;
+    std::string message_index_eviction;
+
+    // Event journal: received message/reaction events are appended to
+    // compressed segment files in journal_dir (empty disables it). Events not
+    // yet dispatched when the process stopped are re-queued on the next
+    // connect when journal_recover is set.
+    std::string journal_dir;
+    uint32_t journal_segment_mb;
+    uint32_t journal_max_segments;
+    bool journal_recover;
+
+    // Gateway recording: raw dispatches are written to gateway_record_path
+    // while connected. A non-empty gateway_replay_path replaces the connection
+    // with an offline playback of such a file at gateway_replay_speed
+    // (0 = as fast as possible, gateway_replay_batch dispatches per tick).
+    std::string gateway_record_path;
+    std::string gateway_replay_path;
+    uint32_t gateway_replay_speed;
+    uint32_t gateway_replay_batch;
+
+    // Runtime metrics are always collected; a non-empty metrics_file_path
+    // also writes them every metrics_interval_ms in Prometheus text format
+    // (for node_exporter's textfile collector or any file-based scraper).
+    std::string metrics_file_path;
+    uint32_t metrics_interval_ms;
+
+    // Event tracing: one in trace_sample_rate gateway events (0 = off) is
+    // followed from receipt to the REST calls its flow makes; the last
+    // trace_buffer_spans spans are kept for the Dump Trace node.
+    uint32_t trace_sample_rate;
+    uint32_t trace_buffer_spans;
+
+    // Per-node execution profiling (Get Discord Stats, Dump Node Profile)
+    bool profile_nodes;
+
+    // Slash commands: an interaction the flow has not answered this many
+    // milliseconds after it arrived gets a deferred response, since Discord
+    // fails interactions left unanswered for 3 seconds. 0 disables.
+    uint32_t interaction_auto_defer_ms;
+
+    // Optional file remembering the hash of the slash commands last
+    // registered per application and guild, so restarts with unchanged
+    // commands skip registration (empty keeps the hashes in memory only)
+    std::string command_state_path;
 };
 
 const DiscordPluginConfig& GetDiscordPluginConfig();
@@ -0,0 +1,53 @@
+/**
+ * Discord Transport - What BotManager sends REST calls and gateway frames through
+ */
+
+#ifndef RUNE_DISCORD_TRANSPORT_H
+#define RUNE_DISCORD_TRANSPORT_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct TransportResponse {
+    int status = 0;  // 0 if the request never got an HTTP response
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> headers;
+};
+
+/**
+ * DiscordTransport - The one path BotManager's actions take to Discord: every
+ * action is built as the REST call (or gateway frame) Discord expects and
+ * handed to the session's transport. DppTransport sends them through a DPP
+ * cluster; MockDiscord (bench/) answers them in-process for end-to-end tests
+ * and benchmarks, installed with BotManager::set_transport(). Requests that
+ * get a 429 are retried inside the transport, as DPP's request queue does,
+ * so BotManager only ever sees final responses.
+ */
+class DiscordTransport {
+public:
+    using ResponseCallback = std::function<void(const TransportResponse&)>;
+    using DispatchCallback = std::function<void(const std::string& raw_event)>;
+
+    virtual ~DiscordTransport() = default;
+
+    // REST call; path is relative to the API base ("/channels/1/messages").
+    // The callback may be empty; it runs on the transport's REST thread or
+    // from poll(). Called from any thread, so it must be thread-safe.
+    virtual void request(const std::string& method, const std::string& path, const std::string& body,
+                         ResponseCallback callback) = 0;
+
+    // Gateway frame sent by the bot (presence updates, member requests) on
+    // one shard; false if that shard is not connected
+    virtual bool gateway_send(uint32_t shard_id, const std::string& payload) = 0;
+    virtual uint32_t shard_count() const = 0;
+
+    // Called from BotManager::tick() on the main thread: hands over the
+    // gateway dispatches and runs the REST callbacks that are due. A
+    // transport that delivers on its own threads does nothing here.
+    virtual void poll(const DispatchCallback& on_dispatch) = 0;
+};
+
+#endif // RUNE_DISCORD_TRANSPORT_H
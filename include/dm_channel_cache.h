@@ -0,0 +1,52 @@
+/**
+ * DM Channel Cache - Bounded LRU map from user ID to DM channel ID
+ */
+
+#ifndef RUNE_DISCORD_DM_CHANNEL_CACHE_H
+#define RUNE_DISCORD_DM_CHANNEL_CACHE_H
+
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <utility>
+
+/**
+ * DmChannelCache - Remembers the DM channel opened for each user so repeat
+ * DMs can go straight to message_create. Thread-safe; optionally persisted
+ * to a small binary file between runs.
+ */
+class DmChannelCache {
+public:
+    explicit DmChannelCache(size_t capacity = 4096);
+
+    // Shrinks the cache immediately if the new capacity is smaller
+    void set_capacity(size_t capacity);
+
+    // Returns true and the channel ID on a hit (and marks it most recent)
+    bool find(dpp::snowflake user_id, dpp::snowflake& channel_id);
+    void insert(dpp::snowflake user_id, dpp::snowflake channel_id);
+    void erase(dpp::snowflake user_id);
+    void clear();
+    size_t size() const;
+
+    // Persistence. load() merges entries from the file (respecting capacity);
+    // save() writes atomically via a temporary file. Both return false on I/O
+    // or format errors and leave the in-memory cache usable.
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+private:
+    using Entry = std::pair<dpp::snowflake, dpp::snowflake>;
+
+    void evict_over_capacity();
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity;
+    std::list<Entry> m_lru;  // front = most recently used
+    SnowflakeMap<std::list<Entry>::iterator> m_index;
+};
+
+#endif // RUNE_DISCORD_DM_CHANNEL_CACHE_H
@@ -0,0 +1,33 @@
+/**
+ * DPP Transport - DiscordTransport over a DPP cluster
+ */
+
+#ifndef RUNE_DISCORD_DPP_TRANSPORT_H
+#define RUNE_DISCORD_DPP_TRANSPORT_H
+
+#include "discord_transport.h"
+#include <dpp/dpp.h>
+
+/**
+ * DppTransport - Sends requests through the cluster's REST queue (which owns
+ * authentication, rate-limit buckets and 429 retries) and gateway frames
+ * through its shards. Responses arrive on DPP's REST threads. Dispatches are
+ * delivered by the cluster's own event handlers (BotManager's
+ * setup_event_handlers), so poll() does nothing. The cluster must outlive
+ * the transport.
+ */
+class DppTransport : public DiscordTransport {
+public:
+    explicit DppTransport(dpp::cluster& cluster) : m_cluster(cluster) {}
+
+    void request(const std::string& method, const std::string& path, const std::string& body,
+                 ResponseCallback callback) override;
+    bool gateway_send(uint32_t shard_id, const std::string& payload) override;
+    uint32_t shard_count() const override;
+    void poll(const DispatchCallback&) override {}
+
+private:
+    dpp::cluster& m_cluster;
+};
+
+#endif // RUNE_DISCORD_DPP_TRANSPORT_H
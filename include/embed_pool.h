@@ -0,0 +1,85 @@
+/**
+ * Embed Pool - Typed embed handles shared between Discord nodes
+ */
+
+#ifndef RUNE_DISCORD_EMBED_POOL_H
+#define RUNE_DISCORD_EMBED_POOL_H
+
+#include <dpp/dpp.h>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Handle passed between nodes on "Embed" int pins. 0 is never a valid handle.
+using EmbedHandle = int64_t;
+
+struct EmbedFieldData {
+    std::string name;
+    std::string value;
+    bool is_inline = false;
+};
+
+// Plain embed description. Kept separate from dpp::embed so pooled slots can
+// be cleared and refilled without giving back their string capacity.
+struct EmbedData {
+    std::string title;
+    std::string description;
+    std::string url;
+    bool has_color = false;
+    uint32_t color = 0;
+    std::string footer_text;
+    std::string footer_icon_url;
+    std::string image_url;
+    std::string thumbnail_url;
+    std::string author_name;
+    std::string author_url;
+    std::string author_icon_url;
+    time_t timestamp = 0;
+    std::vector<EmbedFieldData> fields;
+
+    void clear();
+    dpp::embed to_dpp() const;
+    // Only for non-Discord consumers; Discord nodes use to_dpp()
+    std::string to_json() const;
+};
+
+/**
+ * EmbedPool - Slot pool of EmbedData addressed by generation-checked handles.
+ * Each Build Embed node instance owns one slot for its lifetime and refills
+ * it on every execution; consumers resolve the handle without any
+ * serialize/parse step. Stale handles (released slots) resolve to nothing.
+ */
+class EmbedPool {
+public:
+    static EmbedPool& instance();
+
+    EmbedHandle acquire();
+    void release(EmbedHandle handle);
+
+    // Replace the contents of a slot. Returns false for stale handles.
+    bool store(EmbedHandle handle, const EmbedData& data);
+
+    // Build outputs from a slot. Return false for stale or zero handles.
+    bool build(EmbedHandle handle, dpp::embed& out) const;
+    bool to_json(EmbedHandle handle, std::string& out) const;
+
+private:
+    EmbedPool() = default;
+
+    struct Slot {
+        EmbedData data;
+        uint32_t generation = 1;
+        bool in_use = false;
+    };
+
+    const Slot* resolve(EmbedHandle handle) const;
+    Slot* resolve(EmbedHandle handle);
+
+    mutable std::mutex m_mutex;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+};
+
+#endif // RUNE_DISCORD_EMBED_POOL_H
@@ -0,0 +1,160 @@
+/**
+ * Entity Cache - Plugin-side TTL cache for REST-fetched users and channels
+ */
+
+#ifndef RUNE_DISCORD_ENTITY_CACHE_H
+#define RUNE_DISCORD_ENTITY_CACHE_H
+
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Flattened user as exposed to flows. found=false is a (cached) miss.
+struct UserRecord {
+    bool found = false;
+    std::string username;
+    std::string global_name;
+    std::string avatar_url;
+    bool is_bot = false;
+};
+
+struct ChannelRecord {
+    bool found = false;
+    std::string name;
+    std::string topic;
+    int64_t type = 0;
+    dpp::snowflake guild_id;
+};
+
+/**
+ * TtlCache - ID-keyed cache with per-entry expiry and request collapsing.
+ * Positive and negative results are both cached (with their own TTLs), and
+ * concurrent lookups for the same ID share a single in-flight fetch: the
+ * first caller is told to start it, later callers are queued behind it.
+ */
+template <typename Record>
+class TtlCache {
+public:
+    using Callback = std::function<void(const Record&)>;
+    using Clock = std::chrono::steady_clock;
+
+    enum class Lookup {
+        Hit,     // out holds the cached record; callback not stored
+        Joined,  // a fetch is already in flight; callback queued
+        Start    // callback queued; caller must start the fetch
+    };
+
+    explicit TtlCache(size_t capacity = 50000) : m_capacity(capacity) {}
+
+    void set_capacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_capacity = capacity;
+    }
+
+    Lookup lookup(dpp::snowflake id, Callback callback, Record& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(id);
+        if (it != m_entries.end()) {
+            if (Clock::now() < it->second.expires) {
+                out = it->second.record;
+                return Lookup::Hit;
+            }
+            m_entries.erase(it);
+        }
+
+        auto& waiters = m_inflight[id];
+        const bool first = waiters.empty();
+        waiters.push_back(std::move(callback));
+        return first ? Lookup::Start : Lookup::Joined;
+    }
+
+    // Non-blocking probe used for batch hits; does not join in-flight fetches
+    bool peek(dpp::snowflake id, Record& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(id);
+        if (it == m_entries.end() || Clock::now() >= it->second.expires) {
+            return false;
+        }
+        out = it->second.record;
+        return true;
+    }
+
+    // Stores the result (ttl of zero means do not cache) and hands back the
+    // callbacks that were waiting on it.
+    std::vector<Callback> complete(dpp::snowflake id, const Record& record, std::chrono::milliseconds ttl) {
+        std::vector<Callback> waiters;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_inflight.find(id);
+        if (it != m_inflight.end()) {
+            waiters = std::move(it->second);
+            m_inflight.erase(it);
+        }
+
+        if (ttl.count() > 0 && m_capacity > 0) {
+            if (m_entries.size() >= m_capacity) {
+                evict_locked();
+            }
+            m_entries.insert_or_assign(id, Entry{ record, Clock::now() + ttl });
+        }
+        return waiters;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_inflight.clear();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    // Visits every unexpired entry under the cache lock; fn(id, record)
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto now = Clock::now();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (now < it->second.expires) {
+                fn(it->first, it->second.record);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        Record record;
+        Clock::time_point expires;
+    };
+
+    // Drop expired entries; if the cache is still full, drop arbitrary ones
+    // until a quarter of the capacity is free again.
+    void evict_locked() {
+        const auto now = Clock::now();
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (now >= it->second.expires) {
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        const size_t target = m_capacity - m_capacity / 4;
+        for (auto it = m_entries.begin(); it != m_entries.end() && m_entries.size() > target;) {
+            it = m_entries.erase(it);
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity;
+    SnowflakeMap<Entry> m_entries;
+    SnowflakeMap<std::vector<Callback>> m_inflight;
+};
+
+#endif // RUNE_DISCORD_ENTITY_CACHE_H
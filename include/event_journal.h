@@ -0,0 +1,94 @@
+/**
+ * Event Journal - Append-only, segmented, compressed log of gateway events
+ */
+
+#ifndef RUNE_DISCORD_EVENT_JOURNAL_H
+#define RUNE_DISCORD_EVENT_JOURNAL_H
+
+#include "mapped_file.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct JournalRecord {
+    uint64_t seq = 0;
+    uint64_t time_ms = 0;  // unix milliseconds when appended
+    uint16_t kind = 0;
+    std::string payload;
+};
+
+// Which records EventJournal::read visits; kinds is a bit mask of (1 << kind)
+struct JournalFilter {
+    uint64_t after_seq = 0;
+    uint64_t since_ms = 0;
+    uint64_t until_ms = UINT64_MAX;
+    uint32_t kinds = UINT32_MAX;
+};
+
+/**
+ * EventJournal - Appends records to fixed-size segment files that are mapped
+ * read-write, so an append is a compression plus a memcpy and the data is in
+ * the OS page cache (and survives a crash of the process) as soon as
+ * append() returns. Each record is deflated on its own against a preset
+ * dictionary of common gateway JSON, so every record stays independently
+ * readable. A record's length is written last and its header and payload are
+ * covered by a CRC-32, so a torn final record simply ends the segment.
+ * Segment files only ever grow, so a reader that maps one mid-append sees
+ * the records committed so far followed by zeros, never a truncated file.
+ *
+ * A separate mapped checkpoint holds the highest sequence number the consumer
+ * has finished with; records after it are what crash recovery re-delivers.
+ * Segments are named after their first sequence number and the oldest are
+ * deleted beyond max_segments. Thread-safe.
+ */
+class EventJournal {
+public:
+    EventJournal();
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    bool open(const std::string& dir, size_t segment_bytes, size_t max_segments, std::string& error);
+    void close();
+    bool is_open() const;
+
+    // Returns the record's sequence number, or 0 if the journal is closed or
+    // the segment could not be written
+    uint64_t append(uint16_t kind, const std::string& payload);
+
+    void checkpoint(uint64_t seq);
+    uint64_t checkpoint_seq() const;
+
+    // Visits every intact record in dir matching filter, oldest first, until
+    // the visitor returns false. Safe to call while a journal appends to dir.
+    // Returns the number of records visited.
+    using Visitor = std::function<bool(const JournalRecord&)>;
+    static size_t read(const std::string& dir, const JournalFilter& filter, const Visitor& visitor);
+
+private:
+    struct Deflater;
+
+    bool start_segment_locked(size_t min_bytes);
+    void finish_segment_locked();
+
+    mutable std::mutex m_mutex;
+    std::string m_dir;
+    size_t m_segment_bytes = 0;
+    size_t m_max_segments = 0;
+    std::deque<std::string> m_segments;  // oldest first; back is being written
+
+    MappedFile m_segment;
+    size_t m_offset = 0;
+    uint64_t m_next_seq = 1;
+
+    MappedFile m_checkpoint;
+    std::unique_ptr<Deflater> m_deflater;
+    std::vector<uint8_t> m_buffer;
+};
+
+#endif // RUNE_DISCORD_EVENT_JOURNAL_H
@@ -0,0 +1,110 @@
+/**
+ * Event Trace - Sampled per-event spans exported as Chrome trace JSON
+ */
+
+#ifndef RUNE_DISCORD_EVENT_TRACE_H
+#define RUNE_DISCORD_EVENT_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Span names and categories must be string literals (or otherwise outlive
+// the tracer); spans store the pointers only
+struct TraceSpan {
+    uint64_t trace_id = 0;
+    const char* name = nullptr;
+    const char* category = nullptr;
+    int64_t start_us = 0;
+    int64_t end_us = 0;
+};
+
+// What a REST call made from a traced flow carries to its completion
+struct TraceCall {
+    uint64_t trace_id = 0;  // 0 = untraced
+    const char* category = nullptr;
+    int64_t start_us = 0;
+};
+
+/**
+ * EventTracer - Follows one in every N gateway events (trace_sample_rate)
+ * from the gateway handler to the REST calls its flow makes:
+ *
+ *   receive        handler entry to queued (parsing, journal, index)
+ *   queue          queued until tick() picks the batch up
+ *   dispatch_wait  behind earlier events of the same batch
+ *   listeners      event node callbacks
+ *   flow           dispatch to the flow's first REST call
+ *   <route>        each REST call, request to response
+ *
+ * An event is the dispatching thread's current one only while its listener
+ * callbacks (and the flows they trigger) run, set by a Scope; REST calls made
+ * outside a dispatch are not attributed to any event. Spans go to a fixed-size
+ * ring (oldest overwritten) that write_chrome_json() dumps as nestable async
+ * slices, one track per traced event, for chrome://tracing or Perfetto.
+ *
+ * An unsampled event costs one relaxed atomic increment; span recording
+ * takes a mutex, but only sampled events record.
+ */
+class EventTracer {
+public:
+    EventTracer();
+
+    // sample_rate 0 disables tracing; capacity is in spans. Resizing the
+    // ring drops what it held.
+    void configure(uint32_t sample_rate, size_t capacity);
+    bool enabled() const { return m_sample_rate.load(std::memory_order_relaxed) != 0; }
+
+    // New trace ID if this event is sampled, else 0
+    uint64_t sample();
+
+    int64_t now_us() const;
+    int64_t to_us(std::chrono::steady_clock::time_point t) const;
+
+    void record(uint64_t trace_id, const char* name, const char* category, int64_t start_us, int64_t end_us);
+
+    // Dispatching thread's current event; trace_id 0 clears it
+    void set_current(uint64_t trace_id, const char* category, int64_t dispatched_us);
+
+    // Makes an event the current one until the end of the scope
+    class Scope {
+    public:
+        Scope(EventTracer& tracer, uint64_t trace_id, const char* category, int64_t dispatched_us)
+            : m_tracer(tracer) {
+            m_tracer.set_current(trace_id, category, dispatched_us);
+        }
+        ~Scope() { m_tracer.set_current(0, nullptr, 0); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        EventTracer& m_tracer;
+    };
+    // At a REST call: records the flow span on the first call of the current
+    // event and returns what end_call() needs
+    TraceCall begin_call();
+    void end_call(const TraceCall& call, const char* name);
+
+    size_t size() const;
+    void clear();
+
+    // Writes the ring as Chrome trace JSON; returns the number of spans
+    // written, or -1 with error set
+    long write_chrome_json(const std::string& path, std::string& error) const;
+
+private:
+    std::chrono::steady_clock::time_point m_epoch;
+    std::atomic<uint32_t> m_sample_rate{ 0 };
+    std::atomic<uint64_t> m_events{ 0 };
+
+    mutable std::mutex m_mutex;
+    std::vector<TraceSpan> m_ring;
+    size_t m_next = 0;
+    size_t m_size = 0;
+};
+
+#endif // RUNE_DISCORD_EVENT_TRACE_H
@@ -0,0 +1,89 @@
+/**
+ * Flow Scanner - Which Discord node types each flow uses, without loading the flow
+ */
+
+#ifndef RUNE_DISCORD_FLOW_SCANNER_H
+#define RUNE_DISCORD_FLOW_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Definition inputs of one On Slash Command node, as stored in its
+// "properties" (string values, keyed by pin name)
+struct FlowSlashCommand {
+    std::string command;
+    std::string description;
+    std::string options;   // CommandOptions: JSON array text
+    std::string guild_id;  // CommandGuildID; empty: global command
+};
+
+// Result of scanning one flow.json
+struct FlowScan {
+    bool opened = false;      // false: flow.json missing or unreadable
+    std::string error;        // open or parse error; empty on success
+    // Distinct com.rune.discord.* node types, in order of first appearance
+    std::vector<std::string> discord_node_types;
+    // On Slash Command nodes with Command set, in flow order
+    std::vector<FlowSlashCommand> slash_commands;
+
+    bool ok() const { return opened && error.empty(); }
+    bool has(const std::string& type) const;
+};
+
+/**
+ * FlowScanner - Streams flow.json through a SAX handler that only keeps the
+ * "type" of each entry of the top-level "nodes" array, plus the command
+ * definition properties of On Slash Command nodes, and stops at the end of
+ * that array, so links, positions and other properties are tokenized at
+ * most and never built into a DOM.
+ *
+ * Scans are cached by path and reused while the file's size and modification
+ * time are unchanged. prescan() fills the cache for every flow under a flows
+ * directory on several threads, so a host loading many flows at startup pays
+ * for one parallel pass instead of one parse per load. Thread-safe.
+ */
+class FlowScanner {
+public:
+    static const char* const kDiscordTypePrefix;  // "com.rune.discord."
+    static const char* const kSlashCommandType;   // "com.rune.discord.on_slash_command"
+
+    // <flows_dir>/<flow_id>/flow.json
+    static std::string flow_path(const std::string& flows_dir, const std::string& flow_id);
+
+    // Uncached scan
+    static FlowScan scan_file(const std::string& path);
+
+    // Cached scan; the file is stat'ed on every call and rescanned when changed
+    std::shared_ptr<const FlowScan> scan(const std::string& path);
+
+    // Scans every <flows_dir>/<id>/flow.json that is not cached or has changed
+    // on up to `threads` threads (0: one per core). Returns the number scanned.
+    size_t prescan(const std::string& flows_dir, unsigned threads = 0);
+
+    void clear();
+    size_t size() const;
+
+private:
+    struct Entry {
+        uintmax_t size = 0;
+        std::filesystem::file_time_type mtime;
+        std::shared_ptr<const FlowScan> scan;
+    };
+
+    // Cached entry for path if still current, else nullptr
+    std::shared_ptr<const FlowScan> lookup(const std::string& path, uintmax_t size,
+                                           std::filesystem::file_time_type mtime) const;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_cache;
+};
+
+FlowScanner& flow_scanner();
+
+#endif // RUNE_DISCORD_FLOW_SCANNER_H
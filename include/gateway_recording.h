@@ -0,0 +1,96 @@
+/**
+ * Gateway Recording - Capture of raw gateway dispatches and offline playback
+ */
+
+#ifndef RUNE_DISCORD_GATEWAY_RECORDING_H
+#define RUNE_DISCORD_GATEWAY_RECORDING_H
+
+#include "mapped_file.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+
+/**
+ * GatewayRecorder - Appends raw gateway dispatch payloads to a text file, one
+ * per line, prefixed with the microseconds elapsed since recording started:
+ *
+ *   #rune-gateway-recording v1 <start unix ms>
+ *   <offset us> <dispatch JSON>
+ *
+ * Lines can be trimmed, grepped or concatenated by hand to build a replay
+ * scenario. Writes are buffered and flushed at most once a second, so a crash
+ * loses at most the last second. Thread-safe; record() is a single atomic
+ * load while the recorder is closed.
+ */
+class GatewayRecorder {
+public:
+    GatewayRecorder() = default;
+    ~GatewayRecorder();
+
+    GatewayRecorder(const GatewayRecorder&) = delete;
+    GatewayRecorder& operator=(const GatewayRecorder&) = delete;
+
+    // Truncates any existing file at path
+    bool open(const std::string& path, std::string& error);
+    void close();
+    bool is_open() const { return m_open.load(std::memory_order_relaxed); }
+
+    void record(const std::string& raw_event);
+
+    // Dispatches written since open()
+    uint64_t count() const;
+
+private:
+    std::atomic<bool> m_open{ false };
+    mutable std::mutex m_mutex;
+    std::FILE* m_file = nullptr;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_last_flush;
+    uint64_t m_count = 0;
+};
+
+/**
+ * GatewayPlayback - Reads a GatewayRecorder file (memory-mapped) and hands its
+ * dispatches out in order as they fall due. At speed N the recorded gaps are
+ * divided by N; speed 0 ignores timing and hands out a fixed batch per poll(),
+ * so a run is the same sequence of ticks every time. Concatenated recordings
+ * play back to back. Not thread-safe; meant to be pumped from one thread.
+ */
+class GatewayPlayback {
+public:
+    using Visitor = std::function<void(const std::string& raw_event)>;
+
+    bool open(const std::string& path, uint32_t speed, std::string& error);
+    void close();
+    bool is_open() const { return m_file.is_open(); }
+    bool finished() const { return m_position >= m_file.size(); }
+
+    // Visits the dispatches that are due (at speed 0, all remaining ones), at
+    // most max_batch per call; returns the number visited
+    size_t poll(size_t max_batch, const Visitor& visitor);
+
+    uint64_t count() const { return m_count; }
+    // Wall time since the first poll()
+    std::chrono::steady_clock::duration elapsed() const;
+
+private:
+    // Parses the next dispatch line at or after m_position (skipping headers
+    // and junk lines) into offset/payload; false at end of file
+    bool peek(uint64_t& offset_us, size_t& payload, size_t& payload_len, size_t& next);
+
+    MappedFile m_file;
+    size_t m_position = 0;
+    uint32_t m_speed = 1;
+    bool m_started = false;
+    uint64_t m_first_offset_us = 0;
+    std::chrono::steady_clock::time_point m_base;   // when m_first_offset_us was due
+    std::chrono::steady_clock::time_point m_start;  // first poll() that visited
+    uint64_t m_count = 0;
+    std::string m_scratch;
+};
+
+#endif // RUNE_DISCORD_GATEWAY_RECORDING_H
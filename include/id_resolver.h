@@ -0,0 +1,105 @@
+/**
+ * ID Resolver - Batch resolution of user, member and channel IDs
+ */
+
+#ifndef RUNE_DISCORD_ID_RESOLVER_H
+#define RUNE_DISCORD_ID_RESOLVER_H
+
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class BotManager;
+
+enum class ResolveKind {
+    User,
+    Member,
+    Channel
+};
+
+// One resolved ID. Which fields are meaningful depends on the ResolveKind.
+struct ResolvedRecord {
+    dpp::snowflake id;
+    bool found = false;
+    std::string name;         // username (user/member) or channel name
+    std::string secondary;    // global name (user), nickname (member), topic (channel)
+    std::string avatar_url;   // user
+    bool is_bot = false;      // user/member
+    int64_t type = 0;         // channel
+    dpp::snowflake guild_id;  // channel
+    std::vector<dpp::snowflake> roles;  // member
+    int64_t joined_at = 0;    // member
+};
+
+using ResolveCallback = std::function<void(std::vector<ResolvedRecord>& records)>;
+
+/**
+ * IdResolver - Resolves many IDs in one request. Cache hits are answered in
+ * a single pass; misses go through a bounded number of concurrent REST
+ * fetches (rest_max_concurrency). Member misses are first requested from the
+ * gateway in guild member chunks (100 IDs per request) when the
+ * GUILD_MEMBERS intent is enabled, with REST as the fallback for IDs the
+ * chunks do not answer in time.
+ *
+ * All batch state lives on the main thread: resolve() is called from node
+ * execution and completions arrive through BotManager::post_to_main.
+ */
+class IdResolver {
+public:
+    explicit IdResolver(BotManager& bot);
+
+    // Results are parallel to ids. The callback runs on the main thread.
+    void resolve(ResolveKind kind, dpp::snowflake guild_id,
+                 const std::vector<dpp::snowflake>& ids, ResolveCallback callback);
+
+    // Gateway thread: forwards chunk contents for pending member batches.
+    // d is the chunk's parsed "d" object.
+    void on_members_chunk(const nlohmann::json& d);
+    bool has_chunk_waiters() const { return m_chunk_waiters.load() > 0; }
+
+    // Main thread: handles chunk timeouts
+    void tick();
+
+    void clear();
+
+    static std::string records_to_json(ResolveKind kind, const std::vector<ResolvedRecord>& records);
+
+private:
+    struct Batch {
+        uint64_t id = 0;
+        ResolveKind kind = ResolveKind::User;
+        dpp::snowflake guild_id;
+        std::vector<ResolvedRecord> results;
+        SnowflakeMap<std::vector<size_t>> positions;  // id -> indexes (duplicates allowed)
+        std::vector<dpp::snowflake> rest_queue;  // unique IDs waiting for REST
+        size_t rest_next = 0;
+        size_t rest_in_flight = 0;
+        size_t unresolved = 0;                   // unique IDs without an answer
+        bool awaiting_chunks = false;
+        std::chrono::steady_clock::time_point chunk_deadline;
+        ResolveCallback callback;
+    };
+
+    void fill(Batch& batch, dpp::snowflake id, const ResolvedRecord& record);
+    void request_member_chunks(Batch& batch, const std::vector<dpp::snowflake>& ids);
+    void pump_rest(const std::shared_ptr<Batch>& batch);
+    void finish_if_done(const std::shared_ptr<Batch>& batch);
+    void apply_chunk(uint64_t batch_id, std::vector<ResolvedRecord>& members,
+                     const std::vector<dpp::snowflake>& not_found);
+
+    BotManager& m_bot;
+    uint64_t m_next_batch = 1;
+    SnowflakeMap<std::shared_ptr<Batch>, uint64_t> m_batches;
+    // Set while any member batch waits on chunks, so the gateway thread only
+    // parses chunk payloads when someone is listening for them.
+    std::atomic<int> m_chunk_waiters{ 0 };
+};
+
+#endif // RUNE_DISCORD_ID_RESOLVER_H
@@ -0,0 +1,128 @@
+/**
+ * Interaction Tracker - Response state and auto-defer deadline of open interactions
+ */
+
+#ifndef RUNE_DISCORD_INTERACTION_TRACKER_H
+#define RUNE_DISCORD_INTERACTION_TRACKER_H
+
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class BotManager;
+
+enum class InteractionCallKind {
+    Respond,       // POST /interactions/{id}/{token}/callback, type 4
+    Defer,         // the same with type 5 ("thinking..."), no message
+    DeferUpdate,   // the same with type 6: acknowledges a component click silently
+    EditOriginal,  // PATCH /webhooks/{app}/{token}/messages/@original
+    Followup       // POST /webhooks/{app}/{token}
+};
+
+// One REST call on an interaction token
+struct InteractionCall {
+    InteractionCallKind kind = InteractionCallKind::Respond;
+    dpp::snowflake interaction_id;
+    dpp::snowflake application_id;
+    std::string token;
+    dpp::message message;
+};
+
+/**
+ * InteractionTracker - Discord fails an interaction that is not answered
+ * within 3 seconds, and the flow answering it runs on the host's main thread,
+ * behind the current frame and the tick's backlog. track() is called on the
+ * gateway thread as the interaction arrives; if respond() has not been called
+ * by the auto-defer deadline, a deadline thread sends a deferred response,
+ * which keeps the token valid for 15 minutes. For a slash command that shows
+ * "thinking..." and respond() then edits it; a component click is deferred as
+ * an update, which shows nothing, so respond() sends a follow-up. Later calls
+ * are follow-ups as well. release() ends tracking of an interaction that no
+ * node handles.
+ *
+ * Responses made while the initial response or the defer is still in flight
+ * are held until Discord acknowledges it, so an edit or follow-up cannot
+ * overtake the call that creates the message it refers to.
+ */
+class InteractionTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // How long Discord accepts calls on an interaction token
+    static constexpr std::chrono::minutes kTokenLifetime{ 15 };
+
+    explicit InteractionTracker(BotManager& bot);
+    ~InteractionTracker();
+
+    // Gateway thread. A zero auto_defer leaves the response entirely to the
+    // flow. component: a message component click (type 3)
+    void track(dpp::snowflake id, dpp::snowflake application_id, const std::string& token,
+               std::chrono::milliseconds auto_defer, bool component);
+
+    // Any thread. False if the interaction is unknown or its token has expired.
+    bool respond(dpp::snowflake id, const dpp::message& msg);
+
+    // Main thread, for an interaction no node handled. One still pending is
+    // dropped without a defer, so Discord reports it as failed; a slash
+    // command already showing "thinking..." has it replaced by notice.
+    void release(dpp::snowflake id, const dpp::message& notice);
+
+    // Stops the deadline thread and forgets every interaction
+    void clear();
+
+    size_t size() const;
+
+private:
+    enum class State {
+        Pending,    // nothing sent yet
+        Sending,    // initial response or defer in flight; responses wait in held
+        Deferred,   // defer acknowledged, original response still empty
+        Responded   // original response sent; further responses are follow-ups
+    };
+
+    struct Entry {
+        dpp::snowflake application_id;
+        std::string token;
+        bool component = false;
+        State state = State::Pending;
+        std::vector<dpp::message> held;
+    };
+
+    struct Deadline {
+        Clock::time_point at;
+        dpp::snowflake id;
+        bool operator>(const Deadline& other) const { return at > other.at; }
+    };
+
+    void run();
+    // Drops entries whose token has expired; m_mutex held
+    void expire_locked(Clock::time_point now);
+    static InteractionCall make_call(InteractionCallKind kind, dpp::snowflake id, const Entry& entry,
+                                     const dpp::message& msg);
+    // Sends the call that opens the response (Respond or Defer)
+    void send_initial(const InteractionCall& call);
+    void on_initial_sent(dpp::snowflake id, InteractionCallKind kind, bool ok);
+
+    BotManager& m_bot;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    SnowflakeMap<Entry> m_entries;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> m_deadlines;
+    // Arrival order is expiry order
+    std::deque<std::pair<Clock::time_point, dpp::snowflake>> m_expiry;
+    std::thread m_thread;
+    bool m_stop = false;
+};
+
+#endif // RUNE_DISCORD_INTERACTION_TRACKER_H
@@ -0,0 +1,59 @@
+/**
+ * Mapped File - Memory mapping of a whole file
+ */
+
+#ifndef RUNE_DISCORD_MAPPED_FILE_H
+#define RUNE_DISCORD_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * MappedFile - Maps a file for its lifetime (POSIX mmap or Win32 file
+ * mapping). Pages are faulted in on first access, so opening a large file is
+ * cheap and untouched parts are never read. Writable mappings are shared with
+ * the file: stores reach the OS page cache immediately and survive a crash of
+ * the process (not of the machine, unless flush() was called). Move-only.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Returns false (and leaves the object closed) if the file cannot be
+    // opened or mapped; an empty file opens successfully with size() == 0
+    bool open(const std::string& path);
+    // Creates the file if needed and grows it to at least size bytes (new
+    // bytes read as zero); size must be non-zero
+    bool open_writable(const std::string& path, size_t size);
+    void close();
+
+    // Schedules dirty pages of a writable mapping to be written to disk
+    void flush();
+
+    bool is_open() const { return m_open; }
+    bool is_writable() const { return m_writable; }
+    const uint8_t* data() const { return m_data; }
+    uint8_t* writable_data() { return m_writable ? const_cast<uint8_t*>(m_data) : nullptr; }
+    size_t size() const { return m_size; }
+
+private:
+    void swap(MappedFile& other) noexcept;
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_open = false;
+    bool m_writable = false;
+#if defined(_WIN32)
+    void* m_file = nullptr;     // HANDLE
+    void* m_mapping = nullptr;  // HANDLE
+#endif
+};
+
+#endif // RUNE_DISCORD_MAPPED_FILE_H
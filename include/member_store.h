@@ -0,0 +1,223 @@
+/**
+ * Member Store - Compact column store of guild members for very large guilds
+ */
+
+#ifndef RUNE_DISCORD_MEMBER_STORE_H
+#define RUNE_DISCORD_MEMBER_STORE_H
+
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+/**
+ * StringInterner - Append-only string pool. Every distinct string is stored
+ * once in a single arena and referred to by a 32-bit ID; ID 0 is the empty
+ * string. Not thread-safe (MemberStore locks around it).
+ */
+class StringInterner {
+public:
+    StringInterner();
+
+    uint32_t intern(const char* data, size_t size);
+    uint32_t intern(const std::string& s) { return intern(s.data(), s.size()); }
+    std::string get(uint32_t id) const;
+
+    void clear();
+    size_t size() const { return m_offsets.size() - 1; }
+    size_t memory_bytes() const;
+
+private:
+    bool equals(uint32_t id, const char* data, size_t size) const;
+    void grow_table();
+
+    std::string m_arena;
+    std::vector<uint32_t> m_offsets;  // id -> start in arena; one extra entry marks the end
+    std::vector<uint32_t> m_table;    // open-addressed ids, 0 = free slot
+};
+
+/**
+ * RowIndex - Open-addressed (linear probing) table of row numbers. The key
+ * of a row is read back from the owning columns through key_of(row), so a
+ * slot is 4 bytes instead of a key/value pair. Not thread-safe.
+ */
+class RowIndex {
+public:
+    static const uint32_t kNotFound = UINT32_MAX;
+
+    template <typename KeyOf>
+    uint32_t find(uint64_t key, KeyOf key_of) const {
+        if (m_slots.empty()) {
+            return kNotFound;
+        }
+        const size_t mask = m_slots.size() - 1;
+        for (size_t i = home(key, mask);; i = (i + 1) & mask) {
+            const uint32_t slot = m_slots[i];
+            if (slot == 0) {
+                return kNotFound;
+            }
+            if (key_of(slot - 1) == key) {
+                return slot - 1;
+            }
+        }
+    }
+
+    // key must not already be present
+    template <typename KeyOf>
+    void insert(uint64_t key, uint32_t row, KeyOf key_of) {
+        if ((m_size + 1) * 4 > m_slots.size() * 3) {
+            grow(key_of);
+        }
+        const size_t mask = m_slots.size() - 1;
+        size_t i = home(key, mask);
+        while (m_slots[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = row + 1;
+        ++m_size;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    template <typename KeyOf>
+    void erase(uint64_t key, KeyOf key_of) {
+        if (m_slots.empty()) {
+            return;
+        }
+        const size_t mask = m_slots.size() - 1;
+        size_t i = home(key, mask);
+        for (;; i = (i + 1) & mask) {
+            if (m_slots[i] == 0) {
+                return;
+            }
+            if (key_of(m_slots[i] - 1) == key) {
+                break;
+            }
+        }
+        for (size_t j = (i + 1) & mask; m_slots[j] != 0; j = (j + 1) & mask) {
+            const size_t k = home(key_of(m_slots[j] - 1), mask);
+            // Move j into the hole unless its home lies cyclically in (i, j]
+            const bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+            if (!stays) {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i] = 0;
+        --m_size;
+    }
+
+    size_t size() const { return m_size; }
+    size_t memory_bytes() const { return m_slots.capacity() * sizeof(uint32_t); }
+
+private:
+    static size_t home(uint64_t key, size_t mask) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key) & mask;
+    }
+
+    template <typename KeyOf>
+    void grow(KeyOf key_of) {
+        std::vector<uint32_t> old;
+        old.swap(m_slots);
+        m_slots.assign(old.empty() ? 16 : old.size() * 2, 0);
+        const size_t mask = m_slots.size() - 1;
+        for (uint32_t slot : old) {
+            if (slot == 0) {
+                continue;
+            }
+            size_t i = home(key_of(slot - 1), mask);
+            while (m_slots[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            m_slots[i] = slot;
+        }
+    }
+
+    std::vector<uint32_t> m_slots;  // row + 1; 0 = empty
+    size_t m_size = 0;
+};
+
+// Flattened views returned to nodes
+struct StoredUser {
+    std::string username;
+    std::string global_name;
+    bool is_bot = false;
+};
+
+struct StoredMember {
+    std::string username;
+    std::string global_name;
+    std::string nickname;
+    bool is_bot = false;
+    int64_t joined_at = 0;  // unix seconds
+    std::vector<dpp::snowflake> roles;
+};
+
+/**
+ * MemberStore - Keeps only what flows use (ID, names, roles, join time) in
+ * columnar arrays instead of one dpp::user plus one dpp::guild_member object
+ * per member.
+ *
+ * Users are shared across guilds in one table; each guild has its own member
+ * columns indexed by row, with role IDs mapped to per-guild bit positions so
+ * a member's role set is a few 64-bit words. Names are interned. Fed from the
+ * raw gateway JSON (member chunks, member add/update/remove) so it works with
+ * DPP's user cache disabled. Thread-safe: gateway threads write, node
+ * execution reads.
+ */
+class MemberStore {
+public:
+    // Gateway payloads. ingest_chunk takes the "d" object of a
+    // GUILD_MEMBERS_CHUNK; upsert_member takes a member object that carries
+    // its own guild_id (GUILD_MEMBER_ADD/UPDATE).
+    void ingest_chunk(const nlohmann::json& d);
+    void upsert_member(const nlohmann::json& d);
+    void remove_member(dpp::snowflake guild_id, dpp::snowflake user_id);
+    void remove_guild(dpp::snowflake guild_id);
+    void clear();
+
+    bool get_user(dpp::snowflake user_id, StoredUser& out) const;
+    bool get_member(dpp::snowflake guild_id, dpp::snowflake user_id, StoredMember& out) const;
+
+    size_t member_count() const;
+    size_t user_count() const;
+    // Bytes held by the store's arrays, tables and name arena
+    size_t memory_bytes() const;
+
+private:
+    struct GuildColumns {
+        RowIndex index;                        // user ID -> row
+        std::vector<uint32_t> user_row;        // row -> users table row (UINT32_MAX = free)
+        std::vector<uint32_t> nickname;        // interned
+        std::vector<uint32_t> joined_at;       // unix seconds
+        std::vector<uint64_t> role_bits;       // row * role_words .. + role_words
+        size_t role_words = 1;
+        SnowflakeMap<uint16_t> role_bit;       // role ID -> bit
+        std::vector<dpp::snowflake> role_ids;  // bit -> role ID
+        std::vector<uint32_t> free_rows;
+    };
+
+    uint64_t user_key(uint32_t row) const { return m_user_ids[row]; }
+    uint64_t member_key(const GuildColumns& guild, uint32_t row) const { return m_user_ids[guild.user_row[row]]; }
+
+    uint32_t upsert_user_locked(const nlohmann::json& user);
+    void upsert_member_locked(GuildColumns& guild, const nlohmann::json& member);
+    uint16_t role_bit_locked(GuildColumns& guild, dpp::snowflake role_id);
+
+    mutable std::shared_mutex m_mutex;
+    StringInterner m_names;
+    RowIndex m_user_index;                 // user ID -> row
+    std::vector<uint64_t> m_user_ids;
+    std::vector<uint32_t> m_usernames;
+    std::vector<uint32_t> m_global_names;
+    std::vector<uint8_t> m_user_flags;     // bit 0: bot
+    SnowflakeMap<GuildColumns> m_guilds;
+    size_t m_member_count = 0;
+};
+
+#endif // RUNE_DISCORD_MEMBER_STORE_H
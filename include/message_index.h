@@ -0,0 +1,113 @@
+/**
+ * Message Index - Bounded in-memory message history with an inverted index
+ */
+
+#ifndef RUNE_DISCORD_MESSAGE_INDEX_H
+#define RUNE_DISCORD_MESSAGE_INDEX_H
+
+#include "snowflake_map.h"
+#include <dpp/dpp.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+struct IndexedMessage {
+    dpp::snowflake id;
+    dpp::snowflake author_id;
+    dpp::snowflake channel_id;
+    dpp::snowflake guild_id;
+    int64_t timestamp = 0;  // unix seconds
+    std::string content;
+};
+
+// Every set field must match; text matches messages containing all of its
+// words (case-insensitive for ASCII, in any order)
+struct MessageQuery {
+    std::string text;
+    dpp::snowflake author_id;
+    dpp::snowflake channel_id;
+    dpp::snowflake guild_id;
+    int64_t since = 0;  // unix seconds; 0 = the whole retention window
+    size_t limit = 50;
+};
+
+/**
+ * MessageIndex - Keeps the most recent messages in arrival order and indexes
+ * them three ways: word -> messages, author -> messages and channel ->
+ * messages. Posting lists hold 32-bit sequence numbers in ascending order, so
+ * a query walks the shortest matching list from newest to oldest and checks
+ * the other lists with binary searches, stopping once it has enough results
+ * or passes the time cutoff.
+ *
+ * Messages leave the index when they age out of the retention window or, when
+ * the message/memory cap is hit, either the oldest are evicted or new ones are
+ * rejected (Eviction). Posting entries of evicted messages are dropped lazily
+ * in bulk once they make up half of all postings. Words are hashed to 64 bits
+ * and not stored. Thread-safe: gateway threads add, node execution searches.
+ */
+class MessageIndex {
+public:
+    enum class Eviction {
+        Oldest,  // evict the oldest messages to admit new ones
+        Reject   // keep what is indexed and drop new messages until there is room
+    };
+
+    // max_bytes is an estimate covering message text, records and postings
+    void configure(size_t max_messages, size_t max_bytes, std::chrono::seconds window, Eviction eviction);
+
+    void add(const IndexedMessage& message);
+    void remove(dpp::snowflake channel_id, dpp::snowflake message_id);
+    void clear();
+
+    // Newest first; returns the number of results appended to out
+    size_t search(const MessageQuery& query, std::vector<IndexedMessage>& out) const;
+
+    size_t size() const;
+    size_t memory_bytes() const;
+
+    // Hashes of the distinct words in text (runs of ASCII letters/digits, with
+    // non-ASCII bytes kept inside words; ASCII is lower-cased)
+    static void tokenize(const std::string& text, std::vector<uint64_t>& out);
+
+private:
+    using Postings = std::vector<uint32_t>;
+
+    struct Entry {
+        uint64_t id;
+        uint64_t author_id;
+        uint64_t channel_id;
+        uint64_t guild_id;
+        uint32_t timestamp;
+        uint16_t token_count;
+        bool deleted;
+        std::string content;
+    };
+
+    const Entry* entry_at(uint32_t seq) const;
+    size_t entry_bytes(const Entry& entry) const;
+    void index_locked(uint32_t seq, const Entry& entry, const std::vector<uint64_t>& tokens);
+    void expire_locked(int64_t now);
+    void evict_front_locked();
+    void compact_postings_locked();
+    void renumber_locked();
+
+    mutable std::shared_mutex m_mutex;
+    size_t m_max_messages = 1000000;
+    size_t m_max_bytes = 256u << 20;
+    std::chrono::seconds m_window{ 86400 };
+    Eviction m_eviction = Eviction::Oldest;
+
+    std::deque<Entry> m_entries;  // arrival order; front has sequence m_base_seq
+    uint32_t m_base_seq = 0;
+    SnowflakeMap<Postings, uint64_t> m_words;
+    SnowflakeMap<Postings> m_by_author;
+    SnowflakeMap<Postings> m_by_channel;
+    size_t m_live_postings = 0;
+    size_t m_total_postings = 0;
+    size_t m_bytes = 0;
+};
+
+#endif // RUNE_DISCORD_MESSAGE_INDEX_H
@@ -0,0 +1,79 @@
+/**
+ * Message Template - Placeholder templates compiled once, rendered many times
+ */
+
+#ifndef RUNE_DISCORD_MESSAGE_TEMPLATE_H
+#define RUNE_DISCORD_MESSAGE_TEMPLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * MessageTemplate - "Hi {AuthorName}, you said {Content}" compiled into a
+ * flat segment list. Placeholders:
+ *   {AuthorID} {AuthorName} {Content}          - On Message fields
+ *   {UserID} {Emoji}                           - On Reaction fields
+ *   {ChannelID} {GuildID} {MessageID}          - either event's fields
+ *   {Arg0} ... {Arg9}                          - caller-supplied args
+ * "{{" and "}}" produce literal braces. Values are supplied per render by the
+ * caller (Format Message takes them from the event whose listeners are
+ * running, or from wired pins), so a render only ever sees the event that
+ * triggered its flow.
+ */
+class MessageTemplate {
+public:
+    enum Field : uint8_t {
+        AuthorId,
+        AuthorName,
+        Content,
+        UserId,
+        Emoji,
+        ChannelId,
+        GuildId,
+        MessageId,
+        kFieldCount
+    };
+    // Placeholder name of a field, e.g. "AuthorName"
+    static const char* field_name(Field field);
+
+    // Values a render reads; null pointers render as empty strings
+    struct Inputs {
+        const char* fields[kFieldCount] = {};
+        const char* const* args = nullptr;
+        size_t arg_count = 0;
+    };
+
+    // Returns false (and leaves the template empty) on a syntax error or an
+    // unknown placeholder; error describes the problem.
+    bool compile(const std::string& source, std::string& error);
+
+    const std::string& source() const { return m_source; }
+    bool is_compiled() const { return m_compiled; }
+
+    // Renders into out, reusing its capacity; sized once up front.
+    void render(const Inputs& inputs, std::string& out) const;
+
+private:
+    enum class SegmentKind : uint8_t {
+        Literal,
+        Field,
+        Arg
+    };
+
+    struct Segment {
+        SegmentKind kind;
+        uint32_t offset;  // Literal: into m_literals; Field: Field; Arg: arg index
+        uint32_t length;  // Literal only
+    };
+
+    bool add_placeholder(const std::string& name, std::string& error);
+
+    std::string m_source;
+    std::string m_literals;
+    std::vector<Segment> m_segments;
+    bool m_compiled = false;
+};
+
+#endif // RUNE_DISCORD_MESSAGE_TEMPLATE_H
@@ -0,0 +1,168 @@
+/**
+ * Metrics - Lock-free runtime counters, gauges and latency histograms
+ */
+
+#ifndef RUNE_DISCORD_METRICS_H
+#define RUNE_DISCORD_METRICS_H
+
+#include <nlohmann/json.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MetricCounter {
+public:
+    void add(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{ 0 };
+};
+
+class MetricGauge {
+public:
+    MetricGauge() = default;
+    explicit MetricGauge(int64_t initial) : m_value(initial) {}
+
+    void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{ 0 };
+};
+
+/**
+ * LatencyHistogram - HDR-style log-linear histogram of microsecond values.
+ * Values below 16 us have exact buckets; above that every power of two is
+ * split into 16 buckets, so a reported percentile is within 1/16 of the true
+ * value. Values from 2^40 us (about 12 days) up share the last bucket.
+ * record() is a handful of relaxed atomic adds; readers see a slightly torn
+ * but never corrupt view.
+ */
+class LatencyHistogram {
+public:
+    static const int kSubBits = 4;
+    static const uint64_t kSubCount = uint64_t(1) << kSubBits;
+    static const int kMaxExponent = 40;
+    static const size_t kBucketCount = static_cast<size_t>(kMaxExponent - kSubBits + 1) * kSubCount;
+
+    void record(uint64_t us);
+    void record(std::chrono::steady_clock::duration latency);
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t sum_us() const { return m_sum.load(std::memory_order_relaxed); }
+    uint64_t max_us() const { return m_max.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding quantile q (0..1), capped at the
+    // largest value seen; 0 when empty
+    uint64_t percentile_us(double q) const;
+
+    // Raw buckets, for exporters. bucket_upper() is the largest value (us)
+    // that lands in the bucket.
+    uint64_t bucket_value(size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+    static uint64_t bucket_upper(size_t bucket);
+
+private:
+    static size_t bucket_of(uint64_t us);
+
+    std::array<std::atomic<uint64_t>, kBucketCount> m_buckets{};
+    std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_sum{ 0 };
+    std::atomic<uint64_t> m_max{ 0 };
+};
+
+// REST routes the plugin calls, as Discord's route templates
+enum class RestRoute {
+    CreateMessage,        // POST /channels/{id}/messages
+    AddReaction,          // PUT /channels/{id}/messages/{id}/reactions/{emoji}/@me
+    CreateDm,             // POST /users/@me/channels
+    GetUser,              // GET /users/{id}
+    GetChannel,           // GET /channels/{id}
+    GetMember,            // GET /guilds/{id}/members/{id}
+    GetWebhooks,          // GET /channels/{id}/webhooks
+    CreateWebhook,        // POST /channels/{id}/webhooks
+    ExecuteWebhook,       // POST /webhooks/{id}/{token}
+    InteractionCallback,  // POST /interactions/{id}/{token}/callback
+    EditInteraction,      // PATCH /webhooks/{id}/{token}/messages/@original
+    InteractionFollowup,  // POST /webhooks/{id}/{token} (interaction token)
+    OverwriteCommands,    // PUT /applications/{id}[/guilds/{id}]/commands
+    Count
+};
+
+const char* rest_route_name(RestRoute route);
+// Name of a DiscordEventType index ("ready", "message", ...)
+const char* event_type_name(size_t type);
+
+/**
+ * DiscordMetrics - Process-wide registry. Event counters are indexed by
+ * DiscordEventType. Writers are the gateway threads, REST callbacks and
+ * tick(); the gauges are refreshed by BotManager::sample_metrics(). Reading
+ * (to_json, to_prometheus) takes no locks.
+ */
+struct DiscordMetrics {
+    static const size_t kEventTypes = 5;
+    static const size_t kMaxShards = 64;  // shards beyond this are not reported individually
+
+    struct Rest {
+        MetricCounter requests;
+        MetricCounter errors;        // final status >= 400
+        MetricCounter rate_limited;  // final status 429
+        LatencyHistogram latency;
+        MetricGauge in_flight;       // issued, not yet completed
+        // Discord's X-RateLimit-Remaining / Reset-After of the latest response
+        // (-1 until a response carried them)
+        MetricGauge bucket_remaining{ -1 };
+        MetricGauge bucket_reset_after_ms{ -1 };
+    };
+
+    MetricCounter events_received[kEventTypes];
+    MetricCounter events_dispatched[kEventTypes];
+    // Discarded at shutdown, or dispatched with no listener registered
+    MetricCounter events_dropped[kEventTypes];
+    MetricGauge queue_depth;        // events waiting for the next tick
+    MetricGauge last_tick_events;   // events the last tick dispatched
+    LatencyHistogram dispatch_latency;  // enqueue to listener dispatch
+
+    MetricGauge pending_interactions;          // tokens still valid (InteractionTracker)
+    MetricCounter interactions_auto_deferred;  // deferred by the deadline thread
+
+    Rest rest[static_cast<size_t>(RestRoute::Count)];
+
+    MetricGauge shard_count;
+    MetricGauge heartbeat_latency_us[kMaxShards];
+    MetricGauge shard_connected[kMaxShards];  // 1 while the websocket is up
+
+    MetricGauge cached_users;      // DPP cache
+    MetricGauge cached_guilds;
+    MetricGauge cached_channels;
+    MetricGauge stored_members;    // member store
+    MetricGauge stored_users;
+    MetricGauge indexed_messages;  // message index
+    MetricGauge dm_channels;
+    MetricGauge fetched_users;     // fetch TTL caches
+    MetricGauge fetched_channels;
+    MetricGauge member_store_bytes;   // estimated heap footprint
+    MetricGauge message_index_bytes;
+
+    // A REST call was issued; record_rest() completes it
+    void rest_started(RestRoute route);
+    void record_rest(RestRoute route, int status, std::chrono::steady_clock::duration latency);
+    void record_bucket(RestRoute route, int64_t remaining, int64_t reset_after_ms);
+
+    uint64_t total_received() const;
+    uint64_t total_dispatched() const;
+    uint64_t total_dropped() const;
+
+    // Compact summary (percentiles in ms) for the Get Discord Stats node
+    nlohmann::json to_json() const;
+    // Prometheus text exposition format 0.0.4
+    std::string to_prometheus() const;
+};
+
+DiscordMetrics& discord_metrics();
+
+#endif // RUNE_DISCORD_METRICS_H
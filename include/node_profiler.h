@@ -0,0 +1,203 @@
+/**
+ * Node Profiler - Per node type and per flow execution cost of the Discord nodes
+ */
+
+#ifndef RUNE_DISCORD_NODE_PROFILER_H
+#define RUNE_DISCORD_NODE_PROFILER_H
+
+#include "discord_plugin.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Aggregate of one node type in one flow
+struct NodeProfile {
+    uint64_t calls = 0;
+    uint64_t errors = 0;        // execute returned false
+    uint64_t total_ticks = 0;   // including nodes the call ran synchronously
+    uint64_t self_ticks = 0;    // excluding them
+    uint64_t max_ticks = 0;
+    uint64_t allocs = 0;        // self; 0 unless an allocation counter is set
+};
+
+/**
+ * NodeProfiler - Wraps the execute and start_listening entries of every node
+ * the plugin registers (wrap_registry), and the listener callbacks those
+ * start_listening calls add to BotManager (wrap_listener). While enabled
+ * (profile_nodes), each call is timed with the CPU's cycle counter (rdtsc,
+ * cntvct_el0 on ARM64, steady_clock elsewhere) and, when an allocation
+ * counter is installed (RUNE_DISCORD_PROFILE_ALLOCS), its heap allocations
+ * on the calling thread are counted. Calls nest: an On Message callback that
+ * triggers Send Message is charged the send in its total but not its self
+ * cost.
+ *
+ * The SDK does not tell a node which flow it belongs to. A context handed to
+ * start_listening while a flow's on_flow_loaded is running (FlowLoad) is
+ * attributed to that flow, and so are later executions on it; every other
+ * context is reported under the "unknown" flow rather than guessed.
+ *
+ * Disabled, a wrapped call costs one relaxed load and an indirect call.
+ */
+class NodeProfiler {
+public:
+    // Heap allocations made so far by the calling thread
+    using AllocCounter = uint64_t (*)();
+
+    // Upper bound on profiled node types; later registrations pass through
+    static const size_t kMaxNodeTypes = 64;
+
+    struct Row {
+        std::string type_id;
+        std::string name;
+        std::string flow;
+        NodeProfile profile;
+    };
+
+    static NodeProfiler& instance();
+
+    void set_enabled(bool enabled);
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void set_alloc_counter(AllocCounter counter) { m_alloc_counter.store(counter, std::memory_order_relaxed); }
+    bool counts_allocs() const { return m_alloc_counter.load(std::memory_order_relaxed) != nullptr; }
+
+    // Registry to register the plugin's nodes through: forwards each to host
+    // with execute and start_listening wrapped
+    PluginNodeRegistry* wrap_registry(PluginNodeRegistry* host);
+
+    /**
+     * FlowLoad - Scope of one on_flow_loaded call; start_listening contexts
+     * seen inside it belong to flow_id
+     */
+    class FlowLoad {
+    public:
+        FlowLoad(NodeProfiler& profiler, const std::string& flow_id);
+        ~FlowLoad();
+        FlowLoad(const FlowLoad&) = delete;
+        FlowLoad& operator=(const FlowLoad&) = delete;
+
+    private:
+        NodeProfiler& m_profiler;
+        uint32_t m_previous;
+    };
+
+    void flow_unloaded(const std::string& flow_id);
+
+    // Wraps a callback added while a node's start_listening runs so its calls
+    // are charged to that node; other callbacks are returned unchanged
+    template <typename R, typename... Args>
+    std::function<R(Args...)> wrap_listener(std::function<R(Args...)> callback);
+
+    // Rows sorted by sort_by (total, self, mean, max, calls, allocs; unknown
+    // keys sort by total), descending
+    std::vector<Row> rows(const std::string& sort_by) const;
+    nlohmann::json to_json(const std::string& sort_by) const;
+    void reset();
+
+    double ns_per_tick() const;
+
+    // Used by the wrapped registry and vtable entries
+    void add_node(const NodeDesc* desc, const NodeVTable* vtable);
+    bool run_execute(size_t type, void* inst, ExecContext* ctx);
+    bool run_start_listening(size_t type, void* inst, ExecContext* ctx);
+
+private:
+    struct Key {
+        size_t type = 0;
+        uint32_t flow = 0;
+    };
+
+    // Times one call and charges it to key on destruction
+    class Scope {
+    public:
+        Scope(NodeProfiler& profiler, Key key);
+        ~Scope();
+        void failed() { m_failed = true; }
+
+    private:
+        NodeProfiler& m_profiler;
+        Key m_key;
+        bool m_failed = false;
+        uint64_t m_start_ticks = 0;
+        uint64_t m_start_allocs = 0;
+        uint64_t m_child_ticks = 0;
+        uint64_t m_child_allocs = 0;
+        Scope* m_parent = nullptr;
+    };
+
+    NodeProfiler();
+
+    static uint64_t ticks();
+    uint64_t allocs() const;
+
+    // Flow a context was attributed to, kUnknownFlow if none
+    uint32_t flow_of(ExecContext* ctx);
+    // As flow_of, first attributing ctx to the loading flow if there is one
+    uint32_t attribute_context(ExecContext* ctx);
+    void record(Key key, uint64_t total, uint64_t self, uint64_t allocs, bool failed);
+    template <typename Fn>
+    auto call_listener(Key key, Fn&& fn) -> decltype(fn());
+
+    std::atomic<bool> m_enabled{ false };
+    std::atomic<AllocCounter> m_alloc_counter{ nullptr };
+
+    PluginNodeRegistry* m_host_registry = nullptr;
+    PluginNodeRegistry m_registry{};
+    size_t m_type_count = 0;
+    NodeVTable m_original[kMaxNodeTypes]{};
+    NodeVTable m_wrapped[kMaxNodeTypes]{};
+    const NodeDesc* m_descs[kMaxNodeTypes]{};
+
+    // Cycle counter calibration, taken when profiling is enabled
+    std::chrono::steady_clock::time_point m_calibration_time;
+    uint64_t m_calibration_ticks = 0;
+
+    mutable std::mutex m_mutex;
+    static constexpr uint32_t kUnknownFlow = 0;
+    std::vector<std::string> m_flows;                      // index 0: "unknown"
+    uint32_t m_loading_flow = kUnknownFlow;                // inside a FlowLoad
+    std::unordered_map<ExecContext*, uint32_t> m_context_flows;
+    std::unordered_map<uint64_t, NodeProfile> m_profiles;  // type << 32 | flow
+};
+
+// Node whose start_listening is running on this thread (see wrap_listener)
+struct NodeProfilerListening {
+    bool active = false;
+    size_t type = 0;
+    uint32_t flow = 0;
+};
+
+NodeProfilerListening& node_profiler_listening();
+
+template <typename Fn>
+auto NodeProfiler::call_listener(Key key, Fn&& fn) -> decltype(fn()) {
+    if (!enabled()) {
+        return fn();
+    }
+    Scope scope(*this, key);
+    return fn();
+}
+
+template <typename R, typename... Args>
+std::function<R(Args...)> NodeProfiler::wrap_listener(std::function<R(Args...)> callback) {
+    const NodeProfilerListening& listening = node_profiler_listening();
+    if (!listening.active || !callback) {
+        return callback;
+    }
+    Key key;
+    key.type = listening.type;
+    key.flow = listening.flow;
+    return [this, key, callback = std::move(callback)](Args... args) {
+        return call_listener(key, [&]() { return callback(std::forward<Args>(args)...); });
+    };
+}
+
+#endif // RUNE_DISCORD_NODE_PROFILER_H
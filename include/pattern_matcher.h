@@ -0,0 +1,153 @@
+/**
+ * Pattern Matcher - Finds every matching literal and regex of a pattern set in one pass over a text
+ */
+
+#ifndef RUNE_DISCORD_PATTERN_MATCHER_H
+#define RUNE_DISCORD_PATTERN_MATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RUNE_PATTERN_MATCHER_SSE2 1
+#else
+#define RUNE_PATTERN_MATCHER_SSE2 0
+#endif
+
+/**
+ * PatternMatcher - Compiles a pattern set once and reports the id (index) of
+ * every pattern occurring in a text. A pattern written as /.../ is a regex;
+ * anything else is a literal.
+ *
+ * Literals go into one Aho-Corasick automaton and regexes into one lazily
+ * built DFA (subset construction over a Thompson NFA of all regexes, with
+ * states created as the texts need them and the cache flushed past
+ * kMaxDfaStates). Both run over byte classes, so a transition is one table
+ * lookup, and the case folding of ignore_case is part of the class tables
+ * rather than a pass over the text. The two automata advance together, so
+ * the text is read once; while both are idle and few bytes can start a
+ * match, the others are skipped (16 at a time with SSE2 when they are few
+ * enough to compare against directly).
+ *
+ * Regexes work on bytes and support literals, ., [...] classes with ranges
+ * and negation, \d \w \s (and their negations), escapes, (...) and (?:...)
+ * groups, |, * + ? {m} {m,} {m,n} and the ^ $ anchors. Lazy quantifiers are
+ * accepted and behave like greedy ones, since only whether a pattern occurs
+ * is reported.
+ *
+ * match() updates the DFA cache, so one matcher must not be used from several
+ * threads at once.
+ */
+class PatternMatcher {
+public:
+    static const size_t kMaxDfaStates = 4096;
+    static const size_t kMaxNfaStates = 100000;
+
+    // Returns false with error set (naming the pattern) if a regex is
+    // invalid, a pattern is empty, or the regexes are too large
+    bool compile(const std::vector<std::string>& patterns, bool ignore_case, std::string& error);
+
+    // Appends the ids of the patterns found in text, ascending
+    void match(const char* text, size_t length, std::vector<uint32_t>& out);
+    void match(const std::string& text, std::vector<uint32_t>& out) { match(text.data(), text.size(), out); }
+
+    size_t size() const { return m_pattern_count; }
+    size_t literal_count() const { return m_literal_count; }
+    size_t regex_count() const { return m_regex_count; }
+    // Lazy DFA states currently cached
+    size_t dfa_states() const { return m_dfa.size(); }
+
+    // A JSON array of strings, or one pattern per line (blank lines skipped)
+    static bool parse_list(const std::string& text, std::vector<std::string>& out, std::string& error);
+
+private:
+    struct NfaState {
+        enum Kind : uint8_t { Bytes, Split, Jump, Match, AssertBegin, AssertEnd };
+        Kind kind = Jump;
+        uint32_t set = 0;  // Bytes: index into m_sets
+        uint32_t out = 0;
+        uint32_t out1 = 0;  // Split only
+        uint32_t pattern = 0;  // Match only
+    };
+    struct ByteSet {
+        uint64_t bits[4] = {};
+        bool has(uint8_t b) const { return (bits[b >> 6] >> (b & 63)) & 1; }
+        void add(uint8_t b) { bits[b >> 6] |= uint64_t(1) << (b & 63); }
+    };
+    struct DfaState {
+        std::vector<uint32_t> nfa;      // sorted NFA states (Bytes, Match, AssertEnd only)
+        std::vector<uint32_t> accepts;  // patterns matched on entering the state
+        std::vector<uint32_t> end_accepts;  // patterns matched if the text ends here
+        bool end_computed = false;
+    };
+    class RegexCompiler;
+
+    // Aho-Corasick
+    bool build_literals(const std::vector<std::pair<std::string, uint32_t>>& literals, std::string& error);
+
+    // Lazy DFA
+    // States reachable from roots without consuming a byte; ^ is passed only
+    // when at_begin, $ only when at_end (otherwise kept for end_accepts)
+    void closure(const std::vector<uint32_t>& roots, bool at_begin, bool at_end, std::vector<uint32_t>& out);
+    uint32_t intern(std::vector<uint32_t>&& nfa);
+    uint32_t dfa_step(uint32_t state, uint8_t cls);
+    const std::vector<uint32_t>& end_accepts(uint32_t state);
+    // m_dfa_next entry for a transition into state
+    int32_t dfa_entry(uint32_t state) const;
+    void reset_dfa();
+
+    // First index >= i whose byte is in m_start_bytes (length if none)
+    size_t skip(const uint8_t* text, size_t i, size_t length) const;
+    void mark(const std::vector<uint32_t>& patterns);
+    void mark_literals(uint32_t state);
+
+    size_t m_pattern_count = 0;
+    size_t m_literal_count = 0;
+    size_t m_regex_count = 0;
+    bool m_ignore_case = false;
+
+    // Aho-Corasick: m_ac_next[state * m_ac_classes + class] is the target's
+    // row offset (| kOutputFlag); state 0 is the root
+    uint16_t m_ac_class[256] = {};
+    uint32_t m_ac_classes = 1;
+    std::vector<uint32_t> m_ac_next;
+    std::vector<uint32_t> m_ac_out_begin;  // state -> range of m_ac_out (size states + 1)
+    std::vector<uint32_t> m_ac_out;
+
+    // Regex NFA and its lazy DFA: m_dfa_next[state * m_re_classes + class] is
+    // the target's row offset (| kOutputFlag), -1 unknown
+    std::vector<NfaState> m_nfa;
+    std::vector<ByteSet> m_sets;
+    uint32_t m_nfa_start = 0;
+    uint8_t m_re_class[256] = {};
+    uint8_t m_re_class_byte[256] = {};  // a representative byte per class
+    uint32_t m_re_classes = 1;
+    std::vector<DfaState> m_dfa;
+    std::vector<int32_t> m_dfa_next;
+    std::map<std::vector<uint32_t>, uint32_t> m_dfa_index;
+    uint32_t m_dfa_begin = 0;  // at the start of the text (^ holds)
+    uint32_t m_dfa_idle = 0;   // elsewhere, with nothing in progress
+    std::vector<uint32_t> m_visit;  // closure() visit stamps, per NFA state
+    uint32_t m_visit_stamp = 0;
+    std::vector<uint32_t> m_stack;
+
+    // Bytes that move an idle automaton; for the SSE2 prefilter, the same set
+    // listed when it has at most kPrefilterBytes members
+    bool m_start_bytes[256] = {};
+    bool m_skip = false;
+    std::vector<uint8_t> m_prefilter;
+    static const size_t kPrefilterBytes = 6;
+    static const size_t kSkipBytes = 32;  // no skipping above this many start bytes
+    // Set on m_ac_next and m_dfa_next entries whose target reports patterns
+    static const uint32_t kOutputFlag = 0x40000000;
+
+    // Per match() call
+    std::vector<uint8_t> m_seen;
+    std::vector<uint32_t> m_found;
+};
+
+#endif // RUNE_DISCORD_PATTERN_MATCHER_H
@@ -0,0 +1,56 @@
+/**
+ * Plugin Log - Level-gated, rate-limited logging to the host
+ */
+
+#ifndef RUNE_DISCORD_PLUGIN_LOG_H
+#define RUNE_DISCORD_PLUGIN_LOG_H
+
+#include "discord_plugin.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Effective minimum level (PLUGIN_LOG_LEVEL_*) and minimum forwarded DPP
+// severity (dpp::loglevel); set from the config by discord_log_configure()
+extern std::atomic<int> g_discord_log_level;
+extern std::atomic<int> g_discord_dpp_log_severity;
+
+inline bool discord_log_enabled(int level) {
+    return g_host && level >= g_discord_log_level.load(std::memory_order_relaxed);
+}
+
+inline bool discord_dpp_log_enabled(int severity) {
+    return g_host && severity >= g_discord_dpp_log_severity.load(std::memory_order_relaxed);
+}
+
+// Applies log_level, dpp_log_min_severity and log_rate_limit
+void discord_log_configure(const DiscordPluginConfig& cfg);
+
+// Queues a line for the host. Safe from any thread (DPP callbacks included);
+// lines reach the host on the next discord_log_flush(). site identifies the
+// call site for rate limiting and must be a string literal.
+void discord_log_write(int level, const char* site, std::string message);
+
+/**
+ * Drains the queue into g_host->log. Called from the plugin's on_tick and at
+ * unload, on the host's thread. Lines beyond log_rate_limit per call site
+ * within a 10 s window are dropped and summarized once the window closes
+ * ("suppressed N similar line(s)", with the last one); lines that found the
+ * queue full are counted and reported the same way. final reports pending
+ * summaries immediately (unload).
+ */
+void discord_log_flush(bool final = false);
+
+#define DISCORD_LOG_STR2(x) #x
+#define DISCORD_LOG_STR(x) DISCORD_LOG_STR2(x)
+
+// Builds and queues message only if level is enabled, so disabled levels cost
+// one relaxed load: DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, "a " + std::to_string(n))
+#define DISCORD_LOG(level, message)                                                     \
+    do {                                                                                \
+        if (discord_log_enabled(level)) {                                               \
+            discord_log_write((level), __FILE__ ":" DISCORD_LOG_STR(__LINE__), (message)); \
+        }                                                                               \
+    } while (0)
+
+#endif // RUNE_DISCORD_PLUGIN_LOG_H
@@ -0,0 +1,440 @@
+/**
+ * Snowflake Map - Open-addressing flat hash map for 64-bit Discord IDs
+ */
+
+#ifndef RUNE_DISCORD_SNOWFLAKE_MAP_H
+#define RUNE_DISCORD_SNOWFLAKE_MAP_H
+
+#include <dpp/dpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RUNE_SNOWFLAKE_MAP_SSE2 1
+#include <emmintrin.h>
+#else
+#define RUNE_SNOWFLAKE_MAP_SSE2 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/**
+ * SnowflakeMap - Drop-in replacement for std::unordered_map<dpp::snowflake, V>
+ * for the plugin's ID-keyed indexes.
+ *
+ * Slots live in one flat array next to a byte-per-slot control array, so a
+ * lookup touches one 16-byte control group (compared 16 slots at a time with
+ * SSE2, or a scalar loop elsewhere) and then the matching slot; there is no
+ * per-node allocation and no pointer chasing. Each control byte holds 7 bits
+ * of the hash for full slots, or marks the slot empty/deleted. Capacity is a
+ * power of two and the table grows at 7/8 load.
+ *
+ * Like std::unordered_map, inserting may rehash and invalidate iterators and
+ * references; erasing only invalidates the erased element, so erase(it)
+ * inside an iteration loop is safe. Not thread-safe.
+ */
+template <typename Value, typename Key = dpp::snowflake>
+class SnowflakeMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<const Key, Value>;
+    using size_type = size_t;
+
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename SnowflakeMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<Const, const value_type*, value_type*>::type;
+        using reference = typename std::conditional<Const, const value_type&, value_type&>::type;
+        using map_pointer = typename std::conditional<Const, const SnowflakeMap*, SnowflakeMap*>::type;
+
+        basic_iterator() = default;
+        basic_iterator(map_pointer map, size_t index) : m_map(map), m_index(index) {}
+        // iterator -> const_iterator
+        template <bool C = Const, typename = typename std::enable_if<C>::type>
+        basic_iterator(const basic_iterator<false>& other) : m_map(other.m_map), m_index(other.m_index) {}
+
+        reference operator*() const { return m_map->m_slots[m_index]; }
+        pointer operator->() const { return &m_map->m_slots[m_index]; }
+
+        basic_iterator& operator++() {
+            m_index = m_map->next_full(m_index + 1);
+            return *this;
+        }
+        basic_iterator operator++(int) {
+            basic_iterator prev = *this;
+            ++*this;
+            return prev;
+        }
+
+        bool operator==(const basic_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const basic_iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        friend class SnowflakeMap;
+        template <bool> friend class basic_iterator;
+
+        map_pointer m_map = nullptr;
+        size_t m_index = 0;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    SnowflakeMap() = default;
+    explicit SnowflakeMap(size_t expected) { reserve(expected); }
+
+    ~SnowflakeMap() {
+        destroy_slots();
+        deallocate();
+    }
+
+    SnowflakeMap(const SnowflakeMap&) = delete;
+    SnowflakeMap& operator=(const SnowflakeMap&) = delete;
+
+    SnowflakeMap(SnowflakeMap&& other) noexcept { swap(other); }
+    SnowflakeMap& operator=(SnowflakeMap&& other) noexcept {
+        if (this != &other) {
+            destroy_slots();
+            deallocate();
+            swap(other);
+        }
+        return *this;
+    }
+
+    void swap(SnowflakeMap& other) noexcept {
+        std::swap(m_ctrl, other.m_ctrl);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_growth_left, other.m_growth_left);
+    }
+
+    iterator begin() { return iterator(this, next_full(0)); }
+    iterator end() { return iterator(this, m_capacity); }
+    const_iterator begin() const { return const_iterator(this, next_full(0)); }
+    const_iterator end() const { return const_iterator(this, m_capacity); }
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+
+    // Bytes owned by the table (control bytes plus slots), excluding any heap
+    // memory owned by the values themselves
+    size_t memory_bytes() const { return m_capacity == 0 ? 0 : allocation_size(m_capacity); }
+
+    iterator find(const Key& key) {
+        const size_t index = find_index(key);
+        return iterator(this, index == kNotFound ? m_capacity : index);
+    }
+
+    const_iterator find(const Key& key) const {
+        const size_t index = find_index(key);
+        return const_iterator(this, index == kNotFound ? m_capacity : index);
+    }
+
+    bool contains(const Key& key) const { return find_index(key) != kNotFound; }
+    size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        const uint64_t hash = hash_key(key);
+        size_t index = find_index(key, hash);
+        if (index != kNotFound) {
+            return { iterator(this, index), false };
+        }
+
+        if (m_growth_left == 0) {
+            rehash_for_insert();
+        }
+        index = find_insert_slot(hash);
+        new (&m_slots[index]) value_type(std::piecewise_construct,
+                                         std::forward_as_tuple(key),
+                                         std::forward_as_tuple(std::forward<Args>(args)...));
+        if (m_ctrl[index] == kEmpty) {
+            --m_growth_left;
+        }
+        m_ctrl[index] = h2(hash);
+        ++m_size;
+        return { iterator(this, index), true };
+    }
+
+    template <typename V>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value) {
+        auto result = try_emplace(key, std::forward<V>(value));
+        if (!result.second) {
+            result.first->second = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    Value& operator[](const Key& key) { return try_emplace(key).first->second; }
+
+    // Returns the iterator following the erased element
+    iterator erase(iterator it) {
+        erase_index(it.m_index);
+        return iterator(this, next_full(it.m_index + 1));
+    }
+
+    iterator erase(const_iterator it) {
+        erase_index(it.m_index);
+        return iterator(this, next_full(it.m_index + 1));
+    }
+
+    size_t erase(const Key& key) {
+        const size_t index = find_index(key);
+        if (index == kNotFound) {
+            return 0;
+        }
+        erase_index(index);
+        return 1;
+    }
+
+    // Destroys all elements but keeps the allocated table
+    void clear() {
+        if (m_capacity == 0) {
+            return;
+        }
+        destroy_slots();
+        std::memset(m_ctrl, static_cast<unsigned char>(kEmpty), m_capacity);
+        m_size = 0;
+        m_growth_left = max_load(m_capacity);
+    }
+
+    void reserve(size_t count) {
+        const size_t wanted = capacity_for(count);
+        if (wanted > m_capacity) {
+            resize(wanted);
+        }
+    }
+
+private:
+    static constexpr size_t kGroupWidth = 16;
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+    static constexpr int8_t kEmpty = -128;   // 0x80
+    static constexpr int8_t kDeleted = -2;   // 0xFE; full slots are 0..127
+
+    // Snowflakes put a millisecond timestamp in the high bits and small
+    // worker/sequence counters in the low bits, so the raw value clusters
+    // badly. A murmur-style finalizer spreads both halves over all 64 bits.
+    static uint64_t hash_key(const Key& key) {
+        uint64_t x = static_cast<uint64_t>(key);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    static int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+    static size_t h1(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+
+    static size_t max_load(size_t capacity) { return capacity - capacity / 8; }
+
+    static size_t capacity_for(size_t count) {
+        size_t capacity = kGroupWidth;
+        while (max_load(capacity) < count) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    static unsigned lowest_bit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    // Bit i of the result is set when control byte i of the group equals b
+    static uint32_t match_byte(const int8_t* group, int8_t b) {
+#if RUNE_SNOWFLAKE_MAP_SSE2
+        const __m128i ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(b))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            mask |= static_cast<uint32_t>(group[i] == b) << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Empty and deleted both have the sign bit set; full slots do not
+    static uint32_t match_empty_or_deleted(const int8_t* group) {
+#if RUNE_SNOWFLAKE_MAP_SSE2
+        const __m128i ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            mask |= static_cast<uint32_t>(group[i] < 0) << i;
+        }
+        return mask;
+#endif
+    }
+
+    size_t find_index(const Key& key) const { return find_index(key, hash_key(key)); }
+
+    // Groups are probed in triangular order, which visits every group once
+    // for a power-of-two group count. A group with an empty slot ends the
+    // probe: the key would have been placed there.
+    size_t find_index(const Key& key, uint64_t hash) const {
+        if (m_size == 0) {
+            return kNotFound;
+        }
+        const size_t groupMask = m_capacity / kGroupWidth - 1;
+        const int8_t tag = h2(hash);
+        size_t group = h1(hash) & groupMask;
+        for (size_t probe = 1; probe <= groupMask + 1; ++probe) {
+            const int8_t* ctrl = m_ctrl + group * kGroupWidth;
+            for (uint32_t mask = match_byte(ctrl, tag); mask != 0; mask &= mask - 1) {
+                const size_t index = group * kGroupWidth + lowest_bit(mask);
+                if (m_slots[index].first == key) {
+                    return index;
+                }
+            }
+            if (match_byte(ctrl, kEmpty) != 0) {
+                return kNotFound;
+            }
+            group = (group + probe) & groupMask;
+        }
+        return kNotFound;
+    }
+
+    // First empty or deleted slot on the key's probe sequence. The caller
+    // guarantees one exists (growth_left > 0).
+    size_t find_insert_slot(uint64_t hash) const {
+        const size_t groupMask = m_capacity / kGroupWidth - 1;
+        size_t group = h1(hash) & groupMask;
+        for (size_t probe = 1;; ++probe) {
+            const uint32_t mask = match_empty_or_deleted(m_ctrl + group * kGroupWidth);
+            if (mask != 0) {
+                return group * kGroupWidth + lowest_bit(mask);
+            }
+            group = (group + probe) & groupMask;
+        }
+    }
+
+    // A slot can go straight back to empty only if its group still has an
+    // empty slot: such a group has never been full, so no probe sequence
+    // has passed through it. Otherwise it becomes a tombstone.
+    void erase_index(size_t index) {
+        m_slots[index].~value_type();
+        const int8_t* group = m_ctrl + (index & ~(kGroupWidth - 1));
+        if (match_byte(group, kEmpty) != 0) {
+            m_ctrl[index] = kEmpty;
+            ++m_growth_left;
+        } else {
+            m_ctrl[index] = kDeleted;
+        }
+        --m_size;
+    }
+
+    size_t next_full(size_t index) const {
+        while (index < m_capacity && m_ctrl[index] < 0) {
+            ++index;
+        }
+        return index;
+    }
+
+    // Out of fresh slots: grow if the table is genuinely full, otherwise
+    // the space went to tombstones and rebuilding at the same size reclaims it
+    void rehash_for_insert() {
+        if (m_capacity == 0) {
+            resize(kGroupWidth);
+        } else if (m_size <= max_load(m_capacity) * 7 / 8) {
+            resize(m_capacity);
+        } else {
+            resize(m_capacity * 2);
+        }
+    }
+
+    static size_t slots_offset(size_t capacity) {
+        const size_t align = alignof(value_type);
+        return (capacity + align - 1) / align * align;
+    }
+
+    static size_t allocation_size(size_t capacity) {
+        return slots_offset(capacity) + capacity * sizeof(value_type);
+    }
+
+    static constexpr size_t allocation_align() {
+        return alignof(value_type) > kGroupWidth ? alignof(value_type) : kGroupWidth;
+    }
+
+    void resize(size_t capacity) {
+        int8_t* oldCtrl = m_ctrl;
+        value_type* oldSlots = m_slots;
+        const size_t oldCapacity = m_capacity;
+
+        void* block = ::operator new(allocation_size(capacity), std::align_val_t(allocation_align()));
+        m_ctrl = static_cast<int8_t*>(block);
+        m_slots = reinterpret_cast<value_type*>(static_cast<char*>(block) + slots_offset(capacity));
+        m_capacity = capacity;
+        std::memset(m_ctrl, static_cast<unsigned char>(kEmpty), capacity);
+        m_growth_left = max_load(capacity) - m_size;
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (oldCtrl[i] < 0) {
+                continue;
+            }
+            const uint64_t hash = hash_key(oldSlots[i].first);
+            const size_t index = find_insert_slot(hash);
+            new (&m_slots[index]) value_type(std::piecewise_construct,
+                                             std::forward_as_tuple(oldSlots[i].first),
+                                             std::forward_as_tuple(std::move(oldSlots[i].second)));
+            m_ctrl[index] = h2(hash);
+            oldSlots[i].~value_type();
+        }
+
+        if (oldCtrl) {
+            ::operator delete(oldCtrl, std::align_val_t(allocation_align()));
+        }
+    }
+
+    void destroy_slots() {
+        if (std::is_trivially_destructible<value_type>::value) {
+            return;
+        }
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_ctrl[i] >= 0) {
+                m_slots[i].~value_type();
+            }
+        }
+    }
+
+    void deallocate() {
+        if (m_ctrl) {
+            ::operator delete(m_ctrl, std::align_val_t(allocation_align()));
+        }
+        m_ctrl = nullptr;
+        m_slots = nullptr;
+        m_capacity = 0;
+        m_size = 0;
+        m_growth_left = 0;
+    }
+
+    int8_t* m_ctrl = nullptr;       // m_capacity control bytes, 16-byte aligned
+    value_type* m_slots = nullptr;  // same allocation, after the control bytes
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+    size_t m_growth_left = 0;       // empty slots usable before a rehash
+};
+
+#endif // RUNE_DISCORD_SNOWFLAKE_MAP_H
@@ -0,0 +1,14 @@
+/**
+ * Atomic File - Implementation
+ */
+
+#include "atomic_file.h"
+#include <cstdio>
+
+bool atomic_replace_file(const std::string& tmp_path, const std::string& path) {
+    if (std::rename(tmp_path.c_str(), path.c_str()) == 0) {
+        return true;
+    }
+    std::remove(path.c_str());
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
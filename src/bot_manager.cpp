@@ -4,8 +4,97 @@
 
 #include "bot_manager.h"
 #include "discord_plugin.h"
+#include "plugin_log.h"
+#include "atomic_file.h"
+#include "node_profiler.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <thread>
 #include <exception>
+#include <shared_mutex>
+
+using json = nlohmann::json;
+
+// Name given to webhooks the plugin creates for the webhook fast path
+static const char* kWebhookName = "RUNE";
+
+// Event journal record kinds (raw gateway dispatch payloads)
+static const uint16_t kJournalMessage = 1;
+static const uint16_t kJournalReaction = 2;
+
+// Trace span category of an event (one track per traced event)
+static const char* trace_category(DiscordEventType type) {
+    switch (type) {
+        case DiscordEventType::Ready: return "ready";
+        case DiscordEventType::Message: return "message";
+        case DiscordEventType::ReactionAdd: return "reaction_add";
+        case DiscordEventType::SlashCommand: return "slash_command";
+        case DiscordEventType::Component: return "component";
+    }
+    return "event";
+}
+
+// Plugin log level of a forwarded DPP message
+static int dpp_log_level(dpp::loglevel severity) {
+    switch (severity) {
+        case dpp::ll_trace:
+        case dpp::ll_debug: return PLUGIN_LOG_LEVEL_DEBUG;
+        case dpp::ll_info: return PLUGIN_LOG_LEVEL_INFO;
+        case dpp::ll_warning: return PLUGIN_LOG_LEVEL_WARN;
+        default: return PLUGIN_LOG_LEVEL_ERROR;
+    }
+}
+
+// Rate-limit site of a forwarded DPP message, one per severity
+static const char* dpp_log_site(dpp::loglevel severity) {
+    switch (severity) {
+        case dpp::ll_trace: return "dpp:trace";
+        case dpp::ll_debug: return "dpp:debug";
+        case dpp::ll_info: return "dpp:info";
+        case dpp::ll_warning: return "dpp:warning";
+        case dpp::ll_error: return "dpp:error";
+        default: return "dpp:critical";
+    }
+}
+
+// Value of a response header; names compare case-insensitively (DPP
+// lower-cases them, Discord does not)
+static const std::string* find_header(const TransportResponse& response, const char* name) {
+    const size_t length = std::strlen(name);
+    for (const auto& header : response.headers) {
+        if (header.first.size() == length &&
+            std::equal(header.first.begin(), header.first.end(), name, [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == b;
+            })) {
+            return &header.second;
+        }
+    }
+    return nullptr;
+}
+
+// Bucket state Discord reports on every REST response
+static void record_rate_limit_headers(RestRoute route, const TransportResponse& response) {
+    const std::string* remaining = find_header(response, "x-ratelimit-remaining");
+    if (!remaining) {
+        return;
+    }
+    const std::string* resetAfter = find_header(response, "x-ratelimit-reset-after");
+    const double resetSeconds = resetAfter ? std::atof(resetAfter->c_str()) : 0.0;
+    discord_metrics().record_bucket(route, std::atoll(remaining->c_str()),
+                                    static_cast<int64_t>(resetSeconds * 1000.0));
+}
+
+static bool rest_ok(const TransportResponse& response) {
+    return response.status >= 200 && response.status < 300;
+}
+
+constexpr std::chrono::seconds BotManager::kCommandSyncDelay;
+constexpr std::chrono::minutes BotManager::kWebhookRetryDelay;
 
 BotManager& BotManager::instance() {
     static BotManager instance;
@@ -25,6 +114,14 @@ bool BotManager::initialize(const std::string& token) {
         return false;
     }
 
+    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+    if (m_installed_transport) {
+        return start_transport_session();
+    }
+    if (!cfg.gateway_replay_path.empty()) {
+        return start_gateway_replay();
+    }
+
     if (token.empty()) {
         if (g_host) {
             g_host->log(PLUGIN_LOG_LEVEL_ERROR,
@@ -33,8 +130,6 @@ bool BotManager::initialize(const std::string& token) {
         return false;
     }
 
-    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
-
     auto any_flags_set = [](const DiscordPluginConfig& c) -> bool {
         return c.intent_guilds ||
                c.intent_guild_members ||
@@ -117,23 +212,65 @@ bool BotManager::initialize(const std::string& token) {
     m_token = token;
     // DPP cluster constructor expects intents in its own numeric type; perform an
     // explicit cast here to avoid implicit narrowing warnings inside std::make_unique.
-    m_bot = std::make_unique<dpp::cluster>(token, static_cast<decltype(dpp::i_default_intents)>(intents));
+    // With the member store on, users and members live in its compact columns
+    // rather than as one DPP object each
+    dpp::cache_policy_t cachePolicy;
+    if (cfg.member_store_enabled) {
+        cachePolicy.user_policy = dpp::cp_none;
+    }
+    m_bot = std::make_unique<dpp::cluster>(token, static_cast<decltype(dpp::i_default_intents)>(intents),
+                                           0, 0, 1, true, cachePolicy);
+    m_dpp_transport = std::make_unique<DppTransport>(*m_bot);
 
-    // Forward DPP logs into the unified plugin log (at DEBUG level) if enabled
+    // Forward DPP logs at or above dpp_log_min_severity into the plugin log if
+    // enabled; the severity check comes before any string is built
     if (g_host && m_bot && cfg.enable_dpp_logging) {
         m_bot->on_log([](const dpp::log_t& event) {
-            if (!g_host) {
+            if (!discord_dpp_log_enabled(event.severity)) {
                 return;
             }
-            std::string msg = "DPP[" + std::to_string(static_cast<int>(event.severity)) + "]: " + event.message;
-            g_host->log(PLUGIN_LOG_LEVEL_DEBUG, msg.c_str());
+            discord_log_write(dpp_log_level(event.severity), dpp_log_site(event.severity),
+                              "DPP[" + std::to_string(static_cast<int>(event.severity)) + "]: " + event.message);
         });
     }
 
+    configure_stores();
+    load_command_state();
+    if (!cfg.dm_cache_path.empty() && m_dm_channels.load(cfg.dm_cache_path)) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, "Discord plugin: loaded " + std::to_string(m_dm_channels.size()) +
+            " DM channel(s) from '" + cfg.dm_cache_path + "'");
+    }
+    load_snapshot(token);
+    if (!cfg.journal_dir.empty()) {
+        std::string error;
+        if (m_journal.open(cfg.journal_dir, size_t(cfg.journal_segment_mb) << 20, cfg.journal_max_segments, error)) {
+            if (cfg.journal_recover) {
+                recover_journal();
+            }
+        } else if (g_host) {
+            std::string msg = "Discord plugin: event journal disabled, cannot open '" + cfg.journal_dir + "': " + error;
+            g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
+        }
+    }
+    if (!cfg.gateway_record_path.empty()) {
+        std::string error;
+        if (m_recorder.open(cfg.gateway_record_path, error)) {
+            if (g_host) {
+                std::string msg = "Discord plugin: recording gateway dispatches to '" + cfg.gateway_record_path + "'";
+                g_host->log(PLUGIN_LOG_LEVEL_INFO, msg.c_str());
+            }
+        } else if (g_host) {
+            std::string msg = "Discord plugin: gateway recording disabled, cannot open '" +
+                cfg.gateway_record_path + "': " + error;
+            g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
+        }
+    }
+
     setup_event_handlers();
 
     // Start bot in background thread
     m_bot->start(dpp::st_return);
+    m_transport = m_dpp_transport.get();
     m_running = true;
 
     if (g_host) {
@@ -145,19 +282,80 @@ bool BotManager::initialize(const std::string& token) {
 }
 
 void BotManager::shutdown() {
-    if (!m_running || !m_bot) {
+    if (!m_running) {
         return;
     }
 
     m_running = false;
     m_readyFired = false;
+    // Stops the deadline thread before the transport it sends through goes away
+    m_interactions.clear();
+    m_transport = nullptr;
+    // DPP's caches are still populated until the cluster goes away. Offline
+    // sessions never loaded the persisted caches, so they leave them untouched.
+    const bool persist = m_bot != nullptr;
+    if (persist) {
+        save_snapshot();
+    }
+    m_dpp_transport.reset();
     m_bot.reset();
+    m_recorder.close();
+    m_playback.close();
+    m_replaying = false;
 
-    // Clear event queue
+    // Clear event queue. Journaled events stay past the checkpoint and are
+    // recovered on the next initialize().
     {
         std::lock_guard<std::mutex> lock(m_event_mutex);
+        DiscordMetrics& metrics = discord_metrics();
+        for (std::queue<QueuedEvent> pending = m_event_queue; !pending.empty(); pending.pop()) {
+            metrics.events_dropped[static_cast<size_t>(pending.front().type)].add();
+        }
+        for (std::queue<QueuedEvent> pending = m_interaction_queue; !pending.empty(); pending.pop()) {
+            metrics.events_dropped[static_cast<size_t>(pending.front().type)].add();
+        }
         std::queue<QueuedEvent> empty;
         std::swap(m_event_queue, empty);
+        std::queue<QueuedEvent> emptyInteractions;
+        std::swap(m_interaction_queue, emptyInteractions);
+        metrics.queue_depth.set(0);
+    }
+    m_journal.close();
+    if (!GetDiscordPluginConfig().metrics_file_path.empty()) {
+        sample_metrics();
+        write_metrics_file();
+    }
+
+    const std::string& dmCachePath = GetDiscordPluginConfig().dm_cache_path;
+    if (persist && !dmCachePath.empty() && !m_dm_channels.save(dmCachePath) && g_host) {
+        std::string msg = "Discord plugin: failed to save DM channel cache to '" + dmCachePath + "'";
+        g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
+    }
+    m_dm_channels.clear();
+    m_user_cache.clear();
+    m_channel_cache.clear();
+    m_id_resolver.clear();
+    m_member_store.clear();
+    m_snapshot.close();
+    m_message_index.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_main_task_mutex);
+        m_main_tasks.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_presence_mutex);
+        m_presence_pending = false;
+        m_pending_presence_payload.clear();
+        m_last_presence_payload.clear();
+    }
+
+    // Webhooks are re-resolved on the next connection (the token may differ)
+    {
+        std::lock_guard<std::mutex> lock(m_webhook_mutex);
+        m_channel_webhooks.clear();
+        m_pending_webhook_messages.clear();
+        m_webhook_retry_at.clear();
     }
 }
 
@@ -165,163 +363,329 @@ bool BotManager::is_running() const {
     return m_running;
 }
 
-void BotManager::setup_event_handlers() {
-    if (!m_bot) return;
+void BotManager::configure_stores() {
+    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+    m_user_cache.set_capacity(cfg.entity_cache_capacity);
+    m_channel_cache.set_capacity(cfg.entity_cache_capacity);
+    m_dm_channels.set_capacity(cfg.dm_cache_capacity);
+    m_message_index.configure(cfg.message_index_max_messages, size_t(cfg.message_index_max_mb) << 20,
+                              std::chrono::seconds(cfg.message_index_window_s),
+                              cfg.message_index_eviction == "reject" ? MessageIndex::Eviction::Reject
+                                                                     : MessageIndex::Eviction::Oldest);
+    m_tracer.configure(cfg.trace_sample_rate, cfg.trace_buffer_spans);
+}
 
-    m_bot->on_ready([this](const dpp::ready_t& event) {
-        (void)event;
-        if (g_host) {
-            g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
-                "Discord plugin: DPP on_ready received; queuing Ready event");
-        }
-        QueuedEvent qe;
-        qe.type = DiscordEventType::Ready;
-        {
-            std::lock_guard<std::mutex> lock(m_event_mutex);
-            m_event_queue.push(qe);
-        }
+void BotManager::index_message(const MessageEventData& message, int64_t sent) {
+    if (!GetDiscordPluginConfig().message_index_enabled) {
+        return;
+    }
+    IndexedMessage indexed;
+    indexed.id = message.message_id;
+    indexed.author_id = message.author_id;
+    indexed.channel_id = message.channel_id;
+    indexed.guild_id = message.guild_id;
+    indexed.timestamp = sent;
+    indexed.content = message.content;
+    m_message_index.add(indexed);
+}
 
-        // Once all shards are ready, set a default presence so the bot appears online.
-        // Users can override this at any time using the Set Presence node.
-        set_presence(dpp::presence(dpp::ps_online, dpp::at_game, "online"));
-    });
+// The "d" object of a raw gateway dispatch, or null if it cannot be parsed
+static json dispatch_payload(const std::string& raw_event) {
+    json raw = json::parse(raw_event, nullptr, false);
+    if (raw.is_discarded() || !raw.is_object()) {
+        return json();
+    }
+    auto d = raw.find("d");
+    return d == raw.end() ? json() : std::move(*d);
+}
 
-    m_bot->on_message_create([this](const dpp::message_create_t& event) {
-        // Ignore bot messages
-        if (event.msg.author.is_bot()) return;
+static dpp::snowflake json_snowflake(const json& obj, const char* key) {
+    auto it = obj.find(key);
+    if (it == obj.end() || !it->is_string()) {
+        return dpp::snowflake();
+    }
+    return std::strtoull(it->get_ref<const std::string&>().c_str(), nullptr, 10);
+}
 
-        if (g_host) {
-            g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
-                "Discord plugin: DPP on_message_create received; queuing Message event");
-        }
+static std::string json_string(const json& obj, const char* key) {
+    auto it = obj.find(key);
+    return it != obj.end() && it->is_string() ? it->get<std::string>() : std::string();
+}
 
-        QueuedEvent qe;
-        qe.type = DiscordEventType::Message;
-        qe.message_data.author_id = event.msg.author.id;
-        qe.message_data.author_name = event.msg.author.username;
-        qe.message_data.content = event.msg.content;
-        qe.message_data.channel_id = event.msg.channel_id;
-        qe.message_data.guild_id = event.msg.guild_id;
-        qe.message_data.message_id = event.msg.id;
-        {
-            std::lock_guard<std::mutex> lock(m_event_mutex);
-            m_event_queue.push(qe);
+// The bot's own user in a READY payload
+static dpp::snowflake ready_user_id(const json& d) {
+    auto user = d.is_object() ? d.find("user") : d.end();
+    return d.is_object() && user != d.end() && user->is_object() ? json_snowflake(*user, "id") : dpp::snowflake();
+}
+
+// Application of a READY payload; a bot's application id is its user id when
+// the partial application object is missing
+static dpp::snowflake ready_application_id(const json& d) {
+    if (!d.is_object()) {
+        return dpp::snowflake();
+    }
+    auto application = d.find("application");
+    if (application != d.end() && application->is_object()) {
+        const dpp::snowflake id = json_snowflake(*application, "id");
+        if (!id.empty()) {
+            return id;
         }
-    });
+    }
+    return ready_user_id(d);
+}
 
+// Every dispatch goes through handle_dispatch(), the same function gateway
+// replay and in-process transports feed, so a recorded or scripted session
+// sees exactly what live handling would have done. DPP still parses each
+// event into its own cache before the handler runs.
+void BotManager::setup_event_handlers() {
+    if (!m_bot) return;
+
+    m_bot->on_ready([this](const dpp::ready_t& event) {
+        handle_dispatch(event.raw_event, event.shard_id);
+    });
+    m_bot->on_message_create([this](const dpp::message_create_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_message_delete([this](const dpp::message_delete_t& event) {
+        handle_dispatch(event.raw_event);
+    });
     m_bot->on_message_reaction_add([this](const dpp::message_reaction_add_t& event) {
-        (void)event;
-        if (g_host) {
-            g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
-                "Discord plugin: DPP on_message_reaction_add received; queuing ReactionAdd event");
-        }
-        QueuedEvent qe;
-        qe.type = DiscordEventType::ReactionAdd;
-        qe.reaction_data.user_id = event.reacting_user.id;
-        qe.reaction_data.emoji = event.reacting_emoji.name;
-        qe.reaction_data.message_id = event.message_id;
-        qe.reaction_data.channel_id = event.channel_id;
-        qe.reaction_data.guild_id = event.reacting_guild.id;
-        {
-            std::lock_guard<std::mutex> lock(m_event_mutex);
-            m_event_queue.push(qe);
-        }
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_guild_create([this](const dpp::guild_create_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_guild_delete([this](const dpp::guild_delete_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_guild_members_chunk([this](const dpp::guild_members_chunk_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_guild_member_add([this](const dpp::guild_member_add_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_guild_member_update([this](const dpp::guild_member_update_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_guild_member_remove([this](const dpp::guild_member_remove_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_channel_delete([this](const dpp::channel_delete_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_guild_role_delete([this](const dpp::guild_role_delete_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    // DPP splits INTERACTION_CREATE by kind; handle_dispatch() splits it again
+    m_bot->on_slashcommand([this](const dpp::slashcommand_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_button_click([this](const dpp::button_click_t& event) {
+        handle_dispatch(event.raw_event);
+    });
+    m_bot->on_select_click([this](const dpp::select_click_t& event) {
+        handle_dispatch(event.raw_event);
     });
 }
 
 void BotManager::tick() {
+    flush_presence();
+
+    const auto now = std::chrono::steady_clock::now();
+    if (m_running && now - m_last_metrics_sample >= std::chrono::seconds(1)) {
+        m_last_metrics_sample = now;
+        sample_metrics();
+        const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+        if (!cfg.metrics_file_path.empty() &&
+            now - m_last_metrics_write >= std::chrono::milliseconds(cfg.metrics_interval_ms)) {
+            m_last_metrics_write = now;
+            write_metrics_file();
+        }
+    }
+
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_main_task_mutex);
+        tasks.swap(m_main_tasks);
+    }
+    for (auto& task : tasks) {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: exception in main-thread task: ") + e.what());
+        } catch (...) {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
+                "Discord plugin: unknown exception in main-thread task");
+        }
+    }
+    m_id_resolver.tick();
+    sync_commands(now);
+    m_components.advance(now);
+
+    if (m_replaying) {
+        pump_gateway_replay();
+    } else if (m_transport) {
+        m_transport->poll([this](const std::string& raw_event) {
+            handle_dispatch(raw_event);
+        });
+    }
+
     // Process queued events on main thread
+    std::queue<QueuedEvent> interactions_to_process;
     std::queue<QueuedEvent> events_to_process;
     {
         std::lock_guard<std::mutex> lock(m_event_mutex);
+        std::swap(interactions_to_process, m_interaction_queue);
         std::swap(events_to_process, m_event_queue);
     }
 
-    const auto eventCount = events_to_process.size();
-    if (g_host && eventCount > 0) {
-        std::string msg = "Discord plugin: BotManager::tick processing " +
-            std::to_string(eventCount) + " event(s)";
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG, msg.c_str());
+    const auto eventCount = interactions_to_process.size() + events_to_process.size();
+    const auto batchStart = std::chrono::steady_clock::now();
+    DiscordMetrics& metrics = discord_metrics();
+    metrics.queue_depth.set(0);
+    metrics.last_tick_events.set(static_cast<int64_t>(eventCount));
+    if (eventCount > 0) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: BotManager::tick processing " + std::to_string(eventCount) + " event(s)");
     }
 
     std::vector<ReadyCallback> ready_cbs;
     std::vector<MessageCallback> message_cbs;
     std::vector<ReactionCallback> reaction_cbs;
+    std::vector<SlashCommandCallback> slash_command_cbs;
     {
         std::lock_guard<std::mutex> lock(m_listener_mutex);
         ready_cbs = m_ready_listeners;
         message_cbs = m_message_listeners;
         reaction_cbs = m_reaction_listeners;
+        slash_command_cbs = m_slash_command_listeners;
     }
 
-    while (!events_to_process.empty()) {
-        const auto& event = events_to_process.front();
+    uint64_t lastJournalSeq = 0;
+    // Interactions first: Discord only waits so long for their response
+    for (std::queue<QueuedEvent>* lane : { &interactions_to_process, &events_to_process }) {
+        while (!lane->empty()) {
+            auto& event = lane->front();
+            lastJournalSeq = std::max(lastJournalSeq, event.journal_seq);
 
-        switch (event.type) {
-            case DiscordEventType::Ready:
-                for (auto& cb : ready_cbs) {
-                    try {
-                        cb();
-                    } catch (const std::exception& e) {
-                        if (g_host) {
-                            std::string msg = "Discord plugin: exception in Ready listener: ";
-                            msg += e.what();
-                            g_host->log(PLUGIN_LOG_LEVEL_ERROR, msg.c_str());
-                        }
-                    } catch (...) {
-                        if (g_host) {
-                            g_host->log(PLUGIN_LOG_LEVEL_ERROR,
+            const size_t typeIndex = static_cast<size_t>(event.type);
+            const auto dispatchStart = std::chrono::steady_clock::now();
+            metrics.dispatch_latency.record(dispatchStart - event.queued_at);
+            metrics.events_dispatched[typeIndex].add();
+
+            const uint64_t traceId = event.trace_id;
+            const char* traceCategory = trace_category(event.type);
+            if (traceId != 0) {
+                m_tracer.record(traceId, "queue", traceCategory, m_tracer.to_us(event.queued_at),
+                                m_tracer.to_us(batchStart));
+                m_tracer.record(traceId, "dispatch_wait", traceCategory, m_tracer.to_us(batchStart),
+                                m_tracer.to_us(dispatchStart));
+            }
+            // REST calls made by the flow this event starts are attributed to
+            // it, and nothing after its dispatch is
+            EventTracer::Scope traceScope(m_tracer, traceId, traceCategory,
+                                          traceId != 0 ? m_tracer.to_us(dispatchStart) : 0);
+            // Same for dispatching_event(): set only while its listeners run
+            m_dispatching_event = &event;
+
+            switch (event.type) {
+                case DiscordEventType::Ready:
+                    for (auto& cb : ready_cbs) {
+                        try {
+                            cb();
+                        } catch (const std::exception& e) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: exception in Ready listener: ") + e.what());
+                        } catch (...) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
                                 "Discord plugin: unknown exception in Ready listener");
                         }
                     }
-                }
-                m_readyFired = true;
-                break;
+                    m_readyFired = true;
+                    break;
 
-            case DiscordEventType::Message:
-                for (auto& cb : message_cbs) {
-                    try {
-                        cb(event.message_data);
-                    } catch (const std::exception& e) {
-                        if (g_host) {
-                            std::string msg = "Discord plugin: exception in Message listener: ";
-                            msg += e.what();
-                            g_host->log(PLUGIN_LOG_LEVEL_ERROR, msg.c_str());
-                        }
-                    } catch (...) {
-                        if (g_host) {
-                            g_host->log(PLUGIN_LOG_LEVEL_ERROR,
+                case DiscordEventType::Message:
+                    if (message_cbs.empty()) {
+                        metrics.events_dropped[typeIndex].add();
+                    }
+                    for (auto& cb : message_cbs) {
+                        try {
+                            cb(event.message_data);
+                        } catch (const std::exception& e) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: exception in Message listener: ") + e.what());
+                        } catch (...) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
                                 "Discord plugin: unknown exception in Message listener");
                         }
                     }
+                    break;
+
+                case DiscordEventType::ReactionAdd:
+                    if (reaction_cbs.empty()) {
+                        metrics.events_dropped[typeIndex].add();
+                    }
+                    for (auto& cb : reaction_cbs) {
+                        try {
+                            cb(event.reaction_data);
+                        } catch (const std::exception& e) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: exception in Reaction listener: ") + e.what());
+                        } catch (...) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
+                                "Discord plugin: unknown exception in Reaction listener");
+                        }
+                    }
+                    break;
+
+                case DiscordEventType::SlashCommand: {
+                    bool taken = false;
+                    for (auto& cb : slash_command_cbs) {
+                        try {
+                            taken = cb(event.interaction_data) || taken;
+                        } catch (const std::exception& e) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: exception in SlashCommand listener: ") + e.what());
+                        } catch (...) {
+                            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
+                                "Discord plugin: unknown exception in SlashCommand listener");
+                        }
+                    }
+                    if (!taken) {
+                        metrics.events_dropped[typeIndex].add();
+                        m_interactions.release(event.interaction_data.interaction_id,
+                            dpp::message("This command is not available right now."));
+                    }
+                    break;
                 }
-                break;
 
-            case DiscordEventType::ReactionAdd:
-                for (auto& cb : reaction_cbs) {
+                case DiscordEventType::Component:
                     try {
-                        cb(event.reaction_data);
-                    } catch (const std::exception& e) {
-                        if (g_host) {
-                            std::string msg = "Discord plugin: exception in Reaction listener: ";
-                            msg += e.what();
-                            g_host->log(PLUGIN_LOG_LEVEL_ERROR, msg.c_str());
+                        if (m_components.route(event.component_data) != ComponentRouter::Result::Routed) {
+                            metrics.events_dropped[typeIndex].add();
+                            m_interactions.release(event.component_data.interaction_id, dpp::message());
                         }
+                    } catch (const std::exception& e) {
+                        DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: exception in Component listener: ") + e.what());
                     } catch (...) {
-                        if (g_host) {
-                            g_host->log(PLUGIN_LOG_LEVEL_ERROR,
-                                "Discord plugin: unknown exception in Reaction listener");
-                        }
+                        DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
+                            "Discord plugin: unknown exception in Component listener");
                     }
-                }
-                break;
+                    break;
+            }
+            m_dispatching_event = nullptr;
+
+            if (traceId != 0) {
+                m_tracer.record(traceId, "listeners", traceCategory, m_tracer.to_us(dispatchStart), m_tracer.now_us());
+            }
+            lane->pop();
         }
+    }
 
-        events_to_process.pop();
+    if (lastJournalSeq > 0) {
+        m_journal.checkpoint(lastJournalSeq);
     }
 }
 
 void BotManager::add_ready_listener(ReadyCallback callback) {
+    callback = NodeProfiler::instance().wrap_listener(std::move(callback));
     {
         std::lock_guard<std::mutex> lock(m_listener_mutex);
         m_ready_listeners.push_back(callback);
@@ -330,22 +694,36 @@ void BotManager::add_ready_listener(ReadyCallback callback) {
     // If the bot is already ready, immediately invoke this listener once so
     // late subscribers (e.g., flows opened after connect) still see a Ready.
     if (m_readyFired) {
-        if (g_host) {
-            g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
-                "Discord plugin: add_ready_listener called after ready; invoking callback immediately");
-        }
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: add_ready_listener called after ready; invoking callback immediately");
         callback();
     }
 }
 
 void BotManager::add_message_listener(MessageCallback callback) {
+    callback = NodeProfiler::instance().wrap_listener(std::move(callback));
     std::lock_guard<std::mutex> lock(m_listener_mutex);
-    m_message_listeners.push_back(callback);
+    m_message_listeners.push_back(std::move(callback));
 }
 
 void BotManager::add_reaction_listener(ReactionCallback callback) {
+    callback = NodeProfiler::instance().wrap_listener(std::move(callback));
+    std::lock_guard<std::mutex> lock(m_listener_mutex);
+    m_reaction_listeners.push_back(std::move(callback));
+}
+
+void BotManager::add_slash_command_listener(SlashCommandCallback callback) {
+    callback = NodeProfiler::instance().wrap_listener(std::move(callback));
     std::lock_guard<std::mutex> lock(m_listener_mutex);
-    m_reaction_listeners.push_back(callback);
+    m_slash_command_listeners.push_back(std::move(callback));
+}
+
+ComponentRouter::Handle BotManager::add_component_route(const std::string& prefix, bool message_bound,
+                                                       ComponentRouter::ClickCallback on_click,
+                                                       ComponentRouter::ExpiryCallback on_expired) {
+    return m_components.add_route(prefix, message_bound,
+                                  NodeProfiler::instance().wrap_listener(std::move(on_click)),
+                                  NodeProfiler::instance().wrap_listener(std::move(on_expired)));
 }
 
 void BotManager::clear_listeners() {
@@ -353,86 +731,1387 @@ void BotManager::clear_listeners() {
     m_ready_listeners.clear();
     m_message_listeners.clear();
     m_reaction_listeners.clear();
+    m_slash_command_listeners.clear();
 }
 
 void BotManager::send_message(dpp::snowflake channel_id, const std::string& content) {
-    if (!m_bot || !m_running) return;
-    m_bot->message_create(dpp::message(channel_id, content));
+    create_message(dpp::message(channel_id, content));
 }
 
 void BotManager::send_embed(dpp::snowflake channel_id, const dpp::embed& embed) {
-    if (!m_bot || !m_running) return;
     dpp::message msg(channel_id, "");
     msg.add_embed(embed);
-    m_bot->message_create(msg);
+    create_message(msg);
+}
+
+void BotManager::create_message(const dpp::message& msg, DiscordTransport::ResponseCallback callback) {
+    rest_request(RestRoute::CreateMessage, "POST",
+                 "/channels/" + std::to_string(static_cast<uint64_t>(msg.channel_id)) + "/messages",
+                 msg.build_json(false), std::move(callback));
+}
+
+// Percent-encodes a path segment (reaction emoji, webhook token)
+static std::string url_encode(const std::string& value) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : value) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '_' || c == '.' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
 }
 
 void BotManager::add_reaction(dpp::snowflake channel_id, dpp::snowflake message_id, const std::string& emoji) {
-    if (!m_bot || !m_running) return;
-    m_bot->message_add_reaction(message_id, channel_id, emoji);
+    rest_request(RestRoute::AddReaction, "PUT",
+                 "/channels/" + std::to_string(static_cast<uint64_t>(channel_id)) + "/messages/" +
+                 std::to_string(static_cast<uint64_t>(message_id)) + "/reactions/" + url_encode(emoji) + "/@me",
+                 std::string(), nullptr);
 }
 
-void BotManager::reply_to_message(dpp::snowflake channel_id, dpp::snowflake message_id, const std::string& content) {
-    if (!m_bot || !m_running) return;
+void BotManager::reply_to_message(dpp::snowflake channel_id, dpp::snowflake message_id, const std::string& content,
+                                  const dpp::embed* embed) {
     dpp::message msg(channel_id, content);
     msg.set_reference(message_id);
-    m_bot->message_create(msg);
+    if (embed) {
+        msg.add_embed(*embed);
+    }
+    create_message(msg);
 }
 
-void BotManager::send_direct_message(dpp::snowflake user_id, const std::string& content) {
-    if (!m_bot || !m_running) {
-        if (g_host) {
-            g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
-                "Discord plugin: send_direct_message called but bot is not running");
+bool BotManager::respond_to_interaction(dpp::snowflake interaction_id, const dpp::message& msg) {
+    return m_interactions.respond(interaction_id, msg);
+}
+
+// Callback type of the calls that open an interaction's response
+static dpp::interaction_response_type interaction_response_type(InteractionCallKind kind) {
+    switch (kind) {
+        case InteractionCallKind::Defer:
+            return dpp::ir_deferred_channel_message_with_source;
+        case InteractionCallKind::DeferUpdate:
+            return dpp::ir_deferred_update_message;
+        default:
+            return dpp::ir_channel_message_with_source;
+    }
+}
+
+void BotManager::send_interaction_call(const InteractionCall& call, std::function<void(bool ok)> done) {
+    const std::string interactionId = std::to_string(static_cast<uint64_t>(call.interaction_id));
+    const std::string applicationId = std::to_string(static_cast<uint64_t>(call.application_id));
+    auto completion = [done](const TransportResponse& response) {
+        const bool ok = rest_ok(response);
+        if (!ok) {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, "Discord plugin: interaction response failed (status=" +
+                std::to_string(response.status) + "): " + response.body);
+        }
+        if (done) {
+            done(ok);
+        }
+    };
+    switch (call.kind) {
+        case InteractionCallKind::Respond:
+        case InteractionCallKind::Defer:
+        case InteractionCallKind::DeferUpdate: {
+            json body = { {"type", interaction_response_type(call.kind)} };
+            if (call.kind == InteractionCallKind::Respond) {
+                body["data"] = json::parse(call.message.build_json(false), nullptr, false);
+            }
+            rest_request(RestRoute::InteractionCallback, "POST",
+                         "/interactions/" + interactionId + "/" + call.token + "/callback",
+                         body.dump(), completion);
+            break;
         }
+        case InteractionCallKind::EditOriginal:
+            rest_request(RestRoute::EditInteraction, "PATCH",
+                         "/webhooks/" + applicationId + "/" + call.token + "/messages/@original",
+                         call.message.build_json(false), completion);
+            break;
+        case InteractionCallKind::Followup:
+            rest_request(RestRoute::InteractionFollowup, "POST",
+                         "/webhooks/" + applicationId + "/" + call.token,
+                         call.message.build_json(false), completion);
+            break;
+    }
+}
+
+// Runs on the transport's REST thread, so it only queues lines for the host
+static void log_direct_message_error(const TransportResponse& response, const char* call) {
+    json error = json::parse(response.body, nullptr, false);
+    const std::string message = error.is_object() && error.contains("message") && error["message"].is_string()
+        ? error["message"].get<std::string>() : response.body;
+    DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: ") + call + " failed (status=" +
+        std::to_string(response.status) + "): " + message);
+
+    if (response.status == 401) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
+            "Discord plugin: Discord returned 401 Unauthorized for direct_message_create. "
+            "This usually means the bot token is invalid, includes the 'Bot ' prefix, or has been reset. "
+            "Update the DISCORD_TOKEN environment variable or plugin settings token with a valid raw bot token and reconnect.");
+    }
+}
+
+void BotManager::send_direct_message(dpp::snowflake user_id, const std::string& content) {
+    dpp::snowflake channel_id;
+    if (!m_dm_channels.find(user_id, channel_id)) {
+        open_and_send_direct_message(user_id, content);
         return;
     }
 
-    dpp::message msg;
-    msg.set_content(content);
+    create_message(dpp::message(channel_id, content), [this, user_id, content](const TransportResponse& response) {
+        if (rest_ok(response)) {
+            return;
+        }
 
-    m_bot->direct_message_create(user_id, msg, [](const dpp::confirmation_callback_t& cb) {
-        if (!g_host) {
+        // A stale channel (deleted or no longer reachable) is dropped and the
+        // DM retried once through the full open-channel path.
+        if (response.status == 404) {
+            m_dm_channels.erase(user_id);
+            open_and_send_direct_message(user_id, content);
             return;
         }
 
-        if (cb.is_error()) {
-            const auto& error = cb.get_error();
+        log_direct_message_error(response, "message_create (cached DM channel)");
+    });
+}
 
-            std::string err = "Discord plugin: direct_message_create failed: ";
-            err += error.message;
-            g_host->log(PLUGIN_LOG_LEVEL_ERROR, err.c_str());
+// Opens (or looks up) the DM channel, caches it, then sends
+void BotManager::open_and_send_direct_message(dpp::snowflake user_id, const std::string& content) {
+    json body = { {"recipient_id", std::to_string(static_cast<uint64_t>(user_id))} };
+    rest_request(RestRoute::CreateDm, "POST", "/users/@me/channels", body.dump(),
+        [this, user_id, content](const TransportResponse& response) {
+            json channel = rest_ok(response) ? json::parse(response.body, nullptr, false) : json();
+            const dpp::snowflake dm = channel.is_object() ? json_snowflake(channel, "id") : dpp::snowflake();
+            if (dm.empty()) {
+                log_direct_message_error(response, "direct_message_create");
+                return;
+            }
+            m_dm_channels.insert(user_id, dm);
+            create_message(dpp::message(dm, content), [](const TransportResponse& sent) {
+                if (!rest_ok(sent)) {
+                    log_direct_message_error(sent, "message_create (new DM channel)");
+                }
+            });
+        });
+}
 
-            const std::string& emsg = error.message;
-            const bool has401 = (emsg.find("401") != std::string::npos);
-            const bool hasUnauthorized =
-                (emsg.find("Unauthorized") != std::string::npos) ||
-                (emsg.find("unauthorized") != std::string::npos);
+void BotManager::set_presence(const dpp::presence& presence) {
+    if (!is_online()) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: set_presence called but bot is not running");
+        return;
+    }
 
-            if (has401 || hasUnauthorized) {
-                g_host->log(PLUGIN_LOG_LEVEL_ERROR,
-                    "Discord plugin: Discord returned 401 Unauthorized for direct_message_create. "
-                    "This usually means the bot token is invalid, includes the 'Bot ' prefix, or has been reset. "
-                    "Update the DISCORD_TOKEN environment variable or plugin settings token with a valid raw bot token and reconnect.");
-            }
+    std::string payload = presence.build_json();
+    {
+        std::lock_guard<std::mutex> lock(m_presence_mutex);
+        if (payload == m_last_presence_payload) {
+            // Back to what is already live; drop any newer-but-unsent state
+            m_presence_pending = false;
+            m_pending_presence_payload.clear();
+            return;
         }
-    });
+        m_pending_presence_payload = std::move(payload);
+        m_presence_pending = true;
+    }
+
+    // Leading edge: send right away when outside the debounce window,
+    // otherwise tick() sends the latest pending state once it elapses.
+    flush_presence();
 }
 
-void BotManager::set_presence(const dpp::presence& presence) {
-    if (!m_bot || !m_running) {
-        if (g_host) {
-            g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
-                "Discord plugin: set_presence called but bot is not running");
+void BotManager::flush_presence() {
+    std::string payload;
+    {
+        std::lock_guard<std::mutex> lock(m_presence_mutex);
+        if (!m_presence_pending) {
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto window = std::chrono::milliseconds(GetDiscordPluginConfig().presence_debounce_ms);
+        if (!m_last_presence_payload.empty() && now - m_last_presence_send < window) {
+            return;
         }
+
+        payload = std::move(m_pending_presence_payload);
+        m_pending_presence_payload.clear();
+        m_presence_pending = false;
+        m_last_presence_payload = payload;
+        m_last_presence_send = now;
+    }
+
+    send_presence_payload(payload);
+
+    DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+        "Discord plugin: presence updated via BotManager::set_presence");
+}
+
+void BotManager::send_presence_payload(const std::string& payload) {
+    DiscordTransport* transport = m_running ? m_transport : nullptr;
+    if (!transport) return;
+
+    // Same frame for every shard; shards that are not connected pick the
+    // presence up from resend_presence_to_shard() when they become ready.
+    for (uint32_t shard = 0; shard < transport->shard_count(); ++shard) {
+        transport->gateway_send(shard, payload);
+    }
+}
+
+void BotManager::resend_presence_to_shard(uint32_t shard_id) {
+    DiscordTransport* transport = m_running ? m_transport : nullptr;
+    if (!transport) return;
+
+    std::string payload;
+    {
+        std::lock_guard<std::mutex> lock(m_presence_mutex);
+        payload = m_last_presence_payload;
+    }
+
+    // Nothing live yet means the first send is still pending; tick() will
+    // deliver it to every connected shard.
+    if (payload.empty()) return;
+
+    transport->gateway_send(shard_id, payload);
+}
+
+void BotManager::send_webhook_message(dpp::snowflake channel_id, const std::string& content,
+                                      const std::string& username, const std::string& avatar_url,
+                                      const dpp::embed* embed) {
+    if (!is_online()) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: send_webhook_message called but bot is not running");
         return;
     }
 
-    m_bot->set_presence(presence);
+    // Build the execute payload up front so the pending path and the cached
+    // path share it. Username/avatar override the webhook's defaults.
+    PendingWebhookMessage pending;
+    pending.fallback = dpp::message(channel_id, content);
+    if (embed) {
+        pending.fallback.add_embed(*embed);
+    }
 
-    if (g_host) {
-        g_host->log(PLUGIN_LOG_LEVEL_INFO,
-            "Discord plugin: presence updated via BotManager::set_presence");
+    json body = json::parse(pending.fallback.build_json(false));
+    body.erase("channel_id");
+    if (!username.empty()) {
+        body["username"] = username;
+    }
+    if (!avatar_url.empty()) {
+        body["avatar_url"] = avatar_url;
+    }
+    pending.body = body.dump();
+
+    send_via_webhook(channel_id, std::move(pending));
+}
+
+void BotManager::send_via_webhook(dpp::snowflake channel_id, PendingWebhookMessage pending) {
+    ChannelWebhook webhook;
+    bool needsResolve = false;
+    bool sendAsBot = false;
+    {
+        std::lock_guard<std::mutex> lock(m_webhook_mutex);
+        // A channel whose webhook failed recently is not looked up again per send
+        auto failed = m_webhook_retry_at.find(channel_id);
+        if (failed != m_webhook_retry_at.end()) {
+            if (std::chrono::steady_clock::now() < failed->second) {
+                sendAsBot = true;
+            } else {
+                m_webhook_retry_at.erase(failed);
+            }
+        }
+        auto it = sendAsBot ? m_channel_webhooks.end() : m_channel_webhooks.find(channel_id);
+        if (it != m_channel_webhooks.end()) {
+            webhook = it->second;
+        } else if (!sendAsBot) {
+            auto& queue = m_pending_webhook_messages[channel_id];
+            needsResolve = queue.empty();
+            queue.push_back(std::move(pending));
+            if (!needsResolve) {
+                // A lookup for this channel is already in flight
+                return;
+            }
+        }
     }
+
+    if (sendAsBot) {
+        create_message(pending.fallback);
+        return;
+    }
+    if (needsResolve) {
+        resolve_channel_webhook(channel_id);
+        return;
+    }
+
+    execute_webhook(channel_id, webhook, std::move(pending));
 }
 
+void BotManager::resolve_channel_webhook(dpp::snowflake channel_id) {
+    const std::string channel = std::to_string(static_cast<uint64_t>(channel_id));
+    // Reuse a webhook this bot created earlier before creating a new one;
+    // channels are limited to a small number of webhooks.
+    auto on_listed = [this, channel_id, channel](const TransportResponse& response) {
+        json webhooks = rest_ok(response) ? json::parse(response.body, nullptr, false) : json();
+        if (webhooks.is_array()) {
+            const dpp::snowflake me = m_bot_user_id.load();
+            for (const auto& wh : webhooks) {
+                auto user = wh.is_object() ? wh.find("user") : wh.end();
+                if (user == wh.end() || !user->is_object() || json_snowflake(*user, "id") != me) {
+                    continue;
+                }
+                ChannelWebhook found{ json_snowflake(wh, "id"), json_string(wh, "token") };
+                if (!found.token.empty()) {
+                    on_channel_webhook_resolved(channel_id, &found);
+                    return;
+                }
+            }
+        } else {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_WARN, "Discord plugin: get_channel_webhooks failed (status=" +
+                std::to_string(response.status) + "): " + response.body);
+        }
+
+        json body = { {"name", kWebhookName} };
+        auto on_created = [this, channel_id](const TransportResponse& created) {
+            json wh = rest_ok(created) ? json::parse(created.body, nullptr, false) : json();
+            ChannelWebhook made;
+            if (wh.is_object()) {
+                made = ChannelWebhook{ json_snowflake(wh, "id"), json_string(wh, "token") };
+            }
+            if (made.token.empty()) {
+                DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, "Discord plugin: create_webhook failed (requires Manage Webhooks, "
+                    "status=" + std::to_string(created.status) + "): " + created.body);
+                on_channel_webhook_resolved(channel_id, nullptr);
+                return;
+            }
+            on_channel_webhook_resolved(channel_id, &made);
+        };
+        rest_request(RestRoute::CreateWebhook, "POST", "/channels/" + channel + "/webhooks", body.dump(), on_created);
+    };
+    rest_request(RestRoute::GetWebhooks, "GET", "/channels/" + channel + "/webhooks", std::string(), on_listed);
+}
+
+void BotManager::on_channel_webhook_resolved(dpp::snowflake channel_id, const ChannelWebhook* webhook) {
+    std::vector<PendingWebhookMessage> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_webhook_mutex);
+        auto it = m_pending_webhook_messages.find(channel_id);
+        if (it != m_pending_webhook_messages.end()) {
+            pending = std::move(it->second);
+            m_pending_webhook_messages.erase(it);
+        }
+        if (webhook) {
+            m_channel_webhooks[channel_id] = *webhook;
+        } else {
+            m_webhook_retry_at[channel_id] = std::chrono::steady_clock::now() + kWebhookRetryDelay;
+        }
+    }
+
+    for (auto& msg : pending) {
+        if (webhook) {
+            execute_webhook(channel_id, *webhook, std::move(msg));
+        } else {
+            // No usable webhook; keep the output flowing through the bot itself
+            create_message(msg.fallback);
+        }
+    }
+}
+
+void BotManager::execute_webhook(dpp::snowflake channel_id, const ChannelWebhook& webhook, PendingWebhookMessage msg) {
+    const std::string path =
+        "/webhooks/" + std::to_string(static_cast<uint64_t>(webhook.id)) + "/" + url_encode(webhook.token);
+    const std::string body = msg.body;
+    rest_request(RestRoute::ExecuteWebhook, "POST", path, body,
+        [this, channel_id, webhook, msg = std::move(msg)](const TransportResponse& response) mutable {
+            if (rest_ok(response)) {
+                return;
+            }
+
+            if (response.status == 401 || response.status == 404) {
+                // Webhook was deleted or its token reset: forget it and send
+                // the message again, which resolves a fresh webhook. A second
+                // failure goes out as the bot instead of being dropped.
+                {
+                    std::lock_guard<std::mutex> lock(m_webhook_mutex);
+                    auto it = m_channel_webhooks.find(channel_id);
+                    if (it != m_channel_webhooks.end() && it->second.id == webhook.id) {
+                        m_channel_webhooks.erase(it);
+                    }
+                }
+                DISCORD_LOG(PLUGIN_LOG_LEVEL_WARN,
+                    "Discord plugin: channel webhook is gone (status=" + std::to_string(response.status) +
+                    "); " + (msg.retried ? "sending as the bot" : "resolving it again"));
+                if (msg.retried) {
+                    create_message(msg.fallback);
+                } else {
+                    msg.retried = true;
+                    send_via_webhook(channel_id, std::move(msg));
+                }
+                return;
+            }
+
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
+                "Discord plugin: webhook execute failed (status=" + std::to_string(response.status) + "): " +
+                response.body);
+        });
+}
+
+// ============================================================================
+// Slash command registration
+// ============================================================================
+
+void BotManager::load_command_state() {
+    // Completions of a previous session's overwrites are never delivered
+    m_commands.cancel_in_flight();
+    m_commands_dirty = true;
+    m_commands_changed_at = std::chrono::steady_clock::time_point();
+
+    // Like the other persisted state, sessions without a cluster leave the
+    // file alone
+    const std::string& path = GetDiscordPluginConfig().command_state_path;
+    if (!m_bot || path.empty()) {
+        return;
+    }
+    if (!m_commands.load(path)) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_WARN, "Discord plugin: ignoring unreadable slash command state '" + path +
+            "'; commands will be registered again");
+    }
+}
+
+void BotManager::sync_commands(std::chrono::steady_clock::time_point now) {
+    if (m_commands.generation() != m_command_generation) {
+        m_command_generation = m_commands.generation();
+        m_commands_changed_at = now;
+        m_commands_dirty = true;
+    }
+    // Flows load one at a time; wait for the set to settle
+    if (!m_commands_dirty || !m_running || m_replaying || !m_readyFired ||
+        now - m_commands_changed_at < kCommandSyncDelay) {
+        return;
+    }
+    const dpp::snowflake applicationId = m_application_id.load();
+    if (applicationId.empty() || !m_transport) {
+        return;
+    }
+    m_commands_dirty = false;
+
+    // Every loaded flow is rescanned first, so each scope is hashed from its
+    // complete command set
+    m_commands.scan_flows();
+    std::vector<CommandRegistry::Registration> registrations = m_commands.changed(applicationId);
+    if (registrations.empty()) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, "Discord plugin: " + std::to_string(m_commands.size()) +
+            " slash command definition(s) unchanged; skipping registration");
+        return;
+    }
+    for (const CommandRegistry::Registration& registration : registrations) {
+        m_commands.begin(applicationId, registration);
+        overwrite_commands(applicationId, registration);
+    }
+}
+
+void BotManager::overwrite_commands(dpp::snowflake application_id, const CommandRegistry::Registration& registration) {
+    const std::string application = std::to_string(static_cast<uint64_t>(application_id));
+    const std::string scope = registration.guild_id.empty() ? std::string("commands") :
+        "guilds/" + std::to_string(static_cast<uint64_t>(registration.guild_id)) + "/commands";
+
+    rest_request(RestRoute::OverwriteCommands, "PUT", "/applications/" + application + "/" + scope,
+        registration.body, [this, application_id, registration](const TransportResponse& response) {
+            const int status = response.status;
+            if (status >= 400) {
+                DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, "Discord plugin: slash command registration response: " +
+                    response.body);
+            }
+            post_to_main([this, application_id, registration, status]() {
+                on_commands_overwritten(application_id, registration, status);
+            });
+        });
+}
+
+void BotManager::on_commands_overwritten(dpp::snowflake application_id,
+                                         const CommandRegistry::Registration& registration, int status) {
+    const std::string scope = registration.guild_id.empty() ? std::string("globally") :
+        "in guild " + std::to_string(static_cast<uint64_t>(registration.guild_id));
+    if (status >= 400 || status == 0) {
+        // Retried when the definitions change or on the next connection
+        m_commands.failed(application_id, registration);
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, "Discord plugin: failed to register " +
+            std::to_string(registration.count) + " slash command(s) " + scope + " (status=" +
+            std::to_string(status) + ")");
+        return;
+    }
+
+    m_commands.registered(application_id, registration);
+    DISCORD_LOG(PLUGIN_LOG_LEVEL_INFO, "Discord plugin: registered " + std::to_string(registration.count) +
+        " slash command(s) " + scope);
+    const std::string& path = GetDiscordPluginConfig().command_state_path;
+    if (m_bot && !path.empty() && !m_commands.save(path)) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_WARN, "Discord plugin: failed to save slash command state to '" + path + "'");
+    }
+}
+
+void BotManager::post_to_main(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(m_main_task_mutex);
+    m_main_tasks.push_back(std::move(task));
+}
+
+static UserRecord make_user_record(const dpp::user& user) {
+    UserRecord record;
+    record.found = true;
+    record.username = user.username;
+    record.global_name = user.global_name;
+    record.avatar_url = user.get_avatar_url();
+    record.is_bot = user.is_bot();
+    return record;
+}
+
+static ChannelRecord make_channel_record(const dpp::channel& channel) {
+    ChannelRecord record;
+    record.found = true;
+    record.name = channel.name;
+    record.topic = channel.topic;
+    record.type = static_cast<int64_t>(channel.get_type());
+    record.guild_id = channel.guild_id;
+    return record;
+}
+
+// Records from REST JSON
+static UserRecord user_record_from_json(const json& u) {
+    UserRecord record;
+    record.found = true;
+    record.username = json_string(u, "username");
+    record.global_name = json_string(u, "global_name");
+    const std::string avatar = json_string(u, "avatar");
+    if (!avatar.empty()) {
+        // Animated avatars have an "a_" hash, as in dpp::user::get_avatar_url
+        const bool animated = avatar.compare(0, 2, "a_") == 0;
+        record.avatar_url = "https://cdn.discordapp.com/avatars/" + json_string(u, "id") + "/" + avatar +
+            (animated ? ".gif" : ".png");
+    }
+    record.is_bot = u.value("bot", false);
+    return record;
+}
+
+static ChannelRecord channel_record_from_json(const json& c) {
+    ChannelRecord record;
+    record.found = true;
+    record.name = json_string(c, "name");
+    record.topic = json_string(c, "topic");
+    record.type = c.value("type", int64_t(0));
+    record.guild_id = json_snowflake(c, "guild_id");
+    return record;
+}
+
+// Not-found responses are cached for the negative TTL; transient failures
+// (rate limits, 5xx, network) are reported as misses but not cached.
+static std::chrono::milliseconds fetch_result_ttl(bool found, int status) {
+    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+    if (found) {
+        return std::chrono::milliseconds(cfg.entity_cache_ttl_ms);
+    }
+    if (status == 404) {
+        return std::chrono::milliseconds(cfg.entity_cache_negative_ttl_ms);
+    }
+    return std::chrono::milliseconds(0);
+}
+
+void BotManager::fetch_user(dpp::snowflake user_id, UserFetchCallback callback) {
+    UserRecord record;
+    if (find_local_user(user_id, record)) {
+        post_to_main([callback = std::move(callback), record = std::move(record)]() { callback(record); });
+        return;
+    }
+
+    switch (m_user_cache.lookup(user_id, callback, record)) {
+        case TtlCache<UserRecord>::Lookup::Hit:
+            post_to_main([callback = std::move(callback), record = std::move(record)]() { callback(record); });
+            return;
+        case TtlCache<UserRecord>::Lookup::Joined:
+            return;
+        case TtlCache<UserRecord>::Lookup::Start:
+            break;
+    }
+
+    auto deliver = [this, user_id](const UserRecord& result, std::chrono::milliseconds ttl) {
+        auto waiters = m_user_cache.complete(user_id, result, ttl);
+        post_to_main([waiters = std::move(waiters), result]() {
+            for (auto& waiter : waiters) {
+                waiter(result);
+            }
+        });
+    };
+
+    rest_request(RestRoute::GetUser, "GET", "/users/" + std::to_string(static_cast<uint64_t>(user_id)), std::string(),
+        [deliver](const TransportResponse& response) {
+            json u = response.status == 200 ? json::parse(response.body, nullptr, false) : json();
+            if (!u.is_object()) {
+                deliver(UserRecord(), fetch_result_ttl(false, response.status));
+                return;
+            }
+            deliver(user_record_from_json(u), fetch_result_ttl(true, response.status));
+        });
+}
+
+bool BotManager::find_local_user(dpp::snowflake user_id, UserRecord& out) {
+    if (dpp::user* cached = dpp::find_user(user_id)) {
+        out = make_user_record(*cached);
+        return true;
+    }
+    StoredUser stored;
+    if (m_member_store.get_user(user_id, stored)) {
+        out = UserRecord();
+        out.found = true;
+        out.username = stored.username;
+        out.global_name = stored.global_name;
+        out.is_bot = stored.is_bot;
+        return true;
+    }
+    SnapshotUser snap;
+    if (m_snapshot.find_user(user_id, snap)) {
+        out = UserRecord();
+        out.found = true;
+        out.username = std::move(snap.username);
+        out.global_name = std::move(snap.global_name);
+        out.avatar_url = std::move(snap.avatar_url);
+        out.is_bot = snap.is_bot;
+        return true;
+    }
+    return false;
+}
+
+bool BotManager::peek_user(dpp::snowflake user_id, UserRecord& out) {
+    return find_local_user(user_id, out) || m_user_cache.peek(user_id, out);
+}
+
+bool BotManager::send_guild_gateway_payload(dpp::snowflake guild_id, const std::string& payload) {
+    DiscordTransport* transport = m_running ? m_transport : nullptr;
+    if (!transport) {
+        return false;
+    }
+    // Discord routes a guild to shard (guild_id >> 22) % shard_count
+    const uint32_t shards = std::max<uint32_t>(1, transport->shard_count());
+    return transport->gateway_send(static_cast<uint32_t>((static_cast<uint64_t>(guild_id) >> 22) % shards), payload);
+}
+
+bool BotManager::find_local_channel(dpp::snowflake channel_id, ChannelRecord& out) {
+    if (dpp::channel* cached = dpp::find_channel(channel_id)) {
+        out = make_channel_record(*cached);
+        return true;
+    }
+    SnapshotChannel snap;
+    if (m_snapshot.find_channel(channel_id, snap)) {
+        out = ChannelRecord();
+        out.found = true;
+        out.name = std::move(snap.name);
+        out.topic = std::move(snap.topic);
+        out.type = static_cast<int64_t>(snap.type);
+        out.guild_id = snap.guild_id;
+        return true;
+    }
+    return false;
+}
+
+bool BotManager::peek_channel(dpp::snowflake channel_id, ChannelRecord& out) {
+    return find_local_channel(channel_id, out) || m_channel_cache.peek(channel_id, out);
+}
+
+void BotManager::resolve_ids(ResolveKind kind, dpp::snowflake guild_id,
+                             const std::vector<dpp::snowflake>& ids, ResolveCallback callback) {
+    m_id_resolver.resolve(kind, guild_id, ids, std::move(callback));
+}
+
+void BotManager::fetch_channel(dpp::snowflake channel_id, ChannelFetchCallback callback) {
+    ChannelRecord record;
+    if (find_local_channel(channel_id, record)) {
+        post_to_main([callback = std::move(callback), record = std::move(record)]() { callback(record); });
+        return;
+    }
+
+    switch (m_channel_cache.lookup(channel_id, callback, record)) {
+        case TtlCache<ChannelRecord>::Lookup::Hit:
+            post_to_main([callback = std::move(callback), record = std::move(record)]() { callback(record); });
+            return;
+        case TtlCache<ChannelRecord>::Lookup::Joined:
+            return;
+        case TtlCache<ChannelRecord>::Lookup::Start:
+            break;
+    }
+
+    auto deliver = [this, channel_id](const ChannelRecord& result, std::chrono::milliseconds ttl) {
+        auto waiters = m_channel_cache.complete(channel_id, result, ttl);
+        post_to_main([waiters = std::move(waiters), result]() {
+            for (auto& waiter : waiters) {
+                waiter(result);
+            }
+        });
+    };
+
+    rest_request(RestRoute::GetChannel, "GET", "/channels/" + std::to_string(static_cast<uint64_t>(channel_id)),
+        std::string(),
+        [deliver](const TransportResponse& response) {
+            json c = response.status == 200 ? json::parse(response.body, nullptr, false) : json();
+            if (!c.is_object()) {
+                deliver(ChannelRecord(), fetch_result_ttl(false, response.status));
+                return;
+            }
+            deliver(channel_record_from_json(c), fetch_result_ttl(true, response.status));
+        });
+}
+
+// ============================================================================
+// Warm-start snapshot
+// ============================================================================
+
+void BotManager::load_snapshot(const std::string& token) {
+    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+    if (cfg.snapshot_path.empty()) {
+        return;
+    }
+
+    std::string error;
+    if (m_snapshot.load(cfg.snapshot_path, CacheSnapshot::hash_token(token),
+                        std::chrono::seconds(cfg.snapshot_max_age_s), error)) {
+        if (g_host) {
+            std::string msg = "Discord plugin: loaded warm-start snapshot from '" + cfg.snapshot_path + "'";
+            g_host->log(PLUGIN_LOG_LEVEL_INFO, msg.c_str());
+        }
+    } else {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, "Discord plugin: not using snapshot '" + cfg.snapshot_path + "': " + error);
+    }
+}
+
+// Visits every object in a DPP cache under the cache's read lock
+template <typename T, typename Fn>
+static void copy_dpp_cache(dpp::cache<T>* cache, Fn fn) {
+    if (!cache) {
+        return;
+    }
+    std::shared_lock<std::shared_mutex> lock(cache->get_mutex());
+    for (const auto& entry : cache->get_container()) {
+        if (entry.second) {
+            fn(*entry.second);
+        }
+    }
+}
+
+// Live DPP state is written as-is. Records from the previous snapshot are
+// carried forward only when this session never received a guild (for
+// example a shutdown before ready), so entities deleted while the bot was
+// offline do not survive a successful session. Users are not deleted by
+// Discord, so older ones fill whatever room is left under the user cap.
+void BotManager::save_snapshot() {
+    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+    if (cfg.snapshot_path.empty()) {
+        return;
+    }
+
+    SnapshotData data;
+    copy_dpp_cache(dpp::get_guild_cache(), [&data](const dpp::guild& g) {
+        data.guilds.push_back(SnapshotGuild{ g.id, g.owner_id, g.name, static_cast<uint32_t>(g.member_count) });
+    });
+    copy_dpp_cache(dpp::get_channel_cache(), [&data](const dpp::channel& c) {
+        SnapshotChannel channel;
+        channel.id = c.id;
+        channel.guild_id = c.guild_id;
+        channel.parent_id = c.parent_id;
+        channel.name = c.name;
+        channel.topic = c.topic;
+        channel.type = static_cast<uint32_t>(c.get_type());
+        channel.position = c.position;
+        data.channels.push_back(std::move(channel));
+    });
+    copy_dpp_cache(dpp::get_role_cache(), [&data](const dpp::role& r) {
+        SnapshotRole role;
+        role.id = r.id;
+        role.guild_id = r.guild_id;
+        role.permissions = static_cast<uint64_t>(r.permissions);
+        role.name = r.name;
+        role.colour = r.colour;
+        role.position = r.position;
+        data.roles.push_back(std::move(role));
+    });
+
+    // Users: recently fetched ones first, then DPP's cache, then the old file
+    const size_t maxUsers = cfg.snapshot_max_users;
+    SnowflakeMap<uint8_t> seenUsers;
+    auto add_user = [&](SnapshotUser user) {
+        if (data.users.size() < maxUsers && seenUsers.try_emplace(user.id, uint8_t(1)).second) {
+            data.users.push_back(std::move(user));
+        }
+    };
+    m_user_cache.for_each([&](dpp::snowflake id, const UserRecord& record) {
+        if (record.found) {
+            add_user(SnapshotUser{ id, record.username, record.global_name, record.avatar_url, record.is_bot });
+        }
+    });
+    copy_dpp_cache(dpp::get_user_cache(), [&](const dpp::user& u) {
+        add_user(SnapshotUser{ u.id, u.username, u.global_name, u.get_avatar_url(), u.is_bot() });
+    });
+
+    SnapshotData previous;
+    m_snapshot.collect(previous);
+    if (data.guilds.empty()) {
+        data.guilds = std::move(previous.guilds);
+        data.channels.insert(data.channels.end(), previous.channels.begin(), previous.channels.end());
+        data.roles.insert(data.roles.end(), previous.roles.begin(), previous.roles.end());
+    }
+    for (auto& user : previous.users) {
+        add_user(std::move(user));
+    }
+
+    // The old file stays mapped until collect() is done; unmap before replacing it
+    m_snapshot.close();
+
+    std::string error;
+    if (!CacheSnapshot::save(cfg.snapshot_path, data, CacheSnapshot::hash_token(m_token), error)) {
+        if (g_host) {
+            std::string msg = "Discord plugin: failed to save snapshot: " + error;
+            g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
+        }
+    } else {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, "Discord plugin: saved snapshot (" + std::to_string(data.guilds.size()) +
+            " guilds, " + std::to_string(data.channels.size()) + " channels, " + std::to_string(data.roles.size()) +
+            " roles, " + std::to_string(data.users.size()) + " users) to '" + cfg.snapshot_path + "'");
+    }
+}
+
+// ============================================================================
+// Event journal
+// ============================================================================
+
+void BotManager::enqueue_event(QueuedEvent& event, uint16_t journal_kind, const std::string& raw_event) {
+    std::lock_guard<std::mutex> lock(m_event_mutex);
+    if (journal_kind != 0 && !raw_event.empty()) {
+        event.journal_seq = m_journal.append(journal_kind, raw_event);
+    }
+    push_event_locked(std::move(event));
+}
+
+void BotManager::begin_trace(QueuedEvent& event) {
+    event.trace_id = m_tracer.sample();
+    if (event.trace_id != 0) {
+        event.received_us = m_tracer.now_us();
+    }
+}
+
+void BotManager::push_event_locked(QueuedEvent&& event) {
+    event.queued_at = std::chrono::steady_clock::now();
+    if (event.trace_id != 0) {
+        m_tracer.record(event.trace_id, "receive", trace_category(event.type), event.received_us,
+                        m_tracer.to_us(event.queued_at));
+    }
+    DiscordMetrics& metrics = discord_metrics();
+    metrics.events_received[static_cast<size_t>(event.type)].add();
+    if (event.type == DiscordEventType::SlashCommand || event.type == DiscordEventType::Component) {
+        m_interaction_queue.push(std::move(event));
+    } else {
+        m_event_queue.push(std::move(event));
+    }
+    metrics.queue_depth.set(static_cast<int64_t>(m_event_queue.size() + m_interaction_queue.size()));
+}
+
+// Queued events built from the "d" object of a raw MESSAGE_CREATE or
+// MESSAGE_REACTION_ADD dispatch (handle_dispatch and journal recovery)
+static void message_event_from_dispatch(const json& d, QueuedEvent& out) {
+    auto author = d.find("author");
+    out.type = DiscordEventType::Message;
+    if (author != d.end() && author->is_object()) {
+        out.message_data.author_id = json_snowflake(*author, "id");
+        out.message_data.author_name = author->value("username", std::string());
+    }
+    auto content = d.find("content");
+    if (content != d.end() && content->is_string()) {
+        out.message_data.content = content->get<std::string>();
+    }
+    out.message_data.channel_id = json_snowflake(d, "channel_id");
+    out.message_data.guild_id = json_snowflake(d, "guild_id");
+    out.message_data.message_id = json_snowflake(d, "id");
+}
+
+static void reaction_event_from_dispatch(const json& d, QueuedEvent& out) {
+    auto emoji = d.find("emoji");
+    out.type = DiscordEventType::ReactionAdd;
+    out.reaction_data.user_id = json_snowflake(d, "user_id");
+    if (emoji != d.end() && emoji->is_object() && (*emoji)["name"].is_string()) {
+        out.reaction_data.emoji = (*emoji)["name"].get<std::string>();
+    }
+    out.reaction_data.message_id = json_snowflake(d, "message_id");
+    out.reaction_data.channel_id = json_snowflake(d, "channel_id");
+    out.reaction_data.guild_id = json_snowflake(d, "guild_id");
+}
+
+// Slash command options as {"name": value}, with subcommands and groups as
+// nested objects
+static json interaction_options(const json& options) {
+    json out = json::object();
+    if (!options.is_array()) {
+        return out;
+    }
+    for (const auto& option : options) {
+        auto name = option.is_object() ? option.find("name") : option.end();
+        if (!option.is_object() || name == option.end() || !name->is_string()) {
+            continue;
+        }
+        auto value = option.find("value");
+        auto nested = option.find("options");
+        if (value != option.end()) {
+            out[name->get<std::string>()] = *value;
+        } else {
+            out[name->get<std::string>()] = interaction_options(nested != option.end() ? *nested : json());
+        }
+    }
+    return out;
+}
+
+static void interaction_event_from_dispatch(const json& d, QueuedEvent& out) {
+    out.type = DiscordEventType::SlashCommand;
+    InteractionEventData& data = out.interaction_data;
+    data.interaction_id = json_snowflake(d, "id");
+    data.channel_id = json_snowflake(d, "channel_id");
+    data.guild_id = json_snowflake(d, "guild_id");
+
+    // Guild interactions carry the user inside member, DMs at the top level
+    auto member = d.find("member");
+    auto user = d.find("user");
+    if (member != d.end() && member->is_object() && member->contains("user")) {
+        user = member->find("user");
+    }
+    if (user != d.end() && user->is_object()) {
+        data.user_id = json_snowflake(*user, "id");
+        data.user_name = user->value("username", std::string());
+    }
+
+    auto command = d.find("data");
+    if (command != d.end() && command->is_object()) {
+        data.command_name = command->value("name", std::string());
+        auto options = command->find("options");
+        data.options_json = interaction_options(options != command->end() ? *options : json()).dump();
+    } else {
+        data.options_json = "{}";
+    }
+}
+
+static void component_event_from_dispatch(const json& d, QueuedEvent& out) {
+    out.type = DiscordEventType::Component;
+    ComponentEventData& data = out.component_data;
+    data.interaction_id = json_snowflake(d, "id");
+    data.channel_id = json_snowflake(d, "channel_id");
+    data.guild_id = json_snowflake(d, "guild_id");
+
+    auto member = d.find("member");
+    auto user = d.find("user");
+    if (member != d.end() && member->is_object() && member->contains("user")) {
+        user = member->find("user");
+    }
+    if (user != d.end() && user->is_object()) {
+        data.user_id = json_snowflake(*user, "id");
+        data.user_name = user->value("username", std::string());
+    }
+
+    auto message = d.find("message");
+    if (message != d.end() && message->is_object()) {
+        data.message_id = json_snowflake(*message, "id");
+    }
+
+    data.values_json = "[]";
+    auto component = d.find("data");
+    if (component != d.end() && component->is_object()) {
+        data.custom_id = component->value("custom_id", std::string());
+        data.component_type = component->value("component_type", 0);
+        auto values = component->find("values");
+        if (values != component->end() && values->is_array()) {
+            data.values_json = values->dump();
+        }
+    }
+}
+
+static bool event_from_journal(const JournalRecord& record, QueuedEvent& out) {
+    json d = dispatch_payload(record.payload);
+    if (!d.is_object()) {
+        return false;
+    }
+    out = QueuedEvent();
+    out.journal_seq = record.seq;
+    if (record.kind == kJournalMessage) {
+        message_event_from_dispatch(d, out);
+        return true;
+    }
+    if (record.kind == kJournalReaction) {
+        reaction_event_from_dispatch(d, out);
+        return true;
+    }
+    return false;
+}
+
+// Interactions are never journaled: their tokens expire long before a
+// recovered event could be answered. Live ones start their auto-defer clock
+// here, before they wait in the queue.
+void BotManager::queue_interaction(const json& d, QueuedEvent& event) {
+    auto kind = d.find("type");
+    if (kind == d.end() || !kind->is_number_integer()) {
+        return;
+    }
+    dpp::snowflake interactionId;
+    const bool component = kind->get<int>() == 3;
+    if (kind->get<int>() == 2) {
+        interaction_event_from_dispatch(d, event);
+        interactionId = event.interaction_data.interaction_id;
+    } else if (component) {
+        component_event_from_dispatch(d, event);
+        interactionId = event.component_data.interaction_id;
+    } else {
+        return;  // autocomplete, modal submit
+    }
+    if (!m_replaying) {
+        const auto autoDefer = std::chrono::milliseconds(GetDiscordPluginConfig().interaction_auto_defer_ms);
+        m_interactions.track(interactionId, json_snowflake(d, "application_id"),
+                             d.value("token", std::string()), autoDefer, component);
+    }
+    enqueue_event(event, 0, std::string());
+}
+
+// Events journaled after the checkpoint were received but never dispatched
+// (shutdown or crash); queue them ahead of anything from the new session
+void BotManager::recover_journal() {
+    JournalFilter filter;
+    filter.after_seq = m_journal.checkpoint_seq();
+    filter.kinds = (1u << kJournalMessage) | (1u << kJournalReaction);
+
+    size_t recovered = 0;
+    std::lock_guard<std::mutex> lock(m_event_mutex);
+    EventJournal::read(GetDiscordPluginConfig().journal_dir, filter, [this, &recovered](const JournalRecord& record) {
+        QueuedEvent event;
+        if (event_from_journal(record, event)) {
+            push_event_locked(std::move(event));
+            ++recovered;
+        }
+        return true;
+    });
+
+    if (g_host && recovered > 0) {
+        std::string msg = "Discord plugin: recovered " + std::to_string(recovered) +
+            " undispatched event(s) from the journal";
+        g_host->log(PLUGIN_LOG_LEVEL_INFO, msg.c_str());
+    }
+}
+
+bool BotManager::replay_journal(uint64_t since_ms, uint64_t until_ms, bool messages, bool reactions,
+                                size_t limit, size_t& queued) {
+    queued = 0;
+    const std::string& dir = GetDiscordPluginConfig().journal_dir;
+    if (dir.empty()) {
+        return false;
+    }
+
+    JournalFilter filter;
+    filter.since_ms = since_ms;
+    filter.until_ms = until_ms;
+    filter.kinds = (messages ? (1u << kJournalMessage) : 0) | (reactions ? (1u << kJournalReaction) : 0);
+
+    std::vector<QueuedEvent> events;
+    if (filter.kinds != 0 && limit > 0) {
+        EventJournal::read(dir, filter, [&events, limit](const JournalRecord& record) {
+            QueuedEvent event;
+            if (event_from_journal(record, event)) {
+                // Replays must not move the recovery checkpoint
+                event.journal_seq = 0;
+                events.push_back(std::move(event));
+            }
+            return events.size() < limit;
+        });
+    }
+
+    std::lock_guard<std::mutex> lock(m_event_mutex);
+    for (auto& event : events) {
+        push_event_locked(std::move(event));
+    }
+    queued = events.size();
+    return true;
+}
+
+// ============================================================================
+// Gateway replay
+// ============================================================================
+
+// Offline mode: no cluster is created, so actions are no-ops and lookups only
+// see what the replayed dispatches put into the plugin's own stores. The
+// persisted snapshot, DM cache and journal belong to the live bot and are
+// left alone.
+bool BotManager::start_gateway_replay() {
+    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+    std::string error;
+    if (!m_playback.open(cfg.gateway_replay_path, cfg.gateway_replay_speed, error)) {
+        if (g_host) {
+            std::string msg = "Discord plugin: cannot replay gateway recording '" + cfg.gateway_replay_path + "': " + error;
+            g_host->log(PLUGIN_LOG_LEVEL_ERROR, msg.c_str());
+        }
+        return false;
+    }
+
+    configure_stores();
+    m_replaying = true;
+    m_running = true;
+
+    if (g_host) {
+        std::string msg = "Discord plugin: replaying gateway recording '" + cfg.gateway_replay_path + "' at ";
+        msg += cfg.gateway_replay_speed == 0 ? std::string("maximum speed") : std::to_string(cfg.gateway_replay_speed) + "x";
+        msg += " (no network)";
+        g_host->log(PLUGIN_LOG_LEVEL_INFO, msg.c_str());
+    }
+    return true;
+}
+
+void BotManager::pump_gateway_replay() {
+    if (!m_playback.is_open()) {
+        return;
+    }
+    const size_t batch = std::max<size_t>(1, GetDiscordPluginConfig().gateway_replay_batch);
+    m_playback.poll(batch, [this](const std::string& raw_event) {
+        handle_dispatch(raw_event);
+    });
+
+    if (m_playback.finished()) {
+        if (g_host) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(m_playback.elapsed()).count();
+            std::string msg = "Discord plugin: gateway replay finished (" + std::to_string(m_playback.count()) +
+                " dispatch(es) in " + std::to_string(ms) + " ms)";
+            g_host->log(PLUGIN_LOG_LEVEL_INFO, msg.c_str());
+        }
+        m_playback.close();
+    }
+}
+
+// Turns one raw dispatch frame into queued events and store updates. Live
+// handlers, gateway replay and in-process transports all come through here;
+// only the live session has a recorder and journal open, and actions started
+// here (presence, member requests) are no-ops without a transport.
+void BotManager::handle_dispatch(const std::string& raw_event, uint32_t shard_id) {
+    m_recorder.record(raw_event);
+
+    json frame = json::parse(raw_event, nullptr, false);
+    if (frame.is_discarded() || !frame.is_object()) {
+        return;
+    }
+    auto t = frame.find("t");
+    auto dIt = frame.find("d");
+    if (t == frame.end() || !t->is_string() || dIt == frame.end() || !dIt->is_object()) {
+        return;
+    }
+    const std::string& type = t->get_ref<const std::string&>();
+    const json& d = *dIt;
+    const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+
+    if (type == "MESSAGE_CREATE") {
+        // Ignore bot messages
+        auto author = d.find("author");
+        if (author != d.end() && author->is_object() && author->value("bot", false)) {
+            return;
+        }
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: MESSAGE_CREATE received; queuing Message event");
+        QueuedEvent qe;
+        begin_trace(qe);
+        message_event_from_dispatch(d, qe);
+        index_message(qe.message_data, static_cast<int64_t>(dpp::ts_not_null(&d, "timestamp")));
+        enqueue_event(qe, kJournalMessage, raw_event);
+    } else if (type == "MESSAGE_REACTION_ADD") {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: MESSAGE_REACTION_ADD received; queuing ReactionAdd event");
+        QueuedEvent qe;
+        begin_trace(qe);
+        reaction_event_from_dispatch(d, qe);
+        enqueue_event(qe, kJournalReaction, raw_event);
+    } else if (type == "INTERACTION_CREATE") {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: INTERACTION_CREATE received; queuing interaction event");
+        QueuedEvent qe;
+        begin_trace(qe);
+        queue_interaction(d, qe);
+    } else if (type == "READY") {
+        m_application_id = static_cast<uint64_t>(ready_application_id(d));
+        m_bot_user_id = static_cast<uint64_t>(ready_user_id(d));
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord plugin: READY received; queuing Ready event");
+        QueuedEvent qe;
+        begin_trace(qe);
+        qe.type = DiscordEventType::Ready;
+        enqueue_event(qe, 0, std::string());
+
+        // A (re)identified shard starts without a presence. Restore the current
+        // one on that shard only; the very first ready sets a default presence
+        // so the bot appears online. Users can override this at any time using
+        // the Set Presence node.
+        bool hasPresence = false;
+        {
+            std::lock_guard<std::mutex> lock(m_presence_mutex);
+            hasPresence = !m_last_presence_payload.empty() || m_presence_pending;
+        }
+        if (hasPresence) {
+            resend_presence_to_shard(shard_id);
+        } else {
+            set_presence(dpp::presence(dpp::ps_online, dpp::at_game, "online"));
+        }
+    } else if (type == "MESSAGE_DELETE") {
+        if (cfg.message_index_enabled) {
+            m_message_index.remove(json_snowflake(d, "channel_id"), json_snowflake(d, "id"));
+        }
+    } else if (type == "GUILD_MEMBERS_CHUNK") {
+        // Feeds both the member store and pending Resolve IDs batches
+        if (cfg.member_store_enabled) {
+            m_member_store.ingest_chunk(d);
+        }
+        m_id_resolver.on_members_chunk(d);
+    } else if (type == "GUILD_CREATE") {
+        if (!cfg.member_store_enabled || !cfg.intent_guild_members) {
+            return;
+        }
+        // Empty query with limit 0 asks for the whole member list in chunks
+        json payload = {
+            {"op", 8},
+            {"d", {
+                {"guild_id", json_string(d, "id")},
+                {"query", ""},
+                {"limit", 0},
+                {"presences", false},
+                {"nonce", "rune-store"}
+            }}
+        };
+        send_guild_gateway_payload(json_snowflake(d, "id"), payload.dump());
+    } else if (type == "GUILD_DELETE") {
+        // unavailable=true is an outage, not the bot leaving the guild
+        if (!d.value("unavailable", false)) {
+            const dpp::snowflake guild_id = json_snowflake(d, "id");
+            if (cfg.member_store_enabled) {
+                m_member_store.remove_guild(guild_id);
+            }
+            if (m_snapshot.is_loaded()) {
+                m_snapshot.mark_deleted(guild_id);
+            }
+        }
+    } else if (type == "GUILD_MEMBER_ADD" || type == "GUILD_MEMBER_UPDATE") {
+        if (cfg.member_store_enabled) {
+            m_member_store.upsert_member(d);
+        }
+    } else if (type == "GUILD_MEMBER_REMOVE") {
+        if (cfg.member_store_enabled && d.contains("user") && d["user"].is_object()) {
+            m_member_store.remove_member(json_snowflake(d, "guild_id"), json_snowflake(d["user"], "id"));
+        }
+    } else if (type == "CHANNEL_DELETE") {
+        // Deletions mask the matching snapshot records; creates and updates
+        // need no handling since the live DPP cache is consulted first
+        if (m_snapshot.is_loaded()) {
+            m_snapshot.mark_deleted(json_snowflake(d, "id"));
+        }
+    } else if (type == "GUILD_ROLE_DELETE") {
+        if (m_snapshot.is_loaded()) {
+            m_snapshot.mark_deleted(json_snowflake(d, "role_id"));
+        }
+    }
+}
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+void BotManager::rest_request(RestRoute route, const std::string& method, const std::string& path,
+                              const std::string& body, DiscordTransport::ResponseCallback callback) {
+    DiscordTransport* transport = m_running ? m_transport : nullptr;
+    if (!transport) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, std::string("Discord plugin: ") + rest_route_name(route) +
+            " skipped; bot is not running");
+        if (callback) {
+            callback(TransportResponse());
+        }
+        return;
+    }
+
+    discord_metrics().rest_started(route);
+    const auto started = std::chrono::steady_clock::now();
+    const TraceCall trace = m_tracer.begin_call();
+    transport->request(method, path, body,
+        [this, route, started, trace, callback = std::move(callback)](const TransportResponse& response) {
+            discord_metrics().record_rest(route, response.status, std::chrono::steady_clock::now() - started);
+            record_rate_limit_headers(route, response);
+            m_tracer.end_call(trace, rest_route_name(route));
+            if (callback) {
+                callback(response);
+            } else if (!rest_ok(response)) {
+                DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: ") + rest_route_name(route) +
+                    " failed (status=" + std::to_string(response.status) + "): " + response.body);
+            }
+        });
+}
+
+void BotManager::sample_metrics() {
+    DiscordMetrics& metrics = discord_metrics();
+
+    uint32_t shards = 0;
+    if (m_bot) {
+        for (const auto& entry : m_bot->get_shards()) {
+            const uint32_t id = entry.first;
+            dpp::discord_client* shard = entry.second;
+            if (shard && id < DiscordMetrics::kMaxShards) {
+                metrics.heartbeat_latency_us[id].set(static_cast<int64_t>(shard->websocket_ping * 1e6));
+                metrics.shard_connected[id].set(shard->is_connected() ? 1 : 0);
+            }
+            shards = std::max(shards, id + 1);
+        }
+    }
+    metrics.shard_count.set(shards);
+
+    metrics.cached_users.set(static_cast<int64_t>(dpp::get_user_count()));
+    metrics.cached_guilds.set(static_cast<int64_t>(dpp::get_guild_count()));
+    metrics.cached_channels.set(static_cast<int64_t>(dpp::get_channel_count()));
+    metrics.stored_members.set(static_cast<int64_t>(m_member_store.member_count()));
+    metrics.stored_users.set(static_cast<int64_t>(m_member_store.user_count()));
+    metrics.indexed_messages.set(static_cast<int64_t>(m_message_index.size()));
+    metrics.dm_channels.set(static_cast<int64_t>(m_dm_channels.size()));
+    metrics.fetched_users.set(static_cast<int64_t>(m_user_cache.size()));
+    metrics.fetched_channels.set(static_cast<int64_t>(m_channel_cache.size()));
+    metrics.member_store_bytes.set(static_cast<int64_t>(m_member_store.memory_bytes()));
+    metrics.message_index_bytes.set(static_cast<int64_t>(m_message_index.memory_bytes()));
+}
+
+void BotManager::write_metrics_file() {
+    const std::string& path = GetDiscordPluginConfig().metrics_file_path;
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (out.is_open()) {
+            out << discord_metrics().to_prometheus();
+        }
+        if (!out.is_open() || !out.good()) {
+            if (g_host) {
+                std::string msg = "Discord plugin: cannot write metrics file '" + tmpPath + "'";
+                g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
+            }
+            return;
+        }
+    }
+
+    if (!atomic_replace_file(tmpPath, path) && g_host) {
+        std::string msg = "Discord plugin: cannot rename '" + tmpPath + "' to '" + path + "'";
+        g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
+    }
+}
+
+// ============================================================================
+// In-process transport
+// ============================================================================
+
+// Like a gateway replay, but actions reach the transport instead of being
+// dropped; the persisted caches and journal are left alone
+bool BotManager::start_transport_session() {
+    configure_stores();
+    load_command_state();
+    m_transport = m_installed_transport;
+    m_running = true;
+    if (g_host) {
+        g_host->log(PLUGIN_LOG_LEVEL_INFO,
+            "Discord plugin: running on an in-process transport (no network)");
+    }
+    return true;
+}
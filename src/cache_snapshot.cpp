@@ -0,0 +1,430 @@
+/**
+ * Cache Snapshot - Implementation
+ *
+ * File layout (all integers little-endian):
+ *   header   magic "RSNP", u32 version, u64 created (unix ms), u64 token hash,
+ *            u32 section count, u32 reserved
+ *   sections section count x { u32 kind, u32 record size, u64 offset, u64 count }
+ *   data     string pool and fixed-size record arrays sorted by ID; strings
+ *            are referenced as { u32 offset, u32 length } into the pool
+ */
+
+#include "cache_snapshot.h"
+#include "atomic_file.h"
+#include <algorithm>
+#include <fstream>
+
+static const char kSnapshotMagic[4] = { 'R', 'S', 'N', 'P' };
+static const uint32_t kSnapshotVersion = 1;
+static const size_t kHeaderSize = 32;
+static const size_t kSectionEntrySize = 24;
+
+enum SectionKind : uint32_t {
+    kSectionStrings = 1,
+    kSectionGuilds = 2,
+    kSectionChannels = 3,
+    kSectionRoles = 4,
+    kSectionUsers = 5
+};
+
+// Record sizes; each starts with its u64 ID
+static const size_t kGuildRecordSize = 32;    // id, owner_id, name, member_count, pad
+static const size_t kChannelRecordSize = 48;  // id, guild_id, parent_id, name, topic, type, position
+static const size_t kRoleRecordSize = 40;     // id, guild_id, permissions, name, colour, position
+static const size_t kUserRecordSize = 40;     // id, username, global_name, avatar_url, flags, pad
+
+static const uint32_t kUserFlagBot = 1;
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+static void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+static void patch_u64(std::vector<uint8_t>& out, size_t at, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out[at + i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+uint64_t CacheSnapshot::hash_token(const std::string& token) {
+    uint64_t h = 14695981039346656037ULL;  // FNV-1a
+    for (unsigned char c : token) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// ============================================================================
+// Loading and lookups
+// ============================================================================
+
+bool CacheSnapshot::load(const std::string& path, uint64_t token_hash, std::chrono::seconds max_age, std::string& error) {
+    close();
+
+    if (!m_file.open(path)) {
+        error = "cannot open file";
+        return false;
+    }
+
+    const uint8_t* data = m_file.data();
+    const size_t size = m_file.size();
+    if (size < kHeaderSize || std::char_traits<char>::compare(reinterpret_cast<const char*>(data), kSnapshotMagic, 4) != 0) {
+        error = "not a snapshot file";
+        close();
+        return false;
+    }
+    if (get_u32(data + 4) != kSnapshotVersion) {
+        error = "unsupported snapshot version " + std::to_string(get_u32(data + 4));
+        close();
+        return false;
+    }
+
+    const uint64_t created = get_u64(data + 8);
+    const uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    const uint64_t maxAgeMs = static_cast<uint64_t>(max_age.count()) * 1000;
+    if (created > now + 60000 || now - std::min(now, created) > maxAgeMs) {
+        error = "snapshot is too old or has a future timestamp";
+        close();
+        return false;
+    }
+    if (get_u64(data + 16) != token_hash) {
+        error = "snapshot was written for a different bot token";
+        close();
+        return false;
+    }
+
+    const uint32_t sectionCount = get_u32(data + 24);
+    if (sectionCount > 64 || kHeaderSize + size_t(sectionCount) * kSectionEntrySize > size) {
+        error = "corrupt section table";
+        close();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < sectionCount; ++i) {
+        const uint8_t* entry = data + kHeaderSize + size_t(i) * kSectionEntrySize;
+        const uint32_t kind = get_u32(entry);
+        const uint32_t recordSize = get_u32(entry + 4);
+        const uint64_t offset = get_u64(entry + 8);
+        const uint64_t count = get_u64(entry + 16);
+        if (recordSize == 0 || offset > size || count > (size - offset) / recordSize) {
+            error = "section out of bounds";
+            close();
+            return false;
+        }
+
+        Section section{ data + offset, static_cast<size_t>(count) };
+        switch (kind) {
+            case kSectionStrings:
+                m_strings = data + offset;
+                m_strings_size = static_cast<size_t>(count);
+                break;
+            case kSectionGuilds:
+                if (recordSize != kGuildRecordSize) { error = "bad guild record size"; close(); return false; }
+                m_guilds = section;
+                break;
+            case kSectionChannels:
+                if (recordSize != kChannelRecordSize) { error = "bad channel record size"; close(); return false; }
+                m_channels = section;
+                break;
+            case kSectionRoles:
+                if (recordSize != kRoleRecordSize) { error = "bad role record size"; close(); return false; }
+                m_roles = section;
+                break;
+            case kSectionUsers:
+                if (recordSize != kUserRecordSize) { error = "bad user record size"; close(); return false; }
+                m_users = section;
+                break;
+            default:
+                break;  // unknown sections are skipped
+        }
+    }
+
+    m_created_ms = created;
+    m_loaded = true;
+    return true;
+}
+
+void CacheSnapshot::close() {
+    m_file.close();
+    m_loaded = false;
+    m_created_ms = 0;
+    m_strings = nullptr;
+    m_strings_size = 0;
+    m_guilds = Section();
+    m_channels = Section();
+    m_roles = Section();
+    m_users = Section();
+    std::lock_guard<std::mutex> lock(m_deleted_mutex);
+    m_deleted.clear();
+}
+
+const uint8_t* CacheSnapshot::find_record(const Section& section, size_t record_size, dpp::snowflake id) const {
+    if (!m_loaded) {
+        return nullptr;
+    }
+    const uint64_t key = static_cast<uint64_t>(id);
+    size_t lo = 0;
+    size_t hi = section.count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const uint64_t midId = get_u64(section.records + mid * record_size);
+        if (midId < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < section.count && get_u64(section.records + lo * record_size) == key && !is_deleted(id)) {
+        return section.records + lo * record_size;
+    }
+    return nullptr;
+}
+
+// Out-of-range references read as empty rather than trusting the file
+std::string CacheSnapshot::read_string(const uint8_t* ref) const {
+    const uint32_t offset = get_u32(ref);
+    const uint32_t length = get_u32(ref + 4);
+    if (offset > m_strings_size || length > m_strings_size - offset) {
+        return std::string();
+    }
+    return std::string(reinterpret_cast<const char*>(m_strings + offset), length);
+}
+
+bool CacheSnapshot::is_deleted(dpp::snowflake id) const {
+    std::lock_guard<std::mutex> lock(m_deleted_mutex);
+    return m_deleted.contains(id);
+}
+
+void CacheSnapshot::mark_deleted(dpp::snowflake id) {
+    std::lock_guard<std::mutex> lock(m_deleted_mutex);
+    m_deleted[id] = 1;
+}
+
+bool CacheSnapshot::find_guild(dpp::snowflake id, SnapshotGuild& out) const {
+    const uint8_t* r = find_record(m_guilds, kGuildRecordSize, id);
+    if (!r) {
+        return false;
+    }
+    out.id = get_u64(r);
+    out.owner_id = get_u64(r + 8);
+    out.name = read_string(r + 16);
+    out.member_count = get_u32(r + 24);
+    return true;
+}
+
+bool CacheSnapshot::find_channel(dpp::snowflake id, SnapshotChannel& out) const {
+    const uint8_t* r = find_record(m_channels, kChannelRecordSize, id);
+    if (!r) {
+        return false;
+    }
+    out.id = get_u64(r);
+    out.guild_id = get_u64(r + 8);
+    out.parent_id = get_u64(r + 16);
+    out.name = read_string(r + 24);
+    out.topic = read_string(r + 32);
+    out.type = get_u32(r + 40);
+    out.position = get_u32(r + 44);
+    return true;
+}
+
+bool CacheSnapshot::find_role(dpp::snowflake id, SnapshotRole& out) const {
+    const uint8_t* r = find_record(m_roles, kRoleRecordSize, id);
+    if (!r) {
+        return false;
+    }
+    out.id = get_u64(r);
+    out.guild_id = get_u64(r + 8);
+    out.permissions = get_u64(r + 16);
+    out.name = read_string(r + 24);
+    out.colour = get_u32(r + 32);
+    out.position = get_u32(r + 36);
+    return true;
+}
+
+bool CacheSnapshot::find_user(dpp::snowflake id, SnapshotUser& out) const {
+    const uint8_t* r = find_record(m_users, kUserRecordSize, id);
+    if (!r) {
+        return false;
+    }
+    out.id = get_u64(r);
+    out.username = read_string(r + 8);
+    out.global_name = read_string(r + 16);
+    out.avatar_url = read_string(r + 24);
+    out.is_bot = (get_u32(r + 32) & kUserFlagBot) != 0;
+    return true;
+}
+
+void CacheSnapshot::collect(SnapshotData& out) const {
+    if (!m_loaded) {
+        return;
+    }
+    for (size_t i = 0; i < m_guilds.count; ++i) {
+        SnapshotGuild g;
+        if (find_guild(get_u64(m_guilds.records + i * kGuildRecordSize), g)) out.guilds.push_back(std::move(g));
+    }
+    for (size_t i = 0; i < m_channels.count; ++i) {
+        SnapshotChannel c;
+        if (find_channel(get_u64(m_channels.records + i * kChannelRecordSize), c)) out.channels.push_back(std::move(c));
+    }
+    for (size_t i = 0; i < m_roles.count; ++i) {
+        SnapshotRole r;
+        if (find_role(get_u64(m_roles.records + i * kRoleRecordSize), r)) out.roles.push_back(std::move(r));
+    }
+    for (size_t i = 0; i < m_users.count; ++i) {
+        SnapshotUser u;
+        if (find_user(get_u64(m_users.records + i * kUserRecordSize), u)) out.users.push_back(std::move(u));
+    }
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+namespace {
+
+class StringPool {
+public:
+    void put(std::vector<uint8_t>& out, const std::string& s) {
+        put_u32(out, static_cast<uint32_t>(m_bytes.size()));
+        put_u32(out, static_cast<uint32_t>(s.size()));
+        m_bytes.insert(m_bytes.end(), s.begin(), s.end());
+    }
+    const std::vector<uint8_t>& bytes() const { return m_bytes; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+};
+
+template <typename T>
+void sort_and_dedupe(std::vector<T>& records) {
+    std::stable_sort(records.begin(), records.end(), [](const T& a, const T& b) {
+        return static_cast<uint64_t>(a.id) < static_cast<uint64_t>(b.id);
+    });
+    // Callers list live records first, so the first of each ID wins
+    records.erase(std::unique(records.begin(), records.end(), [](const T& a, const T& b) {
+        return a.id == b.id;
+    }), records.end());
+}
+
+} // namespace
+
+bool CacheSnapshot::save(const std::string& path, SnapshotData& data, uint64_t token_hash, std::string& error) {
+    sort_and_dedupe(data.guilds);
+    sort_and_dedupe(data.channels);
+    sort_and_dedupe(data.roles);
+    sort_and_dedupe(data.users);
+
+    StringPool pool;
+    std::vector<uint8_t> guilds, channels, roles, users;
+    guilds.reserve(data.guilds.size() * kGuildRecordSize);
+    for (const auto& g : data.guilds) {
+        put_u64(guilds, g.id);
+        put_u64(guilds, g.owner_id);
+        pool.put(guilds, g.name);
+        put_u32(guilds, g.member_count);
+        put_u32(guilds, 0);
+    }
+    channels.reserve(data.channels.size() * kChannelRecordSize);
+    for (const auto& c : data.channels) {
+        put_u64(channels, c.id);
+        put_u64(channels, c.guild_id);
+        put_u64(channels, c.parent_id);
+        pool.put(channels, c.name);
+        pool.put(channels, c.topic);
+        put_u32(channels, c.type);
+        put_u32(channels, c.position);
+    }
+    roles.reserve(data.roles.size() * kRoleRecordSize);
+    for (const auto& r : data.roles) {
+        put_u64(roles, r.id);
+        put_u64(roles, r.guild_id);
+        put_u64(roles, r.permissions);
+        pool.put(roles, r.name);
+        put_u32(roles, r.colour);
+        put_u32(roles, r.position);
+    }
+    users.reserve(data.users.size() * kUserRecordSize);
+    for (const auto& u : data.users) {
+        put_u64(users, u.id);
+        pool.put(users, u.username);
+        pool.put(users, u.global_name);
+        pool.put(users, u.avatar_url);
+        put_u32(users, u.is_bot ? kUserFlagBot : 0);
+        put_u32(users, 0);
+    }
+
+    struct Pending {
+        uint32_t kind;
+        uint32_t record_size;
+        const std::vector<uint8_t>* bytes;
+    };
+    const Pending sections[] = {
+        { kSectionStrings, 1, &pool.bytes() },
+        { kSectionGuilds, static_cast<uint32_t>(kGuildRecordSize), &guilds },
+        { kSectionChannels, static_cast<uint32_t>(kChannelRecordSize), &channels },
+        { kSectionRoles, static_cast<uint32_t>(kRoleRecordSize), &roles },
+        { kSectionUsers, static_cast<uint32_t>(kUserRecordSize), &users },
+    };
+    const uint32_t sectionCount = static_cast<uint32_t>(sizeof(sections) / sizeof(sections[0]));
+
+    std::vector<uint8_t> header;
+    header.insert(header.end(), kSnapshotMagic, kSnapshotMagic + 4);
+    put_u32(header, kSnapshotVersion);
+    put_u64(header, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    put_u64(header, token_hash);
+    put_u32(header, sectionCount);
+    put_u32(header, 0);
+
+    // Section data starts 8-byte aligned after the table
+    uint64_t offset = kHeaderSize + sectionCount * kSectionEntrySize;
+    for (const auto& s : sections) {
+        put_u32(header, s.kind);
+        put_u32(header, s.record_size);
+        const size_t at = header.size();
+        put_u64(header, 0);
+        put_u64(header, s.bytes->size() / s.record_size);
+        patch_u64(header, at, offset);
+        offset += (s.bytes->size() + 7) & ~size_t(7);
+    }
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            error = "cannot create '" + tmpPath + "'";
+            return false;
+        }
+        static const char padding[8] = {};
+        out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        for (const auto& s : sections) {
+            out.write(reinterpret_cast<const char*>(s.bytes->data()), static_cast<std::streamsize>(s.bytes->size()));
+            out.write(padding, static_cast<std::streamsize>(((s.bytes->size() + 7) & ~size_t(7)) - s.bytes->size()));
+        }
+        if (!out.good()) {
+            error = "write to '" + tmpPath + "' failed";
+            return false;
+        }
+    }
+
+    if (!atomic_replace_file(tmpPath, path)) {
+        error = "cannot rename '" + tmpPath + "' to '" + path + "'";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,221 @@
+/**
+ * Command Registry - Implementation
+ */
+
+#include "command_registry.h"
+#include "atomic_file.h"
+#include "flow_scanner.h"
+#include "plugin_log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using json = nlohmann::json;
+
+static const int kStateVersion = 1;
+
+// On Slash Command properties as the Discord API wants them
+static SlashCommandDefinition to_definition(const std::string& flow_id, const FlowSlashCommand& command) {
+    SlashCommandDefinition definition;
+    definition.name = command.command;
+    definition.description = command.description.empty() ? command.command : command.description;
+    if (!command.options.empty()) {
+        json parsed = json::parse(command.options, nullptr, false);
+        if (parsed.is_array()) {
+            definition.options = std::move(parsed);
+        } else {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_WARN, "Discord plugin: CommandOptions of slash command '" + command.command +
+                "' in flow '" + flow_id + "' is not a JSON array; registering it without options");
+        }
+    }
+    definition.guild_id = std::strtoull(command.guild_id.c_str(), nullptr, 10);
+    return definition;
+}
+
+void CommandRegistry::add_flow(const std::string& flow_id, const std::string& path) {
+    m_flows[flow_id].path = path;
+    ++m_generation;
+}
+
+size_t CommandRegistry::size() const {
+    size_t count = 0;
+    for (const auto& flow : m_flows) {
+        count += flow.second.definitions.size();
+    }
+    return count;
+}
+
+std::set<uint64_t> CommandRegistry::defined_scopes() const {
+    std::set<uint64_t> scopes;
+    for (const auto& flow : m_flows) {
+        for (const SlashCommandDefinition& definition : flow.second.definitions) {
+            scopes.insert(static_cast<uint64_t>(definition.guild_id));
+        }
+    }
+    return scopes;
+}
+
+void CommandRegistry::scan_flows() {
+    const std::set<uint64_t> before = defined_scopes();
+    for (auto& entry : m_flows) {
+        Flow& flow = entry.second;
+        const std::shared_ptr<const FlowScan> scan = flow_scanner().scan(flow.path);
+        if (!scan->opened) {
+            flow.definitions.clear();
+        } else if (scan->ok()) {
+            flow.definitions.clear();
+            for (const FlowSlashCommand& command : scan->slash_commands) {
+                flow.definitions.push_back(to_definition(entry.first, command));
+            }
+        } else {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_WARN, "Discord plugin: keeping the slash commands of flow '" + entry.first +
+                "'; its flow.json could not be parsed: " + scan->error);
+        }
+    }
+
+    const std::set<uint64_t> after = defined_scopes();
+    for (uint64_t scope : before) {
+        if (after.count(scope) == 0) {
+            m_vacated.insert(scope);
+        }
+    }
+    for (uint64_t scope : after) {
+        m_vacated.erase(scope);
+    }
+}
+
+uint64_t CommandRegistry::fnv1a(const std::string& data) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string CommandRegistry::scope_key(dpp::snowflake application_id, dpp::snowflake guild_id) {
+    return std::to_string(static_cast<uint64_t>(application_id)) + ":" +
+           std::to_string(static_cast<uint64_t>(guild_id));
+}
+
+std::vector<CommandRegistry::Registration> CommandRegistry::changed(dpp::snowflake application_id) const {
+    // guild -> name -> definition. Several nodes may define the same command;
+    // the first by flow id, then by position in the flow, wins.
+    std::map<uint64_t, std::map<std::string, const SlashCommandDefinition*>> scopes;
+    for (const auto& flow : m_flows) {
+        for (const SlashCommandDefinition& definition : flow.second.definitions) {
+            scopes[static_cast<uint64_t>(definition.guild_id)].emplace(definition.name, &definition);
+        }
+    }
+    // Scopes whose flow files dropped every command they defined are cleared;
+    // a registered scope no loaded flow has defined is left alone
+    for (uint64_t scope : m_vacated) {
+        scopes[scope];
+    }
+
+    std::vector<Registration> result;
+    for (const auto& scope : scopes) {
+        json commands = json::array();
+        for (const auto& command : scope.second) {
+            json item = {
+                {"name", command.second->name},
+                {"description", command.second->description},
+                {"type", 1}
+            };
+            if (command.second->options.is_array() && !command.second->options.empty()) {
+                item["options"] = command.second->options;
+            }
+            commands.push_back(std::move(item));
+        }
+
+        Registration registration;
+        registration.guild_id = scope.first;
+        registration.body = commands.dump();
+        registration.hash = fnv1a(registration.body);
+        registration.count = commands.size();
+
+        const std::string key = scope_key(application_id, registration.guild_id);
+        auto inFlight = m_in_flight.find(key);
+        if (inFlight != m_in_flight.end() && inFlight->second == registration.hash) {
+            continue;
+        }
+        auto registered = m_registered.find(key);
+        const bool known = registered != m_registered.end();
+        if ((known && registered->second == registration.hash) || (!known && registration.count == 0)) {
+            continue;
+        }
+        result.push_back(std::move(registration));
+    }
+    return result;
+}
+
+void CommandRegistry::begin(dpp::snowflake application_id, const Registration& registration) {
+    m_in_flight[scope_key(application_id, registration.guild_id)] = registration.hash;
+}
+
+void CommandRegistry::registered(dpp::snowflake application_id, const Registration& registration) {
+    const std::string key = scope_key(application_id, registration.guild_id);
+    auto inFlight = m_in_flight.find(key);
+    if (inFlight != m_in_flight.end() && inFlight->second == registration.hash) {
+        m_in_flight.erase(inFlight);
+    }
+    m_registered[key] = registration.hash;
+}
+
+void CommandRegistry::failed(dpp::snowflake application_id, const Registration& registration) {
+    const std::string key = scope_key(application_id, registration.guild_id);
+    auto inFlight = m_in_flight.find(key);
+    if (inFlight != m_in_flight.end() && inFlight->second == registration.hash) {
+        m_in_flight.erase(inFlight);
+    }
+}
+
+bool CommandRegistry::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return true;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    json state = json::parse(text.str(), nullptr, false);
+    if (state.is_discarded() || !state.is_object() || state.value("version", 0) != kStateVersion) {
+        return false;
+    }
+    auto scopes = state.find("scopes");
+    if (scopes == state.end() || !scopes->is_object()) {
+        return false;
+    }
+
+    m_registered.clear();
+    for (auto it = scopes->begin(); it != scopes->end(); ++it) {
+        if (it.value().is_string()) {
+            m_registered[it.key()] = std::strtoull(it.value().get_ref<const std::string&>().c_str(), nullptr, 16);
+        }
+    }
+    return true;
+}
+
+bool CommandRegistry::save(const std::string& path) const {
+    json scopes = json::object();
+    for (const auto& entry : m_registered) {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(entry.second));
+        scopes[entry.first] = hex;
+    }
+    const json state = { {"version", kStateVersion}, {"scopes", std::move(scopes)} };
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << state.dump(2);
+        if (!out.good()) {
+            return false;
+        }
+    }
+
+    return atomic_replace_file(tmpPath, path);
+}
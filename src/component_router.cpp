@@ -0,0 +1,172 @@
+/**
+ * Component Router - Implementation
+ */
+
+#include "component_router.h"
+#include "plugin_log.h"
+#include <algorithm>
+#include <utility>
+
+const char ComponentRouter::kSeparator;
+const size_t ComponentRouter::kWheelSlots;
+
+void ComponentRouter::split(const std::string& custom_id, std::string& prefix, std::string& state) {
+    const size_t separator = custom_id.find(kSeparator);
+    if (separator == std::string::npos) {
+        prefix = custom_id;
+        state.clear();
+    } else {
+        prefix.assign(custom_id, 0, separator);
+        state.assign(custom_id, separator + 1, std::string::npos);
+    }
+}
+
+ComponentRouter::Handle ComponentRouter::add_route(const std::string& prefix, bool message_bound,
+                                                   ClickCallback on_click, ExpiryCallback on_expired) {
+    if (prefix.empty() || prefix.find(kSeparator) != std::string::npos || m_routes.count(prefix) > 0) {
+        return 0;
+    }
+    Route route;
+    route.handle = m_next_handle++;
+    route.message_bound = message_bound;
+    route.on_click = std::move(on_click);
+    route.on_expired = std::move(on_expired);
+    m_prefixes.emplace(route.handle, prefix);
+    const Handle handle = route.handle;
+    m_routes.emplace(prefix, std::move(route));
+    return handle;
+}
+
+void ComponentRouter::remove_route(Handle handle) {
+    auto prefix = m_prefixes.find(handle);
+    if (prefix == m_prefixes.end()) {
+        return;
+    }
+    m_routes.erase(prefix->second);
+    m_prefixes.erase(prefix);
+    // Wheel entries of these bindings find nothing when they come due
+    for (auto it = m_bindings.begin(); it != m_bindings.end();) {
+        if (it->first.route == handle) {
+            it = m_bindings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+uint64_t ComponentRouter::wheel_tick(Clock::time_point now) const {
+    if (now <= m_origin) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(now - m_origin).count());
+}
+
+bool ComponentRouter::bind(dpp::snowflake message_id, const std::string& prefix, std::chrono::seconds ttl,
+                           Clock::time_point now) {
+    auto route = m_routes.find(prefix);
+    if (route == m_routes.end()) {
+        return false;
+    }
+
+    Binding& binding = m_bindings[BindingKey{ static_cast<uint64_t>(message_id), route->second.handle }];
+    binding.seq = m_next_seq++;
+    binding.deadline = 0;
+    if (ttl.count() <= 0) {
+        return true;
+    }
+
+    if (!m_wheel_started) {
+        m_wheel.assign(kWheelSlots, std::vector<WheelEntry>());
+        m_origin = now;
+        m_tick = 0;
+        m_wheel_started = true;
+    }
+    // advance() never moves past the current tick, so the deadline is ahead of it
+    binding.deadline = std::max(wheel_tick(now), m_tick) + static_cast<uint64_t>(ttl.count());
+    m_wheel[binding.deadline % kWheelSlots].push_back(
+        WheelEntry{ BindingKey{ static_cast<uint64_t>(message_id), route->second.handle }, binding.deadline,
+                    binding.seq });
+    return true;
+}
+
+ComponentRouter::Result ComponentRouter::route(const ComponentEventData& event) const {
+    std::string prefix;
+    std::string state;
+    split(event.custom_id, prefix, state);
+
+    auto route = m_routes.find(prefix);
+    if (route == m_routes.end()) {
+        return Result::NoRoute;
+    }
+    if (route->second.message_bound &&
+        m_bindings.count(BindingKey{ static_cast<uint64_t>(event.message_id), route->second.handle }) == 0) {
+        return Result::NotBound;
+    }
+    // The callback runs a flow, which may add or remove routes
+    const ClickCallback callback = route->second.on_click;
+    if (callback) {
+        callback(event, state);
+    }
+    return Result::Routed;
+}
+
+void ComponentRouter::advance(Clock::time_point now) {
+    if (!m_wheel_started) {
+        return;
+    }
+    const uint64_t target = wheel_tick(now);
+    if (target <= m_tick) {
+        return;
+    }
+
+    // Each slot is visited at most once: after a long stall one revolution
+    // covers every deadline up to target
+    std::vector<std::pair<Handle, uint64_t>> expired;
+    const uint64_t steps = std::min<uint64_t>(target - m_tick, kWheelSlots);
+    for (uint64_t step = 1; step <= steps; ++step) {
+        std::vector<WheelEntry>& slot = m_wheel[(m_tick + step) % kWheelSlots];
+        size_t kept = 0;
+        for (size_t i = 0; i < slot.size(); ++i) {
+            const WheelEntry& entry = slot[i];
+            if (entry.deadline > target) {
+                slot[kept++] = entry;  // a later revolution
+                continue;
+            }
+            auto binding = m_bindings.find(entry.key);
+            if (binding != m_bindings.end() && binding->second.seq == entry.seq) {
+                m_bindings.erase(binding);
+                expired.emplace_back(entry.key.route, entry.key.message_id);
+            }
+        }
+        slot.resize(kept);
+    }
+    m_tick = target;
+
+    for (const auto& item : expired) {
+        auto prefix = m_prefixes.find(item.first);
+        if (prefix == m_prefixes.end()) {
+            continue;  // removed by an earlier expiry callback
+        }
+        const ExpiryCallback callback = m_routes[prefix->second].on_expired;
+        if (!callback) {
+            continue;
+        }
+        try {
+            callback(item.second);
+        } catch (const std::exception& e) {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, std::string("Discord plugin: exception in component expiry: ") + e.what());
+        } catch (...) {
+            DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR,
+                "Discord plugin: unknown exception in component expiry");
+        }
+    }
+}
+
+void ComponentRouter::clear() {
+    m_routes.clear();
+    m_prefixes.clear();
+    m_bindings.clear();
+    m_wheel.clear();
+    m_wheel_started = false;
+    m_tick = 0;
+}
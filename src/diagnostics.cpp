@@ -0,0 +1,128 @@
+/**
+ * Diagnostics - Implementation
+ */
+
+#include "diagnostics.h"
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include <cstdarg>
+#include <cstdio>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::chrono::seconds DiagnosticsPanel::kLiveInterval;
+
+DiagnosticsPanel& diagnostics_panel() {
+    static DiagnosticsPanel panel;
+    return panel;
+}
+
+static void appendf(std::string& out, const char* format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    out += line;
+}
+
+static double mib(int64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+std::string DiagnosticsPanel::render() {
+    const DiscordMetrics& metrics = discord_metrics();
+    BotManager& bot = BotManager::instance();
+
+    const Clock::time_point now = Clock::now();
+    const double elapsed = m_rendered ? std::chrono::duration<double>(now - m_last_render).count() : 0.0;
+    auto rate = [elapsed](uint64_t current, uint64_t previous) {
+        return elapsed > 0.0 ? static_cast<double>(current - previous) / elapsed : 0.0;
+    };
+
+    std::string out;
+    out.reserve(2048);
+    const int64_t shards = metrics.shard_count.value();
+    appendf(out, "Discord diagnostics: %s, %lld shard(s)\n",
+            !bot.is_running() ? "stopped" : bot.is_replaying() ? "replaying" : "running",
+            static_cast<long long>(shards));
+    for (int64_t i = 0; i < shards && static_cast<size_t>(i) < DiscordMetrics::kMaxShards; ++i) {
+        appendf(out, "  shard %lld: %s, heartbeat %.1f ms\n", static_cast<long long>(i),
+                metrics.shard_connected[i].value() ? "connected" : "disconnected",
+                static_cast<double>(metrics.heartbeat_latency_us[i].value()) / 1000.0);
+    }
+
+    out += "Events/s:";
+    for (size_t i = 0; i < DiscordMetrics::kEventTypes; ++i) {
+        const uint64_t received = metrics.events_received[i].value();
+        appendf(out, " %s %.1f", event_type_name(i), rate(received, m_last_received[i]));
+        m_last_received[i] = received;
+    }
+    const uint64_t dropped = metrics.total_dropped();
+    appendf(out, " (dropped %llu, %.1f/s)\n", static_cast<unsigned long long>(dropped), rate(dropped, m_last_dropped));
+    m_last_dropped = dropped;
+
+    appendf(out, "Queue: %lld waiting, last tick %lld, dispatch p50 %.2f ms p99 %.2f ms\n",
+            static_cast<long long>(metrics.queue_depth.value()),
+            static_cast<long long>(metrics.last_tick_events.value()),
+            static_cast<double>(metrics.dispatch_latency.percentile_us(0.50)) / 1000.0,
+            static_cast<double>(metrics.dispatch_latency.percentile_us(0.99)) / 1000.0);
+
+    appendf(out, "Interactions: %lld pending, %llu auto-deferred\n",
+            static_cast<long long>(metrics.pending_interactions.value()),
+            static_cast<unsigned long long>(metrics.interactions_auto_deferred.value()));
+
+    uint64_t restTotal = 0;
+    for (const auto& route : metrics.rest) {
+        restTotal += route.requests.value();
+    }
+    appendf(out, "REST: %.1f req/s\n", rate(restTotal, m_last_rest));
+    m_last_rest = restTotal;
+    for (size_t i = 0; i < static_cast<size_t>(RestRoute::Count); ++i) {
+        const DiscordMetrics::Rest& r = metrics.rest[i];
+        if (r.requests.value() == 0 && r.in_flight.value() == 0) {
+            continue;
+        }
+        appendf(out, "  %s: %lld in flight, ", rest_route_name(static_cast<RestRoute>(i)),
+                static_cast<long long>(r.in_flight.value()));
+        if (r.bucket_remaining.value() >= 0) {
+            appendf(out, "bucket %lld left (reset in %lld ms), ", static_cast<long long>(r.bucket_remaining.value()),
+                    static_cast<long long>(r.bucket_reset_after_ms.value()));
+        }
+        appendf(out, "%llu req, %llu err, %llu 429, p99 %.1f ms\n", static_cast<unsigned long long>(r.requests.value()),
+                static_cast<unsigned long long>(r.errors.value()), static_cast<unsigned long long>(r.rate_limited.value()),
+                static_cast<double>(r.latency.percentile_us(0.99)) / 1000.0);
+    }
+
+    appendf(out, "Caches: users %lld, guilds %lld, channels %lld, dm channels %lld, fetched %lld/%lld\n",
+            static_cast<long long>(metrics.cached_users.value()), static_cast<long long>(metrics.cached_guilds.value()),
+            static_cast<long long>(metrics.cached_channels.value()), static_cast<long long>(metrics.dm_channels.value()),
+            static_cast<long long>(metrics.fetched_users.value()),
+            static_cast<long long>(metrics.fetched_channels.value()));
+    appendf(out, "  member store %lld members (%.1f MiB), message index %lld messages (%.1f MiB)",
+            static_cast<long long>(metrics.stored_members.value()), mib(metrics.member_store_bytes.value()),
+            static_cast<long long>(metrics.indexed_messages.value()), mib(metrics.message_index_bytes.value()));
+
+    m_last_render = now;
+    m_rendered = true;
+    return out;
+}
+
+void DiagnosticsPanel::set_live(bool live) {
+    m_live = live;
+    // First live render on the next tick
+    m_next_live = Clock::now();
+}
+
+void DiagnosticsPanel::tick() {
+    if (!m_live || !g_host) {
+        return;
+    }
+    const Clock::time_point now = Clock::now();
+    if (now < m_next_live) {
+        return;
+    }
+    m_next_live = now + kLiveInterval;
+    const std::string report = render();
+    g_host->log(PLUGIN_LOG_LEVEL_INFO, report.c_str());
+}
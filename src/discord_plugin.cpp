@@ -4,8 +4,11 @@
 
 #include "discord_plugin.h"
 #include "bot_manager.h"
+#include "plugin_log.h"
+#include "node_profiler.h"
+#include "diagnostics.h"
+#include "flow_scanner.h"
 #include <nlohmann/json.hpp>
-#include <fstream>
 
 using json = nlohmann::json;
 
@@ -43,7 +46,55 @@ static DiscordPluginConfig g_DiscordConfig{
 
     // Convenience toggles
     false, // enable_message_content_intent
-    true   // enable_dpp_logging
+    true,  // enable_dpp_logging
+
+    std::string("info"),    // log_level
+    std::string("warning"), // dpp_log_min_severity
+    20,                     // log_rate_limit
+
+    5000,  // presence_debounce_ms
+
+    4096,          // dm_cache_capacity
+    std::string(), // dm_cache_path
+
+    300000, // entity_cache_ttl_ms
+    30000,  // entity_cache_negative_ttl_ms
+    50000,  // entity_cache_capacity
+
+    8,      // rest_max_concurrency
+
+    false,  // member_store_enabled
+
+    std::string(), // snapshot_path
+    86400,         // snapshot_max_age_s
+    100000,        // snapshot_max_users
+
+    false,            // message_index_enabled
+    1000000,          // message_index_max_messages
+    256,              // message_index_max_mb
+    86400,            // message_index_window_s
+    std::string("oldest"), // message_index_eviction
+
+    std::string(), // journal_dir
+    16,            // journal_segment_mb
+    64,            // journal_max_segments
+    true,          // journal_recover
+
+    std::string(), // gateway_record_path
+    std::string(), // gateway_replay_path
+    1,             // gateway_replay_speed
+    1000,          // gateway_replay_batch
+
+    std::string(), // metrics_file_path
+    15000,         // metrics_interval_ms
+
+    0,             // trace_sample_rate
+    65536,         // trace_buffer_spans
+
+    false,         // profile_nodes
+
+    2000,          // interaction_auto_defer_ms
+    std::string()  // command_state_path
 };
 
 static void Discord_UpdateConfigFromJson(const char* settings_json)
@@ -76,6 +127,40 @@ static void Discord_UpdateConfigFromJson(const char* settings_json)
 
     g_DiscordConfig.enable_message_content_intent = false;
     g_DiscordConfig.enable_dpp_logging = true;
+    g_DiscordConfig.log_level = "info";
+    g_DiscordConfig.dpp_log_min_severity = "warning";
+    g_DiscordConfig.log_rate_limit = 20;
+    g_DiscordConfig.presence_debounce_ms = 5000;
+    g_DiscordConfig.dm_cache_capacity = 4096;
+    g_DiscordConfig.dm_cache_path.clear();
+    g_DiscordConfig.entity_cache_ttl_ms = 300000;
+    g_DiscordConfig.entity_cache_negative_ttl_ms = 30000;
+    g_DiscordConfig.entity_cache_capacity = 50000;
+    g_DiscordConfig.rest_max_concurrency = 8;
+    g_DiscordConfig.member_store_enabled = false;
+    g_DiscordConfig.snapshot_path.clear();
+    g_DiscordConfig.snapshot_max_age_s = 86400;
+    g_DiscordConfig.snapshot_max_users = 100000;
+    g_DiscordConfig.message_index_enabled = false;
+    g_DiscordConfig.message_index_max_messages = 1000000;
+    g_DiscordConfig.message_index_max_mb = 256;
+    g_DiscordConfig.message_index_window_s = 86400;
+    g_DiscordConfig.message_index_eviction = "oldest";
+    g_DiscordConfig.journal_dir.clear();
+    g_DiscordConfig.journal_segment_mb = 16;
+    g_DiscordConfig.journal_max_segments = 64;
+    g_DiscordConfig.journal_recover = true;
+    g_DiscordConfig.gateway_record_path.clear();
+    g_DiscordConfig.gateway_replay_path.clear();
+    g_DiscordConfig.gateway_replay_speed = 1;
+    g_DiscordConfig.gateway_replay_batch = 1000;
+    g_DiscordConfig.metrics_file_path.clear();
+    g_DiscordConfig.metrics_interval_ms = 15000;
+    g_DiscordConfig.trace_sample_rate = 0;
+    g_DiscordConfig.trace_buffer_spans = 65536;
+    g_DiscordConfig.profile_nodes = false;
+    g_DiscordConfig.interaction_auto_defer_ms = 2000;
+    g_DiscordConfig.command_state_path.clear();
 
     if (!settings_json || !*settings_json)
         return;
@@ -143,6 +228,176 @@ static void Discord_UpdateConfigFromJson(const char* settings_json)
         {
             g_DiscordConfig.enable_dpp_logging = j["enable_dpp_logging"].get<bool>();
         }
+
+        if (j.contains("log_level") && j["log_level"].is_string())
+        {
+            g_DiscordConfig.log_level = j["log_level"].get<std::string>();
+        }
+
+        if (j.contains("dpp_log_min_severity") && j["dpp_log_min_severity"].is_string())
+        {
+            g_DiscordConfig.dpp_log_min_severity = j["dpp_log_min_severity"].get<std::string>();
+        }
+
+        if (j.contains("log_rate_limit") && j["log_rate_limit"].is_number_unsigned())
+        {
+            g_DiscordConfig.log_rate_limit = j["log_rate_limit"].get<uint32_t>();
+        }
+
+        if (j.contains("presence_debounce_ms") && j["presence_debounce_ms"].is_number_unsigned())
+        {
+            g_DiscordConfig.presence_debounce_ms = j["presence_debounce_ms"].get<uint32_t>();
+        }
+
+        if (j.contains("dm_cache_capacity") && j["dm_cache_capacity"].is_number_unsigned())
+        {
+            g_DiscordConfig.dm_cache_capacity = j["dm_cache_capacity"].get<uint32_t>();
+        }
+
+        if (j.contains("dm_cache_path") && j["dm_cache_path"].is_string())
+        {
+            g_DiscordConfig.dm_cache_path = j["dm_cache_path"].get<std::string>();
+        }
+
+        if (j.contains("entity_cache_ttl_ms") && j["entity_cache_ttl_ms"].is_number_unsigned())
+        {
+            g_DiscordConfig.entity_cache_ttl_ms = j["entity_cache_ttl_ms"].get<uint32_t>();
+        }
+
+        if (j.contains("entity_cache_negative_ttl_ms") && j["entity_cache_negative_ttl_ms"].is_number_unsigned())
+        {
+            g_DiscordConfig.entity_cache_negative_ttl_ms = j["entity_cache_negative_ttl_ms"].get<uint32_t>();
+        }
+
+        if (j.contains("entity_cache_capacity") && j["entity_cache_capacity"].is_number_unsigned())
+        {
+            g_DiscordConfig.entity_cache_capacity = j["entity_cache_capacity"].get<uint32_t>();
+        }
+
+        if (j.contains("rest_max_concurrency") && j["rest_max_concurrency"].is_number_unsigned())
+        {
+            g_DiscordConfig.rest_max_concurrency = j["rest_max_concurrency"].get<uint32_t>();
+        }
+
+        if (j.contains("member_store_enabled") && j["member_store_enabled"].is_boolean())
+        {
+            g_DiscordConfig.member_store_enabled = j["member_store_enabled"].get<bool>();
+        }
+
+        if (j.contains("snapshot_path") && j["snapshot_path"].is_string())
+        {
+            g_DiscordConfig.snapshot_path = j["snapshot_path"].get<std::string>();
+        }
+
+        if (j.contains("snapshot_max_age_s") && j["snapshot_max_age_s"].is_number_unsigned())
+        {
+            g_DiscordConfig.snapshot_max_age_s = j["snapshot_max_age_s"].get<uint32_t>();
+        }
+
+        if (j.contains("snapshot_max_users") && j["snapshot_max_users"].is_number_unsigned())
+        {
+            g_DiscordConfig.snapshot_max_users = j["snapshot_max_users"].get<uint32_t>();
+        }
+
+        if (j.contains("message_index_enabled") && j["message_index_enabled"].is_boolean())
+        {
+            g_DiscordConfig.message_index_enabled = j["message_index_enabled"].get<bool>();
+        }
+
+        if (j.contains("message_index_max_messages") && j["message_index_max_messages"].is_number_unsigned())
+        {
+            g_DiscordConfig.message_index_max_messages = j["message_index_max_messages"].get<uint32_t>();
+        }
+
+        if (j.contains("message_index_max_mb") && j["message_index_max_mb"].is_number_unsigned())
+        {
+            g_DiscordConfig.message_index_max_mb = j["message_index_max_mb"].get<uint32_t>();
+        }
+
+        if (j.contains("message_index_window_s") && j["message_index_window_s"].is_number_unsigned())
+        {
+            g_DiscordConfig.message_index_window_s = j["message_index_window_s"].get<uint32_t>();
+        }
+
+        if (j.contains("message_index_eviction") && j["message_index_eviction"].is_string())
+        {
+            g_DiscordConfig.message_index_eviction = j["message_index_eviction"].get<std::string>();
+        }
+
+        if (j.contains("journal_dir") && j["journal_dir"].is_string())
+        {
+            g_DiscordConfig.journal_dir = j["journal_dir"].get<std::string>();
+        }
+
+        if (j.contains("journal_segment_mb") && j["journal_segment_mb"].is_number_unsigned())
+        {
+            g_DiscordConfig.journal_segment_mb = j["journal_segment_mb"].get<uint32_t>();
+        }
+
+        if (j.contains("journal_max_segments") && j["journal_max_segments"].is_number_unsigned())
+        {
+            g_DiscordConfig.journal_max_segments = j["journal_max_segments"].get<uint32_t>();
+        }
+
+        if (j.contains("journal_recover") && j["journal_recover"].is_boolean())
+        {
+            g_DiscordConfig.journal_recover = j["journal_recover"].get<bool>();
+        }
+
+        if (j.contains("gateway_record_path") && j["gateway_record_path"].is_string())
+        {
+            g_DiscordConfig.gateway_record_path = j["gateway_record_path"].get<std::string>();
+        }
+
+        if (j.contains("gateway_replay_path") && j["gateway_replay_path"].is_string())
+        {
+            g_DiscordConfig.gateway_replay_path = j["gateway_replay_path"].get<std::string>();
+        }
+
+        if (j.contains("gateway_replay_speed") && j["gateway_replay_speed"].is_number_unsigned())
+        {
+            g_DiscordConfig.gateway_replay_speed = j["gateway_replay_speed"].get<uint32_t>();
+        }
+
+        if (j.contains("gateway_replay_batch") && j["gateway_replay_batch"].is_number_unsigned())
+        {
+            g_DiscordConfig.gateway_replay_batch = j["gateway_replay_batch"].get<uint32_t>();
+        }
+
+        if (j.contains("metrics_file_path") && j["metrics_file_path"].is_string())
+        {
+            g_DiscordConfig.metrics_file_path = j["metrics_file_path"].get<std::string>();
+        }
+
+        if (j.contains("metrics_interval_ms") && j["metrics_interval_ms"].is_number_unsigned())
+        {
+            g_DiscordConfig.metrics_interval_ms = j["metrics_interval_ms"].get<uint32_t>();
+        }
+
+        if (j.contains("trace_sample_rate") && j["trace_sample_rate"].is_number_unsigned())
+        {
+            g_DiscordConfig.trace_sample_rate = j["trace_sample_rate"].get<uint32_t>();
+        }
+
+        if (j.contains("trace_buffer_spans") && j["trace_buffer_spans"].is_number_unsigned())
+        {
+            g_DiscordConfig.trace_buffer_spans = j["trace_buffer_spans"].get<uint32_t>();
+        }
+
+        if (j.contains("profile_nodes") && j["profile_nodes"].is_boolean())
+        {
+            g_DiscordConfig.profile_nodes = j["profile_nodes"].get<bool>();
+        }
+
+        if (j.contains("interaction_auto_defer_ms") && j["interaction_auto_defer_ms"].is_number_unsigned())
+        {
+            g_DiscordConfig.interaction_auto_defer_ms = j["interaction_auto_defer_ms"].get<uint32_t>();
+        }
+
+        if (j.contains("command_state_path") && j["command_state_path"].is_string())
+        {
+            g_DiscordConfig.command_state_path = j["command_state_path"].get<std::string>();
+        }
     }
     catch (const std::exception& e)
     {
@@ -280,20 +535,17 @@ static void EnsureDiscordBotConnectedFromConfig()
     if (BotManager::instance().is_running())
         return;
 
+    // A gateway replay runs offline and needs no token
     std::string token = ResolveDiscordToken(nullptr);
-    if (token.empty())
+    if (token.empty() && g_DiscordConfig.gateway_replay_path.empty())
     {
         g_host->log(PLUGIN_LOG_LEVEL_ERROR,
             "Discord plugin: auto_connect is enabled but no Discord token is configured (settings/env)");
         return;
     }
 
-    {
-        std::string msg = "Discord plugin: auto-connect helper resolved token (length=";
-        msg += std::to_string(token.size());
-        msg += ")";
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG, msg.c_str());
-    }
+    DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+        "Discord plugin: auto-connect helper resolved token (length=" + std::to_string(token.size()) + ")");
 
     if (BotManager::instance().initialize(token))
     {
@@ -312,65 +564,37 @@ void Discord_EnsureAutoConnectFromConfig()
     EnsureDiscordBotConnectedFromConfig();
 }
 
-// Helper: check if a given flow JSON contains any Discord On Ready nodes
+// Helper: check if a given flow JSON contains any Discord On Ready nodes. The
+// first lookup in a flows directory scans all of its flows in parallel; after
+// that a flow is only rescanned when its flow.json changes.
 static bool FlowHasDiscordOnReadyNode(const std::string& flowsDir, const std::string& flowId)
 {
     if (flowsDir.empty() || flowId.empty())
         return false;
 
-    std::string path = flowsDir;
-    if (!path.empty() && path.back() != '\\' && path.back() != '/')
+    static std::string s_PrescannedFlowsDir;
+    if (s_PrescannedFlowsDir != flowsDir)
     {
-#if defined(_WIN32)
-        path += '\\';
-#else
-        path += '/';
-#endif
+        s_PrescannedFlowsDir = flowsDir;
+        const size_t scanned = flow_scanner().prescan(flowsDir);
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
+            "Discord_OnFlowLoaded: prescanned " + std::to_string(scanned) + " flow(s) in '" + flowsDir + "'");
     }
-    path += flowId;
-    path += "/flow.json";
 
-    try
-    {
-        std::ifstream file(path);
-        if (!file.is_open())
-        {
-            if (g_host)
-            {
-                std::string msg = "Discord_OnFlowLoaded: could not open flow.json at '" + path + "'";
-                g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
-            }
-            return false;
-        }
-
-        json j;
-        file >> j;
-
-        if (!j.contains("nodes") || !j["nodes"].is_array())
-            return false;
-
-        for (const auto& node : j["nodes"])
-        {
-            if (node.contains("type") && node["type"].is_string())
-            {
-                const std::string type = node["type"].get<std::string>();
-                if (type == "com.rune.discord.on_ready")
-                {
-                    return true;
-                }
-            }
-        }
-    }
-    catch (const std::exception& e)
+    const std::shared_ptr<const FlowScan> scan = flow_scanner().scan(FlowScanner::flow_path(flowsDir, flowId));
+    if (!scan->ok())
     {
         if (g_host)
         {
-            std::string msg = std::string("Discord_OnFlowLoaded: exception while parsing flow.json: ") + e.what();
-            g_host->log(PLUGIN_LOG_LEVEL_ERROR, msg.c_str());
+            std::string msg = scan->opened
+                ? "Discord_OnFlowLoaded: error while parsing flow.json: " + scan->error
+                : "Discord_OnFlowLoaded: " + scan->error;
+            g_host->log(scan->opened ? PLUGIN_LOG_LEVEL_ERROR : PLUGIN_LOG_LEVEL_WARN, msg.c_str());
         }
+        return false;
     }
 
-    return false;
+    return scan->has("com.rune.discord.on_ready");
 }
 
 static void Discord_OnFlowLoaded(const char* flow_id)
@@ -381,38 +605,48 @@ static void Discord_OnFlowLoaded(const char* flow_id)
     std::string flowId = flow_id ? flow_id : "";
     if (flowId.empty())
     {
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
             "Discord_OnFlowLoaded: called with empty flow id, skipping");
         return;
     }
 
+    // Nodes the host starts listening while this runs belong to flowId
+    NodeProfiler::FlowLoad profilerFlow(NodeProfiler::instance(), flowId);
+
+    // Slash commands are registered from the flow files, not from the nodes
+    // that happen to be listening
+    const char* flowsDirSetting = RUNE_GET_SETTING(g_host, "flows_directory");
+    if (flowsDirSetting && flowsDirSetting[0])
+    {
+        BotManager::instance().commands().add_flow(flowId, FlowScanner::flow_path(flowsDirSetting, flowId));
+    }
+
     if (!g_DiscordConfig.auto_connect)
     {
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
             "Discord_OnFlowLoaded: auto_connect is false, skipping auto-connect for flow");
         return;
     }
 
     if (BotManager::instance().is_running())
     {
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
             "Discord_OnFlowLoaded: bot already running, skipping auto-connect");
         return;
     }
 
-    const char* flowsDirC = RUNE_GET_SETTING(g_host, "flows_directory");
-    if (!flowsDirC || !flowsDirC[0])
+    if (!flowsDirSetting || !flowsDirSetting[0])
     {
         g_host->log(PLUGIN_LOG_LEVEL_WARN,
             "Discord_OnFlowLoaded: flows_directory setting not available; cannot inspect flow for On Ready nodes");
         return;
     }
 
-    std::string flowsDir(flowsDirC);
+    std::string flowsDir(flowsDirSetting);
 
     if (!FlowHasDiscordOnReadyNode(flowsDir, flowId))
     {
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG,
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG,
             "Discord_OnFlowLoaded: flow has no com.rune.discord.on_ready nodes; skipping auto-connect");
         return;
     }
@@ -423,11 +657,22 @@ static void Discord_OnFlowLoaded(const char* flow_id)
     Discord_EnsureAutoConnectFromConfig();
 }
 
+// An unloaded flow keeps its slash commands: its flow file still defines them
+static void Discord_OnFlowUnloaded(const char* flow_id)
+{
+    if (flow_id && flow_id[0])
+    {
+        NodeProfiler::instance().flow_unloaded(flow_id);
+    }
+}
+
 // Node registration wrapper functions
 void register_event_nodes(PluginNodeRegistry* reg) {
     register_on_ready_node(reg);
     register_on_message_node(reg);
     register_on_reaction_node(reg);
+    register_on_slash_command_node(reg);
+    register_on_component_node(reg);
 }
 
 void register_action_nodes(PluginNodeRegistry* reg) {
@@ -435,14 +680,29 @@ void register_action_nodes(PluginNodeRegistry* reg) {
     register_send_message_node(reg);
     register_send_embed_node(reg);
     register_reply_to_message_node(reg);
+    register_respond_to_interaction_node(reg);
+    register_bind_component_message_node(reg);
     register_send_direct_message_node(reg);
     register_set_presence_node(reg);
+    register_send_via_webhook_node(reg);
+    register_replay_journal_node(reg);
+    register_dump_trace_node(reg);
+    register_dump_node_profile_node(reg);
 }
 
 void register_data_nodes(PluginNodeRegistry* reg) {
     register_get_user_node(reg);
     register_get_channel_node(reg);
+    register_get_member_node(reg);
+    register_fetch_user_node(reg);
+    register_fetch_channel_node(reg);
+    register_resolve_ids_node(reg);
+    register_search_messages_node(reg);
+    register_match_patterns_node(reg);
+    register_get_discord_stats_node(reg);
     register_build_embed_node(reg);
+    register_embed_to_json_node(reg);
+    register_format_message_node(reg);
 }
 
 static bool on_load(HostServices* host) {
@@ -452,14 +712,18 @@ static bool on_load(HostServices* host) {
     // Load initial settings into config (if available)
     const char* settings_json = RUNE_GET_PLUGIN_SETTINGS(host, "com.rune.discord");
     Discord_UpdateConfigFromJson(settings_json);
+    discord_log_configure(g_DiscordConfig);
+    NodeProfiler::instance().set_enabled(g_DiscordConfig.profile_nodes);
 
     return true;
 }
 
 static void on_register(PluginNodeRegistry* reg, LuauRegistry* luau) {
-    register_event_nodes(reg);
-    register_action_nodes(reg);
-    register_data_nodes(reg);
+    // Nodes go through the profiler so profile_nodes can be switched at runtime
+    PluginNodeRegistry* profiled = NodeProfiler::instance().wrap_registry(reg);
+    register_event_nodes(profiled);
+    register_action_nodes(profiled);
+    register_data_nodes(profiled);
 
     if (g_host) {
         g_host->log(PLUGIN_LOG_LEVEL_INFO, "Discord nodes registered");
@@ -468,11 +732,14 @@ static void on_register(PluginNodeRegistry* reg, LuauRegistry* luau) {
 
 static void on_unload(void) {
     BotManager::instance().shutdown();
+    discord_log_flush(true);
     g_host = nullptr;
 }
 
 static void on_tick(float delta_time) {
     BotManager::instance().tick();
+    diagnostics_panel().tick();
+    discord_log_flush();
 }
 
 static const PluginSettingsSchema* Discord_GetSettingsSchema(void)
@@ -590,6 +857,145 @@ static const PluginSettingsSchema* Discord_GetSettingsSchema(void)
             "\"enable_dpp_logging\":{"
                 "\"type\":\"boolean\","
                 "\"description\":\"Forward internal DPP log messages to the RUNE log\""
+            "},"
+            "\"log_level\":{"
+                "\"type\":\"string\","
+                "\"enum\":[\"debug\",\"info\",\"warn\",\"error\"],"
+                "\"description\":\"Minimum level of plugin log lines; lower-level lines are skipped before they are formatted\""
+            "},"
+            "\"dpp_log_min_severity\":{"
+                "\"type\":\"string\","
+                "\"enum\":[\"trace\",\"debug\",\"info\",\"warning\",\"error\",\"critical\"],"
+                "\"description\":\"Minimum severity of DPP log messages forwarded when enable_dpp_logging is on\""
+            "},"
+            "\"log_rate_limit\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Maximum log lines per call site every 10 seconds; repeats beyond it are summarized (0 disables the limit)\""
+            "},"
+            "\"presence_debounce_ms\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Presence updates within this window (ms) are coalesced; only the latest state is sent. 0 disables coalescing.\""
+            "},"
+            "\"dm_cache_capacity\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Maximum number of user DM channels remembered so repeat DMs skip opening the channel. 0 disables the cache.\""
+            "},"
+            "\"dm_cache_path\":{"
+                "\"type\":\"string\","
+                "\"description\":\"Optional file used to persist the DM channel cache across restarts (empty keeps it in memory only)\""
+            "},"
+            "\"entity_cache_ttl_ms\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"How long (ms) users/channels fetched over REST by Fetch User/Fetch Channel stay cached\""
+            "},"
+            "\"entity_cache_negative_ttl_ms\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"How long (ms) a not-found user/channel is remembered before REST is asked again\""
+            "},"
+            "\"entity_cache_capacity\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Maximum number of cached users and channels (each) for Fetch User/Fetch Channel\""
+            "},"
+            "\"rest_max_concurrency\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Maximum concurrent REST lookups per Resolve IDs batch\""
+            "},"
+            "\"member_store_enabled\":{"
+                "\"type\":\"boolean\","
+                "\"description\":\"Store guild members in a compact column store instead of DPP's user cache (for very large guilds; needs the guild_members intent to load full member lists)\""
+            "},"
+            "\"snapshot_path\":{"
+                "\"type\":\"string\","
+                "\"description\":\"Optional file for a warm-start snapshot of guilds, channels, roles and users, written on disconnect and loaded on connect (empty disables it)\""
+            "},"
+            "\"snapshot_max_age_s\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Snapshots older than this many seconds are ignored on connect\""
+            "},"
+            "\"snapshot_max_users\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Maximum number of users written to the snapshot\""
+            "},"
+            "\"message_index_enabled\":{"
+                "\"type\":\"boolean\","
+                "\"description\":\"Keep a searchable in-memory history of recent messages for the Search Messages node\""
+            "},"
+            "\"message_index_max_messages\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Maximum number of messages kept in the search history\""
+            "},"
+            "\"message_index_max_mb\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Approximate memory cap (MiB) for the search history and its index\""
+            "},"
+            "\"message_index_window_s\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Messages older than this many seconds drop out of the search history\""
+            "},"
+            "\"message_index_eviction\":{"
+                "\"type\":\"string\","
+                "\"enum\":[\"oldest\",\"reject\"],"
+                "\"description\":\"At the message or memory cap: 'oldest' evicts the oldest messages, 'reject' stops indexing new ones until old ones age out\""
+            "},"
+            "\"journal_dir\":{"
+                "\"type\":\"string\","
+                "\"description\":\"Optional directory for an append-only journal of received message and reaction events (used by Replay Journal and crash recovery; empty disables it)\""
+            "},"
+            "\"journal_segment_mb\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Size (MiB) of each journal segment file\""
+            "},"
+            "\"journal_max_segments\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Number of journal segments kept before the oldest is deleted (0 keeps all)\""
+            "},"
+            "\"journal_recover\":{"
+                "\"type\":\"boolean\","
+                "\"description\":\"On connect, re-queue journaled events that were received but not dispatched before the last shutdown or crash\""
+            "},"
+            "\"gateway_record_path\":{"
+                "\"type\":\"string\","
+                "\"description\":\"Optional file that every raw gateway dispatch the plugin handles is written to, with its arrival time, for later replay (empty disables recording)\""
+            "},"
+            "\"gateway_replay_path\":{"
+                "\"type\":\"string\","
+                "\"description\":\"Optional gateway recording to play back instead of connecting to Discord: no token or network is needed, recorded events reach the event nodes, and actions do nothing\""
+            "},"
+            "\"gateway_replay_speed\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Playback speed of gateway_replay_path (1 = as recorded, N = N times faster, 0 = as fast as possible)\""
+            "},"
+            "\"gateway_replay_batch\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Most recorded dispatches fed per tick; at speed 0 every tick gets exactly this many, so runs are repeatable\""
+            "},"
+            "\"metrics_file_path\":{"
+                "\"type\":\"string\","
+                "\"description\":\"Optional file the plugin's runtime metrics (event rates, dispatch and REST latency, 429s, heartbeat latency, cache sizes) are written to in Prometheus text format (empty disables the file)\""
+            "},"
+            "\"metrics_interval_ms\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"How often metrics_file_path is rewritten (milliseconds)\""
+            "},"
+            "\"trace_sample_rate\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Trace one in this many gateway events from receipt through queueing, dispatch and flow to the REST calls it makes (0 disables tracing; takes effect on connect). Dump with the Dump Trace node\""
+            "},"
+            "\"trace_buffer_spans\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Trace spans kept in memory; older ones are overwritten\""
+            "},"
+            "\"profile_nodes\":{"
+                "\"type\":\"boolean\","
+                "\"description\":\"Time every Discord node execution and event callback per node type and flow (see Get Discord Stats and Dump Node Profile)\""
+            "},"
+            "\"interaction_auto_defer_ms\":{"
+                "\"type\":\"integer\","
+                "\"description\":\"Send a deferred response to slash commands the flow has not answered after this many milliseconds (Discord allows 3000; 0 disables)\""
+            "},"
+            "\"command_state_path\":{"
+                "\"type\":\"string\","
+                "\"description\":\"Optional file remembering the slash commands last registered, so restarts with unchanged commands make no registration calls (empty keeps it in memory only)\""
             "}"
         "}"
         "}";
@@ -621,7 +1027,41 @@ static const PluginSettingsSchema* Discord_GetSettingsSchema(void)
         "},"
         "\"gateway_intents\":0,"
         "\"enable_message_content_intent\":false,"
-        "\"enable_dpp_logging\":true"
+        "\"enable_dpp_logging\":true,"
+        "\"log_level\":\"info\","
+        "\"dpp_log_min_severity\":\"warning\","
+        "\"log_rate_limit\":20,"
+        "\"presence_debounce_ms\":5000,"
+        "\"dm_cache_capacity\":4096,"
+        "\"dm_cache_path\":\"\","
+        "\"entity_cache_ttl_ms\":300000,"
+        "\"entity_cache_negative_ttl_ms\":30000,"
+        "\"entity_cache_capacity\":50000,"
+        "\"rest_max_concurrency\":8,"
+        "\"member_store_enabled\":false,"
+        "\"snapshot_path\":\"\","
+        "\"snapshot_max_age_s\":86400,"
+        "\"snapshot_max_users\":100000,"
+        "\"message_index_enabled\":false,"
+        "\"message_index_max_messages\":1000000,"
+        "\"message_index_max_mb\":256,"
+        "\"message_index_window_s\":86400,"
+        "\"message_index_eviction\":\"oldest\","
+        "\"journal_dir\":\"\","
+        "\"journal_segment_mb\":16,"
+        "\"journal_max_segments\":64,"
+        "\"journal_recover\":true,"
+        "\"gateway_record_path\":\"\","
+        "\"gateway_replay_path\":\"\","
+        "\"gateway_replay_speed\":1,"
+        "\"gateway_replay_batch\":1000,"
+        "\"metrics_file_path\":\"\","
+        "\"metrics_interval_ms\":15000,"
+        "\"trace_sample_rate\":0,"
+        "\"trace_buffer_spans\":65536,"
+        "\"profile_nodes\":false,"
+        "\"interaction_auto_defer_ms\":2000,"
+        "\"command_state_path\":\"\""
         "}";
 
     static PluginSettingsSchema s_Schema{ schema, defaults };
@@ -631,6 +1071,8 @@ static const PluginSettingsSchema* Discord_GetSettingsSchema(void)
 static void Discord_OnSettingsChanged(const char* settings_json)
 {
     Discord_UpdateConfigFromJson(settings_json);
+    discord_log_configure(g_DiscordConfig);
+    NodeProfiler::instance().set_enabled(g_DiscordConfig.profile_nodes);
 
     if (g_host)
     {
@@ -643,6 +1085,37 @@ static void Discord_OnSettingsChanged(const char* settings_json)
     }
 }
 
+static void Discord_ShowDiagnostics(void)
+{
+    if (g_host)
+    {
+        const std::string report = diagnostics_panel().render();
+        g_host->log(PLUGIN_LOG_LEVEL_INFO, report.c_str());
+    }
+}
+
+static void Discord_ToggleLiveDiagnostics(void)
+{
+    DiagnosticsPanel& panel = diagnostics_panel();
+    panel.set_live(!panel.live());
+    if (g_host)
+    {
+        g_host->log(PLUGIN_LOG_LEVEL_INFO, panel.live()
+            ? "Discord plugin: live diagnostics on (logged every 5 s)"
+            : "Discord plugin: live diagnostics off");
+    }
+}
+
+static const PluginMenuItem* Discord_GetMenus(int* count)
+{
+    static const PluginMenuItem s_Menus[] = {
+        { "Discord/Diagnostics", "Log connection state, event rates, queue, REST buckets and caches", Discord_ShowDiagnostics },
+        { "Discord/Live Diagnostics", "Toggle logging the diagnostics every 5 seconds", Discord_ToggleLiveDiagnostics },
+    };
+    *count = static_cast<int>(sizeof(s_Menus) / sizeof(s_Menus[0]));
+    return s_Menus;
+}
+
 static PluginAPI g_api = {
     {
         "com.rune.discord",          // id
@@ -657,10 +1130,10 @@ static PluginAPI g_api = {
     on_unload,
     on_tick,
     Discord_OnFlowLoaded,      // on_flow_loaded
-    NULL,                      // on_flow_unloaded
+    Discord_OnFlowUnloaded,    // on_flow_unloaded
     Discord_GetSettingsSchema, // get_settings_schema
     Discord_OnSettingsChanged, // on_settings_changed
-    NULL                       // get_menus
+    Discord_GetMenus           // get_menus
 };
 
 NODEPLUG_EXPORT const PluginAPI* NodePlugin_GetAPI(void) {
@@ -0,0 +1,182 @@
+/**
+ * DM Channel Cache - Implementation
+ */
+
+#include "dm_channel_cache.h"
+#include "atomic_file.h"
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+// File layout: magic, version, entry count, then (user_id, channel_id) pairs
+// as little-endian uint64 in most-recent-first order.
+static const char kDmCacheMagic[4] = { 'R', 'D', 'M', 'C' };
+static const uint32_t kDmCacheVersion = 1;
+static const size_t kDmCacheHeaderSize = 12;
+static const size_t kDmCacheEntrySize = 16;
+
+DmChannelCache::DmChannelCache(size_t capacity)
+    : m_capacity(capacity) {
+}
+
+void DmChannelCache::set_capacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    evict_over_capacity();
+}
+
+bool DmChannelCache::find(dpp::snowflake user_id, dpp::snowflake& channel_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(user_id);
+    if (it == m_index.end()) {
+        return false;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    channel_id = it->second->second;
+    return true;
+}
+
+void DmChannelCache::insert(dpp::snowflake user_id, dpp::snowflake channel_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_capacity == 0) {
+        return;
+    }
+
+    auto it = m_index.find(user_id);
+    if (it != m_index.end()) {
+        it->second->second = channel_id;
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return;
+    }
+
+    m_lru.emplace_front(user_id, channel_id);
+    m_index[user_id] = m_lru.begin();
+    evict_over_capacity();
+}
+
+void DmChannelCache::erase(dpp::snowflake user_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(user_id);
+    if (it != m_index.end()) {
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+}
+
+void DmChannelCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+}
+
+size_t DmChannelCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.size();
+}
+
+void DmChannelCache::evict_over_capacity() {
+    while (m_index.size() > m_capacity && !m_lru.empty()) {
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+}
+
+static void write_u32(std::ofstream& out, uint32_t v) {
+    unsigned char b[4];
+    for (int i = 0; i < 4; ++i) b[i] = static_cast<unsigned char>(v >> (8 * i));
+    out.write(reinterpret_cast<const char*>(b), sizeof(b));
+}
+
+static void write_u64(std::ofstream& out, uint64_t v) {
+    unsigned char b[8];
+    for (int i = 0; i < 8; ++i) b[i] = static_cast<unsigned char>(v >> (8 * i));
+    out.write(reinterpret_cast<const char*>(b), sizeof(b));
+}
+
+static bool read_u32(std::ifstream& in, uint32_t& v) {
+    unsigned char b[4];
+    if (!in.read(reinterpret_cast<char*>(b), sizeof(b))) return false;
+    v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(b[i]) << (8 * i);
+    return true;
+}
+
+static bool read_u64(std::ifstream& in, uint64_t& v) {
+    unsigned char b[8];
+    if (!in.read(reinterpret_cast<char*>(b), sizeof(b))) return false;
+    v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(b[i]) << (8 * i);
+    return true;
+}
+
+bool DmChannelCache::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        std::char_traits<char>::compare(magic, kDmCacheMagic, sizeof(magic)) != 0 ||
+        !read_u32(in, version) || version != kDmCacheVersion ||
+        !read_u32(in, count)) {
+        return false;
+    }
+
+    // The count comes from disk: a corrupt one must not drive the allocation
+    in.seekg(0, std::ios::end);
+    const std::streamoff fileSize = in.tellg();
+    in.seekg(static_cast<std::streamoff>(kDmCacheHeaderSize), std::ios::beg);
+    if (fileSize < 0 || !in ||
+        count > (static_cast<uint64_t>(fileSize) - kDmCacheHeaderSize) / kDmCacheEntrySize) {
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t user = 0;
+        uint64_t channel = 0;
+        if (!read_u64(in, user) || !read_u64(in, channel)) {
+            return false;
+        }
+        entries.emplace_back(user, channel);
+    }
+
+    // Insert oldest first so the file's recency order is preserved
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        insert(it->first, it->second);
+    }
+    return true;
+}
+
+bool DmChannelCache::save(const std::string& path) const {
+    std::vector<Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entries.assign(m_lru.begin(), m_lru.end());
+    }
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        out.write(kDmCacheMagic, sizeof(kDmCacheMagic));
+        write_u32(out, kDmCacheVersion);
+        write_u32(out, static_cast<uint32_t>(entries.size()));
+        for (const auto& e : entries) {
+            write_u64(out, static_cast<uint64_t>(e.first));
+            write_u64(out, static_cast<uint64_t>(e.second));
+        }
+        if (!out.good()) {
+            return false;
+        }
+    }
+
+    return atomic_replace_file(tmpPath, path);
+}
@@ -0,0 +1,51 @@
+/**
+ * DPP Transport - Implementation
+ */
+
+#include "dpp_transport.h"
+#include <algorithm>
+
+static dpp::http_method http_method(const std::string& method) {
+    if (method == "GET") return dpp::m_get;
+    if (method == "PUT") return dpp::m_put;
+    if (method == "PATCH") return dpp::m_patch;
+    if (method == "DELETE") return dpp::m_delete;
+    return dpp::m_post;
+}
+
+void DppTransport::request(const std::string& method, const std::string& path, const std::string& body,
+                           ResponseCallback callback) {
+    // DPP buckets requests by endpoint and major parameter, so
+    // "/channels/1/messages" goes in as "/channels", "1", "messages"
+    const size_t majorStart = path.find('/', 1);
+    const size_t paramsStart = majorStart == std::string::npos ? std::string::npos : path.find('/', majorStart + 1);
+    const std::string endpoint = API_PATH + path.substr(0, majorStart);
+    const std::string major = majorStart == std::string::npos ? std::string()
+        : path.substr(majorStart + 1, paramsStart == std::string::npos ? std::string::npos : paramsStart - majorStart - 1);
+    const std::string params = paramsStart == std::string::npos ? std::string() : path.substr(paramsStart + 1);
+
+    m_cluster.post_rest(endpoint, major, params, http_method(method), body,
+        [callback = std::move(callback)](nlohmann::json&, const dpp::http_request_completion_t& http) {
+            if (!callback) {
+                return;
+            }
+            TransportResponse response;
+            response.status = static_cast<int>(http.status);
+            response.body = http.body;
+            response.headers.assign(http.headers.begin(), http.headers.end());
+            callback(response);
+        });
+}
+
+bool DppTransport::gateway_send(uint32_t shard_id, const std::string& payload) {
+    dpp::discord_client* shard = m_cluster.get_shard(shard_id);
+    if (!shard || !shard->is_connected()) {
+        return false;
+    }
+    shard->queue_message(payload);
+    return true;
+}
+
+uint32_t DppTransport::shard_count() const {
+    return std::max<uint32_t>(1, m_cluster.numshards);
+}
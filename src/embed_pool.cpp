@@ -0,0 +1,172 @@
+/**
+ * Embed Pool - Implementation
+ */
+
+#include "embed_pool.h"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+void EmbedData::clear() {
+    title.clear();
+    description.clear();
+    url.clear();
+    has_color = false;
+    color = 0;
+    footer_text.clear();
+    footer_icon_url.clear();
+    image_url.clear();
+    thumbnail_url.clear();
+    author_name.clear();
+    author_url.clear();
+    author_icon_url.clear();
+    timestamp = 0;
+    fields.clear();
+}
+
+dpp::embed EmbedData::to_dpp() const {
+    dpp::embed embed;
+    if (!title.empty()) embed.set_title(title);
+    if (!description.empty()) embed.set_description(description);
+    if (!url.empty()) embed.set_url(url);
+    if (has_color) embed.set_color(color);
+    if (!footer_text.empty()) embed.set_footer(footer_text, footer_icon_url);
+    if (!image_url.empty()) embed.set_image(image_url);
+    if (!thumbnail_url.empty()) embed.set_thumbnail(thumbnail_url);
+    if (!author_name.empty()) embed.set_author(author_name, author_url, author_icon_url);
+    if (timestamp != 0) embed.set_timestamp(timestamp);
+    for (const auto& field : fields) {
+        embed.add_field(field.name, field.value, field.is_inline);
+    }
+    return embed;
+}
+
+std::string EmbedData::to_json() const {
+    json j = json::object();
+    if (!title.empty()) j["title"] = title;
+    if (!description.empty()) j["description"] = description;
+    if (!url.empty()) j["url"] = url;
+    if (has_color) j["color"] = color;
+    if (!footer_text.empty()) {
+        json footer = { {"text", footer_text} };
+        if (!footer_icon_url.empty()) footer["icon_url"] = footer_icon_url;
+        j["footer"] = footer;
+    }
+    if (!image_url.empty()) j["image"] = { {"url", image_url} };
+    if (!thumbnail_url.empty()) j["thumbnail"] = { {"url", thumbnail_url} };
+    if (!author_name.empty()) {
+        json author = { {"name", author_name} };
+        if (!author_url.empty()) author["url"] = author_url;
+        if (!author_icon_url.empty()) author["icon_url"] = author_icon_url;
+        j["author"] = author;
+    }
+    if (timestamp != 0) {
+        char buf[32];
+        std::tm tm{};
+#if defined(_WIN32)
+        gmtime_s(&tm, &timestamp);
+#else
+        gmtime_r(&timestamp, &tm);
+#endif
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+        j["timestamp"] = buf;
+    }
+    if (!fields.empty()) {
+        json arr = json::array();
+        for (const auto& field : fields) {
+            arr.push_back({ {"name", field.name}, {"value", field.value}, {"inline", field.is_inline} });
+        }
+        j["fields"] = arr;
+    }
+    return j.dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+EmbedPool& EmbedPool::instance() {
+    static EmbedPool pool;
+    return pool;
+}
+
+// Handle layout: high 32 bits generation, low 32 bits slot index + 1
+static EmbedHandle make_handle(uint32_t index, uint32_t generation) {
+    return static_cast<EmbedHandle>((static_cast<uint64_t>(generation) << 32) | (index + 1u));
+}
+
+EmbedHandle EmbedPool::acquire() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t index;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+
+    Slot& slot = m_slots[index];
+    slot.in_use = true;
+    slot.data.clear();
+    return make_handle(index, slot.generation);
+}
+
+void EmbedPool::release(EmbedHandle handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Slot* slot = resolve(handle);
+    if (!slot) {
+        return;
+    }
+
+    slot->in_use = false;
+    // Bump the generation so outstanding copies of the handle go stale;
+    // skip 0 on wrap-around so handles never collapse to 0.
+    if (++slot->generation == 0) {
+        slot->generation = 1;
+    }
+    m_free.push_back(static_cast<uint32_t>((static_cast<uint64_t>(handle) & 0xFFFFFFFFu) - 1u));
+}
+
+bool EmbedPool::store(EmbedHandle handle, const EmbedData& data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Slot* slot = resolve(handle);
+    if (!slot) {
+        return false;
+    }
+    slot->data = data;
+    return true;
+}
+
+bool EmbedPool::build(EmbedHandle handle, dpp::embed& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Slot* slot = resolve(handle);
+    if (!slot) {
+        return false;
+    }
+    out = slot->data.to_dpp();
+    return true;
+}
+
+bool EmbedPool::to_json(EmbedHandle handle, std::string& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Slot* slot = resolve(handle);
+    if (!slot) {
+        return false;
+    }
+    out = slot->data.to_json();
+    return true;
+}
+
+const EmbedPool::Slot* EmbedPool::resolve(EmbedHandle handle) const {
+    const uint64_t raw = static_cast<uint64_t>(handle);
+    const uint32_t low = static_cast<uint32_t>(raw & 0xFFFFFFFFu);
+    if (low == 0 || low > m_slots.size()) {
+        return nullptr;
+    }
+    const Slot& slot = m_slots[low - 1];
+    if (!slot.in_use || slot.generation != static_cast<uint32_t>(raw >> 32)) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+EmbedPool::Slot* EmbedPool::resolve(EmbedHandle handle) {
+    return const_cast<Slot*>(static_cast<const EmbedPool*>(this)->resolve(handle));
+}
@@ -0,0 +1,418 @@
+/**
+ * Event Journal - Implementation
+ *
+ * Segment layout (all integers little-endian):
+ *   header  magic "RJNL", u32 version, u64 first sequence number,
+ *           u64 created (unix ms), u64 reserved
+ *   records each 8-byte aligned:
+ *           u32 stored length (0 = end of segment), u32 CRC-32 of bytes 8..32
+ *           and the stored payload, u32 raw length, u16 kind, u16 flags,
+ *           u64 sequence number, u64 time (unix ms), stored payload
+ *
+ * Checkpoint file: magic "RJCK", u32 reserved, u64 sequence number.
+ */
+
+#include "event_journal.h"
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+static const char kSegmentMagic[4] = { 'R', 'J', 'N', 'L' };
+static const char kCheckpointMagic[4] = { 'R', 'J', 'C', 'K' };
+static const uint32_t kSegmentVersion = 1;
+static const size_t kSegmentHeaderSize = 32;
+static const size_t kRecordHeaderSize = 32;
+static const size_t kCheckpointSize = 16;
+static const uint16_t kFlagDeflated = 1;
+static const char* kSegmentPrefix = "events-";
+static const char* kSegmentSuffix = ".journal";
+static const char* kCheckpointName = "checkpoint";
+
+// Preset deflate dictionary: the keys and values that repeat in every
+// MESSAGE_CREATE / MESSAGE_REACTION_ADD dispatch. Deflate matches against the
+// end of the dictionary most cheaply, so the most common text comes last.
+static const char kDictionary[] =
+    "\"burst\":false,\"burst_colors\":[],\"type\":0,\"message_author_id\":\"\",\"emoji\":{\"name\":\"\",\"id\":null},"
+    "\"user_id\":\"\",\"message_id\":\"\",\"t\":\"MESSAGE_REACTION_ADD\","
+    "\"tts\":false,\"pinned\":false,\"mention_everyone\":false,\"mention_roles\":[],\"mentions\":[],"
+    "\"edited_timestamp\":null,\"components\":[],\"attachments\":[],\"embeds\":[],\"flags\":0,"
+    "\"nonce\":\"\",\"timestamp\":\"2024-01-01T00:00:00.000000+00:00\","
+    "\"member\":{\"roles\":[],\"premium_since\":null,\"pending\":false,\"nick\":null,\"mute\":false,"
+    "\"joined_at\":\"\",\"flags\":0,\"deaf\":false,\"communication_disabled_until\":null,\"avatar\":null},"
+    "\"author\":{\"username\":\"\",\"public_flags\":0,\"id\":\"\",\"global_name\":null,\"discriminator\":\"0\","
+    "\"clan\":null,\"avatar_decoration_data\":null,\"avatar\":null},"
+    "{\"t\":\"MESSAGE_CREATE\",\"s\":,\"op\":0,\"d\":{\"type\":0,\"content\":\"\",\"channel_id\":\"\",\"id\":\"\",\"guild_id\":\"\"}}";
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+static uint64_t unix_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+
+static uint32_t record_crc(const uint8_t* record, const uint8_t* payload, size_t stored) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, record + 8, static_cast<uInt>(kRecordHeaderSize - 8));
+    crc = crc32(crc, payload, static_cast<uInt>(stored));
+    return static_cast<uint32_t>(crc);
+}
+
+static std::string segment_name(uint64_t first_seq) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%020llu%s", kSegmentPrefix,
+                  static_cast<unsigned long long>(first_seq), kSegmentSuffix);
+    return name;
+}
+
+// Segment files in dir, oldest first (names sort by first sequence number)
+static std::vector<std::string> list_segments(const std::string& dir) {
+    std::vector<std::string> out;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        if (name.size() == std::strlen(kSegmentPrefix) + 20 + std::strlen(kSegmentSuffix) &&
+            name.compare(0, std::strlen(kSegmentPrefix), kSegmentPrefix) == 0 &&
+            name.compare(name.size() - std::strlen(kSegmentSuffix), std::string::npos, kSegmentSuffix) == 0) {
+            out.push_back(it->path().string());
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Calls fn(record, payload) for every intact record of a mapped segment and
+// returns false as soon as fn does
+template <typename Fn>
+static bool scan_segment(const MappedFile& file, Fn fn) {
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    if (size < kSegmentHeaderSize || std::memcmp(data, kSegmentMagic, 4) != 0 ||
+        get_u32(data + 4) != kSegmentVersion) {
+        return true;
+    }
+    size_t offset = kSegmentHeaderSize;
+    while (offset + kRecordHeaderSize <= size) {
+        const uint8_t* record = data + offset;
+        const uint32_t stored = get_u32(record);
+        if (stored == 0 || stored > size - offset - kRecordHeaderSize) {
+            break;
+        }
+        const uint8_t* payload = record + kRecordHeaderSize;
+        if (record_crc(record, payload, stored) != get_u32(record + 4)) {
+            break;
+        }
+        if (!fn(record, payload)) {
+            return false;
+        }
+        offset += align8(kRecordHeaderSize + stored);
+    }
+    return true;
+}
+
+struct EventJournal::Deflater {
+    z_stream stream;
+    bool ready = false;
+
+    Deflater() {
+        std::memset(&stream, 0, sizeof(stream));
+        // Raw deflate (no zlib header), fastest level: records are small and
+        // the dictionary does most of the work
+        ready = deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~Deflater() {
+        if (ready) {
+            deflateEnd(&stream);
+        }
+    }
+
+    // Compresses in into out; false if deflate fails or does not help
+    bool compress(const std::string& in, std::vector<uint8_t>& out) {
+        if (!ready || deflateReset(&stream) != Z_OK ||
+            deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(kDictionary), sizeof(kDictionary) - 1) != Z_OK) {
+            return false;
+        }
+        out.resize(deflateBound(&stream, static_cast<uLong>(in.size())));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        stream.avail_in = static_cast<uInt>(in.size());
+        stream.next_out = out.data();
+        stream.avail_out = static_cast<uInt>(out.size());
+        if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+            return false;
+        }
+        out.resize(out.size() - stream.avail_out);
+        return out.size() < in.size();
+    }
+};
+
+EventJournal::EventJournal() = default;
+
+EventJournal::~EventJournal() {
+    close();
+}
+
+bool EventJournal::is_open() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_segment.is_open();
+}
+
+bool EventJournal::open(const std::string& dir, size_t segment_bytes, size_t max_segments, std::string& error) {
+    close();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        error = "cannot create directory: " + ec.message();
+        return false;
+    }
+
+    m_dir = dir;
+    m_segment_bytes = std::max<size_t>(segment_bytes, 64 * 1024);
+    m_max_segments = max_segments;
+    m_deflater.reset(new Deflater());
+
+    // Continue numbering after the last intact record on disk
+    const std::vector<std::string> existing = list_segments(dir);
+    m_segments.assign(existing.begin(), existing.end());
+    m_next_seq = 1;
+    for (auto it = existing.rbegin(); it != existing.rend(); ++it) {
+        MappedFile file;
+        if (!file.open(*it) || file.size() < kSegmentHeaderSize || std::memcmp(file.data(), kSegmentMagic, 4) != 0) {
+            continue;
+        }
+        uint64_t last = 0;
+        scan_segment(file, [&last](const uint8_t* record, const uint8_t*) {
+            last = get_u64(record + 16);
+            return true;
+        });
+        if (last == 0) {
+            last = get_u64(file.data() + 8) - 1;  // empty segment
+        }
+        if (last > 0) {
+            m_next_seq = last + 1;
+            break;
+        }
+    }
+
+    const std::string checkpointPath = (fs::path(dir) / kCheckpointName).string();
+    if (!m_checkpoint.open_writable(checkpointPath, kCheckpointSize)) {
+        error = "cannot map '" + checkpointPath + "'";
+        return false;
+    }
+    uint8_t* ckpt = m_checkpoint.writable_data();
+    if (std::memcmp(ckpt, kCheckpointMagic, 4) != 0) {
+        // No checkpoint yet: treat everything already on disk as handled
+        std::memcpy(ckpt, kCheckpointMagic, 4);
+        put_u64(ckpt + 8, m_next_seq - 1);
+    }
+
+    if (!start_segment_locked(0)) {
+        m_checkpoint.close();
+        error = "cannot create a segment in '" + dir + "'";
+        return false;
+    }
+    return true;
+}
+
+void EventJournal::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    finish_segment_locked();
+    if (m_checkpoint.is_open()) {
+        m_checkpoint.flush();
+        m_checkpoint.close();
+    }
+    m_segments.clear();
+    m_deflater.reset();
+}
+
+bool EventJournal::start_segment_locked(size_t min_bytes) {
+    const std::string path = (fs::path(m_dir) / segment_name(m_next_seq)).string();
+    if (!m_segment.open_writable(path, std::max(m_segment_bytes, min_bytes + kSegmentHeaderSize))) {
+        return false;
+    }
+    uint8_t* header = m_segment.writable_data();
+    std::memcpy(header, kSegmentMagic, 4);
+    put_u32(header + 4, kSegmentVersion);
+    put_u64(header + 8, m_next_seq);
+    put_u64(header + 16, unix_ms());
+    put_u64(header + 24, 0);
+    m_offset = kSegmentHeaderSize;
+
+    if (m_segments.empty() || m_segments.back() != path) {
+        m_segments.push_back(path);
+    }
+    while (m_max_segments > 0 && m_segments.size() > m_max_segments) {
+        std::error_code ec;
+        fs::remove(m_segments.front(), ec);
+        m_segments.pop_front();
+    }
+    return true;
+}
+
+// Unmaps the current segment. Its zero-filled tail stays: read() may have it
+// mapped, and shrinking a mapped file faults the reader (SIGBUS) on POSIX.
+// A zero record length ends the scan there, as it does while appending.
+void EventJournal::finish_segment_locked() {
+    if (!m_segment.is_open()) {
+        return;
+    }
+    m_segment.flush();
+    m_segment.close();
+    m_offset = 0;
+}
+
+uint64_t EventJournal::append(uint16_t kind, const std::string& payload) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_segment.is_open() || payload.empty() || payload.size() > UINT32_MAX) {
+        return 0;
+    }
+
+    const bool deflated = m_deflater->compress(payload, m_buffer);
+    const uint8_t* stored = deflated ? m_buffer.data() : reinterpret_cast<const uint8_t*>(payload.data());
+    const size_t storedSize = deflated ? m_buffer.size() : payload.size();
+    const size_t recordSize = align8(kRecordHeaderSize + storedSize);
+
+    if (m_offset + recordSize > m_segment.size()) {
+        finish_segment_locked();
+        if (!start_segment_locked(recordSize)) {
+            return 0;
+        }
+    }
+
+    const uint64_t seq = m_next_seq++;
+    uint8_t* record = m_segment.writable_data() + m_offset;
+    put_u32(record + 8, static_cast<uint32_t>(payload.size()));
+    put_u16(record + 12, kind);
+    put_u16(record + 14, deflated ? kFlagDeflated : 0);
+    put_u64(record + 16, seq);
+    put_u64(record + 24, unix_ms());
+    std::memcpy(record + kRecordHeaderSize, stored, storedSize);
+    put_u32(record + 4, record_crc(record, record + kRecordHeaderSize, storedSize));
+    // The length makes the record visible to readers, so it goes in last
+    std::atomic_thread_fence(std::memory_order_release);
+    put_u32(record, static_cast<uint32_t>(storedSize));
+
+    m_offset += recordSize;
+    return seq;
+}
+
+void EventJournal::checkpoint(uint64_t seq) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_checkpoint.is_open() && seq > get_u64(m_checkpoint.data() + 8)) {
+        put_u64(m_checkpoint.writable_data() + 8, seq);
+    }
+}
+
+uint64_t EventJournal::checkpoint_seq() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_checkpoint.is_open() ? get_u64(m_checkpoint.data() + 8) : 0;
+}
+
+size_t EventJournal::read(const std::string& dir, const JournalFilter& filter, const Visitor& visitor) {
+    const std::vector<std::string> segments = list_segments(dir);
+
+    z_stream inflater;
+    std::memset(&inflater, 0, sizeof(inflater));
+    if (inflateInit2(&inflater, -15) != Z_OK) {
+        return 0;
+    }
+
+    size_t visited = 0;
+    JournalRecord out;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        MappedFile file;
+        if (!file.open(segments[i])) {
+            continue;
+        }
+        // Skip whole segments that end at or before after_seq
+        if (i + 1 < segments.size()) {
+            MappedFile next;
+            if (next.open(segments[i + 1]) && next.size() >= kSegmentHeaderSize &&
+                get_u64(next.data() + 8) <= filter.after_seq + 1) {
+                continue;
+            }
+        }
+
+        const bool more = scan_segment(file, [&](const uint8_t* record, const uint8_t* payload) {
+            const uint32_t stored = get_u32(record);
+            const uint32_t rawSize = get_u32(record + 8);
+            const uint16_t kind = static_cast<uint16_t>(record[12] | (record[13] << 8));
+            const uint16_t flags = static_cast<uint16_t>(record[14] | (record[15] << 8));
+            out.seq = get_u64(record + 16);
+            out.time_ms = get_u64(record + 24);
+            out.kind = kind;
+
+            if (out.seq <= filter.after_seq || out.time_ms < filter.since_ms) {
+                return true;
+            }
+            if (out.time_ms > filter.until_ms) {
+                return false;
+            }
+            if (kind >= 32 || !(filter.kinds & (1u << kind))) {
+                return true;
+            }
+
+            if (flags & kFlagDeflated) {
+                out.payload.resize(rawSize);
+                if (inflateReset(&inflater) != Z_OK ||
+                    inflateSetDictionary(&inflater, reinterpret_cast<const Bytef*>(kDictionary),
+                                         sizeof(kDictionary) - 1) != Z_OK) {
+                    return true;
+                }
+                inflater.next_in = const_cast<Bytef*>(payload);
+                inflater.avail_in = stored;
+                inflater.next_out = reinterpret_cast<Bytef*>(&out.payload[0]);
+                inflater.avail_out = rawSize;
+                if (inflate(&inflater, Z_FINISH) != Z_STREAM_END || inflater.avail_out != 0) {
+                    return true;
+                }
+            } else {
+                out.payload.assign(reinterpret_cast<const char*>(payload), stored);
+            }
+
+            ++visited;
+            return visitor(out);
+        });
+        if (!more) {
+            break;
+        }
+    }
+
+    inflateEnd(&inflater);
+    return visited;
+}
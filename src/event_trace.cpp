@@ -0,0 +1,179 @@
+/**
+ * Event Trace - Implementation
+ */
+
+#include "event_trace.h"
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Current event of the dispatching thread (see EventTracer::set_current)
+struct CurrentTrace {
+    uint64_t trace_id = 0;
+    const char* category = nullptr;
+    int64_t dispatched_us = 0;
+    bool flow_recorded = false;
+};
+
+thread_local CurrentTrace t_current;
+
+}  // namespace
+
+EventTracer::EventTracer() : m_epoch(Clock::now()) {
+}
+
+void EventTracer::configure(uint32_t sample_rate, size_t capacity) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (sample_rate == 0) {
+            capacity = 0;
+        }
+        if (capacity != m_ring.size()) {
+            m_ring.assign(capacity, TraceSpan());
+            m_next = 0;
+            m_size = 0;
+        }
+    }
+    m_sample_rate.store(sample_rate, std::memory_order_relaxed);
+}
+
+uint64_t EventTracer::sample() {
+    const uint32_t rate = m_sample_rate.load(std::memory_order_relaxed);
+    if (rate == 0) {
+        return 0;
+    }
+    const uint64_t n = m_events.fetch_add(1, std::memory_order_relaxed);
+    return n % rate == 0 ? n + 1 : 0;
+}
+
+int64_t EventTracer::now_us() const {
+    return to_us(Clock::now());
+}
+
+int64_t EventTracer::to_us(Clock::time_point t) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t - m_epoch).count();
+}
+
+void EventTracer::record(uint64_t trace_id, const char* name, const char* category, int64_t start_us,
+                         int64_t end_us) {
+    if (trace_id == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_ring.empty()) {
+        return;
+    }
+    TraceSpan& span = m_ring[m_next];
+    span.trace_id = trace_id;
+    span.name = name;
+    span.category = category;
+    span.start_us = start_us;
+    span.end_us = end_us < start_us ? start_us : end_us;
+    m_next = (m_next + 1) % m_ring.size();
+    if (m_size < m_ring.size()) {
+        ++m_size;
+    }
+}
+
+void EventTracer::set_current(uint64_t trace_id, const char* category, int64_t dispatched_us) {
+    t_current.trace_id = trace_id;
+    t_current.category = category;
+    t_current.dispatched_us = dispatched_us;
+    t_current.flow_recorded = false;
+}
+
+TraceCall EventTracer::begin_call() {
+    TraceCall call;
+    if (t_current.trace_id == 0) {
+        return call;
+    }
+    call.trace_id = t_current.trace_id;
+    call.category = t_current.category;
+    call.start_us = now_us();
+    if (!t_current.flow_recorded) {
+        t_current.flow_recorded = true;
+        record(call.trace_id, "flow", call.category, t_current.dispatched_us, call.start_us);
+    }
+    return call;
+}
+
+void EventTracer::end_call(const TraceCall& call, const char* name) {
+    if (call.trace_id != 0) {
+        record(call.trace_id, name, call.category, call.start_us, now_us());
+    }
+}
+
+size_t EventTracer::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+void EventTracer::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_next = 0;
+    m_size = 0;
+}
+
+// Names and categories are plugin literals, so only the quote/backslash
+// escapes JSON needs are handled
+static void write_json_string(std::FILE* out, const char* s) {
+    std::fputc('"', out);
+    for (; s && *s; ++s) {
+        if (*s == '"' || *s == '\\') {
+            std::fputc('\\', out);
+        }
+        std::fputc(*s, out);
+    }
+    std::fputc('"', out);
+}
+
+static void write_async_event(std::FILE* out, const TraceSpan& span, char phase, int64_t ts) {
+    std::fputs(",\n{\"name\":", out);
+    write_json_string(out, span.name);
+    std::fputs(",\"cat\":", out);
+    write_json_string(out, span.category);
+    std::fprintf(out, ",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":1,\"id\":\"0x%llx\"", phase,
+                 static_cast<long long>(ts), static_cast<unsigned long long>(span.trace_id));
+    if (phase == 'b') {
+        std::fprintf(out, ",\"args\":{\"trace\":%llu}", static_cast<unsigned long long>(span.trace_id));
+    }
+    std::fputc('}', out);
+}
+
+long EventTracer::write_chrome_json(const std::string& path, std::string& error) const {
+    std::vector<TraceSpan> spans;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        spans.reserve(m_size);
+        if (!m_ring.empty()) {
+            const size_t first = (m_next + m_ring.size() - m_size) % m_ring.size();
+            for (size_t i = 0; i < m_size; ++i) {
+                spans.push_back(m_ring[(first + i) % m_ring.size()]);
+            }
+        }
+    }
+
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+        error = std::strerror(errno);
+        return -1;
+    }
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+    std::fputs("\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Discord plugin\"}}", out);
+    for (const auto& span : spans) {
+        write_async_event(out, span, 'b', span.start_us);
+        write_async_event(out, span, 'e', span.end_us);
+    }
+    std::fputs("\n]}\n", out);
+
+    const bool ok = std::ferror(out) == 0;
+    if (std::fclose(out) != 0 || !ok) {
+        error = "write failed";
+        return -1;
+    }
+    return static_cast<long>(spans.size());
+}
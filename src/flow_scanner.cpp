@@ -0,0 +1,314 @@
+/**
+ * Flow Scanner - Implementation
+ */
+
+#include "flow_scanner.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <thread>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+const char* const FlowScanner::kDiscordTypePrefix = "com.rune.discord.";
+const char* const FlowScanner::kSlashCommandType = "com.rune.discord.on_slash_command";
+
+namespace {
+
+/**
+ * Collects the distinct Discord "type" strings of the objects in the
+ * top-level "nodes" array, and the definition properties of each On Slash
+ * Command node, and ends the parse (returns false) when that array closes.
+ * Every other value is dropped as soon as it is tokenized.
+ */
+class DiscordNodeTypeSax : public nlohmann::json_sax<json> {
+public:
+    explicit DiscordNodeTypeSax(FlowScan& scan)
+        : m_scan(scan), m_prefix_len(std::strlen(FlowScanner::kDiscordTypePrefix)) {}
+
+    bool finished() const { return m_finished; }
+    const std::string& error() const { return m_error; }
+
+    bool null() override { return value(); }
+    bool boolean(bool) override { return value(); }
+    bool number_integer(number_integer_t) override { return value(); }
+    bool number_float(number_float_t, const string_t&) override { return value(); }
+    bool binary(binary_t&) override { return value(); }
+
+    // Guild IDs may be stored as numbers
+    bool number_unsigned(number_unsigned_t val) override {
+        if (m_property) {
+            *m_property = std::to_string(val);
+        }
+        return value();
+    }
+
+    bool string(string_t& val) override {
+        if (m_property) {
+            *m_property = val;
+        } else if (m_expect_type) {
+            m_node_is_command = val == FlowScanner::kSlashCommandType;
+            if (val.compare(0, m_prefix_len, FlowScanner::kDiscordTypePrefix) == 0 &&
+                std::find(m_scan.discord_node_types.begin(), m_scan.discord_node_types.end(), val) ==
+                    m_scan.discord_node_types.end()) {
+                m_scan.discord_node_types.push_back(std::move(val));
+            }
+        }
+        return value();
+    }
+
+    bool start_object(std::size_t) override {
+        const bool properties = m_expect_properties;
+        value();
+        ++m_depth;
+        if (m_nodes_depth != 0 && m_depth == m_nodes_depth + 1) {
+            m_node_is_command = false;
+            m_command = FlowSlashCommand();
+        } else if (properties) {
+            m_properties_depth = m_depth;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (m_depth == m_properties_depth) {
+            m_properties_depth = 0;
+        } else if (m_nodes_depth != 0 && m_depth == m_nodes_depth + 1 && m_node_is_command &&
+                   !m_command.command.empty()) {
+            m_scan.slash_commands.push_back(std::move(m_command));
+        }
+        --m_depth;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        const bool nodes = m_expect_nodes;
+        value();
+        ++m_depth;
+        if (nodes) {
+            m_nodes_depth = m_depth;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (m_depth == m_nodes_depth) {
+            // Nothing after the nodes array matters
+            m_finished = true;
+            return false;
+        }
+        --m_depth;
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        m_expect_nodes = m_depth == 1 && m_nodes_depth == 0 && val == "nodes";
+        const bool nodeKey = m_nodes_depth != 0 && m_depth == m_nodes_depth + 1;
+        m_expect_type = nodeKey && val == "type";
+        m_expect_properties = nodeKey && val == "properties";
+        m_property = nullptr;
+        if (m_properties_depth != 0 && m_depth == m_properties_depth) {
+            if (val == "Command") {
+                m_property = &m_command.command;
+            } else if (val == "Description") {
+                m_property = &m_command.description;
+            } else if (val == "CommandOptions") {
+                m_property = &m_command.options;
+            } else if (val == "CommandGuildID") {
+                m_property = &m_command.guild_id;
+            }
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        m_error = ex.what();
+        return false;
+    }
+
+private:
+    bool value() {
+        m_expect_nodes = false;
+        m_expect_type = false;
+        m_expect_properties = false;
+        m_property = nullptr;
+        return true;
+    }
+
+    FlowScan& m_scan;
+    const size_t m_prefix_len;
+    std::string m_error;
+    int m_depth = 0;
+    int m_nodes_depth = 0;       // depth inside the "nodes" array; 0 until seen
+    int m_properties_depth = 0;  // depth inside a node's "properties"; 0 outside
+    bool m_expect_nodes = false;
+    bool m_expect_type = false;
+    bool m_expect_properties = false;
+    bool m_finished = false;
+    // Node being read
+    bool m_node_is_command = false;
+    FlowSlashCommand m_command;
+    std::string* m_property = nullptr;  // m_command field the next value goes to
+};
+
+bool stat_file(const std::string& path, uintmax_t& size, fs::file_time_type& mtime) {
+    std::error_code ec;
+    size = fs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = fs::last_write_time(path, ec);
+    return !ec;
+}
+
+std::shared_ptr<const FlowScan> unopened(const std::string& path) {
+    auto scan = std::make_shared<FlowScan>();
+    scan->error = "could not open flow.json at '" + path + "'";
+    return scan;
+}
+
+}  // namespace
+
+FlowScanner& flow_scanner() {
+    static FlowScanner scanner;
+    return scanner;
+}
+
+bool FlowScan::has(const std::string& type) const {
+    return std::find(discord_node_types.begin(), discord_node_types.end(), type) != discord_node_types.end();
+}
+
+std::string FlowScanner::flow_path(const std::string& flows_dir, const std::string& flow_id) {
+    std::string path = flows_dir;
+    if (!path.empty() && path.back() != '\\' && path.back() != '/') {
+#if defined(_WIN32)
+        path += '\\';
+#else
+        path += '/';
+#endif
+    }
+    path += flow_id;
+    path += "/flow.json";
+    return path;
+}
+
+FlowScan FlowScanner::scan_file(const std::string& path) {
+    FlowScan result;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        result.error = "could not open flow.json at '" + path + "'";
+        return result;
+    }
+    result.opened = true;
+
+    // One read into a flat buffer; the parser's input adapter is much faster
+    // over a pointer range than over an istream
+    std::string text;
+    const std::streamoff length = file.tellg();
+    if (length > 0) {
+        text.resize(static_cast<size_t>(length));
+        file.seekg(0);
+        file.read(&text[0], length);
+        text.resize(static_cast<size_t>(file.gcount()));
+    }
+
+    DiscordNodeTypeSax handler(result);
+    try {
+        const bool complete = json::sax_parse(text.data(), text.data() + text.size(), &handler);
+        if (!complete && !handler.finished()) {
+            result.error = handler.error().empty() ? "parse stopped" : handler.error();
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+std::shared_ptr<const FlowScan> FlowScanner::lookup(const std::string& path, uintmax_t size,
+                                                    fs::file_time_type mtime) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_cache.find(path);
+    if (it == m_cache.end() || it->second.size != size || it->second.mtime != mtime) {
+        return nullptr;
+    }
+    return it->second.scan;
+}
+
+std::shared_ptr<const FlowScan> FlowScanner::scan(const std::string& path) {
+    uintmax_t size = 0;
+    fs::file_time_type mtime;
+    if (!stat_file(path, size, mtime)) {
+        return unopened(path);
+    }
+    if (std::shared_ptr<const FlowScan> cached = lookup(path, size, mtime)) {
+        return cached;
+    }
+
+    // Parsed outside the lock; two threads missing on the same path both
+    // scan it and the later store wins, which is harmless
+    std::shared_ptr<const FlowScan> result = std::make_shared<const FlowScan>(scan_file(path));
+    if (result->opened) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_cache[path];
+        entry.size = size;
+        entry.mtime = mtime;
+        entry.scan = result;
+    }
+    return result;
+}
+
+size_t FlowScanner::prescan(const std::string& flows_dir, unsigned threads) {
+    std::vector<std::string> pending;
+    std::error_code ec;
+    for (fs::directory_iterator it(flows_dir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code typeEc;
+        if (!it->is_directory(typeEc)) {
+            continue;
+        }
+        std::string path = flow_path(flows_dir, it->path().filename().string());
+        uintmax_t size = 0;
+        fs::file_time_type mtime;
+        if (stat_file(path, size, mtime) && !lookup(path, size, mtime)) {
+            pending.push_back(std::move(path));
+        }
+    }
+    if (pending.empty()) {
+        return 0;
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, pending.size()));
+
+    std::atomic<size_t> next{ 0 };
+    auto worker = [this, &pending, &next]() {
+        for (size_t i = next++; i < pending.size(); i = next++) {
+            scan(pending[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    return pending.size();
+}
+
+void FlowScanner::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cache.clear();
+}
+
+size_t FlowScanner::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cache.size();
+}
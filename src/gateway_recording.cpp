@@ -0,0 +1,214 @@
+/**
+ * Gateway Recording - Implementation
+ */
+
+#include "gateway_recording.h"
+#include <cerrno>
+#include <cstring>
+
+using Clock = std::chrono::steady_clock;
+
+static const char kHeader[] = "#rune-gateway-recording v1";
+static const size_t kWriteBuffer = 64 * 1024;
+
+// ============================================================================
+// GatewayRecorder
+// ============================================================================
+
+GatewayRecorder::~GatewayRecorder() {
+    close();
+}
+
+bool GatewayRecorder::open(const std::string& path, std::string& error) {
+    close();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        error = std::strerror(errno);
+        return false;
+    }
+    std::setvbuf(m_file, nullptr, _IOFBF, kWriteBuffer);
+
+    const auto unixMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::fprintf(m_file, "%s %lld\n", kHeader, static_cast<long long>(unixMs));
+    std::fflush(m_file);
+
+    m_start = Clock::now();
+    m_last_flush = m_start;
+    m_count = 0;
+    m_open.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void GatewayRecorder::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_open.store(false, std::memory_order_relaxed);
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void GatewayRecorder::record(const std::string& raw_event) {
+    if (!is_open() || raw_event.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file) {
+        return;
+    }
+    // Timestamped under the lock so offsets never go backwards in the file
+    const auto now = Clock::now();
+    const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(now - m_start).count();
+    std::fprintf(m_file, "%lld ", static_cast<long long>(offset));
+
+    // Gateway frames are compact JSON, but a stray line break would split
+    // the record, so it is blanked (JSON allows whitespace between tokens)
+    if (raw_event.find_first_of("\r\n") == std::string::npos) {
+        std::fwrite(raw_event.data(), 1, raw_event.size(), m_file);
+    } else {
+        std::string line = raw_event;
+        for (char& c : line) {
+            if (c == '\r' || c == '\n') {
+                c = ' ';
+            }
+        }
+        std::fwrite(line.data(), 1, line.size(), m_file);
+    }
+    std::fputc('\n', m_file);
+    ++m_count;
+
+    if (now - m_last_flush >= std::chrono::seconds(1)) {
+        std::fflush(m_file);
+        m_last_flush = now;
+    }
+}
+
+uint64_t GatewayRecorder::count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+// ============================================================================
+// GatewayPlayback
+// ============================================================================
+
+bool GatewayPlayback::open(const std::string& path, uint32_t speed, std::string& error) {
+    close();
+
+    if (!m_file.open(path)) {
+        error = "cannot open file";
+        return false;
+    }
+    const size_t headerLen = sizeof(kHeader) - 1;
+    if (m_file.size() < headerLen || std::memcmp(m_file.data(), kHeader, headerLen) != 0) {
+        m_file.close();
+        error = "not a gateway recording";
+        return false;
+    }
+
+    m_speed = speed;
+    return true;
+}
+
+void GatewayPlayback::close() {
+    m_file.close();
+    m_position = 0;
+    m_started = false;
+    m_first_offset_us = 0;
+    m_count = 0;
+    m_scratch.clear();
+}
+
+bool GatewayPlayback::peek(uint64_t& offset_us, size_t& payload, size_t& payload_len, size_t& next) {
+    const char* data = reinterpret_cast<const char*>(m_file.data());
+    const size_t size = m_file.size();
+
+    while (m_position < size) {
+        const char* line = data + m_position;
+        const char* nl = static_cast<const char*>(std::memchr(line, '\n', size - m_position));
+        const size_t len = nl ? static_cast<size_t>(nl - line) : size - m_position;
+        const size_t lineEnd = m_position + len;
+        next = nl ? lineEnd + 1 : size;
+
+        // Header (also where concatenated recordings join): timing restarts
+        // from the next dispatch
+        if (len > 0 && line[0] == '#') {
+            m_started = false;
+            m_position = next;
+            continue;
+        }
+
+        size_t i = 0;
+        uint64_t offset = 0;
+        while (i < len && line[i] >= '0' && line[i] <= '9') {
+            offset = offset * 10 + static_cast<uint64_t>(line[i] - '0');
+            ++i;
+        }
+        if (i == 0 || i >= len || line[i] != ' ') {
+            // Blank or hand-edited junk line
+            m_position = next;
+            continue;
+        }
+
+        size_t end = len;
+        if (end > i + 1 && line[end - 1] == '\r') {
+            --end;
+        }
+        offset_us = offset;
+        payload = m_position + i + 1;
+        payload_len = end - (i + 1);
+        return true;
+    }
+    return false;
+}
+
+size_t GatewayPlayback::poll(size_t max_batch, const Visitor& visitor) {
+    if (!m_file.is_open()) {
+        return 0;
+    }
+
+    const auto now = Clock::now();
+    size_t visited = 0;
+    while (visited < max_batch) {
+        uint64_t offset = 0;
+        size_t payload = 0;
+        size_t payloadLen = 0;
+        size_t next = 0;
+        if (!peek(offset, payload, payloadLen, next)) {
+            break;
+        }
+
+        if (!m_started) {
+            // The first dispatch of a recording is due immediately; later
+            // ones keep their recorded distance from it
+            if (m_count == 0) {
+                m_start = now;
+            }
+            m_started = true;
+            m_first_offset_us = offset;
+            m_base = now;
+        }
+        if (m_speed > 0 && offset > m_first_offset_us) {
+            const uint64_t dueUs = (offset - m_first_offset_us) / m_speed;
+            const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - m_base).count();
+            if (dueUs > static_cast<uint64_t>(elapsedUs)) {
+                break;
+            }
+        }
+
+        m_scratch.assign(reinterpret_cast<const char*>(m_file.data()) + payload, payloadLen);
+        m_position = next;
+        ++m_count;
+        ++visited;
+        visitor(m_scratch);
+    }
+    return visited;
+}
+
+std::chrono::steady_clock::duration GatewayPlayback::elapsed() const {
+    return m_count > 0 ? Clock::now() - m_start : Clock::duration::zero();
+}
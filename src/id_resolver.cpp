@@ -0,0 +1,410 @@
+/**
+ * ID Resolver - Implementation
+ */
+
+#include "id_resolver.h"
+#include "bot_manager.h"
+#include "discord_plugin.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+using json = nlohmann::json;
+
+// Gateway limits a Request Guild Members payload to 100 user IDs
+static const size_t kMaxChunkUserIds = 100;
+// How long to wait on member chunks before falling back to REST
+static const std::chrono::seconds kChunkTimeout(10);
+static const char kChunkNoncePrefix[] = "rune:";
+
+IdResolver::IdResolver(BotManager& bot)
+    : m_bot(bot) {
+}
+
+static ResolvedRecord record_from_user(const UserRecord& user) {
+    ResolvedRecord r;
+    r.found = user.found;
+    r.name = user.username;
+    r.secondary = user.global_name;
+    r.avatar_url = user.avatar_url;
+    r.is_bot = user.is_bot;
+    return r;
+}
+
+static ResolvedRecord record_from_channel(const ChannelRecord& channel) {
+    ResolvedRecord r;
+    r.found = channel.found;
+    r.name = channel.name;
+    r.secondary = channel.topic;
+    r.type = channel.type;
+    r.guild_id = channel.guild_id;
+    return r;
+}
+
+static ResolvedRecord record_from_member(const dpp::guild_member& member) {
+    ResolvedRecord r;
+    r.found = true;
+    r.secondary = member.get_nickname();
+    r.roles = member.get_roles();
+    r.joined_at = static_cast<int64_t>(member.joined_at);
+    if (dpp::user* user = dpp::find_user(member.user_id)) {
+        r.name = user->username;
+        r.is_bot = user->is_bot();
+    }
+    return r;
+}
+
+// A REST guild member object; its user comes with it rather than from DPP's cache
+static ResolvedRecord record_from_member_json(json& member, dpp::snowflake guild_id, dpp::snowflake user_id) {
+    dpp::guild_member parsed;
+    parsed.fill_from_json(&member, guild_id, user_id);
+    ResolvedRecord r = record_from_member(parsed);
+    auto user = member.find("user");
+    if (user != member.end() && user->is_object()) {
+        r.name = user->value("username", std::string());
+        r.is_bot = user->value("bot", false);
+    }
+    return r;
+}
+
+static ResolvedRecord record_from_stored_member(const StoredMember& member) {
+    ResolvedRecord r;
+    r.found = true;
+    r.name = member.username;
+    r.secondary = member.nickname;
+    r.is_bot = member.is_bot;
+    r.roles = member.roles;
+    r.joined_at = member.joined_at;
+    return r;
+}
+
+static dpp::snowflake parse_snowflake(const std::string& s) {
+    return std::strtoull(s.c_str(), nullptr, 10);
+}
+
+static bool lookup_cached(BotManager& bot, ResolveKind kind, dpp::snowflake guild_id,
+                          dpp::snowflake id, ResolvedRecord& out) {
+    switch (kind) {
+        case ResolveKind::User: {
+            UserRecord user;
+            if (!bot.peek_user(id, user)) return false;
+            out = record_from_user(user);
+            return true;
+        }
+        case ResolveKind::Channel: {
+            ChannelRecord channel;
+            if (!bot.peek_channel(id, channel)) return false;
+            out = record_from_channel(channel);
+            return true;
+        }
+        case ResolveKind::Member: {
+            StoredMember stored;
+            if (bot.member_store().get_member(guild_id, id, stored)) {
+                out = record_from_stored_member(stored);
+                return true;
+            }
+            try {
+                out = record_from_member(dpp::find_guild_member(guild_id, id));
+                return true;
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+void IdResolver::resolve(ResolveKind kind, dpp::snowflake guild_id,
+                         const std::vector<dpp::snowflake>& ids, ResolveCallback callback) {
+    auto batch = std::make_shared<Batch>();
+    batch->id = m_next_batch++;
+    batch->kind = kind;
+    batch->guild_id = guild_id;
+    batch->callback = std::move(callback);
+    batch->results.resize(ids.size());
+    batch->positions.reserve(ids.size());
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        batch->results[i].id = ids[i];
+        batch->positions[ids[i]].push_back(i);
+    }
+    batch->unresolved = batch->positions.size();
+    m_batches[batch->id] = batch;
+
+    // Single pass over unique IDs: answer what the caches hold, queue the rest
+    std::vector<dpp::snowflake> misses;
+    std::vector<std::pair<dpp::snowflake, ResolvedRecord>> hits;
+    for (const auto& entry : batch->positions) {
+        ResolvedRecord record;
+        if (lookup_cached(m_bot, kind, guild_id, entry.first, record)) {
+            hits.emplace_back(entry.first, std::move(record));
+        } else {
+            misses.push_back(entry.first);
+        }
+    }
+    for (const auto& hit : hits) {
+        fill(*batch, hit.first, hit.second);
+    }
+
+    if (!misses.empty()) {
+        const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
+        if (kind == ResolveKind::Member && cfg.intent_guild_members && m_bot.is_online()) {
+            request_member_chunks(*batch, misses);
+        } else {
+            batch->rest_queue = std::move(misses);
+        }
+        pump_rest(batch);
+    }
+
+    finish_if_done(batch);
+}
+
+void IdResolver::fill(Batch& batch, dpp::snowflake id, const ResolvedRecord& record) {
+    auto it = batch.positions.find(id);
+    if (it == batch.positions.end()) {
+        return;  // already answered (e.g. chunk and REST raced)
+    }
+    for (size_t pos : it->second) {
+        batch.results[pos] = record;
+        batch.results[pos].id = id;
+    }
+    batch.positions.erase(it);
+    --batch.unresolved;
+}
+
+void IdResolver::request_member_chunks(Batch& batch, const std::vector<dpp::snowflake>& ids) {
+    const std::string nonce = kChunkNoncePrefix + std::to_string(batch.id);
+    for (size_t start = 0; start < ids.size(); start += kMaxChunkUserIds) {
+        const size_t end = std::min(ids.size(), start + kMaxChunkUserIds);
+        json userIds = json::array();
+        for (size_t i = start; i < end; ++i) {
+            userIds.push_back(std::to_string(static_cast<uint64_t>(ids[i])));
+        }
+        json payload = {
+            {"op", 8},
+            {"d", {
+                {"guild_id", std::to_string(static_cast<uint64_t>(batch.guild_id))},
+                {"user_ids", userIds},
+                {"presences", false},
+                {"nonce", nonce}
+            }}
+        };
+        if (!m_bot.send_guild_gateway_payload(batch.guild_id, payload.dump())) {
+            // Shard not connected: everything not yet requested goes to REST
+            batch.rest_queue.assign(ids.begin() + start, ids.end());
+            if (start == 0) {
+                return;
+            }
+            break;
+        }
+    }
+
+    batch.awaiting_chunks = true;
+    batch.chunk_deadline = std::chrono::steady_clock::now() + kChunkTimeout;
+    ++m_chunk_waiters;
+}
+
+void IdResolver::pump_rest(const std::shared_ptr<Batch>& batch) {
+    const size_t limit = std::max<uint32_t>(1, GetDiscordPluginConfig().rest_max_concurrency);
+
+    while (batch->rest_in_flight < limit && batch->rest_next < batch->rest_queue.size()) {
+        const dpp::snowflake id = batch->rest_queue[batch->rest_next++];
+        ++batch->rest_in_flight;
+
+        auto on_result = [this, batch, id](const ResolvedRecord& record) {
+            --batch->rest_in_flight;
+            fill(*batch, id, record);
+            pump_rest(batch);
+            finish_if_done(batch);
+        };
+
+        switch (batch->kind) {
+            case ResolveKind::User:
+                m_bot.fetch_user(id, [on_result](const UserRecord& user) {
+                    on_result(record_from_user(user));
+                });
+                break;
+            case ResolveKind::Channel:
+                m_bot.fetch_channel(id, [on_result](const ChannelRecord& channel) {
+                    on_result(record_from_channel(channel));
+                });
+                break;
+            case ResolveKind::Member: {
+                BotManager* bot = &m_bot;
+                const dpp::snowflake guild_id = batch->guild_id;
+                auto on_member = [bot, on_result, guild_id, id](const TransportResponse& response) {
+                    ResolvedRecord record;
+                    json member = response.status == 200 ? json::parse(response.body, nullptr, false) : json();
+                    if (member.is_object()) {
+                        record = record_from_member_json(member, guild_id, id);
+                    }
+                    bot->post_to_main([on_result, record]() { on_result(record); });
+                };
+                m_bot.rest_request(RestRoute::GetMember, "GET",
+                                   "/guilds/" + std::to_string(static_cast<uint64_t>(guild_id)) + "/members/" +
+                                   std::to_string(static_cast<uint64_t>(id)),
+                                   std::string(), on_member);
+                break;
+            }
+        }
+    }
+}
+
+void IdResolver::finish_if_done(const std::shared_ptr<Batch>& batch) {
+    if (batch->unresolved > 0) {
+        return;
+    }
+
+    auto it = m_batches.find(batch->id);
+    if (it == m_batches.end()) {
+        return;  // already finished or cleared
+    }
+    m_batches.erase(it);
+
+    if (batch->awaiting_chunks) {
+        batch->awaiting_chunks = false;
+        --m_chunk_waiters;
+    }
+
+    if (batch->callback) {
+        batch->callback(batch->results);
+    }
+}
+
+void IdResolver::on_members_chunk(const json& d) {
+    if (m_chunk_waiters.load() == 0) {
+        return;
+    }
+
+    auto nonceIt = d.find("nonce");
+    if (nonceIt == d.end() || !nonceIt->is_string()) {
+        return;
+    }
+    const std::string nonce = nonceIt->get<std::string>();
+    const size_t prefixLen = sizeof(kChunkNoncePrefix) - 1;
+    if (nonce.compare(0, prefixLen, kChunkNoncePrefix) != 0) {
+        return;
+    }
+    const uint64_t batchId = std::strtoull(nonce.c_str() + prefixLen, nullptr, 10);
+
+    // Each member object carries its user, so records come straight from the
+    // payload rather than from DPP's cache or the member store
+    std::vector<ResolvedRecord> members;
+    auto list = d.find("members");
+    if (list != d.end() && list->is_array()) {
+        const dpp::snowflake guild_id = parse_snowflake(d.value("guild_id", std::string()));
+        members.reserve(list->size());
+        for (const auto& entry : *list) {
+            if (!entry.is_object() || !entry.contains("user") || !entry["user"].is_object()) {
+                continue;
+            }
+            const dpp::snowflake user_id = parse_snowflake(entry["user"].value("id", std::string()));
+            json member = entry;
+            ResolvedRecord record = record_from_member_json(member, guild_id, user_id);
+            record.id = user_id;
+            members.push_back(std::move(record));
+        }
+    }
+
+    std::vector<dpp::snowflake> notFound;
+    auto nf = d.find("not_found");
+    if (nf != d.end() && nf->is_array()) {
+        for (const auto& v : *nf) {
+            if (v.is_string()) {
+                notFound.push_back(std::strtoull(v.get<std::string>().c_str(), nullptr, 10));
+            } else if (v.is_number_unsigned()) {
+                notFound.push_back(v.get<uint64_t>());
+            }
+        }
+    }
+
+    m_bot.post_to_main([this, batchId, members = std::move(members), notFound = std::move(notFound)]() mutable {
+        apply_chunk(batchId, members, notFound);
+    });
+}
+
+void IdResolver::apply_chunk(uint64_t batch_id, std::vector<ResolvedRecord>& members,
+                             const std::vector<dpp::snowflake>& not_found) {
+    auto it = m_batches.find(batch_id);
+    if (it == m_batches.end()) {
+        return;
+    }
+    std::shared_ptr<Batch> batch = it->second;
+
+    for (const auto& record : members) {
+        fill(*batch, record.id, record);
+    }
+    for (dpp::snowflake id : not_found) {
+        fill(*batch, id, ResolvedRecord());
+    }
+    finish_if_done(batch);
+}
+
+void IdResolver::tick() {
+    if (m_chunk_waiters.load() == 0) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<Batch>> expired;
+    for (const auto& entry : m_batches) {
+        const auto& batch = entry.second;
+        if (batch->awaiting_chunks && now >= batch->chunk_deadline) {
+            expired.push_back(batch);
+        }
+    }
+
+    // Whatever the chunks did not answer goes through REST
+    for (const auto& batch : expired) {
+        batch->awaiting_chunks = false;
+        --m_chunk_waiters;
+        for (const auto& entry : batch->positions) {
+            batch->rest_queue.push_back(entry.first);
+        }
+        pump_rest(batch);
+        finish_if_done(batch);
+    }
+}
+
+void IdResolver::clear() {
+    m_batches.clear();
+    m_chunk_waiters = 0;
+}
+
+std::string IdResolver::records_to_json(ResolveKind kind, const std::vector<ResolvedRecord>& records) {
+    json arr = json::array();
+    for (const auto& r : records) {
+        json item = {
+            {"id", std::to_string(static_cast<uint64_t>(r.id))},
+            {"found", r.found}
+        };
+        switch (kind) {
+            case ResolveKind::User:
+                item["username"] = r.name;
+                item["global_name"] = r.secondary;
+                item["avatar_url"] = r.avatar_url;
+                item["is_bot"] = r.is_bot;
+                break;
+            case ResolveKind::Member: {
+                item["username"] = r.name;
+                item["nickname"] = r.secondary;
+                item["is_bot"] = r.is_bot;
+                json roles = json::array();
+                for (dpp::snowflake role : r.roles) {
+                    roles.push_back(std::to_string(static_cast<uint64_t>(role)));
+                }
+                item["roles"] = roles;
+                item["joined_at"] = r.joined_at;
+                break;
+            }
+            case ResolveKind::Channel:
+                item["name"] = r.name;
+                item["topic"] = r.secondary;
+                item["type"] = r.type;
+                item["guild_id"] = std::to_string(static_cast<uint64_t>(r.guild_id));
+                break;
+        }
+        arr.push_back(std::move(item));
+    }
+    return arr.dump(-1, ' ', false, json::error_handler_t::replace);
+}
@@ -0,0 +1,242 @@
+/**
+ * Interaction Tracker - Implementation
+ */
+
+#include "interaction_tracker.h"
+#include "bot_manager.h"
+#include "metrics.h"
+#include "plugin_log.h"
+
+constexpr std::chrono::minutes InteractionTracker::kTokenLifetime;
+
+InteractionTracker::InteractionTracker(BotManager& bot) : m_bot(bot) {}
+
+InteractionTracker::~InteractionTracker() {
+    clear();
+}
+
+void InteractionTracker::track(dpp::snowflake id, dpp::snowflake application_id, const std::string& token,
+                               std::chrono::milliseconds auto_defer, bool component) {
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    expire_locked(now);
+    auto inserted = m_entries.try_emplace(id);
+    if (!inserted.second) {
+        return;
+    }
+    Entry& entry = inserted.first->second;
+    entry.application_id = application_id;
+    entry.token = token;
+    entry.component = component;
+    m_expiry.emplace_back(now, id);
+    discord_metrics().pending_interactions.set(static_cast<int64_t>(m_entries.size()));
+
+    if (auto_defer.count() > 0) {
+        if (!m_thread.joinable()) {
+            m_thread = std::thread([this]() { run(); });
+        }
+        Deadline deadline;
+        deadline.at = now + auto_defer;
+        deadline.id = id;
+        m_deadlines.push(deadline);
+        m_wake.notify_one();
+    }
+}
+
+InteractionCall InteractionTracker::make_call(InteractionCallKind kind, dpp::snowflake id, const Entry& entry,
+                                              const dpp::message& msg) {
+    InteractionCall call;
+    call.kind = kind;
+    call.interaction_id = id;
+    call.application_id = entry.application_id;
+    call.token = entry.token;
+    call.message = msg;
+    return call;
+}
+
+bool InteractionTracker::respond(dpp::snowflake id, const dpp::message& msg) {
+    InteractionCall call;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        expire_locked(Clock::now());
+        auto it = m_entries.find(id);
+        if (it == m_entries.end()) {
+            return false;
+        }
+        Entry& entry = it->second;
+        switch (entry.state) {
+            case State::Pending:
+                entry.state = State::Sending;
+                call = make_call(InteractionCallKind::Respond, id, entry, msg);
+                break;
+            case State::Sending:
+                entry.held.push_back(msg);
+                return true;
+            case State::Deferred:
+                entry.state = State::Responded;
+                call = make_call(InteractionCallKind::EditOriginal, id, entry, msg);
+                break;
+            case State::Responded:
+                call = make_call(InteractionCallKind::Followup, id, entry, msg);
+                break;
+        }
+    }
+
+    if (call.kind == InteractionCallKind::Respond) {
+        send_initial(call);
+    } else {
+        m_bot.send_interaction_call(call, nullptr);
+    }
+    return true;
+}
+
+void InteractionTracker::release(dpp::snowflake id, const dpp::message& notice) {
+    InteractionCall call;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(id);
+        if (it == m_entries.end()) {
+            return;
+        }
+        Entry& entry = it->second;
+        if (entry.state == State::Pending) {
+            // Its deadline finds no entry and sends nothing; the expiry queue
+            // skips IDs that are gone
+            m_entries.erase(it);
+            discord_metrics().pending_interactions.set(static_cast<int64_t>(m_entries.size()));
+            return;
+        }
+        if (entry.component) {
+            return;  // an update defer shows nothing
+        }
+        switch (entry.state) {
+            case State::Sending:
+                entry.held.push_back(notice);
+                return;
+            case State::Deferred:
+                entry.state = State::Responded;
+                call = make_call(InteractionCallKind::EditOriginal, id, entry, notice);
+                break;
+            default:
+                return;
+        }
+    }
+    m_bot.send_interaction_call(call, nullptr);
+}
+
+void InteractionTracker::send_initial(const InteractionCall& call) {
+    const dpp::snowflake id = call.interaction_id;
+    const InteractionCallKind kind = call.kind;
+    m_bot.send_interaction_call(call, [this, id, kind](bool ok) {
+        on_initial_sent(id, kind, ok);
+    });
+}
+
+void InteractionTracker::on_initial_sent(dpp::snowflake id, InteractionCallKind kind, bool ok) {
+    std::vector<InteractionCall> calls;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(id);
+        if (it == m_entries.end()) {
+            return;
+        }
+        Entry& entry = it->second;
+        std::vector<dpp::message> held;
+        held.swap(entry.held);
+        if (!ok) {
+            // The token is most likely dead; anything else sent on it would fail too
+            entry.state = State::Responded;
+            if (!held.empty()) {
+                DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, "Discord plugin: dropped " + std::to_string(held.size()) +
+                    " response(s) to interaction " + std::to_string(static_cast<uint64_t>(id)) +
+                    " after its initial response failed");
+            }
+            return;
+        }
+
+        // After an update defer there is no response of ours to edit
+        entry.state = kind == InteractionCallKind::Defer ? State::Deferred : State::Responded;
+        for (const dpp::message& msg : held) {
+            InteractionCallKind next = InteractionCallKind::Followup;
+            if (entry.state == State::Deferred) {
+                entry.state = State::Responded;
+                next = InteractionCallKind::EditOriginal;
+            }
+            calls.push_back(make_call(next, id, entry, msg));
+        }
+    }
+    for (const InteractionCall& call : calls) {
+        m_bot.send_interaction_call(call, nullptr);
+    }
+}
+
+void InteractionTracker::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        const Clock::time_point now = Clock::now();
+        expire_locked(now);
+
+        std::vector<InteractionCall> defers;
+        while (!m_deadlines.empty() && m_deadlines.top().at <= now) {
+            const dpp::snowflake id = m_deadlines.top().id;
+            m_deadlines.pop();
+            auto it = m_entries.find(id);
+            if (it != m_entries.end() && it->second.state == State::Pending) {
+                it->second.state = State::Sending;
+                const InteractionCallKind kind =
+                    it->second.component ? InteractionCallKind::DeferUpdate : InteractionCallKind::Defer;
+                defers.push_back(make_call(kind, id, it->second, dpp::message()));
+            }
+        }
+        if (!defers.empty()) {
+            lock.unlock();
+            for (const InteractionCall& call : defers) {
+                discord_metrics().interactions_auto_deferred.add();
+                send_initial(call);
+            }
+            lock.lock();
+            continue;
+        }
+
+        if (m_deadlines.empty()) {
+            m_wake.wait(lock);
+        } else {
+            m_wake.wait_until(lock, m_deadlines.top().at);
+        }
+    }
+}
+
+void InteractionTracker::expire_locked(Clock::time_point now) {
+    bool expired = false;
+    while (!m_expiry.empty() && now - m_expiry.front().first >= kTokenLifetime) {
+        m_entries.erase(m_expiry.front().second);
+        m_expiry.pop_front();
+        expired = true;
+    }
+    if (expired) {
+        discord_metrics().pending_interactions.set(static_cast<int64_t>(m_entries.size()));
+    }
+}
+
+void InteractionTracker::clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = false;
+    m_entries.clear();
+    m_expiry.clear();
+    m_deadlines = decltype(m_deadlines)();
+    discord_metrics().pending_interactions.set(0);
+}
+
+size_t InteractionTracker::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
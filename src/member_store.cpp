@@ -0,0 +1,385 @@
+/**
+ * Member Store - Implementation
+ */
+
+#include "member_store.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+using json = nlohmann::json;
+
+static const uint32_t kFreeRow = UINT32_MAX;
+static const uint8_t kUserFlagBot = 1;
+
+static unsigned lowest_bit(uint64_t bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+}
+
+// ============================================================================
+// StringInterner
+// ============================================================================
+
+static uint64_t hash_bytes(const char* data, size_t size) {
+    uint64_t h = 14695981039346656037ULL;  // FNV-1a
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+StringInterner::StringInterner() {
+    clear();
+}
+
+void StringInterner::clear() {
+    m_arena.clear();
+    m_offsets.assign(2, 0);  // id 0: the empty string
+    m_table.assign(64, 0);
+}
+
+bool StringInterner::equals(uint32_t id, const char* data, size_t size) const {
+    const uint32_t begin = m_offsets[id];
+    const uint32_t end = m_offsets[id + 1];
+    return end - begin == size && std::memcmp(m_arena.data() + begin, data, size) == 0;
+}
+
+uint32_t StringInterner::intern(const char* data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    const size_t mask = m_table.size() - 1;
+    size_t slot = static_cast<size_t>(hash_bytes(data, size)) & mask;
+    while (m_table[slot] != 0) {
+        if (equals(m_table[slot], data, size)) {
+            return m_table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    const uint32_t id = static_cast<uint32_t>(m_offsets.size() - 1);
+    m_arena.append(data, size);
+    m_offsets.push_back(static_cast<uint32_t>(m_arena.size()));
+    m_table[slot] = id;
+
+    // Keep the table at most three quarters full
+    if (size_t(id) * 4 >= m_table.size() * 3) {
+        grow_table();
+    }
+    return id;
+}
+
+void StringInterner::grow_table() {
+    std::vector<uint32_t> table(m_table.size() * 2, 0);
+    const size_t mask = table.size() - 1;
+    for (uint32_t id = 1; id + 1 < m_offsets.size(); ++id) {
+        const uint32_t begin = m_offsets[id];
+        size_t slot = static_cast<size_t>(hash_bytes(m_arena.data() + begin, m_offsets[id + 1] - begin)) & mask;
+        while (table[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = id;
+    }
+    m_table.swap(table);
+}
+
+std::string StringInterner::get(uint32_t id) const {
+    if (id == 0 || id + 1 >= m_offsets.size()) {
+        return std::string();
+    }
+    return std::string(m_arena.data() + m_offsets[id], m_offsets[id + 1] - m_offsets[id]);
+}
+
+size_t StringInterner::memory_bytes() const {
+    return m_arena.capacity() + m_offsets.capacity() * sizeof(uint32_t) + m_table.capacity() * sizeof(uint32_t);
+}
+
+// ============================================================================
+// JSON helpers
+// ============================================================================
+
+static uint64_t json_snowflake(const json& j) {
+    if (j.is_string()) {
+        return std::strtoull(j.get_ref<const std::string&>().c_str(), nullptr, 10);
+    }
+    if (j.is_number_unsigned()) {
+        return j.get<uint64_t>();
+    }
+    return 0;
+}
+
+static uint64_t json_snowflake(const json& obj, const char* key) {
+    auto it = obj.find(key);
+    return it == obj.end() ? 0 : json_snowflake(*it);
+}
+
+static const std::string& json_string(const json& obj, const char* key) {
+    static const std::string empty;
+    auto it = obj.find(key);
+    return (it != obj.end() && it->is_string()) ? it->get_ref<const std::string&>() : empty;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Discord timestamps: "2021-05-01T12:34:56.789000+00:00" (always UTC).
+// Fractional seconds and the offset are ignored; 0 on malformed input.
+static uint32_t parse_iso8601(const std::string& s) {
+    unsigned year, month, day, hour, minute, second;
+    if (s.size() < 19 ||
+        std::sscanf(s.c_str(), "%4u-%2u-%2uT%2u:%2u:%2u", &year, &month, &day, &hour, &minute, &second) != 6) {
+        return 0;
+    }
+    const int64_t t = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return t > 0 && t <= static_cast<int64_t>(UINT32_MAX) ? static_cast<uint32_t>(t) : 0;
+}
+
+// ============================================================================
+// MemberStore
+// ============================================================================
+
+uint32_t MemberStore::upsert_user_locked(const json& user) {
+    const uint64_t user_id = json_snowflake(user, "id");
+    auto keyOf = [this](uint32_t r) { return user_key(r); };
+
+    uint32_t row = m_user_index.find(user_id, keyOf);
+    if (row == RowIndex::kNotFound) {
+        row = static_cast<uint32_t>(m_user_ids.size());
+        m_user_ids.push_back(user_id);
+        m_usernames.push_back(0);
+        m_global_names.push_back(0);
+        m_user_flags.push_back(0);
+        m_user_index.insert(user_id, row, keyOf);
+    }
+
+    m_usernames[row] = m_names.intern(json_string(user, "username"));
+    m_global_names[row] = m_names.intern(json_string(user, "global_name"));
+    auto bot = user.find("bot");
+    m_user_flags[row] = (bot != user.end() && bot->is_boolean() && bot->get<bool>()) ? kUserFlagBot : 0;
+    return row;
+}
+
+uint16_t MemberStore::role_bit_locked(GuildColumns& guild, dpp::snowflake role_id) {
+    auto it = guild.role_bit.find(role_id);
+    if (it != guild.role_bit.end()) {
+        return it->second;
+    }
+
+    const uint16_t bit = static_cast<uint16_t>(guild.role_ids.size());
+    guild.role_ids.push_back(role_id);
+    guild.role_bit.try_emplace(role_id, bit);
+
+    // Widen every row's bitset by one word when the guild outgrows it
+    if (bit / 64 >= guild.role_words) {
+        const size_t oldWords = guild.role_words;
+        const size_t newWords = oldWords + 1;
+        const size_t rows = guild.user_row.size();
+        std::vector<uint64_t> bits(rows * newWords, 0);
+        for (size_t r = 0; r < rows; ++r) {
+            std::memcpy(&bits[r * newWords], &guild.role_bits[r * oldWords], oldWords * sizeof(uint64_t));
+        }
+        guild.role_bits.swap(bits);
+        guild.role_words = newWords;
+    }
+    return bit;
+}
+
+void MemberStore::upsert_member_locked(GuildColumns& guild, const json& member) {
+    auto user = member.find("user");
+    if (user == member.end() || !user->is_object()) {
+        return;
+    }
+    const dpp::snowflake user_id = json_snowflake(*user, "id");
+    if (user_id == 0) {
+        return;
+    }
+    const uint32_t userRow = upsert_user_locked(*user);
+
+    auto keyOf = [this, &guild](uint32_t r) { return member_key(guild, r); };
+    uint32_t row = guild.index.find(user_id, keyOf);
+    if (row == RowIndex::kNotFound) {
+        if (!guild.free_rows.empty()) {
+            row = guild.free_rows.back();
+            guild.free_rows.pop_back();
+        } else {
+            row = static_cast<uint32_t>(guild.user_row.size());
+            guild.user_row.push_back(kFreeRow);
+            guild.nickname.push_back(0);
+            guild.joined_at.push_back(0);
+            guild.role_bits.resize(guild.role_bits.size() + guild.role_words, 0);
+        }
+        // The index reads the key back through user_row, so set it first
+        guild.user_row[row] = userRow;
+        guild.index.insert(user_id, row, keyOf);
+        ++m_member_count;
+    }
+
+    guild.user_row[row] = userRow;
+    guild.nickname[row] = m_names.intern(json_string(member, "nick"));
+    guild.joined_at[row] = parse_iso8601(json_string(member, "joined_at"));
+
+    std::fill_n(guild.role_bits.begin() + row * guild.role_words, guild.role_words, 0);
+    auto roles = member.find("roles");
+    if (roles != member.end() && roles->is_array()) {
+        for (const auto& role : *roles) {
+            const uint16_t bit = role_bit_locked(guild, json_snowflake(role));
+            // role_bit_locked may have widened the rows
+            guild.role_bits[row * guild.role_words + bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+}
+
+void MemberStore::ingest_chunk(const json& d) {
+    const dpp::snowflake guild_id = json_snowflake(d, "guild_id");
+    auto members = d.find("members");
+    if (guild_id == 0 || members == d.end() || !members->is_array()) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    GuildColumns& guild = m_guilds[guild_id];
+    for (const auto& member : *members) {
+        upsert_member_locked(guild, member);
+    }
+}
+
+void MemberStore::upsert_member(const json& d) {
+    const dpp::snowflake guild_id = json_snowflake(d, "guild_id");
+    if (guild_id == 0) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    upsert_member_locked(m_guilds[guild_id], d);
+}
+
+void MemberStore::remove_member(dpp::snowflake guild_id, dpp::snowflake user_id) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto g = m_guilds.find(guild_id);
+    if (g == m_guilds.end()) {
+        return;
+    }
+    GuildColumns& guild = g->second;
+    auto keyOf = [this, &guild](uint32_t r) { return member_key(guild, r); };
+    const uint32_t row = guild.index.find(user_id, keyOf);
+    if (row == RowIndex::kNotFound) {
+        return;
+    }
+
+    guild.index.erase(user_id, keyOf);
+    guild.user_row[row] = kFreeRow;
+    guild.nickname[row] = 0;
+    std::fill_n(guild.role_bits.begin() + row * guild.role_words, guild.role_words, 0);
+    guild.free_rows.push_back(row);
+    --m_member_count;
+}
+
+void MemberStore::remove_guild(dpp::snowflake guild_id) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto g = m_guilds.find(guild_id);
+    if (g == m_guilds.end()) {
+        return;
+    }
+    m_member_count -= g->second.index.size();
+    m_guilds.erase(g);
+}
+
+void MemberStore::clear() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_guilds = SnowflakeMap<GuildColumns>();
+    m_user_index = RowIndex();
+    m_user_ids = {};
+    m_usernames = {};
+    m_global_names = {};
+    m_user_flags = {};
+    m_names.clear();
+    m_member_count = 0;
+}
+
+bool MemberStore::get_user(dpp::snowflake user_id, StoredUser& out) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const uint32_t row = m_user_index.find(user_id, [this](uint32_t r) { return user_key(r); });
+    if (row == RowIndex::kNotFound) {
+        return false;
+    }
+    out.username = m_names.get(m_usernames[row]);
+    out.global_name = m_names.get(m_global_names[row]);
+    out.is_bot = (m_user_flags[row] & kUserFlagBot) != 0;
+    return true;
+}
+
+bool MemberStore::get_member(dpp::snowflake guild_id, dpp::snowflake user_id, StoredMember& out) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto g = m_guilds.find(guild_id);
+    if (g == m_guilds.end()) {
+        return false;
+    }
+    const GuildColumns& guild = g->second;
+    const uint32_t row = guild.index.find(user_id, [this, &guild](uint32_t r) { return member_key(guild, r); });
+    if (row == RowIndex::kNotFound) {
+        return false;
+    }
+
+    const uint32_t userRow = guild.user_row[row];
+    out.username = m_names.get(m_usernames[userRow]);
+    out.global_name = m_names.get(m_global_names[userRow]);
+    out.is_bot = (m_user_flags[userRow] & kUserFlagBot) != 0;
+    out.nickname = m_names.get(guild.nickname[row]);
+    out.joined_at = guild.joined_at[row];
+
+    out.roles.clear();
+    const uint64_t* words = &guild.role_bits[row * guild.role_words];
+    for (size_t w = 0; w < guild.role_words; ++w) {
+        for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+            out.roles.push_back(guild.role_ids[w * 64 + lowest_bit(bits)]);
+        }
+    }
+    return true;
+}
+
+size_t MemberStore::member_count() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_member_count;
+}
+
+size_t MemberStore::user_count() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_user_ids.size();
+}
+
+size_t MemberStore::memory_bytes() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    size_t bytes = m_names.memory_bytes() + m_user_index.memory_bytes() + m_guilds.memory_bytes();
+    bytes += m_user_ids.capacity() * sizeof(uint64_t);
+    bytes += (m_usernames.capacity() + m_global_names.capacity()) * sizeof(uint32_t);
+    bytes += m_user_flags.capacity();
+    for (const auto& entry : m_guilds) {
+        const GuildColumns& g = entry.second;
+        bytes += g.index.memory_bytes() + g.role_bit.memory_bytes();
+        bytes += (g.user_row.capacity() + g.nickname.capacity() + g.joined_at.capacity() + g.free_rows.capacity()) * sizeof(uint32_t);
+        bytes += g.role_bits.capacity() * sizeof(uint64_t);
+        bytes += g.role_ids.capacity() * sizeof(dpp::snowflake);
+    }
+    return bytes;
+}
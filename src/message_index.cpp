@@ -0,0 +1,359 @@
+/**
+ * Message Index - Implementation
+ */
+
+#include "message_index.h"
+#include <algorithm>
+#include <ctime>
+#include <mutex>
+
+// Posting lists below this size are never worth a compaction pass
+static const size_t kMinCompactPostings = 4096;
+
+static int64_t unix_now() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+void MessageIndex::tokenize(const std::string& text, std::vector<uint64_t>& out) {
+    static const uint64_t kOffset = 14695981039346656037ULL;  // FNV-1a
+    static const uint64_t kPrime = 1099511628211ULL;
+
+    out.clear();
+    uint64_t hash = kOffset;
+    size_t length = 0;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        const bool word = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+        if (word) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<unsigned char>(c - 'A' + 'a');
+            }
+            hash = (hash ^ c) * kPrime;
+            ++length;
+        } else if (length > 0) {
+            out.push_back(hash);
+            hash = kOffset;
+            length = 0;
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    if (out.size() > UINT16_MAX) {
+        out.resize(UINT16_MAX);
+    }
+}
+
+void MessageIndex::configure(size_t max_messages, size_t max_bytes, std::chrono::seconds window, Eviction eviction) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_max_messages = max_messages;
+    m_max_bytes = max_bytes;
+    m_window = window;
+    m_eviction = eviction;
+}
+
+const MessageIndex::Entry* MessageIndex::entry_at(uint32_t seq) const {
+    if (seq < m_base_seq || seq - m_base_seq >= m_entries.size()) {
+        return nullptr;
+    }
+    return &m_entries[seq - m_base_seq];
+}
+
+// Estimated cost of one message: record, text and its postings
+size_t MessageIndex::entry_bytes(const Entry& entry) const {
+    return sizeof(Entry) + entry.content.size() + (entry.token_count + 2u) * sizeof(uint32_t);
+}
+
+// First index in [0, bound) whose value is >= seq, or bound if none. Queries
+// walk from newest to oldest, so the answer is usually just below the
+// previous one: probe downwards in doubling steps, then binary search.
+static size_t gallop_down(const std::vector<uint32_t>& list, size_t bound, uint32_t seq) {
+    size_t hi = bound;
+    size_t step = 1;
+    while (hi > 0) {
+        const size_t probe = hi > step ? hi - step : 0;
+        if (list[probe] < seq) {
+            return static_cast<size_t>(std::lower_bound(list.begin() + static_cast<std::ptrdiff_t>(probe) + 1,
+                                                        list.begin() + static_cast<std::ptrdiff_t>(hi), seq) - list.begin());
+        }
+        hi = probe;
+        step *= 2;
+    }
+    return 0;
+}
+
+void MessageIndex::add(const IndexedMessage& message) {
+    std::vector<uint64_t> tokens;
+    tokenize(message.content, tokens);
+
+    const int64_t now = unix_now();
+    Entry entry;
+    entry.id = message.id;
+    entry.author_id = message.author_id;
+    entry.channel_id = message.channel_id;
+    entry.guild_id = message.guild_id;
+    entry.timestamp = static_cast<uint32_t>(message.timestamp > 0 ? message.timestamp : now);
+    entry.token_count = static_cast<uint16_t>(tokens.size());
+    entry.deleted = false;
+    entry.content = message.content;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    const size_t bytes = entry_bytes(entry);
+    if (m_max_messages == 0 || bytes > m_max_bytes) {
+        return;
+    }
+
+    expire_locked(now);
+    if (m_eviction == Eviction::Oldest) {
+        while (!m_entries.empty() && (m_entries.size() >= m_max_messages || m_bytes + bytes > m_max_bytes)) {
+            evict_front_locked();
+        }
+    } else if (m_entries.size() >= m_max_messages || m_bytes + bytes > m_max_bytes) {
+        return;
+    }
+
+    if (static_cast<uint64_t>(m_base_seq) + m_entries.size() >= UINT32_MAX) {
+        renumber_locked();
+    }
+    const uint32_t seq = m_base_seq + static_cast<uint32_t>(m_entries.size());
+    m_entries.push_back(std::move(entry));
+    index_locked(seq, m_entries.back(), tokens);
+    m_bytes += bytes;
+
+    if (m_total_postings > kMinCompactPostings && m_total_postings > 2 * m_live_postings) {
+        compact_postings_locked();
+    }
+}
+
+void MessageIndex::index_locked(uint32_t seq, const Entry& entry, const std::vector<uint64_t>& tokens) {
+    for (uint64_t token : tokens) {
+        m_words[token].push_back(seq);
+    }
+    m_by_author[entry.author_id].push_back(seq);
+    m_by_channel[entry.channel_id].push_back(seq);
+    m_live_postings += tokens.size() + 2;
+    m_total_postings += tokens.size() + 2;
+}
+
+// Arrival order is close enough to timestamp order that expiring from the
+// front only ever keeps a message a few seconds past the window
+void MessageIndex::expire_locked(int64_t now) {
+    const int64_t cutoff = now - static_cast<int64_t>(m_window.count());
+    while (!m_entries.empty() && static_cast<int64_t>(m_entries.front().timestamp) < cutoff) {
+        evict_front_locked();
+    }
+}
+
+void MessageIndex::evict_front_locked() {
+    const Entry& front = m_entries.front();
+    m_bytes -= entry_bytes(front);
+    m_live_postings -= front.token_count + 2u;
+    m_entries.pop_front();
+    ++m_base_seq;
+}
+
+// Drops the postings of evicted messages, which all sit at the front of
+// each list, and lists that end up empty
+void MessageIndex::compact_postings_locked() {
+    size_t total = 0;
+    auto compact = [this, &total](auto& map) {
+        for (auto it = map.begin(); it != map.end();) {
+            Postings& list = it->second;
+            list.erase(list.begin(), std::lower_bound(list.begin(), list.end(), m_base_seq));
+            if (list.empty()) {
+                it = map.erase(it);
+                continue;
+            }
+            if (list.capacity() > 2 * list.size()) {
+                list.shrink_to_fit();
+            }
+            total += list.size();
+            ++it;
+        }
+    };
+    compact(m_words);
+    compact(m_by_author);
+    compact(m_by_channel);
+    m_total_postings = total;
+}
+
+// Sequence numbers are 32-bit; after four billion messages the survivors are
+// re-indexed from zero
+void MessageIndex::renumber_locked() {
+    m_words.clear();
+    m_by_author.clear();
+    m_by_channel.clear();
+    m_base_seq = 0;
+    m_live_postings = 0;
+    m_total_postings = 0;
+    m_bytes = 0;
+
+    std::vector<uint64_t> tokens;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        Entry& entry = m_entries[i];
+        tokenize(entry.content, tokens);
+        entry.token_count = static_cast<uint16_t>(tokens.size());
+        index_locked(static_cast<uint32_t>(i), entry, tokens);
+        m_bytes += entry_bytes(entry);
+    }
+}
+
+void MessageIndex::remove(dpp::snowflake channel_id, dpp::snowflake message_id) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_by_channel.find(channel_id);
+    if (it == m_by_channel.end()) {
+        return;
+    }
+
+    // Message IDs within a channel grow with arrival order, so binary search
+    // by ID and then look around the landing point for out-of-order arrivals
+    const Postings& list = it->second;
+    const uint64_t id = static_cast<uint64_t>(message_id);
+    auto id_of = [this](uint32_t seq) -> uint64_t {
+        const Entry* entry = entry_at(seq);
+        return entry ? entry->id : 0;
+    };
+    const size_t pos = static_cast<size_t>(std::lower_bound(list.begin(), list.end(), id,
+        [&id_of](uint32_t seq, uint64_t value) { return id_of(seq) < value; }) - list.begin());
+    const size_t from = pos > 8 ? pos - 8 : 0;
+    const size_t to = std::min(list.size(), pos + 8);
+    for (size_t i = from; i < to; ++i) {
+        if (!entry_at(list[i])) {
+            continue;
+        }
+        Entry& entry = m_entries[list[i] - m_base_seq];
+        if (entry.id == id && !entry.deleted) {
+            entry.deleted = true;
+            m_bytes -= entry.content.size();
+            std::string().swap(entry.content);
+            return;
+        }
+    }
+}
+
+void MessageIndex::clear() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_entries.clear();
+    m_words.clear();
+    m_by_author.clear();
+    m_by_channel.clear();
+    m_base_seq = 0;
+    m_live_postings = 0;
+    m_total_postings = 0;
+    m_bytes = 0;
+}
+
+size_t MessageIndex::search(const MessageQuery& query, std::vector<IndexedMessage>& out) const {
+    std::vector<uint64_t> tokens;
+    tokenize(query.text, tokens);
+    if (query.limit == 0) {
+        return 0;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const int64_t cutoff = std::max<int64_t>(query.since, unix_now() - static_cast<int64_t>(m_window.count()));
+    const uint64_t author = static_cast<uint64_t>(query.author_id);
+    const uint64_t channel = static_cast<uint64_t>(query.channel_id);
+    const uint64_t guild = static_cast<uint64_t>(query.guild_id);
+
+    // Every word must be indexed; author/channel lists may drive the walk
+    // but are otherwise checked against the record directly
+    std::vector<const Postings*> words;
+    for (uint64_t token : tokens) {
+        auto it = m_words.find(token);
+        if (it == m_words.end()) {
+            return 0;
+        }
+        words.push_back(&it->second);
+    }
+    const Postings* driver = nullptr;
+    auto consider = [&driver](const Postings* list) {
+        if (!driver || list->size() < driver->size()) {
+            driver = list;
+        }
+    };
+    for (const Postings* list : words) {
+        consider(list);
+    }
+    if (author != 0) {
+        auto it = m_by_author.find(author);
+        if (it == m_by_author.end()) {
+            return 0;
+        }
+        consider(&it->second);
+    }
+    if (channel != 0) {
+        auto it = m_by_channel.find(channel);
+        if (it == m_by_channel.end()) {
+            return 0;
+        }
+        consider(&it->second);
+    }
+
+    // Search bounds shrink as the walk moves to older sequence numbers
+    std::vector<size_t> bounds;
+    for (const Postings* list : words) {
+        bounds.push_back(list->size());
+    }
+
+    // Word lists are checked before the record is touched: postings are
+    // contiguous, records are scattered
+    const size_t before = out.size();
+    auto visit = [&](uint32_t seq, const Entry& entry) -> bool {
+        for (size_t k = 0; k < words.size(); ++k) {
+            const Postings& list = *words[k];
+            if (&list == driver) {
+                continue;
+            }
+            bounds[k] = gallop_down(list, bounds[k], seq);
+            if (bounds[k] == list.size() || list[bounds[k]] != seq) {
+                return true;
+            }
+        }
+        if (static_cast<int64_t>(entry.timestamp) < cutoff) {
+            return false;
+        }
+        if (entry.deleted || (author != 0 && entry.author_id != author) ||
+            (channel != 0 && entry.channel_id != channel) || (guild != 0 && entry.guild_id != guild)) {
+            return true;
+        }
+        IndexedMessage result;
+        result.id = entry.id;
+        result.author_id = entry.author_id;
+        result.channel_id = entry.channel_id;
+        result.guild_id = entry.guild_id;
+        result.timestamp = entry.timestamp;
+        result.content = entry.content;
+        out.push_back(std::move(result));
+        return out.size() - before < query.limit;
+    };
+
+    if (driver) {
+        for (size_t i = driver->size(); i-- > 0;) {
+            const uint32_t seq = (*driver)[i];
+            if (seq < m_base_seq) {
+                break;
+            }
+            if (!visit(seq, m_entries[seq - m_base_seq])) {
+                break;
+            }
+        }
+    } else {
+        // No word/author/channel filter: walk the whole history
+        for (size_t i = m_entries.size(); i-- > 0;) {
+            if (!visit(m_base_seq + static_cast<uint32_t>(i), m_entries[i])) {
+                break;
+            }
+        }
+    }
+    return out.size() - before;
+}
+
+size_t MessageIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t MessageIndex::memory_bytes() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_bytes + m_words.memory_bytes() + m_by_author.memory_bytes() + m_by_channel.memory_bytes();
+}
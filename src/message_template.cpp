@@ -0,0 +1,145 @@
+/**
+ * Message Template - Implementation
+ */
+
+#include "message_template.h"
+#include <cstring>
+
+static const char* const kFieldNames[MessageTemplate::kFieldCount] = {
+    "AuthorID", "AuthorName", "Content", "UserID", "Emoji", "ChannelID", "GuildID", "MessageID"
+};
+
+const char* MessageTemplate::field_name(Field field) {
+    return field < kFieldCount ? kFieldNames[field] : "";
+}
+
+bool MessageTemplate::compile(const std::string& source, std::string& error) {
+    m_source = source;
+    m_literals.clear();
+    m_segments.clear();
+    m_compiled = false;
+
+    size_t literalStart = 0;
+    auto flush_literal = [this, &source, &literalStart](size_t end) {
+        // Literal text is copied into one arena so rendering is a few memcpys
+        if (end > literalStart) {
+            Segment seg{ SegmentKind::Literal,
+                static_cast<uint32_t>(m_literals.size()), static_cast<uint32_t>(end - literalStart) };
+            m_literals.append(source, literalStart, end - literalStart);
+            // Merge adjacent literals (e.g. around an escaped brace)
+            if (!m_segments.empty() && m_segments.back().kind == SegmentKind::Literal) {
+                m_segments.back().length += seg.length;
+            } else {
+                m_segments.push_back(seg);
+            }
+        }
+    };
+
+    size_t i = 0;
+    while (i < source.size()) {
+        const char c = source[i];
+        if ((c == '{' || c == '}') && i + 1 < source.size() && source[i + 1] == c) {
+            flush_literal(i + 1);  // keep one brace
+            i += 2;
+            literalStart = i;
+            continue;
+        }
+
+        if (c == '}') {
+            error = "Unmatched '}' at position " + std::to_string(i) + " (use '}}' for a literal brace)";
+            m_segments.clear();
+            return false;
+        }
+
+        if (c != '{') {
+            ++i;
+            continue;
+        }
+
+        const size_t close = source.find('}', i + 1);
+        if (close == std::string::npos) {
+            error = "Unterminated placeholder starting at position " + std::to_string(i);
+            m_segments.clear();
+            return false;
+        }
+
+        flush_literal(i);
+        if (!add_placeholder(source.substr(i + 1, close - i - 1), error)) {
+            m_segments.clear();
+            m_literals.clear();
+            return false;
+        }
+        i = close + 1;
+        literalStart = i;
+    }
+    flush_literal(source.size());
+
+    m_compiled = true;
+    return true;
+}
+
+bool MessageTemplate::add_placeholder(const std::string& name, std::string& error) {
+    for (uint32_t field = 0; field < kFieldCount; ++field) {
+        if (name == kFieldNames[field]) {
+            m_segments.push_back(Segment{ SegmentKind::Field, field, 0 });
+            return true;
+        }
+    }
+
+    if (name.size() == 4 && name.compare(0, 3, "Arg") == 0 && name[3] >= '0' && name[3] <= '9') {
+        m_segments.push_back(Segment{ SegmentKind::Arg, static_cast<uint32_t>(name[3] - '0'), 0 });
+        return true;
+    }
+
+    error = "Unknown placeholder {" + name + "}";
+    return false;
+}
+
+void MessageTemplate::render(const Inputs& inputs, std::string& out) const {
+    out.clear();
+    if (!m_compiled) {
+        return;
+    }
+
+    // Each value's length is measured once
+    size_t fieldSizes[kFieldCount];
+    for (size_t i = 0; i < kFieldCount; ++i) {
+        fieldSizes[i] = inputs.fields[i] ? std::strlen(inputs.fields[i]) : 0;
+    }
+    auto resolve = [this, &inputs, &fieldSizes](const Segment& seg, size_t& size) -> const char* {
+        switch (seg.kind) {
+            case SegmentKind::Literal:
+                size = seg.length;
+                return m_literals.data() + seg.offset;
+            case SegmentKind::Field:
+                size = fieldSizes[seg.offset];
+                return inputs.fields[seg.offset];
+            case SegmentKind::Arg:
+                if (seg.offset < inputs.arg_count && inputs.args[seg.offset]) {
+                    size = std::strlen(inputs.args[seg.offset]);
+                    return inputs.args[seg.offset];
+                }
+                break;
+        }
+        size = 0;
+        return nullptr;
+    };
+
+    // Pass 1: exact size, so the buffer grows at most once
+    size_t total = 0;
+    for (const auto& seg : m_segments) {
+        size_t size = 0;
+        resolve(seg, size);
+        total += size;
+    }
+    out.reserve(total);
+
+    // Pass 2: append
+    for (const auto& seg : m_segments) {
+        size_t size = 0;
+        const char* data = resolve(seg, size);
+        if (size) {
+            out.append(data, size);
+        }
+    }
+}
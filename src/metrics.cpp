@@ -0,0 +1,432 @@
+/**
+ * Metrics - Implementation
+ */
+
+#include "metrics.h"
+#include <cmath>
+#include <cstdio>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+using json = nlohmann::json;
+
+static unsigned highest_bit(uint64_t bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, bits);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(bits));
+#endif
+}
+
+// ============================================================================
+// LatencyHistogram
+// ============================================================================
+
+size_t LatencyHistogram::bucket_of(uint64_t us) {
+    if (us < kSubCount) {
+        return static_cast<size_t>(us);
+    }
+    const uint64_t limit = (uint64_t(1) << kMaxExponent) - 1;
+    if (us > limit) {
+        us = limit;
+    }
+    // Group 1 holds [16, 32), group 2 [32, 64), ...; within a group the
+    // next kSubBits bits below the leading one pick the bucket
+    const unsigned exponent = highest_bit(us);
+    const unsigned shift = exponent - kSubBits;
+    const uint64_t sub = (us >> shift) - kSubCount;
+    return static_cast<size_t>((exponent - kSubBits + 1) * kSubCount + sub);
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t bucket) {
+    const size_t group = bucket / kSubCount;
+    if (group == 0) {
+        return bucket;
+    }
+    const uint64_t sub = bucket % kSubCount;
+    const unsigned shift = static_cast<unsigned>(group - 1);
+    return (((kSubCount + sub) << shift) + (uint64_t(1) << shift)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t us) {
+    m_buckets[bucket_of(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(us, std::memory_order_relaxed);
+    uint64_t seen = m_max.load(std::memory_order_relaxed);
+    while (us > seen && !m_max.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration latency) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    record(us > 0 ? static_cast<uint64_t>(us) : 0);
+}
+
+uint64_t LatencyHistogram::percentile_us(double q) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        total += bucket_value(i);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += bucket_value(i);
+        if (seen >= rank) {
+            const uint64_t upper = bucket_upper(i);
+            const uint64_t max = max_us();
+            return upper < max ? upper : max;
+        }
+    }
+    return max_us();
+}
+
+// ============================================================================
+// DiscordMetrics
+// ============================================================================
+
+static const char* const kEventTypeNames[DiscordMetrics::kEventTypes] = { "ready", "message", "reaction_add", "slash_command", "component" };
+
+static const char* const kRestRouteNames[static_cast<size_t>(RestRoute::Count)] = {
+    "POST /channels/{id}/messages",
+    "PUT /channels/{id}/messages/{id}/reactions/{emoji}/@me",
+    "POST /users/@me/channels",
+    "GET /users/{id}",
+    "GET /channels/{id}",
+    "GET /guilds/{id}/members/{id}",
+    "GET /channels/{id}/webhooks",
+    "POST /channels/{id}/webhooks",
+    "POST /webhooks/{id}/{token}",
+    "POST /interactions/{id}/{token}/callback",
+    "PATCH /webhooks/{id}/{token}/messages/@original",
+    "POST /webhooks/{id}/{token} (interaction)",
+    "PUT /applications/{id}[/guilds/{id}]/commands",
+};
+
+const char* event_type_name(size_t type) {
+    return type < DiscordMetrics::kEventTypes ? kEventTypeNames[type] : "unknown";
+}
+
+const char* rest_route_name(RestRoute route) {
+    const size_t index = static_cast<size_t>(route);
+    return index < static_cast<size_t>(RestRoute::Count) ? kRestRouteNames[index] : "unknown";
+}
+
+DiscordMetrics& discord_metrics() {
+    static DiscordMetrics metrics;
+    return metrics;
+}
+
+void DiscordMetrics::rest_started(RestRoute route) {
+    rest[static_cast<size_t>(route)].in_flight.add(1);
+}
+
+void DiscordMetrics::record_rest(RestRoute route, int status, std::chrono::steady_clock::duration latency) {
+    Rest& r = rest[static_cast<size_t>(route)];
+    r.in_flight.add(-1);
+    r.requests.add();
+    if (status >= 400) {
+        r.errors.add();
+    }
+    if (status == 429) {
+        r.rate_limited.add();
+    }
+    r.latency.record(latency);
+}
+
+void DiscordMetrics::record_bucket(RestRoute route, int64_t remaining, int64_t reset_after_ms) {
+    Rest& r = rest[static_cast<size_t>(route)];
+    r.bucket_remaining.set(remaining);
+    r.bucket_reset_after_ms.set(reset_after_ms);
+}
+
+uint64_t DiscordMetrics::total_received() const {
+    uint64_t total = 0;
+    for (const auto& c : events_received) {
+        total += c.value();
+    }
+    return total;
+}
+
+uint64_t DiscordMetrics::total_dispatched() const {
+    uint64_t total = 0;
+    for (const auto& c : events_dispatched) {
+        total += c.value();
+    }
+    return total;
+}
+
+uint64_t DiscordMetrics::total_dropped() const {
+    uint64_t total = 0;
+    for (const auto& c : events_dropped) {
+        total += c.value();
+    }
+    return total;
+}
+
+static double us_to_ms(uint64_t us) {
+    return static_cast<double>(us) / 1000.0;
+}
+
+json DiscordMetrics::to_json() const {
+    json events = json::object();
+    for (size_t i = 0; i < kEventTypes; ++i) {
+        events[kEventTypeNames[i]] = {
+            {"received", events_received[i].value()},
+            {"dispatched", events_dispatched[i].value()},
+            {"dropped", events_dropped[i].value()}
+        };
+    }
+
+    json routes = json::object();
+    for (size_t i = 0; i < static_cast<size_t>(RestRoute::Count); ++i) {
+        const Rest& r = rest[i];
+        if (r.requests.value() == 0) {
+            continue;
+        }
+        routes[kRestRouteNames[i]] = {
+            {"requests", r.requests.value()},
+            {"errors", r.errors.value()},
+            {"rate_limited", r.rate_limited.value()},
+            {"in_flight", r.in_flight.value()},
+            {"bucket_remaining", r.bucket_remaining.value()},
+            {"p50_ms", us_to_ms(r.latency.percentile_us(0.50))},
+            {"p99_ms", us_to_ms(r.latency.percentile_us(0.99))}
+        };
+    }
+
+    json shards = json::array();
+    const int64_t shardCount = shard_count.value();
+    for (int64_t i = 0; i < shardCount && static_cast<size_t>(i) < kMaxShards; ++i) {
+        shards.push_back({
+            {"shard", i},
+            {"connected", shard_connected[i].value() != 0},
+            {"heartbeat_ms", us_to_ms(static_cast<uint64_t>(heartbeat_latency_us[i].value()))}
+        });
+    }
+
+    return {
+        {"events", events},
+        {"queue_depth", queue_depth.value()},
+        {"last_tick_events", last_tick_events.value()},
+        {"dispatch_latency_ms", {
+            {"count", dispatch_latency.count()},
+            {"p50", us_to_ms(dispatch_latency.percentile_us(0.50))},
+            {"p90", us_to_ms(dispatch_latency.percentile_us(0.90))},
+            {"p99", us_to_ms(dispatch_latency.percentile_us(0.99))},
+            {"max", us_to_ms(dispatch_latency.max_us())}
+        }},
+        {"interactions", {
+            {"pending", pending_interactions.value()},
+            {"auto_deferred", interactions_auto_deferred.value()}
+        }},
+        {"rest", routes},
+        {"shards", shards},
+        {"caches", {
+            {"users", cached_users.value()},
+            {"guilds", cached_guilds.value()},
+            {"channels", cached_channels.value()},
+            {"stored_members", stored_members.value()},
+            {"stored_users", stored_users.value()},
+            {"indexed_messages", indexed_messages.value()},
+            {"dm_channels", dm_channels.value()},
+            {"fetched_users", fetched_users.value()},
+            {"fetched_channels", fetched_channels.value()},
+            {"member_store_bytes", member_store_bytes.value()},
+            {"message_index_bytes", message_index_bytes.value()}
+        }}
+    };
+}
+
+// ----------------------------------------------------------------------------
+// Prometheus text format
+// ----------------------------------------------------------------------------
+
+// Histogram bucket bounds (le, seconds); each is reported from the
+// log-linear buckets that end at or below it
+static const double kPrometheusBounds[] = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+static void append_header(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+static void append_sample(std::string& out, const char* name, const char* suffix, const std::string& labels,
+                          double value) {
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.17g", value);
+    out += name;
+    out += suffix;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += number;
+    out += '\n';
+}
+
+static std::string label(const char* key, const std::string& value) {
+    std::string out = key;
+    out += "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '"';
+    return out;
+}
+
+// Buckets are read once so the cumulative counts, +Inf and _count agree
+static void append_histogram(std::string& out, const char* name, const std::string& labels,
+                             const LatencyHistogram& histogram) {
+    uint64_t counts[LatencyHistogram::kBucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        counts[i] = histogram.bucket_value(i);
+        total += counts[i];
+    }
+
+    const std::string prefix = labels.empty() ? std::string() : labels + ",";
+    size_t bucket = 0;
+    uint64_t cumulative = 0;
+    for (double bound : kPrometheusBounds) {
+        const uint64_t boundUs = static_cast<uint64_t>(bound * 1e6);
+        while (bucket < LatencyHistogram::kBucketCount && LatencyHistogram::bucket_upper(bucket) <= boundUs) {
+            cumulative += counts[bucket++];
+        }
+        char le[32];
+        std::snprintf(le, sizeof(le), "%g", bound);
+        append_sample(out, name, "_bucket", prefix + label("le", le), static_cast<double>(cumulative));
+    }
+    append_sample(out, name, "_bucket", prefix + label("le", "+Inf"), static_cast<double>(total));
+    append_sample(out, name, "_sum", labels, static_cast<double>(histogram.sum_us()) / 1e6);
+    append_sample(out, name, "_count", labels, static_cast<double>(total));
+}
+
+std::string DiscordMetrics::to_prometheus() const {
+    std::string out;
+    out.reserve(16 * 1024);
+
+    append_header(out, "rune_discord_events_received_total", "counter", "Gateway events queued for dispatch.");
+    for (size_t i = 0; i < kEventTypes; ++i) {
+        append_sample(out, "rune_discord_events_received_total", "", label("type", kEventTypeNames[i]),
+                      static_cast<double>(events_received[i].value()));
+    }
+    append_header(out, "rune_discord_events_dispatched_total", "counter", "Events delivered to the event nodes.");
+    for (size_t i = 0; i < kEventTypes; ++i) {
+        append_sample(out, "rune_discord_events_dispatched_total", "", label("type", kEventTypeNames[i]),
+                      static_cast<double>(events_dispatched[i].value()));
+    }
+    append_header(out, "rune_discord_events_dropped_total", "counter",
+                  "Events discarded at shutdown or dispatched with no listener.");
+    for (size_t i = 0; i < kEventTypes; ++i) {
+        append_sample(out, "rune_discord_events_dropped_total", "", label("type", kEventTypeNames[i]),
+                      static_cast<double>(events_dropped[i].value()));
+    }
+
+    append_header(out, "rune_discord_event_queue_depth", "gauge", "Events waiting for the next tick.");
+    append_sample(out, "rune_discord_event_queue_depth", "", std::string(), static_cast<double>(queue_depth.value()));
+    append_header(out, "rune_discord_last_tick_events", "gauge", "Events dispatched by the most recent tick.");
+    append_sample(out, "rune_discord_last_tick_events", "", std::string(), static_cast<double>(last_tick_events.value()));
+
+    append_header(out, "rune_discord_dispatch_latency_seconds", "histogram",
+                  "Time from an event being queued to its dispatch on the main thread.");
+    append_histogram(out, "rune_discord_dispatch_latency_seconds", std::string(), dispatch_latency);
+
+    append_header(out, "rune_discord_pending_interactions", "gauge", "Interactions whose token is still valid.");
+    append_sample(out, "rune_discord_pending_interactions", "", std::string(),
+                  static_cast<double>(pending_interactions.value()));
+    append_header(out, "rune_discord_interactions_auto_deferred_total", "counter",
+                  "Interactions deferred because the flow had not responded by interaction_auto_defer_ms.");
+    append_sample(out, "rune_discord_interactions_auto_deferred_total", "", std::string(),
+                  static_cast<double>(interactions_auto_deferred.value()));
+
+    append_header(out, "rune_discord_rest_requests_total", "counter", "Completed REST requests.");
+    for (size_t i = 0; i < static_cast<size_t>(RestRoute::Count); ++i) {
+        append_sample(out, "rune_discord_rest_requests_total", "", label("route", kRestRouteNames[i]),
+                      static_cast<double>(rest[i].requests.value()));
+    }
+    append_header(out, "rune_discord_rest_errors_total", "counter", "REST requests that finished with status >= 400.");
+    for (size_t i = 0; i < static_cast<size_t>(RestRoute::Count); ++i) {
+        append_sample(out, "rune_discord_rest_errors_total", "", label("route", kRestRouteNames[i]),
+                      static_cast<double>(rest[i].errors.value()));
+    }
+    append_header(out, "rune_discord_rest_rate_limited_total", "counter", "REST requests that finished with status 429.");
+    for (size_t i = 0; i < static_cast<size_t>(RestRoute::Count); ++i) {
+        append_sample(out, "rune_discord_rest_rate_limited_total", "", label("route", kRestRouteNames[i]),
+                      static_cast<double>(rest[i].rate_limited.value()));
+    }
+    append_header(out, "rune_discord_rest_in_flight", "gauge", "REST requests issued and not yet completed.");
+    for (size_t i = 0; i < static_cast<size_t>(RestRoute::Count); ++i) {
+        append_sample(out, "rune_discord_rest_in_flight", "", label("route", kRestRouteNames[i]),
+                      static_cast<double>(rest[i].in_flight.value()));
+    }
+    append_header(out, "rune_discord_rest_latency_seconds", "histogram",
+                  "REST request latency, including time spent in the request queue.");
+    for (size_t i = 0; i < static_cast<size_t>(RestRoute::Count); ++i) {
+        if (rest[i].requests.value() > 0) {
+            append_histogram(out, "rune_discord_rest_latency_seconds", label("route", kRestRouteNames[i]),
+                             rest[i].latency);
+        }
+    }
+
+    append_header(out, "rune_discord_shard_heartbeat_latency_seconds", "gauge",
+                  "Latest gateway heartbeat round trip per shard.");
+    const int64_t shardCount = shard_count.value();
+    for (int64_t i = 0; i < shardCount && static_cast<size_t>(i) < kMaxShards; ++i) {
+        append_sample(out, "rune_discord_shard_heartbeat_latency_seconds", "", label("shard", std::to_string(i)),
+                      static_cast<double>(heartbeat_latency_us[i].value()) / 1e6);
+    }
+    append_header(out, "rune_discord_shard_connected", "gauge", "1 while the shard's gateway websocket is connected.");
+    for (int64_t i = 0; i < shardCount && static_cast<size_t>(i) < kMaxShards; ++i) {
+        append_sample(out, "rune_discord_shard_connected", "", label("shard", std::to_string(i)),
+                      static_cast<double>(shard_connected[i].value()));
+    }
+
+    append_header(out, "rune_discord_cache_entries", "gauge", "Entries held by each cache.");
+    const std::pair<const char*, const MetricGauge*> caches[] = {
+        {"dpp_users", &cached_users},
+        {"dpp_guilds", &cached_guilds},
+        {"dpp_channels", &cached_channels},
+        {"member_store_members", &stored_members},
+        {"member_store_users", &stored_users},
+        {"message_index", &indexed_messages},
+        {"dm_channels", &dm_channels},
+        {"fetched_users", &fetched_users},
+        {"fetched_channels", &fetched_channels},
+    };
+    for (const auto& cache : caches) {
+        append_sample(out, "rune_discord_cache_entries", "", label("cache", cache.first),
+                      static_cast<double>(cache.second->value()));
+    }
+    append_header(out, "rune_discord_cache_bytes", "gauge", "Estimated heap bytes of the plugin's own stores.");
+    append_sample(out, "rune_discord_cache_bytes", "", label("cache", "member_store"),
+                  static_cast<double>(member_store_bytes.value()));
+    append_sample(out, "rune_discord_cache_bytes", "", label("cache", "message_index"),
+                  static_cast<double>(message_index_bytes.value()));
+    return out;
+}
@@ -0,0 +1,334 @@
+/**
+ * Node Profiler - Implementation
+ */
+
+#include "node_profiler.h"
+#include <algorithm>
+#include <array>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define RUNE_DISCORD_HAVE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RUNE_DISCORD_HAVE_RDTSC 1
+#endif
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+thread_local NodeProfilerListening t_listening;
+
+using ExecuteFn = bool (*)(void*, ExecContext*);
+
+// One trampoline per registration slot, so the wrapped entries know which
+// node type they belong to without touching the instance
+template <size_t I>
+bool profiled_execute(void* inst, ExecContext* ctx) {
+    return NodeProfiler::instance().run_execute(I, inst, ctx);
+}
+
+template <size_t I>
+bool profiled_start_listening(void* inst, ExecContext* ctx) {
+    return NodeProfiler::instance().run_start_listening(I, inst, ctx);
+}
+
+template <size_t... I>
+constexpr std::array<ExecuteFn, sizeof...(I)> make_execute_trampolines(std::index_sequence<I...>) {
+    return { { &profiled_execute<I>... } };
+}
+
+template <size_t... I>
+constexpr std::array<ExecuteFn, sizeof...(I)> make_listen_trampolines(std::index_sequence<I...>) {
+    return { { &profiled_start_listening<I>... } };
+}
+
+const auto kExecuteTrampolines = make_execute_trampolines(std::make_index_sequence<NodeProfiler::kMaxNodeTypes>());
+const auto kListenTrampolines = make_listen_trampolines(std::make_index_sequence<NodeProfiler::kMaxNodeTypes>());
+
+// Innermost running scope of this thread, for self vs total cost
+thread_local void* t_scope = nullptr;
+
+uint64_t profile_key(size_t type, uint32_t flow) {
+    return (static_cast<uint64_t>(type) << 32) | flow;
+}
+
+void register_profiled_node(const NodeDesc* desc, const NodeVTable* vtable);
+
+}  // namespace
+
+NodeProfilerListening& node_profiler_listening() {
+    return t_listening;
+}
+
+NodeProfiler& NodeProfiler::instance() {
+    static NodeProfiler instance;
+    return instance;
+}
+
+NodeProfiler::NodeProfiler() {
+    m_flows.push_back("unknown");
+    m_calibration_time = Clock::now();
+    m_calibration_ticks = ticks();
+}
+
+uint64_t NodeProfiler::ticks() {
+#if defined(RUNE_DISCORD_HAVE_RDTSC)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+uint64_t NodeProfiler::allocs() const {
+    const AllocCounter counter = m_alloc_counter.load(std::memory_order_relaxed);
+    return counter ? counter() : 0;
+}
+
+void NodeProfiler::set_enabled(bool enabled) {
+    if (enabled && !m_enabled.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_calibration_time = Clock::now();
+        m_calibration_ticks = ticks();
+    }
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+double NodeProfiler::ns_per_tick() const {
+    std::chrono::steady_clock::time_point since;
+    uint64_t sinceTicks = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        since = m_calibration_time;
+        sinceTicks = m_calibration_ticks;
+    }
+    const uint64_t elapsedTicks = ticks() - sinceTicks;
+    const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+    // Too short an interval to calibrate against; a 1 GHz guess is close
+    // enough until more time has passed
+    if (elapsedTicks < 1000000 || elapsedNs <= 0) {
+        return 1.0;
+    }
+    return static_cast<double>(elapsedNs) / static_cast<double>(elapsedTicks);
+}
+
+PluginNodeRegistry* NodeProfiler::wrap_registry(PluginNodeRegistry* host) {
+    m_host_registry = host;
+    m_registry = *host;
+    m_registry.register_node = register_profiled_node;
+    return &m_registry;
+}
+
+namespace {
+
+void register_profiled_node(const NodeDesc* desc, const NodeVTable* vtable) {
+    NodeProfiler::instance().add_node(desc, vtable);
+}
+
+}  // namespace
+
+void NodeProfiler::add_node(const NodeDesc* desc, const NodeVTable* vtable) {
+    if (!m_host_registry) {
+        return;
+    }
+    if (m_type_count >= kMaxNodeTypes) {
+        m_host_registry->register_node(desc, vtable);
+        return;
+    }
+    const size_t type = m_type_count++;
+    m_descs[type] = desc;
+    m_original[type] = *vtable;
+    m_wrapped[type] = *vtable;
+    if (vtable->execute) {
+        m_wrapped[type].execute = kExecuteTrampolines[type];
+    }
+    if (vtable->start_listening) {
+        m_wrapped[type].start_listening = kListenTrampolines[type];
+    }
+    m_host_registry->register_node(desc, &m_wrapped[type]);
+}
+
+constexpr uint32_t NodeProfiler::kUnknownFlow;
+
+NodeProfiler::FlowLoad::FlowLoad(NodeProfiler& profiler, const std::string& flow_id)
+    : m_profiler(profiler) {
+    std::lock_guard<std::mutex> lock(m_profiler.m_mutex);
+    auto it = std::find(m_profiler.m_flows.begin() + 1, m_profiler.m_flows.end(), flow_id);
+    if (it == m_profiler.m_flows.end()) {
+        it = m_profiler.m_flows.insert(m_profiler.m_flows.end(), flow_id);
+    }
+    m_previous = m_profiler.m_loading_flow;
+    m_profiler.m_loading_flow = static_cast<uint32_t>(it - m_profiler.m_flows.begin());
+}
+
+NodeProfiler::FlowLoad::~FlowLoad() {
+    std::lock_guard<std::mutex> lock(m_profiler.m_mutex);
+    m_profiler.m_loading_flow = m_previous;
+}
+
+void NodeProfiler::flow_unloaded(const std::string& flow_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find(m_flows.begin() + 1, m_flows.end(), flow_id);
+    if (it == m_flows.end()) {
+        return;
+    }
+    const uint32_t flow = static_cast<uint32_t>(it - m_flows.begin());
+    // Contexts of the unloaded flow may be reused by the next one
+    for (auto ctxIt = m_context_flows.begin(); ctxIt != m_context_flows.end();) {
+        ctxIt = ctxIt->second == flow ? m_context_flows.erase(ctxIt) : std::next(ctxIt);
+    }
+}
+
+uint32_t NodeProfiler::flow_of(ExecContext* ctx) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_context_flows.find(ctx);
+    return it != m_context_flows.end() ? it->second : kUnknownFlow;
+}
+
+uint32_t NodeProfiler::attribute_context(ExecContext* ctx) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_loading_flow != kUnknownFlow) {
+        m_context_flows[ctx] = m_loading_flow;
+        return m_loading_flow;
+    }
+    auto it = m_context_flows.find(ctx);
+    return it != m_context_flows.end() ? it->second : kUnknownFlow;
+}
+
+void NodeProfiler::record(Key key, uint64_t total, uint64_t self, uint64_t allocs, bool failed) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    NodeProfile& profile = m_profiles[profile_key(key.type, key.flow)];
+    ++profile.calls;
+    if (failed) {
+        ++profile.errors;
+    }
+    profile.total_ticks += total;
+    profile.self_ticks += self;
+    profile.max_ticks = std::max(profile.max_ticks, total);
+    profile.allocs += allocs;
+}
+
+NodeProfiler::Scope::Scope(NodeProfiler& profiler, Key key)
+    : m_profiler(profiler), m_key(key), m_parent(static_cast<Scope*>(t_scope)) {
+    t_scope = this;
+    m_start_allocs = m_profiler.allocs();
+    m_start_ticks = ticks();
+}
+
+NodeProfiler::Scope::~Scope() {
+    const uint64_t total = ticks() - m_start_ticks;
+    const uint64_t allocs = m_profiler.allocs() - m_start_allocs;
+    t_scope = m_parent;
+    if (m_parent) {
+        m_parent->m_child_ticks += total;
+        m_parent->m_child_allocs += allocs;
+    }
+    const uint64_t self = total > m_child_ticks ? total - m_child_ticks : 0;
+    const uint64_t selfAllocs = allocs > m_child_allocs ? allocs - m_child_allocs : 0;
+    m_profiler.record(m_key, total, self, selfAllocs, m_failed);
+}
+
+bool NodeProfiler::run_execute(size_t type, void* inst, ExecContext* ctx) {
+    const ExecuteFn execute = m_original[type].execute;
+    if (!enabled()) {
+        return execute(inst, ctx);
+    }
+    Key key;
+    key.type = type;
+    key.flow = flow_of(ctx);
+    Scope scope(*this, key);
+    const bool ok = execute(inst, ctx);
+    if (!ok) {
+        scope.failed();
+    }
+    return ok;
+}
+
+bool NodeProfiler::run_start_listening(size_t type, void* inst, ExecContext* ctx) {
+    // Listener callbacks added from here on belong to this node (wrap_listener)
+    const NodeProfilerListening saved = t_listening;
+    t_listening.active = true;
+    t_listening.type = type;
+    t_listening.flow = attribute_context(ctx);
+    const bool ok = m_original[type].start_listening(inst, ctx);
+    t_listening = saved;
+    return ok;
+}
+
+std::vector<NodeProfiler::Row> NodeProfiler::rows(const std::string& sort_by) const {
+    std::vector<Row> result;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        result.reserve(m_profiles.size());
+        for (const auto& entry : m_profiles) {
+            const size_t type = static_cast<size_t>(entry.first >> 32);
+            const uint32_t flow = static_cast<uint32_t>(entry.first & 0xffffffffu);
+            Row row;
+            row.type_id = m_descs[type] && m_descs[type]->type_id ? m_descs[type]->type_id : "";
+            row.name = m_descs[type] && m_descs[type]->name ? m_descs[type]->name : "";
+            row.flow = flow < m_flows.size() ? m_flows[flow] : std::string();
+            row.profile = entry.second;
+            result.push_back(std::move(row));
+        }
+    }
+
+    auto metric = [&sort_by](const NodeProfile& p) -> double {
+        if (sort_by == "self") return static_cast<double>(p.self_ticks);
+        if (sort_by == "mean") return p.calls ? static_cast<double>(p.total_ticks) / p.calls : 0.0;
+        if (sort_by == "max") return static_cast<double>(p.max_ticks);
+        if (sort_by == "calls") return static_cast<double>(p.calls);
+        if (sort_by == "allocs") return static_cast<double>(p.allocs);
+        return static_cast<double>(p.total_ticks);
+    };
+    std::stable_sort(result.begin(), result.end(), [&metric](const Row& a, const Row& b) {
+        return metric(a.profile) > metric(b.profile);
+    });
+    return result;
+}
+
+json NodeProfiler::to_json(const std::string& sort_by) const {
+    const double nsPerTick = ns_per_tick();
+    auto ms = [nsPerTick](double ticks) { return ticks * nsPerTick / 1e6; };
+
+    json nodes = json::array();
+    for (const Row& row : rows(sort_by)) {
+        const NodeProfile& p = row.profile;
+        json entry = {
+            {"node", row.type_id},
+            {"name", row.name},
+            {"flow", row.flow},
+            {"calls", p.calls},
+            {"errors", p.errors},
+            {"total_ms", ms(static_cast<double>(p.total_ticks))},
+            {"self_ms", ms(static_cast<double>(p.self_ticks))},
+            {"mean_us", p.calls ? ms(static_cast<double>(p.total_ticks)) * 1000.0 / p.calls : 0.0},
+            {"max_us", ms(static_cast<double>(p.max_ticks)) * 1000.0},
+            {"total_cycles", p.total_ticks}
+        };
+        if (counts_allocs()) {
+            entry["allocs"] = p.allocs;
+            entry["allocs_per_call"] = p.calls ? static_cast<double>(p.allocs) / p.calls : 0.0;
+        }
+        nodes.push_back(std::move(entry));
+    }
+
+    return {
+        {"enabled", enabled()},
+        {"counts_allocs", counts_allocs()},
+        {"ns_per_cycle", nsPerTick},
+        {"sort", sort_by},
+        {"nodes", std::move(nodes)}
+    };
+}
+
+void NodeProfiler::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profiles.clear();
+}
@@ -0,0 +1,63 @@
+/**
+ * BindComponentMessage Node - Bind a message's components to an On Component node for a limited time
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include <chrono>
+#include <cstdlib>
+
+static bool bind_component_execute(void* inst, ExecContext* ctx) {
+    const char* message_id_str = ctx->get_input_string(ctx, "MessageID");
+    const char* prefix = ctx->get_input_string(ctx, "Prefix");
+
+    if (!message_id_str || !prefix) {
+        ctx->set_error(ctx, "MessageID and Prefix are required");
+        return false;
+    }
+
+    dpp::snowflake message_id = std::strtoull(message_id_str, nullptr, 10);
+    const int64_t timeout = ctx->get_input_int(ctx, "TimeoutSeconds");
+    if (!BotManager::instance().components().bind(message_id, prefix, std::chrono::seconds(timeout > 0 ? timeout : 0),
+                                                  std::chrono::steady_clock::now())) {
+        ctx->set_error(ctx, "No listening On Component node has this Prefix");
+        return false;
+    }
+
+    ctx->trigger_output(ctx, "Done");
+    return true;
+}
+
+static PinDesc bind_component_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"MessageID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Prefix", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"TimeoutSeconds", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+};
+
+static NodeVTable bind_component_vtable = {
+    NULL, NULL,
+    NULL, NULL,
+    NULL, NULL,
+    bind_component_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc bind_component_desc = {
+    "Bind Component Message",
+    "Discord/Actions",
+    "com.rune.discord.bind_component_message",
+    bind_component_pins,
+    5,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Route clicks on MessageID's components with this Prefix to its On Component node for TimeoutSeconds "
+    "(0: until the flow stops), then fire that node's OnExpired. Binding again restarts the timeout"
+};
+
+void register_bind_component_message_node(PluginNodeRegistry* reg) {
+    reg->register_node(&bind_component_desc, &bind_component_vtable);
+}
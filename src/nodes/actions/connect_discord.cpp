@@ -4,6 +4,7 @@
 
 #include "discord_plugin.h"
 #include "bot_manager.h"
+#include "plugin_log.h"
 
 static bool connect_discord_execute(void* inst, ExecContext* ctx) {
     // Resolve token from input, env, or plugin settings
@@ -14,7 +15,7 @@ static bool connect_discord_execute(void* inst, ExecContext* ctx) {
 
     std::string token = ResolveDiscordToken(ctx);
 
-    if (g_host) {
+    if (discord_log_enabled(PLUGIN_LOG_LEVEL_DEBUG)) {
         std::string msg = "Discord Connect Discord: execute (source=";
         msg += !explicitToken.empty() ? "Token pin" : "env/settings";
         msg += ", resolved_length=";
@@ -22,9 +23,9 @@ static bool connect_discord_execute(void* inst, ExecContext* ctx) {
         msg += ", bot_running=";
         msg += BotManager::instance().is_running() ? "true" : "false";
         msg += ")";
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG, msg.c_str());
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, std::move(msg));
     }
-    if (token.empty()) {
+    if (token.empty() && GetDiscordPluginConfig().gateway_replay_path.empty()) {
         ctx->set_error(ctx, "Discord bot token is required to connect");
         if (g_host) {
             g_host->log(PLUGIN_LOG_LEVEL_ERROR,
@@ -0,0 +1,80 @@
+/**
+ * DumpNodeProfile Node - Write the per-node execution profile as JSON
+ */
+
+#include "discord_plugin.h"
+#include "node_profiler.h"
+#include <fstream>
+#include <string>
+
+static bool dump_node_profile_execute(void* inst, ExecContext* ctx) {
+    (void)inst;
+
+    const char* path = ctx->get_input_string(ctx, "Path");
+    if (!path || path[0] == '\0') {
+        ctx->set_error(ctx, "Path is required");
+        return false;
+    }
+
+    NodeProfiler& profiler = NodeProfiler::instance();
+    if (!profiler.enabled()) {
+        ctx->set_error(ctx, "Node profiling is disabled (set profile_nodes in the plugin settings)");
+        return false;
+    }
+
+    const char* sortBy = ctx->get_input_string(ctx, "SortBy");
+    const nlohmann::json profile = profiler.to_json(sortBy && sortBy[0] ? sortBy : "total");
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (out.is_open()) {
+            out << profile.dump(2) << '\n';
+        }
+        if (!out.is_open() || !out.good()) {
+            std::string msg = std::string("Cannot write node profile to '") + path + "'";
+            ctx->set_error(ctx, msg.c_str());
+            return false;
+        }
+    }
+
+    if (ctx->get_input_bool(ctx, "Reset")) {
+        profiler.reset();
+    }
+
+    ctx->set_output_int(ctx, "Rows", static_cast<int64_t>(profile["nodes"].size()));
+    ctx->trigger_output(ctx, "Done");
+    return true;
+}
+
+static PinDesc dump_node_profile_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"Path", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"SortBy", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Reset", "bool", PIN_IN, PIN_KIND_DATA, 0},
+    {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"Rows", "int", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable dump_node_profile_vtable = {
+    NULL, NULL,
+    NULL, NULL,
+    NULL, NULL,
+    dump_node_profile_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc dump_node_profile_desc = {
+    "Dump Node Profile",
+    "Discord/Actions",
+    "com.rune.discord.dump_node_profile",
+    dump_node_profile_pins,
+    6,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Write the per node type and flow execution profile (see profile_nodes) to Path as JSON, sorted by SortBy (total, self, mean, max, calls or allocs); Reset clears it afterwards"
+};
+
+void register_dump_node_profile_node(PluginNodeRegistry* reg) {
+    reg->register_node(&dump_node_profile_desc, &dump_node_profile_vtable);
+}
@@ -0,0 +1,72 @@
+/**
+ * DumpTrace Node - Write the sampled event trace as Chrome trace JSON
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include <string>
+
+static bool dump_trace_execute(void* inst, ExecContext* ctx) {
+    (void)inst;
+
+    const char* path = ctx->get_input_string(ctx, "Path");
+    if (!path || path[0] == '\0') {
+        ctx->set_error(ctx, "Path is required");
+        return false;
+    }
+
+    EventTracer& tracer = BotManager::instance().tracer();
+    if (!tracer.enabled()) {
+        ctx->set_error(ctx, "Event tracing is disabled (set trace_sample_rate in the plugin settings)");
+        return false;
+    }
+
+    std::string error;
+    const long spans = tracer.write_chrome_json(path, error);
+    if (spans < 0) {
+        std::string msg = std::string("Cannot write trace to '") + path + "': " + error;
+        ctx->set_error(ctx, msg.c_str());
+        return false;
+    }
+
+    if (ctx->get_input_bool(ctx, "Clear")) {
+        tracer.clear();
+    }
+
+    ctx->set_output_int(ctx, "Spans", static_cast<int64_t>(spans));
+    ctx->trigger_output(ctx, "Done");
+    return true;
+}
+
+static PinDesc dump_trace_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"Path", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Clear", "bool", PIN_IN, PIN_KIND_DATA, 0},
+    {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"Spans", "int", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable dump_trace_vtable = {
+    NULL, NULL,
+    NULL, NULL,
+    NULL, NULL,
+    dump_trace_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc dump_trace_desc = {
+    "Dump Trace",
+    "Discord/Actions",
+    "com.rune.discord.dump_trace",
+    dump_trace_pins,
+    5,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Write the sampled event trace (see trace_sample_rate) to Path as Chrome trace JSON, viewable in chrome://tracing or Perfetto; Clear empties the buffer afterwards"
+};
+
+void register_dump_trace_node(PluginNodeRegistry* reg) {
+    reg->register_node(&dump_trace_desc, &dump_trace_vtable);
+}
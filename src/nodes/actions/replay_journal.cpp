@@ -0,0 +1,82 @@
+/**
+ * ReplayJournal Node - Re-dispatch journaled events to the event nodes
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "plugin_log.h"
+#include <cstdint>
+#include <cstring>
+
+// Default cap so an unbounded replay cannot flood the event queue
+static const int64_t kDefaultReplayLimit = 10000;
+
+static bool replay_journal_execute(void* inst, ExecContext* ctx) {
+    (void)inst;
+
+    const char* kind = ctx->get_input_string(ctx, "Kind");
+    bool messages = true;
+    bool reactions = true;
+    if (kind && kind[0] != '\0' && std::strcmp(kind, "all") != 0) {
+        messages = std::strcmp(kind, "message") == 0;
+        reactions = std::strcmp(kind, "reaction") == 0;
+        if (!messages && !reactions) {
+            ctx->set_error(ctx, "Kind must be one of: all, message, reaction");
+            return false;
+        }
+    }
+
+    const int64_t since = ctx->get_input_int(ctx, "Since");
+    const int64_t until = ctx->get_input_int(ctx, "Until");
+    const int64_t limit = ctx->get_input_int(ctx, "Limit");
+    const uint64_t sinceMs = since > 0 ? static_cast<uint64_t>(since) * 1000 : 0;
+    const uint64_t untilMs = until > 0 ? static_cast<uint64_t>(until) * 1000 + 999 : UINT64_MAX;
+
+    size_t queued = 0;
+    if (!BotManager::instance().replay_journal(sinceMs, untilMs, messages, reactions,
+                                               static_cast<size_t>(limit > 0 ? limit : kDefaultReplayLimit), queued)) {
+        ctx->set_error(ctx, "Event journal is disabled (set journal_dir in the plugin settings)");
+        return false;
+    }
+
+    DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, "Discord Replay Journal: queued " + std::to_string(queued) + " event(s)");
+
+    ctx->set_output_int(ctx, "Count", static_cast<int64_t>(queued));
+    ctx->trigger_output(ctx, "Done");
+    return true;
+}
+
+static PinDesc replay_journal_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"Since", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Until", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Kind", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Limit", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"Count", "int", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable replay_journal_vtable = {
+    NULL, NULL,
+    NULL, NULL,
+    NULL, NULL,
+    replay_journal_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc replay_journal_desc = {
+    "Replay Journal",
+    "Discord/Actions",
+    "com.rune.discord.replay_journal",
+    replay_journal_pins,
+    7,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Re-dispatch journaled message/reaction events received between Since and Until (unix seconds, 0 = unbounded) to the On Message / On Reaction nodes, oldest first"
+};
+
+void register_replay_journal_node(PluginNodeRegistry* reg) {
+    reg->register_node(&replay_journal_desc, &replay_journal_vtable);
+}
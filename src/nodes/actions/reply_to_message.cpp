@@ -4,6 +4,7 @@
 
 #include "discord_plugin.h"
 #include "bot_manager.h"
+#include "embed_pool.h"
 #include <cstdlib>
 
 static bool reply_execute(void* inst, ExecContext* ctx) {
@@ -11,15 +12,27 @@ static bool reply_execute(void* inst, ExecContext* ctx) {
     const char* message_id_str = ctx->get_input_string(ctx, "MessageID");
     const char* content = ctx->get_input_string(ctx, "Content");
 
-    if (!channel_id_str || !message_id_str || !content) {
-        ctx->set_error(ctx, "ChannelID, MessageID, and Content are required");
+    const EmbedHandle handle = ctx->get_input_int(ctx, "Embed");
+    const bool hasContent = content && content[0] != '\0';
+
+    if (!channel_id_str || !message_id_str || (!hasContent && handle == 0)) {
+        ctx->set_error(ctx, "ChannelID, MessageID, and Content (or Embed) are required");
         return false;
     }
 
     dpp::snowflake channel_id = std::strtoull(channel_id_str, nullptr, 10);
     dpp::snowflake message_id = std::strtoull(message_id_str, nullptr, 10);
 
-    BotManager::instance().reply_to_message(channel_id, message_id, content);
+    if (handle != 0) {
+        dpp::embed embed;
+        if (!EmbedPool::instance().build(handle, embed)) {
+            ctx->set_error(ctx, "Embed is not a valid Build Embed handle");
+            return false;
+        }
+        BotManager::instance().reply_to_message(channel_id, message_id, hasContent ? content : "", &embed);
+    } else {
+        BotManager::instance().reply_to_message(channel_id, message_id, content);
+    }
 
     ctx->trigger_output(ctx, "Done");
     return true;
@@ -30,6 +43,7 @@ static PinDesc reply_pins[] = {
     {"ChannelID", "string", PIN_IN, PIN_KIND_DATA, 0},
     {"MessageID", "string", PIN_IN, PIN_KIND_DATA, 0},
     {"Content", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Embed", "int", PIN_IN, PIN_KIND_DATA, 0},
     {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
 };
 
@@ -48,7 +62,7 @@ static NodeDesc reply_desc = {
     "Discord/Actions",
     "com.rune.discord.reply_to_message",
     reply_pins,
-    5,
+    6,
     NODE_FLAG_NONE,
     NULL, NULL,
     "Reply to a specific Discord message"
@@ -0,0 +1,78 @@
+/**
+ * RespondToInteraction Node - Answer a slash command or component click
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "embed_pool.h"
+#include <cstdlib>
+
+static bool respond_execute(void* inst, ExecContext* ctx) {
+    const char* interaction_id_str = ctx->get_input_string(ctx, "InteractionID");
+    const char* content = ctx->get_input_string(ctx, "Content");
+
+    if (!interaction_id_str || !content) {
+        ctx->set_error(ctx, "InteractionID and Content are required");
+        return false;
+    }
+
+    dpp::snowflake interaction_id = std::strtoull(interaction_id_str, nullptr, 10);
+
+    dpp::message msg(content);
+    const EmbedHandle handle = ctx->get_input_int(ctx, "Embed");
+    if (handle != 0) {
+        dpp::embed embed;
+        if (!EmbedPool::instance().build(handle, embed)) {
+            ctx->set_error(ctx, "Embed is not a valid Build Embed handle");
+            return false;
+        }
+        msg.add_embed(embed);
+    }
+    if (ctx->get_input_bool(ctx, "Ephemeral")) {
+        msg.set_flags(dpp::m_ephemeral);
+    }
+
+    if (!BotManager::instance().respond_to_interaction(interaction_id, msg)) {
+        ctx->set_error(ctx, "InteractionID is unknown or has expired");
+        return false;
+    }
+
+    ctx->trigger_output(ctx, "Done");
+    return true;
+}
+
+static PinDesc respond_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"InteractionID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Content", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Embed", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Ephemeral", "bool", PIN_IN, PIN_KIND_DATA, 0},
+    {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+};
+
+static NodeVTable respond_vtable = {
+    NULL, NULL,
+    NULL, NULL,
+    NULL, NULL,
+    respond_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc respond_desc = {
+    "Respond To Interaction",
+    "Discord/Actions",
+    "com.rune.discord.respond_to_interaction",
+    respond_pins,
+    6,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Answer a slash command from On Slash Command or a click from On Component. The first response replaces the \"thinking\" "
+    "message if the command was auto-deferred (it then stays public even if Ephemeral is set); "
+    "later responses are sent as follow-ups"
+};
+
+void register_respond_to_interaction_node(PluginNodeRegistry* reg) {
+    reg->register_node(&respond_desc, &respond_vtable);
+}
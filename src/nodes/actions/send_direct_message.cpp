@@ -4,6 +4,7 @@
 
 #include "discord_plugin.h"
 #include "bot_manager.h"
+#include "plugin_log.h"
 #include <cstdlib>
 
 static bool send_direct_message_execute(void* inst, ExecContext* ctx) {
@@ -24,22 +25,11 @@ static bool send_direct_message_execute(void* inst, ExecContext* ctx) {
 
     dpp::snowflake user_id = std::strtoull(user_id_str, nullptr, 10);
 
-    if (g_host) {
-        std::string msg = "Discord Send Direct Message: sending DM to user ";
-        msg += user_id_str;
-        msg += " (bot_running=";
-        msg += BotManager::instance().is_running() ? "true" : "false";
-        msg += ")";
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG, msg.c_str());
-    }
+    DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, std::string("Discord Send Direct Message: sending DM to user ") +
+        user_id_str + " (bot_running=" + (BotManager::instance().is_running() ? "true" : "false") + ")");
 
     BotManager::instance().send_direct_message(user_id, content);
 
-    if (g_host) {
-        g_host->log(PLUGIN_LOG_LEVEL_INFO,
-            "Discord Send Direct Message: Done output triggered");
-    }
-
     ctx->trigger_output(ctx, "Done");
     return true;
 }
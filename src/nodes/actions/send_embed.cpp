@@ -4,6 +4,7 @@
 
 #include "discord_plugin.h"
 #include "bot_manager.h"
+#include "embed_pool.h"
 #include <dpp/dpp.h>
 #include <cstdlib>
 
@@ -20,10 +21,19 @@ static bool send_embed_execute(void* inst, ExecContext* ctx) {
 
     dpp::snowflake channel_id = std::strtoull(channel_id_str, nullptr, 10);
 
+    // A connected Build Embed handle takes precedence over the inline pins
     dpp::embed embed;
-    if (title) embed.set_title(title);
-    if (description) embed.set_description(description);
-    embed.set_color(static_cast<uint32_t>(color));
+    const EmbedHandle handle = ctx->get_input_int(ctx, "Embed");
+    if (handle != 0) {
+        if (!EmbedPool::instance().build(handle, embed)) {
+            ctx->set_error(ctx, "Embed is not a valid Build Embed handle");
+            return false;
+        }
+    } else {
+        if (title) embed.set_title(title);
+        if (description) embed.set_description(description);
+        embed.set_color(static_cast<uint32_t>(color));
+    }
 
     BotManager::instance().send_embed(channel_id, embed);
 
@@ -37,6 +47,7 @@ static PinDesc send_embed_pins[] = {
     {"Title", "string", PIN_IN, PIN_KIND_DATA, 0},
     {"Description", "string", PIN_IN, PIN_KIND_DATA, 0},
     {"Color", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Embed", "int", PIN_IN, PIN_KIND_DATA, 0},
     {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
 };
 
@@ -55,7 +66,7 @@ static NodeDesc send_embed_desc = {
     "Discord/Actions",
     "com.rune.discord.send_embed",
     send_embed_pins,
-    6,
+    7,
     NODE_FLAG_NONE,
     NULL, NULL,
     "Send a rich embed message to a Discord channel"
@@ -0,0 +1,81 @@
+/**
+ * SendViaWebhook Node - Send a message through a bot-owned channel webhook
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "embed_pool.h"
+#include <cstdlib>
+
+static bool send_via_webhook_execute(void* inst, ExecContext* ctx) {
+    (void)inst;
+
+    const char* channel_id_str = ctx->get_input_string(ctx, "ChannelID");
+    const char* content = ctx->get_input_string(ctx, "Content");
+    const char* username = ctx->get_input_string(ctx, "Username");
+    const char* avatar_url = ctx->get_input_string(ctx, "AvatarURL");
+
+    const EmbedHandle handle = ctx->get_input_int(ctx, "Embed");
+    const bool hasContent = content && content[0] != '\0';
+
+    if (!channel_id_str || channel_id_str[0] == '\0' ||
+        (!hasContent && handle == 0)) {
+        if (g_host) {
+            g_host->log(PLUGIN_LOG_LEVEL_ERROR,
+                "Discord Send Via Webhook: ChannelID and Content (or Embed) are required");
+        }
+        ctx->set_error(ctx, "ChannelID and Content (or Embed) are required");
+        return false;
+    }
+
+    dpp::snowflake channel_id = std::strtoull(channel_id_str, nullptr, 10);
+
+    dpp::embed embed;
+    if (handle != 0 && !EmbedPool::instance().build(handle, embed)) {
+        ctx->set_error(ctx, "Embed is not a valid Build Embed handle");
+        return false;
+    }
+
+    BotManager::instance().send_webhook_message(channel_id, hasContent ? content : "",
+        username ? username : "",
+        avatar_url ? avatar_url : "",
+        handle != 0 ? &embed : nullptr);
+
+    ctx->trigger_output(ctx, "Done");
+    return true;
+}
+
+static PinDesc send_via_webhook_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"ChannelID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Content", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Username", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"AvatarURL", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Embed", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+};
+
+static NodeVTable send_via_webhook_vtable = {
+    NULL, NULL,
+    NULL, NULL,
+    NULL, NULL,
+    send_via_webhook_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc send_via_webhook_desc = {
+    "Send Via Webhook",
+    "Discord/Actions",
+    "com.rune.discord.send_via_webhook",
+    send_via_webhook_pins,
+    7,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Send a message to a channel through a bot-owned webhook (separate rate limit, custom name and avatar)"
+};
+
+void register_send_via_webhook_node(PluginNodeRegistry* reg) {
+    reg->register_node(&send_via_webhook_desc, &send_via_webhook_vtable);
+}
@@ -4,6 +4,7 @@
 
 #include "discord_plugin.h"
 #include "bot_manager.h"
+#include "plugin_log.h"
 #include <string>
 #include <algorithm>
 #include <cctype>
@@ -54,10 +55,10 @@ static bool set_presence_execute(void* inst, ExecContext* ctx) {
     dpp::presence_status ps = map_status_string(status);
     dpp::presence presence(ps, dpp::at_game, activity);
 
-    if (g_host) {
+    if (discord_log_enabled(PLUGIN_LOG_LEVEL_DEBUG)) {
         std::string msg = "Discord Set Presence: status=" + status +
             ", activity=\"" + activity + "\"";
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG, msg.c_str());
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, std::move(msg));
     }
 
     BotManager::instance().set_presence(presence);
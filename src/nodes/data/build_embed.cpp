@@ -1,59 +1,104 @@
 /**
- * BuildEmbed Node - Construct embed JSON (pure data node)
+ * BuildEmbed Node - Construct a typed embed handle (pure data node)
  */
 
 #include "discord_plugin.h"
+#include "embed_pool.h"
+#include <nlohmann/json.hpp>
 #include <string>
-#include <sstream>
 
-static bool build_embed_execute(void* inst, ExecContext* ctx) {
-    const char* title = ctx->get_input_string(ctx, "Title");
-    const char* description = ctx->get_input_string(ctx, "Description");
-    int64_t color = ctx->get_input_int(ctx, "Color");
-    const char* footer = ctx->get_input_string(ctx, "Footer");
-    const char* image_url = ctx->get_input_string(ctx, "ImageURL");
-
-    // Build JSON string for embed
-    std::ostringstream json;
-    json << "{";
-    
-    bool first = true;
-    
-    if (title && title[0]) {
-        json << "\"title\":\"" << title << "\"";
-        first = false;
+using json = nlohmann::json;
+
+// Each instance owns one pooled embed slot; re-executing refills it in place
+struct BuildEmbedInstance {
+    EmbedHandle handle;
+    EmbedData scratch;
+    std::string json;  // backs the deprecated EmbedJSON output
+};
+
+static void* build_embed_create() {
+    auto* inst = new BuildEmbedInstance();
+    inst->handle = EmbedPool::instance().acquire();
+    return inst;
+}
+
+static void build_embed_destroy(void* inst_ptr) {
+    auto* inst = static_cast<BuildEmbedInstance*>(inst_ptr);
+    EmbedPool::instance().release(inst->handle);
+    delete inst;
+}
+
+static void assign_if_set(std::string& target, const char* value) {
+    if (value && value[0]) {
+        target.assign(value);
+    }
+}
+
+// Fields pin: JSON array of {"name","value","inline"} objects
+static bool parse_fields(const char* fields_json, std::vector<EmbedFieldData>& out, std::string& error) {
+    if (!fields_json || !fields_json[0]) {
+        return true;
     }
-    
-    if (description && description[0]) {
-        if (!first) json << ",";
-        json << "\"description\":\"" << description << "\"";
-        first = false;
+
+    json j = json::parse(fields_json, nullptr, false);
+    if (j.is_discarded() || !j.is_array()) {
+        error = "Fields must be a JSON array of {name, value, inline} objects";
+        return false;
     }
-    
+
+    for (const auto& item : j) {
+        if (!item.is_object()) {
+            continue;
+        }
+        EmbedFieldData field;
+        auto name = item.find("name");
+        auto value = item.find("value");
+        auto inl = item.find("inline");
+        if (name != item.end() && name->is_string()) field.name = name->get<std::string>();
+        if (value != item.end() && value->is_string()) field.value = value->get<std::string>();
+        if (inl != item.end() && inl->is_boolean()) field.is_inline = inl->get<bool>();
+        out.push_back(std::move(field));
+    }
+    return true;
+}
+
+static bool build_embed_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<BuildEmbedInstance*>(inst_ptr);
+    EmbedData& data = inst->scratch;
+    data.clear();
+
+    assign_if_set(data.title, ctx->get_input_string(ctx, "Title"));
+    assign_if_set(data.description, ctx->get_input_string(ctx, "Description"));
+
+    int64_t color = ctx->get_input_int(ctx, "Color");
     if (color != 0) {
-        if (!first) json << ",";
-        json << "\"color\":" << color;
-        first = false;
+        data.has_color = true;
+        data.color = static_cast<uint32_t>(color);
     }
-    
-    if (footer && footer[0]) {
-        if (!first) json << ",";
-        json << "\"footer\":{\"text\":\"" << footer << "\"}";
-        first = false;
+
+    assign_if_set(data.footer_text, ctx->get_input_string(ctx, "Footer"));
+    assign_if_set(data.image_url, ctx->get_input_string(ctx, "ImageURL"));
+    assign_if_set(data.author_name, ctx->get_input_string(ctx, "AuthorName"));
+    assign_if_set(data.author_icon_url, ctx->get_input_string(ctx, "AuthorIconURL"));
+    data.timestamp = static_cast<time_t>(ctx->get_input_int(ctx, "Timestamp"));
+
+    std::string error;
+    if (!parse_fields(ctx->get_input_string(ctx, "Fields"), data.fields, error)) {
+        ctx->set_error(ctx, error.c_str());
+        return false;
     }
-    
-    if (image_url && image_url[0]) {
-        if (!first) json << ",";
-        json << "\"image\":{\"url\":\"" << image_url << "\"}";
+
+    if (!EmbedPool::instance().store(inst->handle, data)) {
+        ctx->set_error(ctx, "Embed handle is no longer valid");
+        return false;
     }
-    
-    json << "}";
 
-    // Store in static buffer (simplified - real impl would use proper memory)
-    static std::string result;
-    result = json.str();
-    ctx->set_output_json(ctx, "EmbedJSON", result.c_str());
+    ctx->set_output_int(ctx, "Embed", inst->handle);
 
+    // Deprecated: flows saved before the Embed handle read this pin. New
+    // flows should use Embed To JSON, which only serializes when asked.
+    EmbedPool::instance().to_json(inst->handle, inst->json);
+    ctx->set_output_json(ctx, "EmbedJSON", inst->json.c_str());
     return true;
 }
 
@@ -63,11 +108,17 @@ static PinDesc build_embed_pins[] = {
     {"Color", "int", PIN_IN, PIN_KIND_DATA, 0},
     {"Footer", "string", PIN_IN, PIN_KIND_DATA, 0},
     {"ImageURL", "string", PIN_IN, PIN_KIND_DATA, 0},
-    {"EmbedJSON", "json", PIN_OUT, PIN_KIND_DATA, 0},
+    {"AuthorName", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"AuthorIconURL", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Timestamp", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Fields", "json", PIN_IN, PIN_KIND_DATA, 0},
+    {"Embed", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"EmbedJSON", "json", PIN_OUT, PIN_KIND_DATA, 0},  // deprecated, see Embed To JSON
 };
 
 static NodeVTable build_embed_vtable = {
-    NULL, NULL,
+    build_embed_create,
+    build_embed_destroy,
     NULL, NULL,
     NULL, NULL,
     build_embed_execute,
@@ -81,13 +132,12 @@ static NodeDesc build_embed_desc = {
     "Discord/Data",
     "com.rune.discord.build_embed",
     build_embed_pins,
-    6,
+    11,
     NODE_FLAG_PURE_DATA,
     NULL, NULL,
-    "Build a Discord embed JSON object"
+    "Build a Discord embed handle for Send Embed, Reply To Message and Send Via Webhook"
 };
 
 void register_build_embed_node(PluginNodeRegistry* reg) {
     reg->register_node(&build_embed_desc, &build_embed_vtable);
 }
-
@@ -0,0 +1,63 @@
+/**
+ * EmbedToJSON Node - Serialize an embed handle to JSON (pure data node)
+ */
+
+#include "discord_plugin.h"
+#include "embed_pool.h"
+#include <string>
+
+struct EmbedToJsonInstance {
+    std::string json;
+};
+
+static void* embed_to_json_create() {
+    return new EmbedToJsonInstance();
+}
+
+static void embed_to_json_destroy(void* inst_ptr) {
+    delete static_cast<EmbedToJsonInstance*>(inst_ptr);
+}
+
+static bool embed_to_json_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<EmbedToJsonInstance*>(inst_ptr);
+    const EmbedHandle handle = ctx->get_input_int(ctx, "Embed");
+
+    if (!EmbedPool::instance().to_json(handle, inst->json)) {
+        ctx->set_error(ctx, "Embed is not a valid Build Embed handle");
+        return false;
+    }
+
+    ctx->set_output_json(ctx, "EmbedJSON", inst->json.c_str());
+    return true;
+}
+
+static PinDesc embed_to_json_pins[] = {
+    {"Embed", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"EmbedJSON", "json", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable embed_to_json_vtable = {
+    embed_to_json_create,
+    embed_to_json_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    embed_to_json_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc embed_to_json_desc = {
+    "Embed To JSON",
+    "Discord/Data",
+    "com.rune.discord.embed_to_json",
+    embed_to_json_pins,
+    2,
+    NODE_FLAG_PURE_DATA,
+    NULL, NULL,
+    "Serialize a Build Embed handle to Discord embed JSON"
+};
+
+void register_embed_to_json_node(PluginNodeRegistry* reg) {
+    reg->register_node(&embed_to_json_desc, &embed_to_json_vtable);
+}
@@ -0,0 +1,110 @@
+/**
+ * FetchUser Node - Look up a user by ID with cache and REST fallback (async)
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "async_node.h"
+#include <cstdlib>
+
+struct FetchUserData {
+    UserRecord record;
+};
+
+struct FetchUserInstance {
+    AsyncNode<FetchUserData> node;
+};
+
+static void* fetch_user_create() {
+    return new FetchUserInstance();
+}
+
+static void fetch_user_destroy(void* inst_ptr) {
+    delete static_cast<FetchUserInstance*>(inst_ptr);
+}
+
+static bool fetch_user_start_listening(void* inst_ptr, ExecContext* ctx) {
+    static_cast<FetchUserInstance*>(inst_ptr)->node.listen(ctx);
+    return true;
+}
+
+static void fetch_user_stop_listening(void* inst_ptr) {
+    static_cast<FetchUserInstance*>(inst_ptr)->node.stop();
+}
+
+static void fetch_user_deliver(ExecContext* ctx, FetchUserData& data, const UserRecord& record) {
+    data.record = record;
+    ctx->set_output_string(ctx, "Username", data.record.username.c_str());
+    ctx->set_output_string(ctx, "GlobalName", data.record.global_name.c_str());
+    ctx->set_output_string(ctx, "AvatarURL", data.record.avatar_url.c_str());
+    ctx->set_output_bool(ctx, "IsBot", data.record.is_bot);
+    ctx->trigger_output(ctx, data.record.found ? "Found" : "NotFound");
+}
+
+static bool fetch_user_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<FetchUserInstance*>(inst_ptr);
+    const char* user_id_str = ctx->get_input_string(ctx, "UserID");
+
+    if (!user_id_str || user_id_str[0] == '\0') {
+        ctx->set_error(ctx, "UserID is required");
+        return false;
+    }
+
+    if (!BotManager::instance().is_online()) {
+        ctx->set_error(ctx, "Discord bot not initialized");
+        return false;
+    }
+
+    dpp::snowflake user_id = std::strtoull(user_id_str, nullptr, 10);
+
+    AsyncNode<FetchUserData>::Execution execution(inst->node, ctx);
+    auto done = execution.callback<const UserRecord&>(fetch_user_deliver);
+
+    // Cached users are answered within this execution, others from tick()
+    UserRecord cached;
+    if (BotManager::instance().peek_user(user_id, cached)) {
+        done(cached);
+    } else {
+        BotManager::instance().fetch_user(user_id, done);
+    }
+
+    return true;
+}
+
+static PinDesc fetch_user_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"UserID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Found", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"NotFound", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"Username", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"GlobalName", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"AvatarURL", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"IsBot", "bool", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable fetch_user_vtable = {
+    fetch_user_create,
+    fetch_user_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    fetch_user_execute,
+    NULL, NULL,
+    fetch_user_start_listening,
+    fetch_user_stop_listening,
+    NULL
+};
+
+static NodeDesc fetch_user_desc = {
+    "Fetch User",
+    "Discord/Data",
+    "com.rune.discord.fetch_user",
+    fetch_user_pins,
+    8,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Look up a user by ID from cache, falling back to the Discord API; fires Found or NotFound"
+};
+
+void register_fetch_user_node(PluginNodeRegistry* reg) {
+    reg->register_node(&fetch_user_desc, &fetch_user_vtable);
+}
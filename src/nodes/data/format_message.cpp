@@ -0,0 +1,157 @@
+/**
+ * FormatMessage Node - Render a placeholder template (pure data node)
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "message_template.h"
+#include <string>
+
+// The template is compiled once per instance and only recompiled when the
+// Template input changes; the output and ID buffers are reused between
+// executions.
+struct FormatMessageInstance {
+    MessageTemplate compiled;
+    std::string error;
+    std::string output;
+    std::string ids[MessageTemplate::kFieldCount];
+};
+
+static void* format_message_create() {
+    return new FormatMessageInstance();
+}
+
+static void format_message_destroy(void* inst_ptr) {
+    delete static_cast<FormatMessageInstance*>(inst_ptr);
+}
+
+static const char* const kArgPins[] = { "Arg0", "Arg1", "Arg2", "Arg3", "Arg4",
+                                        "Arg5", "Arg6", "Arg7", "Arg8", "Arg9" };
+static const size_t kArgCount = sizeof(kArgPins) / sizeof(kArgPins[0]);
+
+static const char* id_text(dpp::snowflake id, std::string& buffer) {
+    buffer = std::to_string(static_cast<uint64_t>(id));
+    return buffer.c_str();
+}
+
+// Field of the Message/ReactionAdd event whose listeners are running, or
+// null if that event type has no such field
+static const char* event_field(const QueuedEvent& event, MessageTemplate::Field field, std::string& buffer) {
+    if (event.type == DiscordEventType::Message) {
+        const MessageEventData& m = event.message_data;
+        switch (field) {
+            case MessageTemplate::AuthorId: return id_text(m.author_id, buffer);
+            case MessageTemplate::AuthorName: return m.author_name.c_str();
+            case MessageTemplate::Content: return m.content.c_str();
+            case MessageTemplate::ChannelId: return id_text(m.channel_id, buffer);
+            case MessageTemplate::GuildId: return id_text(m.guild_id, buffer);
+            case MessageTemplate::MessageId: return id_text(m.message_id, buffer);
+            default: return nullptr;
+        }
+    }
+    if (event.type == DiscordEventType::ReactionAdd) {
+        const ReactionEventData& r = event.reaction_data;
+        switch (field) {
+            case MessageTemplate::UserId: return id_text(r.user_id, buffer);
+            case MessageTemplate::Emoji: return r.emoji.c_str();
+            case MessageTemplate::ChannelId: return id_text(r.channel_id, buffer);
+            case MessageTemplate::GuildId: return id_text(r.guild_id, buffer);
+            case MessageTemplate::MessageId: return id_text(r.message_id, buffer);
+            default: return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+static bool format_message_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<FormatMessageInstance*>(inst_ptr);
+
+    const char* templ = ctx->get_input_string(ctx, "Template");
+    if (!templ) {
+        templ = "";
+    }
+
+    if (!inst->compiled.is_compiled() || inst->compiled.source() != templ) {
+        inst->error.clear();
+        if (!inst->compiled.compile(templ, inst->error)) {
+            ctx->set_error(ctx, inst->error.c_str());
+            return false;
+        }
+    }
+
+    const char* args[kArgCount];
+    for (size_t i = 0; i < kArgCount; ++i) {
+        args[i] = ctx->get_input_string(ctx, kArgPins[i]);
+    }
+
+    // Event placeholders bind to the On Message/On Reaction event that is
+    // running this flow. A wired pin of the same name takes precedence, and
+    // is the only source once the flow continues after an async reply.
+    const QueuedEvent* event = BotManager::instance().dispatching_event();
+    MessageTemplate::Inputs inputs;
+    for (size_t i = 0; i < MessageTemplate::kFieldCount; ++i) {
+        const auto field = static_cast<MessageTemplate::Field>(i);
+        const char* wired = ctx->get_input_string(ctx, MessageTemplate::field_name(field));
+        if ((!wired || !wired[0]) && event) {
+            wired = event_field(*event, field, inst->ids[i]);
+        }
+        inputs.fields[i] = wired;
+    }
+    inputs.args = args;
+    inputs.arg_count = kArgCount;
+
+    inst->compiled.render(inputs, inst->output);
+    ctx->set_output_string(ctx, "Text", inst->output.c_str());
+    return true;
+}
+
+static PinDesc format_message_pins[] = {
+    {"Template", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"AuthorID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"AuthorName", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Content", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"UserID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Emoji", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"ChannelID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"GuildID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"MessageID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg0", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg1", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg2", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg3", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg4", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg5", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg6", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg7", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg8", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Arg9", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Text", "string", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable format_message_vtable = {
+    format_message_create,
+    format_message_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    format_message_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc format_message_desc = {
+    "Format Message",
+    "Discord/Data",
+    "com.rune.discord.format_message",
+    format_message_pins,
+    20,
+    NODE_FLAG_PURE_DATA,
+    NULL, NULL,
+    "Render a template such as \"Hi {AuthorName}, you said {Content}\". AuthorID...MessageID come from the "
+    "On Message/On Reaction event that started the flow, or from the input pin of the same name when it is "
+    "wired (needed after an async node such as Fetch User); Arg0-Arg9 come from their pins"
+};
+
+void register_format_message_node(PluginNodeRegistry* reg) {
+    reg->register_node(&format_message_desc, &format_message_vtable);
+}
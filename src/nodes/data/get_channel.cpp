@@ -30,6 +30,15 @@ static bool get_channel_execute(void* inst, ExecContext* ctx) {
         return true;
     }
 
+    // Until the guild arrives over the gateway, fall back to the snapshot
+    SnapshotChannel snap;
+    if (BotManager::instance().snapshot().find_channel(channel_id, snap)) {
+        ctx->set_output_string(ctx, "Name", snap.name.c_str());
+        ctx->set_output_string(ctx, "Topic", snap.topic.c_str());
+        ctx->set_output_int(ctx, "Type", static_cast<int64_t>(snap.type));
+        return true;
+    }
+
     ctx->set_output_string(ctx, "Name", "");
     ctx->set_output_string(ctx, "Topic", "");
     ctx->set_output_int(ctx, "Type", 0);
@@ -0,0 +1,91 @@
+/**
+ * GetDiscordStats Node - Runtime metrics of the plugin (pure data node)
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "metrics.h"
+#include "node_profiler.h"
+#include <string>
+
+struct GetDiscordStatsInstance {
+    std::string stats;
+    std::string node_profile;
+};
+
+static void* get_discord_stats_create() {
+    return new GetDiscordStatsInstance();
+}
+
+static void get_discord_stats_destroy(void* inst) {
+    delete static_cast<GetDiscordStatsInstance*>(inst);
+}
+
+static bool get_discord_stats_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<GetDiscordStatsInstance*>(inst_ptr);
+    BotManager::instance().sample_metrics();
+
+    const DiscordMetrics& metrics = discord_metrics();
+    uint64_t restRequests = 0;
+    uint64_t rateLimited = 0;
+    for (const auto& route : metrics.rest) {
+        restRequests += route.requests.value();
+        rateLimited += route.rate_limited.value();
+    }
+
+    inst->stats = metrics.to_json().dump();
+    ctx->set_output_json(ctx, "Stats", inst->stats.c_str());
+    ctx->set_output_int(ctx, "EventsReceived", static_cast<int64_t>(metrics.total_received()));
+    ctx->set_output_int(ctx, "EventsDispatched", static_cast<int64_t>(metrics.total_dispatched()));
+    ctx->set_output_int(ctx, "EventsDropped", static_cast<int64_t>(metrics.total_dropped()));
+    ctx->set_output_int(ctx, "QueueDepth", metrics.queue_depth.value());
+    ctx->set_output_float(ctx, "DispatchP99Ms",
+                          static_cast<double>(metrics.dispatch_latency.percentile_us(0.99)) / 1000.0);
+    ctx->set_output_int(ctx, "RestRequests", static_cast<int64_t>(restRequests));
+    ctx->set_output_int(ctx, "RateLimited", static_cast<int64_t>(rateLimited));
+
+    // Node profile rows (empty unless profile_nodes is on), most expensive first
+    const char* sortBy = ctx->get_input_string(ctx, "SortBy");
+    inst->node_profile = NodeProfiler::instance().to_json(sortBy && sortBy[0] ? sortBy : "total")["nodes"].dump();
+    ctx->set_output_json(ctx, "NodeProfile", inst->node_profile.c_str());
+    return true;
+}
+
+static PinDesc get_discord_stats_pins[] = {
+    {"SortBy", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Stats", "json", PIN_OUT, PIN_KIND_DATA, 0},
+    {"EventsReceived", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"EventsDispatched", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"EventsDropped", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"QueueDepth", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"DispatchP99Ms", "float", PIN_OUT, PIN_KIND_DATA, 0},
+    {"RestRequests", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"RateLimited", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"NodeProfile", "json", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable get_discord_stats_vtable = {
+    get_discord_stats_create,
+    get_discord_stats_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    get_discord_stats_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc get_discord_stats_desc = {
+    "Get Discord Stats",
+    "Discord/Data",
+    "com.rune.discord.get_discord_stats",
+    get_discord_stats_pins,
+    10,
+    NODE_FLAG_PURE_DATA,
+    NULL, NULL,
+    "Runtime metrics: event counts, queue depth, dispatch and REST latency, rate limits, heartbeat latency and cache sizes (Stats holds the full set as JSON). NodeProfile lists per node type and flow execution cost when profile_nodes is on, sorted by SortBy (total, self, mean, max, calls or allocs)"
+};
+
+void register_get_discord_stats_node(PluginNodeRegistry* reg) {
+    reg->register_node(&get_discord_stats_desc, &get_discord_stats_vtable);
+}
@@ -0,0 +1,122 @@
+/**
+ * GetMember Node - Get a guild member by guild and user ID (pure data node)
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include <nlohmann/json.hpp>
+#include <cstdlib>
+
+using json = nlohmann::json;
+
+// Output strings are kept on the instance so they outlive the execute call
+struct GetMemberInstance {
+    StoredMember member;
+    std::string roles_json;
+};
+
+static void* get_member_create() {
+    return new GetMemberInstance();
+}
+
+static void get_member_destroy(void* inst_ptr) {
+    delete static_cast<GetMemberInstance*>(inst_ptr);
+}
+
+// Member store first (when enabled), then DPP's member cache
+static bool lookup_member(dpp::snowflake guild_id, dpp::snowflake user_id, StoredMember& out) {
+    if (BotManager::instance().member_store().get_member(guild_id, user_id, out)) {
+        return true;
+    }
+
+    try {
+        dpp::guild_member member = dpp::find_guild_member(guild_id, user_id);
+        out = StoredMember();
+        out.nickname = member.get_nickname();
+        out.roles = member.get_roles();
+        out.joined_at = static_cast<int64_t>(member.joined_at);
+        if (dpp::user* user = dpp::find_user(user_id)) {
+            out.username = user->username;
+            out.global_name = user->global_name;
+            out.is_bot = user->is_bot();
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+static bool get_member_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<GetMemberInstance*>(inst_ptr);
+    const char* guild_id_str = ctx->get_input_string(ctx, "GuildID");
+    const char* user_id_str = ctx->get_input_string(ctx, "UserID");
+
+    if (!guild_id_str || !user_id_str) {
+        ctx->set_error(ctx, "GuildID and UserID are required");
+        return false;
+    }
+
+    if (!BotManager::instance().get_cluster()) {
+        ctx->set_error(ctx, "Discord bot not initialized");
+        return false;
+    }
+
+    dpp::snowflake guild_id = std::strtoull(guild_id_str, nullptr, 10);
+    dpp::snowflake user_id = std::strtoull(user_id_str, nullptr, 10);
+
+    const bool found = lookup_member(guild_id, user_id, inst->member);
+    if (!found) {
+        inst->member = StoredMember();
+    }
+
+    json roles = json::array();
+    for (dpp::snowflake role : inst->member.roles) {
+        roles.push_back(std::to_string(static_cast<uint64_t>(role)));
+    }
+    inst->roles_json = roles.dump();
+
+    ctx->set_output_bool(ctx, "Found", found);
+    ctx->set_output_string(ctx, "Username", inst->member.username.c_str());
+    ctx->set_output_string(ctx, "Nickname", inst->member.nickname.c_str());
+    ctx->set_output_json(ctx, "Roles", inst->roles_json.c_str());
+    ctx->set_output_int(ctx, "JoinedAt", inst->member.joined_at);
+    ctx->set_output_bool(ctx, "IsBot", inst->member.is_bot);
+    return true;
+}
+
+static PinDesc get_member_pins[] = {
+    {"GuildID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"UserID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Found", "bool", PIN_OUT, PIN_KIND_DATA, 0},
+    {"Username", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"Nickname", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"Roles", "json", PIN_OUT, PIN_KIND_DATA, 0},
+    {"JoinedAt", "int", PIN_OUT, PIN_KIND_DATA, 0},
+    {"IsBot", "bool", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable get_member_vtable = {
+    get_member_create,
+    get_member_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    get_member_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc get_member_desc = {
+    "Get Member",
+    "Discord/Data",
+    "com.rune.discord.get_member",
+    get_member_pins,
+    8,
+    NODE_FLAG_PURE_DATA,
+    NULL, NULL,
+    "Get a guild member (username, nickname, roles, join time) from cache by Guild ID and User ID"
+};
+
+void register_get_member_node(PluginNodeRegistry* reg) {
+    reg->register_node(&get_member_desc, &get_member_vtable);
+}
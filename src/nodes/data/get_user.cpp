@@ -32,6 +32,23 @@ static bool get_user_execute(void* inst, ExecContext* ctx) {
         return true;
     }
 
+    // DPP's user cache is off when the member store is enabled
+    StoredUser stored;
+    if (BotManager::instance().member_store().get_user(user_id, stored)) {
+        ctx->set_output_string(ctx, "Username", stored.username.c_str());
+        ctx->set_output_string(ctx, "Discriminator", "0");
+        ctx->set_output_bool(ctx, "IsBot", stored.is_bot);
+        return true;
+    }
+
+    SnapshotUser snap;
+    if (BotManager::instance().snapshot().find_user(user_id, snap)) {
+        ctx->set_output_string(ctx, "Username", snap.username.c_str());
+        ctx->set_output_string(ctx, "Discriminator", "0");
+        ctx->set_output_bool(ctx, "IsBot", snap.is_bot);
+        return true;
+    }
+
     ctx->set_output_string(ctx, "Username", "");
     ctx->set_output_string(ctx, "Discriminator", "0");
     ctx->set_output_bool(ctx, "IsBot", false);
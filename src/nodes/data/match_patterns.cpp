@@ -0,0 +1,106 @@
+/**
+ * MatchPatterns Node - Find which of a set of keywords and regexes occur in a text (pure data node)
+ */
+
+#include "discord_plugin.h"
+#include "pattern_matcher.h"
+#include <nlohmann/json.hpp>
+#include <cstring>
+
+using json = nlohmann::json;
+
+// The compiled set is kept until Patterns or IgnoreCase change, so a flow
+// running on every message compiles it once
+struct MatchPatternsInstance {
+    PatternMatcher matcher;
+    bool compiled = false;
+    std::string patterns;
+    bool ignore_case = false;
+    std::vector<uint32_t> ids;
+    std::string ids_json;
+};
+
+static void* match_patterns_create() {
+    return new MatchPatternsInstance();
+}
+
+static void match_patterns_destroy(void* inst_ptr) {
+    delete static_cast<MatchPatternsInstance*>(inst_ptr);
+}
+
+static bool match_patterns_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<MatchPatternsInstance*>(inst_ptr);
+
+    const char* content = ctx->get_input_string(ctx, "Content");
+    const char* patterns = ctx->get_input_string(ctx, "Patterns");
+    const bool ignoreCase = ctx->get_input_bool(ctx, "IgnoreCase");
+    if (!patterns) {
+        ctx->set_error(ctx, "Patterns is required");
+        return false;
+    }
+
+    if (!inst->compiled || inst->ignore_case != ignoreCase || inst->patterns != patterns) {
+        inst->compiled = false;
+        std::vector<std::string> list;
+        std::string error;
+        if (!PatternMatcher::parse_list(patterns, list, error) || !inst->matcher.compile(list, ignoreCase, error)) {
+            ctx->set_error(ctx, ("Invalid Patterns: " + error).c_str());
+            return false;
+        }
+        inst->compiled = true;
+        inst->patterns = patterns;
+        inst->ignore_case = ignoreCase;
+    }
+
+    inst->ids.clear();
+    if (content) {
+        inst->matcher.match(content, std::strlen(content), inst->ids);
+    }
+    json ids = json::array();
+    for (uint32_t id : inst->ids) {
+        ids.push_back(id);
+    }
+    inst->ids_json = ids.dump();
+
+    ctx->set_output_bool(ctx, "Matched", !inst->ids.empty());
+    ctx->set_output_json(ctx, "MatchIDs", inst->ids_json.c_str());
+    ctx->set_output_int(ctx, "Count", static_cast<int64_t>(inst->ids.size()));
+    return true;
+}
+
+static PinDesc match_patterns_pins[] = {
+    {"Content", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Patterns", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"IgnoreCase", "bool", PIN_IN, PIN_KIND_DATA, 0},
+    {"Matched", "bool", PIN_OUT, PIN_KIND_DATA, 0},
+    {"MatchIDs", "json", PIN_OUT, PIN_KIND_DATA, 0},
+    {"Count", "int", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable match_patterns_vtable = {
+    match_patterns_create,
+    match_patterns_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    match_patterns_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc match_patterns_desc = {
+    "Match Patterns",
+    "Discord/Data",
+    "com.rune.discord.match_patterns",
+    match_patterns_pins,
+    6,
+    NODE_FLAG_PURE_DATA,
+    NULL, NULL,
+    "Check Content against every pattern in one pass. Patterns is a JSON array of strings or one pattern per line; "
+    "/.../ is a regex, anything else a keyword found anywhere in the text. MatchIDs lists the 0-based positions of "
+    "the matching patterns (blank lines not counted). The set is compiled once and reused while Patterns is unchanged."
+};
+
+void register_match_patterns_node(PluginNodeRegistry* reg) {
+    reg->register_node(&match_patterns_desc, &match_patterns_vtable);
+}
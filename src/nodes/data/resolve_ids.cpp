@@ -0,0 +1,160 @@
+/**
+ * ResolveIDs Node - Resolve a batch of user, member or channel IDs (async)
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "async_node.h"
+#include <nlohmann/json.hpp>
+#include <cstdlib>
+#include <cstring>
+
+using json = nlohmann::json;
+
+struct ResolveIdsData {
+    std::string records;
+};
+
+struct ResolveIdsInstance {
+    AsyncNode<ResolveIdsData> node;
+};
+
+static void* resolve_ids_create() {
+    return new ResolveIdsInstance();
+}
+
+static void resolve_ids_destroy(void* inst_ptr) {
+    delete static_cast<ResolveIdsInstance*>(inst_ptr);
+}
+
+static bool resolve_ids_start_listening(void* inst_ptr, ExecContext* ctx) {
+    static_cast<ResolveIdsInstance*>(inst_ptr)->node.listen(ctx);
+    return true;
+}
+
+static void resolve_ids_stop_listening(void* inst_ptr) {
+    static_cast<ResolveIdsInstance*>(inst_ptr)->node.stop();
+}
+
+static bool parse_kind(const char* kind, ResolveKind& out) {
+    if (!kind || !kind[0] || std::strcmp(kind, "user") == 0) {
+        out = ResolveKind::User;
+    } else if (std::strcmp(kind, "member") == 0) {
+        out = ResolveKind::Member;
+    } else if (std::strcmp(kind, "channel") == 0) {
+        out = ResolveKind::Channel;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// IDs pin: JSON array of ID strings (numbers are accepted too)
+static bool parse_ids(const char* ids_json, std::vector<dpp::snowflake>& out) {
+    if (!ids_json || !ids_json[0]) {
+        return false;
+    }
+
+    json j = json::parse(ids_json, nullptr, false);
+    if (j.is_discarded() || !j.is_array()) {
+        return false;
+    }
+
+    out.reserve(j.size());
+    for (const auto& item : j) {
+        if (item.is_string()) {
+            out.push_back(std::strtoull(item.get_ref<const std::string&>().c_str(), nullptr, 10));
+        } else if (item.is_number_unsigned()) {
+            out.push_back(item.get<uint64_t>());
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool resolve_ids_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<ResolveIdsInstance*>(inst_ptr);
+
+    ResolveKind kind;
+    if (!parse_kind(ctx->get_input_string(ctx, "Kind"), kind)) {
+        ctx->set_error(ctx, "Kind must be one of: user, member, channel");
+        return false;
+    }
+
+    std::vector<dpp::snowflake> ids;
+    if (!parse_ids(ctx->get_input_string(ctx, "IDs"), ids)) {
+        ctx->set_error(ctx, "IDs must be a JSON array of ID strings");
+        return false;
+    }
+
+    dpp::snowflake guild_id;
+    if (kind == ResolveKind::Member) {
+        const char* guild_id_str = ctx->get_input_string(ctx, "GuildID");
+        if (!guild_id_str || guild_id_str[0] == '\0') {
+            ctx->set_error(ctx, "GuildID is required when Kind is member");
+            return false;
+        }
+        guild_id = std::strtoull(guild_id_str, nullptr, 10);
+    }
+
+    if (!BotManager::instance().is_online()) {
+        ctx->set_error(ctx, "Discord bot not initialized");
+        return false;
+    }
+
+    // Outputs are written when the batch completes: within this execution if
+    // every ID was cached, otherwise from tick()
+    AsyncNode<ResolveIdsData>::Execution execution(inst->node, ctx);
+    BotManager::instance().resolve_ids(kind, guild_id, ids, execution.callback<std::vector<ResolvedRecord>&>(
+        [kind](ExecContext* c, ResolveIdsData& data, std::vector<ResolvedRecord>& records) {
+            int64_t found = 0;
+            for (const auto& record : records) {
+                found += record.found ? 1 : 0;
+            }
+
+            data.records = IdResolver::records_to_json(kind, records);
+            c->set_output_json(c, "Records", data.records.c_str());
+            c->set_output_int(c, "FoundCount", found);
+            c->trigger_output(c, "Done");
+        }));
+
+    return true;
+}
+
+static PinDesc resolve_ids_pins[] = {
+    {"Exec", "execution", PIN_IN, PIN_KIND_EXECUTION, 0},
+    {"Kind", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"GuildID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"IDs", "json", PIN_IN, PIN_KIND_DATA, 0},
+    {"Done", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"Records", "json", PIN_OUT, PIN_KIND_DATA, 0},
+    {"FoundCount", "int", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable resolve_ids_vtable = {
+    resolve_ids_create,
+    resolve_ids_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    resolve_ids_execute,
+    NULL, NULL,
+    resolve_ids_start_listening,
+    resolve_ids_stop_listening,
+    NULL
+};
+
+static NodeDesc resolve_ids_desc = {
+    "Resolve IDs",
+    "Discord/Data",
+    "com.rune.discord.resolve_ids",
+    resolve_ids_pins,
+    7,
+    NODE_FLAG_NONE,
+    NULL, NULL,
+    "Resolve a JSON array of user, member or channel IDs in one batch; Records lists the results in input order"
+};
+
+void register_resolve_ids_node(PluginNodeRegistry* reg) {
+    reg->register_node(&resolve_ids_desc, &resolve_ids_vtable);
+}
@@ -0,0 +1,111 @@
+/**
+ * SearchMessages Node - Search recent message history (pure data node)
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+
+using json = nlohmann::json;
+
+// Output JSON is kept on the instance so it outlives the execute call
+struct SearchMessagesInstance {
+    std::vector<IndexedMessage> results;
+    std::string results_json;
+};
+
+static void* search_messages_create() {
+    return new SearchMessagesInstance();
+}
+
+static void search_messages_destroy(void* inst_ptr) {
+    delete static_cast<SearchMessagesInstance*>(inst_ptr);
+}
+
+static dpp::snowflake optional_id(ExecContext* ctx, const char* pin) {
+    const char* value = ctx->get_input_string(ctx, pin);
+    return (value && *value) ? dpp::snowflake(std::strtoull(value, nullptr, 10)) : dpp::snowflake();
+}
+
+static bool search_messages_execute(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<SearchMessagesInstance*>(inst_ptr);
+
+    if (!GetDiscordPluginConfig().message_index_enabled) {
+        ctx->set_error(ctx, "Message history is disabled (enable message_index_enabled in the plugin settings)");
+        return false;
+    }
+
+    const char* text = ctx->get_input_string(ctx, "Query");
+    MessageQuery query;
+    query.text = text ? text : "";
+    query.author_id = optional_id(ctx, "AuthorID");
+    query.channel_id = optional_id(ctx, "ChannelID");
+    query.guild_id = optional_id(ctx, "GuildID");
+
+    const int64_t maxAge = ctx->get_input_int(ctx, "MaxAgeSeconds");
+    if (maxAge > 0) {
+        query.since = static_cast<int64_t>(std::time(nullptr)) - maxAge;
+    }
+    const int64_t limit = ctx->get_input_int(ctx, "Limit");
+    query.limit = limit > 0 ? static_cast<size_t>(std::min<int64_t>(limit, 1000)) : 50;
+
+    inst->results.clear();
+    BotManager::instance().message_index().search(query, inst->results);
+
+    json results = json::array();
+    for (const auto& message : inst->results) {
+        results.push_back({
+            {"id", std::to_string(static_cast<uint64_t>(message.id))},
+            {"author_id", std::to_string(static_cast<uint64_t>(message.author_id))},
+            {"channel_id", std::to_string(static_cast<uint64_t>(message.channel_id))},
+            {"guild_id", std::to_string(static_cast<uint64_t>(message.guild_id))},
+            {"timestamp", message.timestamp},
+            {"content", message.content}
+        });
+    }
+    inst->results_json = results.dump();
+
+    ctx->set_output_json(ctx, "Results", inst->results_json.c_str());
+    ctx->set_output_int(ctx, "Count", static_cast<int64_t>(inst->results.size()));
+    return true;
+}
+
+static PinDesc search_messages_pins[] = {
+    {"Query", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"AuthorID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"ChannelID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"GuildID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"MaxAgeSeconds", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Limit", "int", PIN_IN, PIN_KIND_DATA, 0},
+    {"Results", "json", PIN_OUT, PIN_KIND_DATA, 0},
+    {"Count", "int", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable search_messages_vtable = {
+    search_messages_create,
+    search_messages_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    search_messages_execute,
+    NULL, NULL,
+    NULL, NULL,
+    NULL
+};
+
+static NodeDesc search_messages_desc = {
+    "Search Messages",
+    "Discord/Data",
+    "com.rune.discord.search_messages",
+    search_messages_pins,
+    8,
+    NODE_FLAG_PURE_DATA,
+    NULL, NULL,
+    "Search recent messages (newest first) by words, author, channel, guild and age; empty inputs match anything. Requires message_index_enabled."
+};
+
+void register_search_messages_node(PluginNodeRegistry* reg) {
+    reg->register_node(&search_messages_desc, &search_messages_vtable);
+}
@@ -0,0 +1,142 @@
+/**
+ * OnComponent Node - Fires when a button or select menu with this node's custom_id prefix is used
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include "plugin_log.h"
+#include <cstring>
+
+struct OnComponentInstance {
+    ExecContext* ctx;
+    bool listening;
+    ComponentRouter::Handle route;
+    // Cached data for output
+    std::string interaction_id;
+    std::string message_id;
+    std::string custom_id;
+    std::string state;
+    std::string values;
+    std::string user_id;
+    std::string user_name;
+    std::string channel_id;
+    std::string guild_id;
+};
+
+static void* on_component_create() {
+    auto* inst = new OnComponentInstance();
+    inst->ctx = nullptr;
+    inst->listening = false;
+    inst->route = 0;
+    return inst;
+}
+
+static void on_component_destroy(void* inst_ptr) {
+    delete static_cast<OnComponentInstance*>(inst_ptr);
+}
+
+static bool on_component_start_listening(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<OnComponentInstance*>(inst_ptr);
+    const char* prefix = ctx->get_input_string(ctx, "Prefix");
+    const std::string routePrefix = prefix ? prefix : "";
+    const bool messageBound = ctx->get_input_bool(ctx, "MessageBound");
+
+    inst->ctx = ctx;
+    inst->listening = true;
+    inst->route = BotManager::instance().add_component_route(routePrefix, messageBound,
+        [inst](const ComponentEventData& data, const std::string& state) {
+            if (!inst->listening || !inst->ctx) {
+                return;
+            }
+            inst->interaction_id = std::to_string(static_cast<uint64_t>(data.interaction_id));
+            inst->message_id = std::to_string(static_cast<uint64_t>(data.message_id));
+            inst->custom_id = data.custom_id;
+            inst->state = state;
+            inst->values = data.values_json;
+            inst->user_id = std::to_string(static_cast<uint64_t>(data.user_id));
+            inst->user_name = data.user_name;
+            inst->channel_id = std::to_string(static_cast<uint64_t>(data.channel_id));
+            inst->guild_id = std::to_string(static_cast<uint64_t>(data.guild_id));
+
+            inst->ctx->set_output_string(inst->ctx, "InteractionID", inst->interaction_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "MessageID", inst->message_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "CustomID", inst->custom_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "State", inst->state.c_str());
+            inst->ctx->set_output_string(inst->ctx, "Values", inst->values.c_str());
+            inst->ctx->set_output_string(inst->ctx, "UserID", inst->user_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "UserName", inst->user_name.c_str());
+            inst->ctx->set_output_string(inst->ctx, "ChannelID", inst->channel_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "GuildID", inst->guild_id.c_str());
+            inst->ctx->trigger_output(inst->ctx, "OnComponent");
+        },
+        [inst](dpp::snowflake message_id) {
+            if (!inst->listening || !inst->ctx) {
+                return;
+            }
+            inst->message_id = std::to_string(static_cast<uint64_t>(message_id));
+            inst->ctx->set_output_string(inst->ctx, "MessageID", inst->message_id.c_str());
+            inst->ctx->trigger_output(inst->ctx, "OnExpired");
+        });
+
+    if (inst->route == 0) {
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_ERROR, "Discord plugin: On Component prefix '" + routePrefix +
+            "' is empty, contains ':' or is used by another On Component node");
+    }
+    return true;
+}
+
+static void on_component_stop_listening(void* inst_ptr) {
+    auto* inst = static_cast<OnComponentInstance*>(inst_ptr);
+    inst->listening = false;
+    inst->ctx = nullptr;
+    if (inst->route != 0) {
+        BotManager::instance().components().remove_route(inst->route);
+        inst->route = 0;
+    }
+}
+
+static PinDesc on_component_pins[] = {
+    {"Prefix", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"MessageBound", "bool", PIN_IN, PIN_KIND_DATA, 0},
+    {"OnComponent", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"OnExpired", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"InteractionID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"MessageID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"CustomID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"State", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"Values", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"UserID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"UserName", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"ChannelID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"GuildID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable on_component_vtable = {
+    on_component_create,
+    on_component_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    NULL,
+    NULL, NULL,
+    on_component_start_listening,
+    on_component_stop_listening,
+    NULL
+};
+
+static NodeDesc on_component_desc = {
+    "On Component",
+    "Discord/Events",
+    "com.rune.discord.on_component",
+    on_component_pins,
+    13,
+    NODE_FLAG_TRIGGER_EVENT,
+    NULL, NULL,
+    "Fires when a button or select menu whose custom_id is \"<Prefix>:<state>\" is used; State is the "
+    "part after the prefix and Values the selected values (JSON array). Each prefix belongs to one node. "
+    "With MessageBound set, only clicks on messages bound with Bind Component Message are accepted; "
+    "OnExpired fires with MessageID when a binding times out. Answer with Respond To Interaction"
+};
+
+void register_on_component_node(PluginNodeRegistry* reg) {
+    reg->register_node(&on_component_desc, &on_component_vtable);
+}
@@ -4,6 +4,7 @@
 
 #include "discord_plugin.h"
 #include "bot_manager.h"
+#include "plugin_log.h"
 #include <cstring>
 #include <string>
 
@@ -32,7 +33,7 @@ static bool on_ready_start_listening(void* inst_ptr, ExecContext* ctx) {
     const DiscordPluginConfig& cfg = GetDiscordPluginConfig();
 
     // Log current configuration and bot state when this node begins listening
-    if (g_host) {
+    if (discord_log_enabled(PLUGIN_LOG_LEVEL_DEBUG)) {
         std::string msg = "Discord On Ready: start_listening (auto_connect=";
         msg += cfg.auto_connect ? "true" : "false";
         msg += ", bot_running=";
@@ -46,7 +47,7 @@ static bool on_ready_start_listening(void* inst_ptr, ExecContext* ctx) {
         msg += ", ready_already_fired=";
         msg += BotManager::instance().has_ready_fired() ? "true" : "false";
         msg += ")";
-        g_host->log(PLUGIN_LOG_LEVEL_DEBUG, msg.c_str());
+        DISCORD_LOG(PLUGIN_LOG_LEVEL_DEBUG, std::move(msg));
     }
 
     // In auto-connect mode, ensure the bot is running when this node starts listening.
@@ -0,0 +1,123 @@
+/**
+ * OnSlashCommand Node - Fires when a slash command is used
+ */
+
+#include "discord_plugin.h"
+#include "bot_manager.h"
+#include <cstring>
+
+struct OnSlashCommandInstance {
+    ExecContext* ctx;
+    bool listening;
+    // Command this node defines (empty: fires for every command)
+    std::string command;
+    // Cached data for output
+    std::string interaction_id;
+    std::string command_name;
+    std::string options;
+    std::string user_id;
+    std::string user_name;
+    std::string channel_id;
+    std::string guild_id;
+};
+
+static void* on_slash_command_create() {
+    auto* inst = new OnSlashCommandInstance();
+    inst->ctx = nullptr;
+    inst->listening = false;
+    return inst;
+}
+
+static void on_slash_command_destroy(void* inst_ptr) {
+    delete static_cast<OnSlashCommandInstance*>(inst_ptr);
+}
+
+static bool on_slash_command_start_listening(void* inst_ptr, ExecContext* ctx) {
+    auto* inst = static_cast<OnSlashCommandInstance*>(inst_ptr);
+    inst->ctx = ctx;
+    inst->listening = true;
+
+    // The definition inputs are read from the flow file (CommandRegistry);
+    // here Command only filters
+    const char* command = ctx->get_input_string(ctx, "Command");
+    inst->command = command ? command : "";
+
+    BotManager::instance().add_slash_command_listener([inst](const InteractionEventData& data) {
+        if (inst && inst->listening && inst->ctx &&
+            (inst->command.empty() || data.command_name == inst->command)) {
+            inst->interaction_id = std::to_string(static_cast<uint64_t>(data.interaction_id));
+            inst->command_name = data.command_name;
+            inst->options = data.options_json;
+            inst->user_id = std::to_string(static_cast<uint64_t>(data.user_id));
+            inst->user_name = data.user_name;
+            inst->channel_id = std::to_string(static_cast<uint64_t>(data.channel_id));
+            inst->guild_id = std::to_string(static_cast<uint64_t>(data.guild_id));
+
+            inst->ctx->set_output_string(inst->ctx, "InteractionID", inst->interaction_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "CommandName", inst->command_name.c_str());
+            inst->ctx->set_output_string(inst->ctx, "Options", inst->options.c_str());
+            inst->ctx->set_output_string(inst->ctx, "UserID", inst->user_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "UserName", inst->user_name.c_str());
+            inst->ctx->set_output_string(inst->ctx, "ChannelID", inst->channel_id.c_str());
+            inst->ctx->set_output_string(inst->ctx, "GuildID", inst->guild_id.c_str());
+            inst->ctx->trigger_output(inst->ctx, "OnSlashCommand");
+            return true;
+        }
+        return false;
+    });
+
+    return true;
+}
+
+static void on_slash_command_stop_listening(void* inst_ptr) {
+    auto* inst = static_cast<OnSlashCommandInstance*>(inst_ptr);
+    inst->listening = false;
+    inst->ctx = nullptr;
+}
+
+static PinDesc on_slash_command_pins[] = {
+    {"Command", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"Description", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"CommandOptions", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"CommandGuildID", "string", PIN_IN, PIN_KIND_DATA, 0},
+    {"OnSlashCommand", "execution", PIN_OUT, PIN_KIND_EXECUTION, 0},
+    {"InteractionID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"CommandName", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"Options", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"UserID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"UserName", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"ChannelID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+    {"GuildID", "string", PIN_OUT, PIN_KIND_DATA, 0},
+};
+
+static NodeVTable on_slash_command_vtable = {
+    on_slash_command_create,
+    on_slash_command_destroy,
+    NULL, NULL,
+    NULL, NULL,
+    NULL,
+    NULL, NULL,
+    on_slash_command_start_listening,
+    on_slash_command_stop_listening,
+    NULL
+};
+
+static NodeDesc on_slash_command_desc = {
+    "On Slash Command",
+    "Discord/Events",
+    "com.rune.discord.on_slash_command",
+    on_slash_command_pins,
+    12,
+    NODE_FLAG_TRIGGER_EVENT,
+    NULL, NULL,
+    "Fires when a user runs one of the bot's slash commands. With Command set, the node registers that "
+    "command (Description, CommandOptions as a JSON array of Discord command options, CommandGuildID "
+    "for a guild command) and fires only for it; registration is skipped when the commands are unchanged. "
+    "The definition is read from the flow file, so set these inputs as properties rather than wiring them. The "
+    "Options output is a JSON object of the command's options. Answer with Respond To Interaction; "
+    "unanswered commands are deferred after interaction_auto_defer_ms"
+};
+
+void register_on_slash_command_node(PluginNodeRegistry* reg) {
+    reg->register_node(&on_slash_command_desc, &on_slash_command_vtable);
+}
@@ -0,0 +1,1020 @@
+/**
+ * Pattern Matcher - Implementation
+ */
+
+#include "pattern_matcher.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <utility>
+
+#if RUNE_PATTERN_MATCHER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+const size_t PatternMatcher::kMaxDfaStates;
+const size_t PatternMatcher::kMaxNfaStates;
+const size_t PatternMatcher::kPrefilterBytes;
+const size_t PatternMatcher::kSkipBytes;
+const uint32_t PatternMatcher::kOutputFlag;
+
+static uint8_t ascii_lower(uint8_t b) {
+    return (b >= 'A' && b <= 'Z') ? static_cast<uint8_t>(b + ('a' - 'A')) : b;
+}
+
+static uint8_t ascii_upper(uint8_t b) {
+    return (b >= 'a' && b <= 'z') ? static_cast<uint8_t>(b - ('a' - 'A')) : b;
+}
+
+static unsigned lowest_bit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// ============================================================================
+// Regex parsing
+// ============================================================================
+
+// Parses one regex into a syntax tree, then emits its NFA with each node
+// compiled against its continuation (so {m,n} simply emits the child again)
+class PatternMatcher::RegexCompiler {
+public:
+    RegexCompiler(PatternMatcher& matcher, const std::string& source, bool ignore_case)
+        : m_matcher(matcher), m_source(source), m_ignore_case(ignore_case) {}
+
+    // Entry state of the regex, ending in a Match of pattern
+    bool compile(uint32_t pattern, uint32_t& entry, std::string& error) {
+        Node root;
+        if (!parse_alternation(root)) {
+            error = m_error;
+            return false;
+        }
+        if (m_pos != m_source.size()) {
+            error = "unmatched ')' at offset " + std::to_string(m_pos);
+            return false;
+        }
+        NfaState match;
+        match.kind = NfaState::Match;
+        match.pattern = pattern;
+        const uint32_t matchState = add(match);
+        entry = emit(root, matchState);
+        if (m_matcher.m_nfa.size() > kMaxNfaStates) {
+            error = "regexes are too large (more than " + std::to_string(kMaxNfaStates) + " NFA states)";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const int kMaxRepeat = 1000;
+
+    struct Node {
+        enum Kind { Empty, Set, Concat, Alternation, Repeat, Begin, End };
+        Kind kind = Empty;
+        uint32_t set = 0;
+        int min = 0;
+        int max = 0;  // -1: unbounded
+        std::vector<Node> children;
+    };
+
+    bool fail(const std::string& message) {
+        m_error = message + " at offset " + std::to_string(m_pos);
+        return false;
+    }
+
+    bool at_end() const { return m_pos >= m_source.size(); }
+    uint8_t peek() const { return static_cast<uint8_t>(m_source[m_pos]); }
+
+    uint32_t add_set(ByteSet set) {
+        if (m_ignore_case) {
+            ByteSet folded = set;
+            for (int b = 0; b < 256; ++b) {
+                if (set.has(static_cast<uint8_t>(b))) {
+                    folded.add(ascii_lower(static_cast<uint8_t>(b)));
+                    folded.add(ascii_upper(static_cast<uint8_t>(b)));
+                }
+            }
+            set = folded;
+        }
+        m_matcher.m_sets.push_back(set);
+        return static_cast<uint32_t>(m_matcher.m_sets.size() - 1);
+    }
+
+    Node set_node(const ByteSet& set) {
+        Node node;
+        node.kind = Node::Set;
+        node.set = add_set(set);
+        return node;
+    }
+
+    bool parse_alternation(Node& out) {
+        Node first;
+        if (!parse_concatenation(first)) {
+            return false;
+        }
+        if (at_end() || peek() != '|') {
+            out = std::move(first);
+            return true;
+        }
+        out.kind = Node::Alternation;
+        out.children.push_back(std::move(first));
+        while (!at_end() && peek() == '|') {
+            ++m_pos;
+            Node next;
+            if (!parse_concatenation(next)) {
+                return false;
+            }
+            out.children.push_back(std::move(next));
+        }
+        return true;
+    }
+
+    bool parse_concatenation(Node& out) {
+        out.kind = Node::Concat;
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            Node item;
+            if (!parse_repeat(item)) {
+                return false;
+            }
+            out.children.push_back(std::move(item));
+        }
+        return true;
+    }
+
+    bool parse_number(int& value) {
+        if (at_end() || peek() < '0' || peek() > '9') {
+            return false;
+        }
+        value = 0;
+        while (!at_end() && peek() >= '0' && peek() <= '9') {
+            value = std::min(value * 10 + (peek() - '0'), kMaxRepeat + 1);
+            ++m_pos;
+        }
+        return true;
+    }
+
+    // {m}, {m,} or {m,n}; anything else leaves m_pos alone and is literal
+    bool parse_braces(int& min, int& max) {
+        const size_t start = m_pos;
+        ++m_pos;
+        if (!parse_number(min)) {
+            m_pos = start;
+            return false;
+        }
+        max = min;
+        if (!at_end() && peek() == ',') {
+            ++m_pos;
+            max = -1;
+            if (!at_end() && peek() != '}') {
+                if (!parse_number(max)) {
+                    m_pos = start;
+                    return false;
+                }
+            }
+        }
+        if (at_end() || peek() != '}') {
+            m_pos = start;
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    bool parse_repeat(Node& out) {
+        if (!parse_atom(out)) {
+            return false;
+        }
+        while (!at_end()) {
+            int min = 0;
+            int max = 0;
+            const uint8_t c = peek();
+            if (c == '*') {
+                min = 0;
+                max = -1;
+                ++m_pos;
+            } else if (c == '+') {
+                min = 1;
+                max = -1;
+                ++m_pos;
+            } else if (c == '?') {
+                min = 0;
+                max = 1;
+                ++m_pos;
+            } else if (c != '{' || !parse_braces(min, max)) {
+                break;
+            }
+            if (min > kMaxRepeat || max > kMaxRepeat) {
+                return fail("repeat count above " + std::to_string(kMaxRepeat));
+            }
+            if (max >= 0 && max < min) {
+                return fail("repeat range {" + std::to_string(min) + "," + std::to_string(max) + "} is reversed");
+            }
+            if (out.kind == Node::Begin || out.kind == Node::End) {
+                return fail("nothing to repeat");
+            }
+            // Lazy and possessive markers do not change whether a match exists
+            if (!at_end() && (peek() == '?' || peek() == '+')) {
+                ++m_pos;
+            }
+            Node repeat;
+            repeat.kind = Node::Repeat;
+            repeat.min = min;
+            repeat.max = max;
+            repeat.children.push_back(std::move(out));
+            out = std::move(repeat);
+        }
+        return true;
+    }
+
+    // \d \w \s and their negations; false if c is not a class escape
+    static bool class_escape(uint8_t c, ByteSet& set) {
+        ByteSet base;
+        const uint8_t lower = ascii_lower(c);
+        if (lower == 'd') {
+            for (int b = '0'; b <= '9'; ++b) base.add(static_cast<uint8_t>(b));
+        } else if (lower == 'w') {
+            for (int b = '0'; b <= '9'; ++b) base.add(static_cast<uint8_t>(b));
+            for (int b = 'a'; b <= 'z'; ++b) base.add(static_cast<uint8_t>(b));
+            for (int b = 'A'; b <= 'Z'; ++b) base.add(static_cast<uint8_t>(b));
+            base.add('_');
+        } else if (lower == 's') {
+            for (const char* s = " \t\n\r\f\v"; *s; ++s) base.add(static_cast<uint8_t>(*s));
+        } else {
+            return false;
+        }
+        if (c != lower) {
+            for (int i = 0; i < 4; ++i) base.bits[i] = ~base.bits[i];
+        }
+        for (int i = 0; i < 4; ++i) set.bits[i] |= base.bits[i];
+        return true;
+    }
+
+    static int hex_value(uint8_t c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // The byte of an escape after the backslash (m_pos on the escaped char)
+    bool escaped_byte(uint8_t& out) {
+        const uint8_t c = peek();
+        ++m_pos;
+        switch (c) {
+            case 'n': out = '\n'; return true;
+            case 't': out = '\t'; return true;
+            case 'r': out = '\r'; return true;
+            case 'f': out = '\f'; return true;
+            case 'v': out = '\v'; return true;
+            case '0': out = 0; return true;
+            case 'x': {
+                if (m_pos + 2 > m_source.size() || hex_value(peek()) < 0 ||
+                    hex_value(static_cast<uint8_t>(m_source[m_pos + 1])) < 0) {
+                    return fail("\\x needs two hex digits");
+                }
+                out = static_cast<uint8_t>(hex_value(peek()) * 16 + hex_value(static_cast<uint8_t>(m_source[m_pos + 1])));
+                m_pos += 2;
+                return true;
+            }
+            default:
+                if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+                    --m_pos;
+                    return fail(std::string("unsupported escape \\") + static_cast<char>(c));
+                }
+                out = c;
+                return true;
+        }
+    }
+
+    bool parse_class(Node& out) {
+        ++m_pos;  // '['
+        bool negate = false;
+        if (!at_end() && peek() == '^') {
+            negate = true;
+            ++m_pos;
+        }
+        ByteSet set;
+        bool first = true;
+        while (true) {
+            if (at_end()) {
+                return fail("unterminated [");
+            }
+            uint8_t c = peek();
+            if (c == ']' && !first) {
+                ++m_pos;
+                break;
+            }
+            first = false;
+            uint8_t low = c;
+            if (c == '\\') {
+                ++m_pos;
+                if (at_end()) {
+                    return fail("trailing \\");
+                }
+                if (class_escape(peek(), set)) {
+                    ++m_pos;
+                    continue;
+                }
+                if (!escaped_byte(low)) {
+                    return false;
+                }
+            } else {
+                ++m_pos;
+            }
+            uint8_t high = low;
+            if (m_pos + 1 < m_source.size() && peek() == '-' && m_source[m_pos + 1] != ']') {
+                ++m_pos;
+                high = peek();
+                ++m_pos;
+                if (high == '\\') {
+                    if (at_end() || !escaped_byte(high)) {
+                        return m_error.empty() ? fail("trailing \\") : false;
+                    }
+                }
+                if (high < low) {
+                    return fail("reversed range in [...]");
+                }
+            }
+            for (int b = low; b <= high; ++b) {
+                set.add(static_cast<uint8_t>(b));
+            }
+        }
+        if (negate) {
+            // Folding is applied to the set before negation, so [^a] with
+            // ignore_case excludes 'A' as well
+            if (m_ignore_case) {
+                for (int b = 0; b < 256; ++b) {
+                    if (set.has(static_cast<uint8_t>(b))) {
+                        set.add(ascii_lower(static_cast<uint8_t>(b)));
+                        set.add(ascii_upper(static_cast<uint8_t>(b)));
+                    }
+                }
+            }
+            for (int i = 0; i < 4; ++i) set.bits[i] = ~set.bits[i];
+        }
+        out = set_node(set);
+        return true;
+    }
+
+    bool parse_atom(Node& out) {
+        const uint8_t c = peek();
+        switch (c) {
+            case '(': {
+                ++m_pos;
+                if (!at_end() && peek() == '?') {
+                    if (m_pos + 1 < m_source.size() && m_source[m_pos + 1] == ':') {
+                        m_pos += 2;
+                    } else {
+                        return fail("unsupported group (?");
+                    }
+                }
+                if (!parse_alternation(out)) {
+                    return false;
+                }
+                if (at_end() || peek() != ')') {
+                    return fail("missing )");
+                }
+                ++m_pos;
+                return true;
+            }
+            case '[':
+                return parse_class(out);
+            case '.': {
+                ++m_pos;
+                ByteSet set;
+                for (int i = 0; i < 4; ++i) set.bits[i] = ~uint64_t(0);
+                set.bits['\n' >> 6] &= ~(uint64_t(1) << ('\n' & 63));
+                out = set_node(set);
+                return true;
+            }
+            case '^':
+                ++m_pos;
+                out.kind = Node::Begin;
+                return true;
+            case '$':
+                ++m_pos;
+                out.kind = Node::End;
+                return true;
+            case '*':
+            case '+':
+            case '?':
+                return fail("nothing to repeat");
+            case '\\': {
+                ++m_pos;
+                if (at_end()) {
+                    return fail("trailing \\");
+                }
+                ByteSet set;
+                if (class_escape(peek(), set)) {
+                    ++m_pos;
+                    out = set_node(set);
+                    return true;
+                }
+                uint8_t b = 0;
+                if (!escaped_byte(b)) {
+                    return false;
+                }
+                set.add(b);
+                out = set_node(set);
+                return true;
+            }
+            default: {
+                ++m_pos;
+                ByteSet set;
+                set.add(c);
+                out = set_node(set);
+                return true;
+            }
+        }
+    }
+
+    uint32_t add(const NfaState& state) {
+        m_matcher.m_nfa.push_back(state);
+        return static_cast<uint32_t>(m_matcher.m_nfa.size() - 1);
+    }
+
+    uint32_t split(uint32_t a, uint32_t b) {
+        NfaState state;
+        state.kind = NfaState::Split;
+        state.out = a;
+        state.out1 = b;
+        return add(state);
+    }
+
+    // Entry of node, continuing to next
+    uint32_t emit(const Node& node, uint32_t next) {
+        if (m_matcher.m_nfa.size() > kMaxNfaStates) {
+            return next;  // compile() reports the overflow
+        }
+        switch (node.kind) {
+            case Node::Empty:
+                return next;
+            case Node::Set: {
+                NfaState state;
+                state.kind = NfaState::Bytes;
+                state.set = node.set;
+                state.out = next;
+                return add(state);
+            }
+            case Node::Begin:
+            case Node::End: {
+                NfaState state;
+                state.kind = node.kind == Node::Begin ? NfaState::AssertBegin : NfaState::AssertEnd;
+                state.out = next;
+                return add(state);
+            }
+            case Node::Concat:
+                for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+                    next = emit(*it, next);
+                }
+                return next;
+            case Node::Alternation: {
+                uint32_t entry = emit(node.children.back(), next);
+                for (size_t i = node.children.size() - 1; i-- > 0;) {
+                    entry = split(emit(node.children[i], next), entry);
+                }
+                return entry;
+            }
+            case Node::Repeat: {
+                const Node& child = node.children.front();
+                uint32_t entry = next;
+                if (node.max < 0) {
+                    // Loop: the split is patched once the body exists
+                    const uint32_t loop = split(0, next);
+                    m_matcher.m_nfa[loop].out = emit(child, loop);
+                    entry = loop;
+                } else {
+                    for (int i = node.min; i < node.max; ++i) {
+                        entry = split(emit(child, entry), next);
+                    }
+                }
+                for (int i = 0; i < node.min; ++i) {
+                    entry = emit(child, entry);
+                }
+                return entry;
+            }
+        }
+        return next;
+    }
+
+    PatternMatcher& m_matcher;
+    const std::string& m_source;
+    bool m_ignore_case;
+    size_t m_pos = 0;
+    std::string m_error;
+};
+
+// ============================================================================
+// Compilation
+// ============================================================================
+
+bool PatternMatcher::parse_list(const std::string& text, std::vector<std::string>& out, std::string& error) {
+    out.clear();
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if (first != std::string::npos && text[first] == '[') {
+        nlohmann::json list = nlohmann::json::parse(text, nullptr, false);
+        if (list.is_discarded() || !list.is_array()) {
+            error = "Patterns is not a valid JSON array";
+            return false;
+        }
+        for (const auto& item : list) {
+            if (!item.is_string()) {
+                error = "Patterns must contain only strings";
+                return false;
+            }
+            out.push_back(item.get<std::string>());
+        }
+        return true;
+    }
+
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string line = text.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.find_first_not_of(" \t") != std::string::npos) {
+            out.push_back(std::move(line));
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool PatternMatcher::compile(const std::vector<std::string>& patterns, bool ignore_case, std::string& error) {
+    *this = PatternMatcher();
+    m_ignore_case = ignore_case;
+    m_pattern_count = patterns.size();
+
+    std::vector<std::pair<std::string, uint32_t>> literals;
+    std::vector<uint32_t> entries;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        const std::string& pattern = patterns[i];
+        const uint32_t id = static_cast<uint32_t>(i);
+        if (pattern.size() >= 2 && pattern.front() == '/' && pattern.back() == '/') {
+            const std::string source = pattern.substr(1, pattern.size() - 2);
+            RegexCompiler regex(*this, source, ignore_case);
+            uint32_t entry = 0;
+            std::string regexError;
+            if (!regex.compile(id, entry, regexError)) {
+                error = "pattern " + std::to_string(i) + " (" + pattern + "): " + regexError;
+                *this = PatternMatcher();
+                return false;
+            }
+            entries.push_back(entry);
+            ++m_regex_count;
+        } else if (pattern.empty()) {
+            error = "pattern " + std::to_string(i) + " is empty";
+            *this = PatternMatcher();
+            return false;
+        } else {
+            literals.emplace_back(pattern, id);
+            ++m_literal_count;
+        }
+    }
+
+    if (!build_literals(literals, error)) {
+        *this = PatternMatcher();
+        return false;
+    }
+
+    if (!entries.empty()) {
+        // One start state branching into every regex
+        uint32_t start = entries.back();
+        for (size_t i = entries.size() - 1; i-- > 0;) {
+            NfaState state;
+            state.kind = NfaState::Split;
+            state.out = entries[i];
+            state.out1 = start;
+            m_nfa.push_back(state);
+            start = static_cast<uint32_t>(m_nfa.size() - 1);
+        }
+        m_nfa_start = start;
+
+        // Byte classes: bytes no regex set tells apart share a class
+        std::vector<uint16_t> classOf(256, 0);
+        uint16_t classes = 1;
+        for (const ByteSet& set : m_sets) {
+            std::map<std::pair<uint16_t, bool>, uint16_t> renumber;
+            for (int b = 0; b < 256; ++b) {
+                const auto key = std::make_pair(classOf[b], set.has(static_cast<uint8_t>(b)));
+                auto it = renumber.emplace(key, static_cast<uint16_t>(renumber.size())).first;
+                classOf[b] = it->second;
+            }
+            classes = static_cast<uint16_t>(renumber.size());
+        }
+        m_re_classes = classes;
+        for (int b = 255; b >= 0; --b) {
+            m_re_class[b] = static_cast<uint8_t>(classOf[b]);
+            m_re_class_byte[classOf[b]] = static_cast<uint8_t>(b);
+        }
+        m_visit.assign(m_nfa.size(), 0);
+        reset_dfa();
+    }
+
+    // Prefilter: bytes that take an idle automaton anywhere
+    size_t startCount = 0;
+    for (int b = 0; b < 256; ++b) {
+        bool start = false;
+        if (m_literal_count > 0 && m_ac_next[m_ac_class[b]] != 0) {
+            start = true;
+        }
+        if (m_regex_count > 0 && dfa_step(m_dfa_idle, m_re_class[b]) != m_dfa_idle) {
+            start = true;
+        }
+        m_start_bytes[b] = start;
+        startCount += start ? 1 : 0;
+    }
+    // Checking for a skip costs a mispredicted branch whenever most bytes
+    // can start a match anyway (keyword lists covering the alphabet)
+    m_skip = startCount <= kSkipBytes;
+    if (startCount > 0 && startCount <= kPrefilterBytes) {
+        for (int b = 0; b < 256; ++b) {
+            if (m_start_bytes[b]) {
+                m_prefilter.push_back(static_cast<uint8_t>(b));
+            }
+        }
+    }
+
+    m_seen.assign(m_pattern_count, 0);
+    return true;
+}
+
+bool PatternMatcher::build_literals(const std::vector<std::pair<std::string, uint32_t>>& literals,
+                                    std::string& error) {
+    if (literals.empty()) {
+        return true;
+    }
+    auto fold = [this](uint8_t b) { return m_ignore_case ? ascii_lower(b) : b; };
+
+    // Class 0 is every byte no literal contains
+    uint16_t classOf[256] = {};
+    uint32_t classes = 1;
+    for (const auto& literal : literals) {
+        for (char c : literal.first) {
+            const uint8_t b = fold(static_cast<uint8_t>(c));
+            if (classOf[b] == 0) {
+                classOf[b] = static_cast<uint16_t>(classes++);
+            }
+        }
+    }
+    m_ac_classes = classes;
+    for (int b = 0; b < 256; ++b) {
+        m_ac_class[b] = classOf[fold(static_cast<uint8_t>(b))];
+    }
+
+    // Trie; missing edges are kNone until the BFS below fills them
+    const uint32_t kNone = std::numeric_limits<uint32_t>::max();
+    m_ac_next.assign(classes, kNone);
+    std::vector<std::vector<uint32_t>> outputs(1);
+    for (const auto& literal : literals) {
+        uint32_t state = 0;
+        for (char c : literal.first) {
+            const uint32_t cls = classOf[fold(static_cast<uint8_t>(c))];
+            uint32_t& edge = m_ac_next[state * classes + cls];
+            if (edge == kNone) {
+                const uint32_t created = static_cast<uint32_t>(outputs.size());
+                edge = created;
+                outputs.emplace_back();
+                m_ac_next.resize(m_ac_next.size() + classes, kNone);
+                state = created;
+            } else {
+                state = edge;
+            }
+        }
+        outputs[state].push_back(literal.second);
+    }
+
+    if (static_cast<uint64_t>(outputs.size()) * classes >= kOutputFlag) {
+        error = "keywords are too large (" + std::to_string(outputs.size()) + " automaton states)";
+        return false;
+    }
+
+    // Failure links, folded into a complete transition table
+    std::vector<uint32_t> failure(outputs.size(), 0);
+    std::deque<uint32_t> queue;
+    for (uint32_t cls = 0; cls < classes; ++cls) {
+        uint32_t& edge = m_ac_next[cls];
+        if (edge == kNone) {
+            edge = 0;
+        } else {
+            queue.push_back(edge);
+        }
+    }
+    while (!queue.empty()) {
+        const uint32_t state = queue.front();
+        queue.pop_front();
+        const std::vector<uint32_t>& inherited = outputs[failure[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+        for (uint32_t cls = 0; cls < classes; ++cls) {
+            const uint32_t viaFailure = m_ac_next[failure[state] * classes + cls];
+            uint32_t& edge = m_ac_next[state * classes + cls];
+            if (edge == kNone) {
+                edge = viaFailure;
+            } else {
+                failure[edge] = viaFailure;
+                queue.push_back(edge);
+            }
+        }
+    }
+
+    m_ac_out_begin.assign(outputs.size() + 1, 0);
+    for (size_t state = 0; state < outputs.size(); ++state) {
+        std::sort(outputs[state].begin(), outputs[state].end());
+        m_ac_out_begin[state] = static_cast<uint32_t>(m_ac_out.size());
+        m_ac_out.insert(m_ac_out.end(), outputs[state].begin(), outputs[state].end());
+    }
+    m_ac_out_begin[outputs.size()] = static_cast<uint32_t>(m_ac_out.size());
+
+    // Transitions hold the target's row offset, flagged when the target has
+    // output, so a step is one load with no multiply or second lookup
+    for (uint32_t& target : m_ac_next) {
+        target = (outputs[target].empty() ? 0 : kOutputFlag) | target * classes;
+    }
+    return true;
+}
+
+// ============================================================================
+// Lazy DFA
+// ============================================================================
+
+void PatternMatcher::closure(const std::vector<uint32_t>& roots, bool at_begin, bool at_end,
+                             std::vector<uint32_t>& out) {
+    out.clear();
+    if (++m_visit_stamp == 0) {
+        std::fill(m_visit.begin(), m_visit.end(), 0);
+        m_visit_stamp = 1;
+    }
+    std::vector<uint32_t>& stack = m_stack;
+    stack.assign(roots.begin(), roots.end());
+    while (!stack.empty()) {
+        const uint32_t id = stack.back();
+        stack.pop_back();
+        if (m_visit[id] == m_visit_stamp) {
+            continue;
+        }
+        m_visit[id] = m_visit_stamp;
+        const NfaState& state = m_nfa[id];
+        switch (state.kind) {
+            case NfaState::Bytes:
+            case NfaState::Match:
+                out.push_back(id);
+                break;
+            case NfaState::Split:
+                stack.push_back(state.out1);
+                stack.push_back(state.out);
+                break;
+            case NfaState::Jump:
+                stack.push_back(state.out);
+                break;
+            case NfaState::AssertBegin:
+                if (at_begin) {
+                    stack.push_back(state.out);
+                }
+                break;
+            case NfaState::AssertEnd:
+                if (at_end) {
+                    stack.push_back(state.out);
+                } else {
+                    out.push_back(id);  // resolved when the text ends here
+                }
+                break;
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+uint32_t PatternMatcher::intern(std::vector<uint32_t>&& nfa) {
+    auto found = m_dfa_index.find(nfa);
+    if (found != m_dfa_index.end()) {
+        return found->second;
+    }
+    DfaState state;
+    for (uint32_t id : nfa) {
+        if (m_nfa[id].kind == NfaState::Match) {
+            state.accepts.push_back(m_nfa[id].pattern);
+        }
+    }
+    std::sort(state.accepts.begin(), state.accepts.end());
+    state.accepts.erase(std::unique(state.accepts.begin(), state.accepts.end()), state.accepts.end());
+    state.nfa = std::move(nfa);
+
+    const uint32_t index = static_cast<uint32_t>(m_dfa.size());
+    m_dfa_index.emplace(state.nfa, index);
+    m_dfa.push_back(std::move(state));
+    m_dfa_next.resize(m_dfa_next.size() + m_re_classes, -1);
+    return index;
+}
+
+void PatternMatcher::reset_dfa() {
+    m_dfa.clear();
+    m_dfa_next.clear();
+    m_dfa_index.clear();
+    std::vector<uint32_t> roots(1, m_nfa_start);
+    std::vector<uint32_t> set;
+    closure(roots, true, false, set);
+    m_dfa_begin = intern(std::move(set));
+    set = std::vector<uint32_t>();
+    closure(roots, false, false, set);
+    m_dfa_idle = intern(std::move(set));
+}
+
+uint32_t PatternMatcher::dfa_step(uint32_t state, uint8_t cls) {
+    const size_t slot = static_cast<size_t>(state) * m_re_classes + cls;
+    if (m_dfa_next[slot] >= 0) {
+        return static_cast<uint32_t>(m_dfa_next[slot]);
+    }
+
+    // Every regex may also start at the next byte (unanchored search)
+    const uint8_t byte = m_re_class_byte[cls];
+    std::vector<uint32_t> roots(1, m_nfa_start);
+    for (uint32_t id : m_dfa[state].nfa) {
+        const NfaState& nfa = m_nfa[id];
+        if (nfa.kind == NfaState::Bytes && m_sets[nfa.set].has(byte)) {
+            roots.push_back(nfa.out);
+        }
+    }
+    std::vector<uint32_t> next;
+    closure(roots, false, false, next);
+
+    if (m_dfa.size() >= kMaxDfaStates && m_dfa_index.find(next) == m_dfa_index.end()) {
+        // Start over rather than grow without bound; the source state is gone
+        // with the cache, so this transition is not recorded
+        reset_dfa();
+        return intern(std::move(next));
+    }
+    const uint32_t target = intern(std::move(next));
+    m_dfa_next[slot] = dfa_entry(target);
+    return target;
+}
+
+const std::vector<uint32_t>& PatternMatcher::end_accepts(uint32_t state) {
+    DfaState& dfa = m_dfa[state];
+    if (!dfa.end_computed) {
+        std::vector<uint32_t> roots;
+        for (uint32_t id : dfa.nfa) {
+            if (m_nfa[id].kind == NfaState::AssertEnd) {
+                roots.push_back(m_nfa[id].out);
+            }
+        }
+        if (!roots.empty()) {
+            std::vector<uint32_t> reached;
+            closure(roots, false, true, reached);
+            for (uint32_t id : reached) {
+                if (m_nfa[id].kind == NfaState::Match) {
+                    dfa.end_accepts.push_back(m_nfa[id].pattern);
+                }
+            }
+        }
+        dfa.end_computed = true;
+    }
+    return dfa.end_accepts;
+}
+
+// ============================================================================
+// Matching
+// ============================================================================
+
+size_t PatternMatcher::skip(const uint8_t* text, size_t i, size_t length) const {
+#if RUNE_PATTERN_MATCHER_SSE2
+    if (!m_prefilter.empty()) {
+        __m128i needles[kPrefilterBytes];
+        const size_t count = m_prefilter.size();
+        for (size_t k = 0; k < count; ++k) {
+            needles[k] = _mm_set1_epi8(static_cast<char>(m_prefilter[k]));
+        }
+        for (; i + 16 <= length; i += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i hits = _mm_cmpeq_epi8(chunk, needles[0]);
+            for (size_t k = 1; k < count; ++k) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[k]));
+            }
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+            if (mask != 0) {
+                return i + lowest_bit(mask);
+            }
+        }
+    }
+#endif
+    while (i < length && !m_start_bytes[text[i]]) {
+        ++i;
+    }
+    return i;
+}
+
+void PatternMatcher::mark(const std::vector<uint32_t>& patterns) {
+    for (uint32_t id : patterns) {
+        if (!m_seen[id]) {
+            m_seen[id] = 1;
+            m_found.push_back(id);
+        }
+    }
+}
+
+int32_t PatternMatcher::dfa_entry(uint32_t state) const {
+    const uint32_t offset = state * m_re_classes;
+    return static_cast<int32_t>(m_dfa[state].accepts.empty() ? offset : offset | kOutputFlag);
+}
+
+void PatternMatcher::mark_literals(uint32_t state) {
+    for (uint32_t i = m_ac_out_begin[state]; i < m_ac_out_begin[state + 1]; ++i) {
+        const uint32_t id = m_ac_out[i];
+        if (!m_seen[id]) {
+            m_seen[id] = 1;
+            m_found.push_back(id);
+        }
+    }
+}
+
+void PatternMatcher::match(const char* text, size_t length, std::vector<uint32_t>& out) {
+    if (m_pattern_count == 0) {
+        return;
+    }
+    m_found.clear();
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(text);
+    const bool literals = m_literal_count > 0;
+    const bool regexes = m_regex_count > 0;
+
+    // Hot loop state in locals; ac and dfa are row offsets into their
+    // tables, and the DFA table moves when dfa_step() adds a state
+    const uint32_t* acNext = m_ac_next.data();
+    const uint32_t acClasses = m_ac_classes;
+    const uint32_t reClasses = m_re_classes;
+    const int32_t* dfaNext = m_dfa_next.data();
+    uint32_t dfaIdle = m_dfa_idle * reClasses;
+
+    uint32_t ac = 0;
+    uint32_t dfa = m_dfa_begin * reClasses;
+    if (regexes) {
+        mark(m_dfa[m_dfa_begin].accepts);
+    }
+
+    size_t i = 0;
+    while (i < length && m_found.size() < m_pattern_count) {
+        if (m_skip && ac == 0 && (!regexes || dfa == dfaIdle) && !m_start_bytes[bytes[i]]) {
+            i = skip(bytes, i + 1, length);
+            if (i == length) {
+                break;
+            }
+        }
+        const uint8_t b = bytes[i++];
+        if (literals) {
+            ac = acNext[ac + m_ac_class[b]];
+            if (ac & kOutputFlag) {
+                ac &= ~kOutputFlag;
+                mark_literals(ac / acClasses);
+            }
+        }
+        if (regexes) {
+            const uint8_t cls = m_re_class[b];
+            int32_t next = dfaNext[dfa + cls];
+            if (next < 0) {
+                next = dfa_entry(dfa_step(dfa / reClasses, cls));
+                dfaNext = m_dfa_next.data();
+                dfaIdle = m_dfa_idle * reClasses;
+            }
+            dfa = static_cast<uint32_t>(next) & ~kOutputFlag;
+            if (static_cast<uint32_t>(next) & kOutputFlag) {
+                mark(m_dfa[dfa / reClasses].accepts);
+            }
+        }
+    }
+
+    if (regexes && m_found.size() < m_pattern_count) {
+        if (length == 0) {
+            // ^ and $ both hold on an empty text
+            std::vector<uint32_t> roots(1, m_nfa_start);
+            std::vector<uint32_t> reached;
+            closure(roots, true, true, reached);
+            for (uint32_t id : reached) {
+                if (m_nfa[id].kind == NfaState::Match && !m_seen[m_nfa[id].pattern]) {
+                    m_seen[m_nfa[id].pattern] = 1;
+                    m_found.push_back(m_nfa[id].pattern);
+                }
+            }
+        } else {
+            mark(end_accepts(dfa / m_re_classes));
+        }
+    }
+
+    std::sort(m_found.begin(), m_found.end());
+    for (uint32_t id : m_found) {
+        m_seen[id] = 0;
+    }
+    out.insert(out.end(), m_found.begin(), m_found.end());
+}
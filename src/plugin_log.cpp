@@ -0,0 +1,153 @@
+/**
+ * Plugin Log - Implementation
+ */
+
+#include "plugin_log.h"
+#include <dpp/dpp.h>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+std::atomic<int> g_discord_log_level{ PLUGIN_LOG_LEVEL_INFO };
+std::atomic<int> g_discord_dpp_log_severity{ dpp::ll_warning };
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Lines queued between two flushes (one tick); more are dropped and counted
+constexpr size_t kQueueCapacity = 4096;
+constexpr auto kRateWindow = std::chrono::seconds(10);
+
+struct LogLine {
+    int level = 0;
+    const char* site = nullptr;
+    std::string message;
+};
+
+// Rate-limit window of one call site (flush side only)
+struct SiteState {
+    Clock::time_point window_start;
+    uint32_t count = 0;
+    uint32_t suppressed = 0;
+    int level = 0;
+    std::string last;
+};
+
+std::atomic<uint32_t> g_rate_limit{ 20 };
+
+// Writers append to g_queue; the flush swaps it with g_draining so the host
+// is called without the lock held. Both keep their capacity across swaps.
+std::mutex g_queue_mutex;
+std::vector<LogLine> g_queue;
+uint64_t g_queue_dropped = 0;
+
+std::vector<LogLine> g_draining;
+std::unordered_map<const char*, SiteState> g_sites;
+Clock::time_point g_last_sweep;
+
+int parse_log_level(const std::string& name) {
+    if (name == "debug") return PLUGIN_LOG_LEVEL_DEBUG;
+    if (name == "warn" || name == "warning") return PLUGIN_LOG_LEVEL_WARN;
+    if (name == "error") return PLUGIN_LOG_LEVEL_ERROR;
+    return PLUGIN_LOG_LEVEL_INFO;
+}
+
+int parse_dpp_severity(const std::string& name) {
+    if (name == "trace") return dpp::ll_trace;
+    if (name == "debug") return dpp::ll_debug;
+    if (name == "info") return dpp::ll_info;
+    if (name == "error") return dpp::ll_error;
+    if (name == "critical") return dpp::ll_critical;
+    return dpp::ll_warning;
+}
+
+void report_suppressed(SiteState& site) {
+    if (site.suppressed == 0) {
+        return;
+    }
+    std::string msg = "Discord plugin: suppressed " + std::to_string(site.suppressed) +
+        " similar line(s), last: " + site.last;
+    g_host->log(site.level, msg.c_str());
+    site.suppressed = 0;
+    site.last.clear();
+}
+
+}  // namespace
+
+void discord_log_configure(const DiscordPluginConfig& cfg) {
+    g_discord_log_level.store(parse_log_level(cfg.log_level), std::memory_order_relaxed);
+    g_discord_dpp_log_severity.store(parse_dpp_severity(cfg.dpp_log_min_severity), std::memory_order_relaxed);
+    g_rate_limit.store(cfg.log_rate_limit, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_queue_mutex);
+    g_queue.reserve(kQueueCapacity);
+}
+
+void discord_log_write(int level, const char* site, std::string message) {
+    std::lock_guard<std::mutex> lock(g_queue_mutex);
+    if (g_queue.size() >= kQueueCapacity) {
+        ++g_queue_dropped;
+        return;
+    }
+    g_queue.push_back(LogLine{ level, site, std::move(message) });
+}
+
+void discord_log_flush(bool final) {
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_queue_mutex);
+        g_draining.swap(g_queue);
+        if (g_queue.capacity() < kQueueCapacity) {
+            g_queue.reserve(kQueueCapacity);
+        }
+        dropped = g_queue_dropped;
+        g_queue_dropped = 0;
+    }
+    if (!g_host) {
+        g_draining.clear();
+        return;
+    }
+
+    const Clock::time_point now = Clock::now();
+    const uint32_t limit = g_rate_limit.load(std::memory_order_relaxed);
+    for (auto& line : g_draining) {
+        if (limit == 0) {
+            g_host->log(line.level, line.message.c_str());
+            continue;
+        }
+        SiteState& site = g_sites[line.site];
+        if (now - site.window_start >= kRateWindow) {
+            report_suppressed(site);
+            site.window_start = now;
+            site.count = 0;
+        }
+        if (++site.count <= limit) {
+            g_host->log(line.level, line.message.c_str());
+        } else {
+            ++site.suppressed;
+            site.level = line.level;
+            site.last = std::move(line.message);
+        }
+    }
+    g_draining.clear();
+
+    if (dropped > 0) {
+        std::string msg = "Discord plugin: log queue full, dropped " + std::to_string(dropped) + " line(s)";
+        g_host->log(PLUGIN_LOG_LEVEL_WARN, msg.c_str());
+    }
+
+    // Summaries of sites that went quiet are due once their window closes
+    if (final || now - g_last_sweep >= std::chrono::seconds(1)) {
+        g_last_sweep = now;
+        for (auto& entry : g_sites) {
+            SiteState& site = entry.second;
+            if (site.suppressed > 0 && (final || now - site.window_start >= kRateWindow)) {
+                report_suppressed(site);
+                site.window_start = now;
+                site.count = 0;
+            }
+        }
+    }
+}
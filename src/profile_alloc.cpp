@@ -0,0 +1,47 @@
+/**
+ * Profile Alloc - Per-thread heap allocation counter for the node profiler
+ *
+ * Only built into the plugin with RUNE_DISCORD_PROFILE_ALLOCS. Replaces the
+ * plugin's global operator new/delete with malloc/free plus a thread-local
+ * count. On ELF platforms the plugin is then linked with
+ * -Bsymbolic-functions, so only the plugin's own allocations bind here and
+ * the host's allocator is left alone; Windows DLLs and macOS two-level
+ * namespaces bind locally already.
+ */
+
+#include "node_profiler.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local uint64_t t_allocs = 0;
+
+uint64_t thread_alloc_count() {
+    return t_allocs;
+}
+
+struct InstallAllocCounter {
+    InstallAllocCounter() { NodeProfiler::instance().set_alloc_counter(thread_alloc_count); }
+};
+
+InstallAllocCounter s_install;
+
+}  // namespace
+
+// new[] and the nothrow forms go through operator new(size_t) by default
+void* operator new(std::size_t size) {
+    ++t_allocs;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
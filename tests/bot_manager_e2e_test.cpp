@@ -0,0 +1,429 @@
+/**
+ * BotManager End-to-End Test - The plugin behind a fake host, with MockDiscord
+ * installed as the session's transport
+ *
+ * Usage: bot_manager_e2e_test
+ * Exits non-zero if any check fails. Each case drives BotManager the way the
+ * nodes do and checks the REST calls and gateway frames that reached the mock.
+ * Dispatches from the mock go through BotManager::handle_dispatch(), the
+ * function the live DPP handlers forward to.
+ */
+
+#include "bot_manager.h"
+#include "discord_plugin.h"
+#include "mock_discord.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+NODEPLUG_EXPORT const PluginAPI* NodePlugin_GetAPI(void);
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+static const uint64_t kGuildId = 81384788765712384ULL;
+static const uint64_t kChannelId = 81384788765712385ULL;
+static const uint64_t kBotUserId = 81384788765712386ULL;
+static const uint64_t kAuthorId = 81384788765712387ULL;
+static const uint32_t kAutoDeferMs = 50;
+
+static int g_failures = 0;
+static std::vector<std::string> g_startup_frames;  // gateway frames sent after the first READY
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_failures;                                                        \
+        }                                                                        \
+    } while (0)
+
+// ============================================================================
+// Fake host
+// ============================================================================
+
+static std::string g_settings_json;
+static std::string g_flows_directory;
+
+static void test_log(int level, const char* message) {
+    if (level >= PLUGIN_LOG_LEVEL_WARN) {
+        std::fprintf(stderr, "  [plugin] %s\n", message);
+    }
+}
+
+static const char* test_get_setting(HostServices*, const char* key) {
+    if (std::strcmp(key, "com.rune.discord") == 0) {
+        return g_settings_json.c_str();
+    }
+    if (std::strcmp(key, "flows_directory") == 0) {
+        return g_flows_directory.c_str();
+    }
+    return nullptr;
+}
+
+static void test_register_node(const NodeDesc*, const NodeVTable*) {
+}
+
+static HostServices g_host_services{};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// Ticks the plugin as the host would until done() holds; false on timeout
+static bool tick_until(const PluginAPI* api, const std::function<bool()>& done,
+                       Clock::duration timeout = std::chrono::seconds(2)) {
+    const auto deadline = Clock::now() + timeout;
+    while (!done()) {
+        if (Clock::now() > deadline) {
+            return false;
+        }
+        api->on_tick(0.0f);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static void tick_for(const PluginAPI* api, Clock::duration duration) {
+    const auto until = Clock::now() + duration;
+    tick_until(api, [&]() { return Clock::now() > until; }, duration + std::chrono::seconds(1));
+}
+
+static std::vector<MockRequest> requests_to(const MockDiscord& mock, const std::string& route) {
+    std::vector<MockRequest> matched;
+    for (const auto& request : mock.requests()) {
+        if (request.route == route) {
+            matched.push_back(request);
+        }
+    }
+    return matched;
+}
+
+static std::string body_string(const MockRequest& request, const char* key) {
+    json body = json::parse(request.body, nullptr, false);
+    return body.is_object() && body.contains(key) && body[key].is_string() ? body[key].get<std::string>() : "";
+}
+
+// ============================================================================
+// Cases
+// ============================================================================
+
+// Gateway MESSAGE_CREATE -> message listener -> reply through the transport
+static void test_message_reply(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    bot.add_message_listener([&bot](const MessageEventData& event) {
+        bot.send_message(event.channel_id, "pong: " + event.content);
+    });
+
+    mock.message_create(kGuildId, kChannelId, kAuthorId, "ping");
+    CHECK(tick_until(api, [&]() { return !requests_to(mock, "POST /channels/{id}/messages").empty(); }));
+
+    const auto sent = requests_to(mock, "POST /channels/{id}/messages");
+    CHECK(sent.size() == 1);
+    if (!sent.empty()) {
+        CHECK(sent[0].path == "/channels/" + std::to_string(kChannelId) + "/messages");
+        CHECK(sent[0].status == 200);
+        CHECK(body_string(sent[0], "content") == "pong: ping");
+    }
+    bot.clear_listeners();
+}
+
+// dispatching_event() is the event whose listeners are running, and only then
+static void test_dispatching_event(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    std::string seenContent;
+    bool seenType = false;
+    bot.add_message_listener([&](const MessageEventData&) {
+        const QueuedEvent* event = bot.dispatching_event();
+        if (event) {
+            seenType = event->type == DiscordEventType::Message;
+            seenContent = event->message_data.content;
+        }
+    });
+
+    mock.message_create(kGuildId, kChannelId, kAuthorId, "bound");
+    CHECK(tick_until(api, [&]() { return !seenContent.empty(); }));
+    CHECK(seenType);
+    CHECK(seenContent == "bound");
+    CHECK(bot.dispatching_event() == nullptr);
+    bot.clear_listeners();
+}
+
+// The first DM opens the channel; the next reuses it, and a 404 on the cached
+// channel reopens it
+static void test_direct_messages(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    const auto messages = [&]() { return requests_to(mock, "POST /channels/{id}/messages").size(); };
+
+    bot.send_direct_message(kAuthorId, "first");
+    CHECK(tick_until(api, [&]() { return messages() == 1; }));
+    CHECK(requests_to(mock, "POST /users/@me/channels").size() == 1);
+
+    bot.send_direct_message(kAuthorId, "second");
+    CHECK(tick_until(api, [&]() { return messages() == 2; }));
+    CHECK(requests_to(mock, "POST /users/@me/channels").size() == 1);
+
+    const auto sent = requests_to(mock, "POST /channels/{id}/messages");
+    if (sent.size() == 2) {
+        CHECK(sent[0].path == sent[1].path);
+        CHECK(sent[0].path != "/channels/" + std::to_string(kChannelId) + "/messages");
+        CHECK(body_string(sent[1], "content") == "second");
+    }
+
+    mock.fail_next("POST /channels/{id}/messages", 404);
+    bot.send_direct_message(kAuthorId, "after a 404");
+    CHECK(tick_until(api, [&]() { return messages() == 4; }));
+    CHECK(requests_to(mock, "POST /users/@me/channels").size() == 2);
+}
+
+// A command nobody takes is released without a response; one a listener
+// takes but does not answer is auto-deferred
+static void test_slash_commands(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    const auto callbacks = [&]() { return requests_to(mock, "POST /interactions/{id}/{token}/callback"); };
+
+    mock.slash_command(kGuildId, kChannelId, kAuthorId, "unheard");
+    tick_for(api, std::chrono::milliseconds(kAutoDeferMs * 4));
+    CHECK(callbacks().empty());
+
+    std::string seen;
+    bot.add_slash_command_listener([&seen](const InteractionEventData& event) {
+        seen = event.command_name;
+        return true;
+    });
+    const uint64_t interaction = mock.slash_command(kGuildId, kChannelId, kAuthorId, "slow");
+    CHECK(tick_until(api, [&]() { return !callbacks().empty(); }));
+    CHECK(seen == "slow");
+
+    const auto sent = callbacks();
+    if (!sent.empty()) {
+        CHECK(sent[0].path.rfind("/interactions/" + std::to_string(interaction) + "/", 0) == 0);
+        json body = json::parse(sent[0].body, nullptr, false);
+        CHECK(body.is_object() && body.value("type", 0) == 5);
+    }
+    bot.clear_listeners();
+}
+
+// The channel webhook is created once and its token used for every execute
+static void test_webhook_messages(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    const auto executes = [&]() { return requests_to(mock, "POST /webhooks/{id}/{token}"); };
+
+    bot.send_webhook_message(kChannelId, "one", "relay", "");
+    CHECK(tick_until(api, [&]() { return executes().size() == 1; }));
+    bot.send_webhook_message(kChannelId, "two", "relay", "");
+    CHECK(tick_until(api, [&]() { return executes().size() == 2; }));
+
+    CHECK(requests_to(mock, "POST /channels/{id}/webhooks").size() == 1);
+    for (const auto& execute : executes()) {
+        CHECK(execute.status == 200);
+        CHECK(body_string(execute, "username") == "relay");
+    }
+    CHECK(requests_to(mock, "POST /channels/{id}/messages").empty());
+}
+
+// A message whose webhook is gone is sent again through a re-resolved
+// webhook, and as the bot if that fails too
+static void test_webhook_recovery(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    const auto executes = [&]() { return requests_to(mock, "POST /webhooks/{id}/{token}"); };
+
+    mock.fail_next("POST /webhooks/{id}/{token}", 404);
+    bot.send_webhook_message(kChannelId, "survives", "relay", "");
+    CHECK(tick_until(api, [&]() { return executes().size() == 2; }));
+    CHECK(requests_to(mock, "GET /channels/{id}/webhooks").size() == 1);
+    const auto sent = executes();
+    if (sent.size() == 2) {
+        CHECK(sent[0].status == 404);
+        CHECK(sent[1].status == 200);
+        CHECK(body_string(sent[1], "content") == "survives");
+    }
+
+    mock.fail_next("POST /webhooks/{id}/{token}", 401, 2);
+    bot.send_webhook_message(kChannelId, "as the bot", "relay", "");
+    CHECK(tick_until(api, [&]() { return !requests_to(mock, "POST /channels/{id}/messages").empty(); }));
+    const auto fallback = requests_to(mock, "POST /channels/{id}/messages");
+    CHECK(fallback.size() == 1);
+    if (!fallback.empty()) {
+        CHECK(body_string(fallback[0], "content") == "as the bot");
+    }
+}
+
+// A re-identified shard gets the current presence back, and nothing else
+static void test_ready_presence(const PluginAPI* api, MockDiscord& mock) {
+    CHECK(g_startup_frames.size() == 1);
+
+    mock.ready(kBotUserId, { kGuildId });
+    CHECK(tick_until(api, [&]() { return !mock.gateway_frames().empty(); }));
+    tick_for(api, std::chrono::milliseconds(20));
+
+    const auto frames = mock.gateway_frames();
+    CHECK(frames.size() == 1);
+    if (frames.size() == 1 && g_startup_frames.size() == 1) {
+        CHECK(frames[0] == g_startup_frames[0]);
+    }
+}
+
+// Messages are indexed with the timestamp Discord sent, as in a live session
+static void test_message_index(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    const uint64_t id = mock.message_create(kGuildId, kChannelId, kAuthorId, "indexed through dispatch");
+
+    MessageQuery query;
+    query.text = "indexed dispatch";
+    std::vector<IndexedMessage> found;
+    CHECK(tick_until(api, [&]() {
+        found.clear();
+        return bot.message_index().search(query, found) > 0;
+    }));
+    if (!found.empty()) {
+        CHECK(found[0].id == id);
+        CHECK(found[0].author_id == kAuthorId);
+        CHECK(found[0].timestamp == static_cast<int64_t>(((id >> 22) + 1420070400000ULL) / 1000));
+    }
+}
+
+// A user fetch goes to REST once and is answered on the main thread
+static void test_fetch_user(const PluginAPI* api, MockDiscord& mock) {
+    auto& bot = BotManager::instance();
+    const std::thread::id mainThread = std::this_thread::get_id();
+
+    int answered = 0;
+    UserRecord record;
+    bool onMainThread = false;
+    bot.fetch_user(kAuthorId, [&](const UserRecord& user) {
+        record = user;
+        onMainThread = std::this_thread::get_id() == mainThread;
+        ++answered;
+    });
+    CHECK(tick_until(api, [&]() { return answered == 1; }));
+    CHECK(onMainThread);
+    CHECK(record.username == "e2e-user");
+    CHECK(requests_to(mock, "GET /users/{id}").size() == 1);
+
+    bot.fetch_user(kAuthorId, [&](const UserRecord&) { ++answered; });
+    CHECK(tick_until(api, [&]() { return answered == 2; }));
+    CHECK(requests_to(mock, "GET /users/{id}").size() == 1);
+}
+
+// <flows>/<flow_id>/flow.json with one On Slash Command node per command
+static void write_command_flow(const std::string& flow_id, const std::vector<std::string>& commands) {
+    json nodes = json::array();
+    for (const std::string& command : commands) {
+        nodes.push_back({
+            {"id", nodes.size()},
+            {"type", "com.rune.discord.on_slash_command"},
+            {"properties", { {"Command", command}, {"Description", "The " + command + " command"} }}
+        });
+    }
+    const auto dir = std::filesystem::path(g_flows_directory) / flow_id;
+    std::filesystem::create_directories(dir);
+    std::ofstream out(dir / "flow.json", std::ios::binary | std::ios::trunc);
+    out << json{ {"id", flow_id}, {"nodes", nodes}, {"links", json::array()} }.dump();
+}
+
+// Commands come from the loaded flow files: unloading the flow keeps them
+// registered, and only removing them from the file clears the scope
+static void test_command_sync(const PluginAPI* api, MockDiscord& mock) {
+    const auto overwrites = [&]() { return requests_to(mock, "PUT /applications/{id}/commands"); };
+    const auto settled = std::chrono::milliseconds(1500);
+
+    write_command_flow("commands", { "ping", "echo" });
+    api->on_flow_loaded("commands");
+    CHECK(tick_until(api, [&]() { return !overwrites().empty(); }, std::chrono::seconds(3)));
+    auto sent = overwrites();
+    CHECK(sent.size() == 1);
+    if (!sent.empty()) {
+        json body = json::parse(sent[0].body, nullptr, false);
+        CHECK(body.is_array() && body.size() == 2 && body[0].value("name", "") == "echo");
+    }
+
+    mock.clear_log();
+    api->on_flow_unloaded("commands");
+    tick_for(api, settled);
+    api->on_flow_loaded("commands");
+    tick_for(api, settled);
+    CHECK(overwrites().empty());
+
+    write_command_flow("commands", {});
+    api->on_flow_loaded("commands");
+    CHECK(tick_until(api, [&]() { return !overwrites().empty(); }, std::chrono::seconds(3)));
+    sent = overwrites();
+    CHECK(sent.size() == 1 && sent[0].body == "[]");
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    const PluginAPI* api = NodePlugin_GetAPI();
+
+    const auto flowsDir = std::filesystem::temp_directory_path() / "rune_discord_e2e";
+    std::filesystem::remove_all(flowsDir);
+    std::filesystem::create_directories(flowsDir);
+    g_flows_directory = flowsDir.string();
+
+    json settings = json::parse(api->get_settings_schema()->defaults);
+    settings["interaction_auto_defer_ms"] = kAutoDeferMs;
+    settings["message_index_enabled"] = true;
+    g_settings_json = settings.dump();
+
+    g_host_services.log = test_log;
+    g_host_services.get_setting = test_get_setting;
+    api->on_load(&g_host_services);
+
+    PluginNodeRegistry registry{};
+    registry.register_node = test_register_node;
+    api->on_register(&registry, nullptr);
+
+    MockDiscord mock;
+    mock.add_user(kAuthorId, "e2e-user");
+    mock.add_channel(kChannelId, kGuildId, "general");
+    mock.add_member(kGuildId, kAuthorId);
+
+    BotManager::instance().set_transport(&mock);
+    if (!BotManager::instance().initialize("e2e")) {
+        std::fprintf(stderr, "BotManager failed to start against the mock\n");
+        return 1;
+    }
+    mock.ready(kBotUserId, { kGuildId });
+    CHECK(tick_until(api, [&]() { return mock.pending() == 0 && !mock.gateway_frames().empty(); }));
+    g_startup_frames = mock.gateway_frames();
+
+    const std::vector<std::pair<const char*, void (*)(const PluginAPI*, MockDiscord&)>> cases = {
+        { "message_reply", test_message_reply },
+        { "dispatching_event", test_dispatching_event },
+        { "direct_messages", test_direct_messages },
+        { "slash_commands", test_slash_commands },
+        { "webhook_messages", test_webhook_messages },
+        { "webhook_recovery", test_webhook_recovery },
+        { "fetch_user", test_fetch_user },
+        { "ready_presence", test_ready_presence },
+        { "message_index", test_message_index },
+        { "command_sync", test_command_sync },
+    };
+    for (const auto& testCase : cases) {
+        const int before = g_failures;
+        mock.clear_log();
+        testCase.second(api, mock);
+        std::printf("%-20s %s\n", testCase.first, g_failures == before ? "ok" : "FAILED");
+    }
+
+    api->on_unload();
+    BotManager::instance().set_transport(nullptr);
+    std::filesystem::remove_all(flowsDir);
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    return 0;
+}